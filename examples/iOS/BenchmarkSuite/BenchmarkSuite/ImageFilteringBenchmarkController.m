@@ -29,9 +29,164 @@
     UIImage *imageFilteredUsingGPUImageRoutine = [self imageProcessedUsingGPUImage:inputImage];
     [self writeImage:imageFilteredUsingGPUImageRoutine toFile:@"Lambeau-GPUImageFiltered.png"];
     
+    [self logKuwaharaRadiusSweepForImage:inputImage];
+    [self logResamplingRatioSweepForImage:inputImage];
+    [self logBatchThroughputForImage:inputImage];
+    [self logToneCurveUpdateTimes];
+    
     [self.tableView reloadData];
 }
 
+- (CGFloat)millisecondsToProcessImage:(UIImage *)imageToProcess withFilter:(GPUImageOutput<GPUImageInput> *)filter;
+{
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    
+    GPUImagePicture *stillImageSource = [[GPUImagePicture alloc] initWithImage:imageToProcess];
+    [stillImageSource addTarget:filter];
+    [filter useNextFrameForImageCapture];
+    [stillImageSource processImage];
+    CGImageRef filteredImage = [filter newCGImageFromCurrentlyProcessedOutput];
+    CGImageRelease(filteredImage);
+    
+    return (CFAbsoluteTimeGetCurrent() - startTime) * 1000.0;
+}
+
+- (void)logKuwaharaRadiusSweepForImage:(UIImage *)imageToProcess;
+{
+    if (![GPUImageSummedAreaTableFilter isSupported])
+    {
+        NSLog(@"Summed-area tables need float render targets, skipping the radius sweep");
+        return;
+    }
+    
+    // The shader loop of GPUImageKuwaharaFilter gets too slow to finish a frame at the larger radii, so it's only compared up to 8
+    for (NSUInteger radius = 2; radius <= 32; radius *= 2)
+    {
+        GPUImageIntegralKuwaharaFilter *integralKuwaharaFilter = [[GPUImageIntegralKuwaharaFilter alloc] init];
+        integralKuwaharaFilter.radius = radius;
+        CGFloat integralTime = [self millisecondsToProcessImage:imageToProcess withFilter:integralKuwaharaFilter];
+        
+        if (radius <= 8)
+        {
+            GPUImageKuwaharaFilter *kuwaharaFilter = [[GPUImageKuwaharaFilter alloc] init];
+            kuwaharaFilter.radius = radius;
+            CGFloat loopTime = [self millisecondsToProcessImage:imageToProcess withFilter:kuwaharaFilter];
+            NSLog(@"Kuwahara radius %lu: %f ms summed-area table, %f ms shader loop", (unsigned long)radius, integralTime, loopTime);
+        }
+        else
+        {
+            NSLog(@"Kuwahara radius %lu: %f ms summed-area table", (unsigned long)radius, integralTime);
+        }
+    }
+}
+
+- (void)logResamplingRatioSweepForImage:(UIImage *)imageToProcess;
+{
+    NSArray *modeNames = @[@"automatic", @"box prefiltered Lanczos", @"repeated halving", @"area average"];
+    CGFloat ratios[] = {1.5, 2.0, 3.0, 4.0, 8.0, 16.0};
+    
+    for (NSUInteger ratioIndex = 0; ratioIndex < sizeof(ratios) / sizeof(ratios[0]); ratioIndex++)
+    {
+        CGSize outputSize = CGSizeMake(round(imageToProcess.size.width / ratios[ratioIndex]), round(imageToProcess.size.height / ratios[ratioIndex]));
+        for (GPUImageResamplingMode mode = kGPUImageResamplingAutomatic; mode <= kGPUImageResamplingAreaAverage; mode++)
+        {
+            GPUImageResamplingFilter *resamplingFilter = [[GPUImageResamplingFilter alloc] init];
+            resamplingFilter.resamplingMode = mode;
+            [resamplingFilter forceProcessingAtSize:outputSize];
+            CGFloat resamplingTime = [self millisecondsToProcessImage:imageToProcess withFilter:resamplingFilter];
+            NSLog(@"Resampling %.1f:1 (%@): %f ms in %lu passes", ratios[ratioIndex], modeNames[mode], resamplingTime, (unsigned long)resamplingFilter.numberOfPasses);
+        }
+    }
+}
+
+- (void)logBatchThroughputForImage:(UIImage *)imageToProcess;
+{
+    NSUInteger numberOfImages = 24;
+    NSMutableArray *images = [NSMutableArray arrayWithCapacity:numberOfImages];
+    for (NSUInteger imageIndex = 0; imageIndex < numberOfImages; imageIndex++)
+    {
+        [images addObject:imageToProcess];
+    }
+    
+    // One GPUImagePicture per image, each decoded, uploaded, rendered and read back before the next one starts
+    GPUImageSepiaFilter *sequentialFilter = [[GPUImageSepiaFilter alloc] init];
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    for (UIImage *image in images)
+    {
+        @autoreleasepool {
+            GPUImagePicture *stillImageSource = [[GPUImagePicture alloc] initWithImage:image];
+            [stillImageSource addTarget:sequentialFilter];
+            [sequentialFilter useNextFrameForImageCapture];
+            [stillImageSource processImageSync];
+            [sequentialFilter imageFromCurrentFramebuffer];
+            [stillImageSource removeAllTargets];
+        }
+    }
+    double sequentialImagesPerSecond = numberOfImages / (CFAbsoluteTimeGetCurrent() - startTime);
+    
+    // The same images with the stages overlapped
+    for (NSUInteger maximumImagesInFlight = 3; maximumImagesInFlight <= 6; maximumImagesInFlight++)
+    {
+        GPUImageBatchProcessor *batchProcessor = [[GPUImageBatchProcessor alloc] initWithFilter:[[GPUImageSepiaFilter alloc] init]];
+        batchProcessor.maximumImagesInFlight = maximumImagesInFlight;
+        dispatch_semaphore_t batchSemaphore = dispatch_semaphore_create(0);
+        [batchProcessor processImages:images imageHandler:nil completion:^(BOOL finished) {
+            dispatch_semaphore_signal(batchSemaphore);
+        }];
+        dispatch_semaphore_wait(batchSemaphore, DISPATCH_TIME_FOREVER);
+        
+        NSLog(@"Batch of %lu images: %f images/s with %lu in flight, %f images/s one GPUImagePicture at a time", (unsigned long)numberOfImages, batchProcessor.imagesPerSecond, (unsigned long)maximumImagesInFlight, sequentialImagesPerSecond);
+    }
+}
+
+- (void)logToneCurveUpdateTimes;
+{
+    NSUInteger numberOfUpdates = 1000;
+    CGPoint points[] = {{0.0, 0.0}, {0.25, 0.2}, {0.5, 0.55}, {0.75, 0.8}, {1.0, 1.0}};
+    NSUInteger pointCount = sizeof(points) / sizeof(points[0]);
+    NSMutableArray *controlPoints = [NSMutableArray arrayWithCapacity:pointCount];
+    for (NSUInteger pointIndex = 0; pointIndex < pointCount; pointIndex++)
+    {
+        [controlPoints addObject:[NSValue valueWithCGPoint:points[pointIndex]]];
+    }
+    GPUImageToneCurveFilter *toneCurveFilter = [[GPUImageToneCurveFilter alloc] init];
+    
+    // The boxed spline the filter used to build its curves with, still there for existing callers
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger update = 0; update < numberOfUpdates; update++)
+    {
+        @autoreleasepool {
+            [toneCurveFilter getPreparedSplineCurve:controlPoints];
+        }
+    }
+    double boxedSplineTime = (CFAbsoluteTimeGetCurrent() - startTime) * 1000.0 / numberOfUpdates;
+    
+    GLfloat curve[256];
+    startTime = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger update = 0; update < numberOfUpdates; update++)
+    {
+        GPUImageSolveToneCurve(points, pointCount, curve);
+    }
+    double solveTime = (CFAbsoluteTimeGetCurrent() - startTime) * 1000.0 / numberOfUpdates;
+    
+    // Whole updates as a slider would drive them, the solve and the texture write
+    startTime = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger update = 0; update < numberOfUpdates; update++)
+    {
+        toneCurveFilter.redControlPoints = controlPoints;
+    }
+    double channelUpdateTime = (CFAbsoluteTimeGetCurrent() - startTime) * 1000.0 / numberOfUpdates;
+    
+    startTime = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger update = 0; update < numberOfUpdates; update++)
+    {
+        toneCurveFilter.rgbCompositeControlPoints = controlPoints;
+    }
+    double compositeUpdateTime = (CFAbsoluteTimeGetCurrent() - startTime) * 1000.0 / numberOfUpdates;
+    
+    NSLog(@"Tone curve of %lu points: %f ms boxed spline, %f ms C solve, %f ms per red channel update, %f ms per composite update", (unsigned long)pointCount, boxedSplineTime, solveTime, channelUpdateTime, compositeUpdateTime);
+}
+
 - (UIImage *)imageProcessedOnCPU:(UIImage *)imageToProcess;
 {
     // Drawn from Rahul Vyas' answer on Stack Overflow at http://stackoverflow.com/a/4211729/19679
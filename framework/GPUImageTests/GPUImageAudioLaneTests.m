@@ -0,0 +1,241 @@
+#import <XCTest/XCTest.h>
+#import "GPUImageAudioLane.h"
+
+static const Float64 kTestSampleRate = 48000.0;
+static const float kSampleAccuracy = 1e-5;
+
+// The conversion the lane runs on every block of 16-bit PCM, private to it
+@interface GPUImageAudioLane (Testing)
+
+- (void)processPCMBufferList:(AudioBufferList *)bufferList withProcessors:(NSArray *)processors sampleRate:(Float64)sampleRate;
+
+@end
+
+// Keeps a copy of the last block it was handed
+@interface GPUImageTestAudioProcessor : NSObject <GPUImageAudioProcessor>
+
+@property (nonatomic, assign) NSUInteger frameCount;
+@property (nonatomic, assign) NSUInteger channelCount;
+@property (nonatomic, assign) Float64 sampleRate;
+@property (nonatomic, strong) NSData *samples;
+
+@end
+
+@implementation GPUImageTestAudioProcessor
+
+- (void)processSamples:(float *)samples frameCount:(NSUInteger)frameCount channelCount:(NSUInteger)channelCount sampleRate:(Float64)sampleRate {
+  self.frameCount = frameCount;
+  self.channelCount = channelCount;
+  self.sampleRate = sampleRate;
+  self.samples = [NSData dataWithBytes:samples length:frameCount * channelCount * sizeof(float)];
+}
+
+- (void)reset {
+}
+
+@end
+
+// A square wave of the given peak on every channel, so that the peak is exact and every sample has the same magnitude
+static NSMutableData *squareWave(NSUInteger frameCount, NSUInteger channelCount, float amplitude) {
+  NSMutableData *data = [NSMutableData dataWithLength:frameCount * channelCount * sizeof(float)];
+  float *samples = [data mutableBytes];
+  for (NSUInteger frame = 0; frame < frameCount; frame++) {
+    for (NSUInteger channel = 0; channel < channelCount; channel++) {
+      samples[frame * channelCount + channel] = (frame % 2 == 0) ? amplitude : -amplitude;
+    }
+  }
+  return data;
+}
+
+static float peakOfSamples(NSData *data) {
+  const float *samples = [data bytes];
+  float peak = 0.0;
+  for (NSUInteger sample = 0; sample < [data length] / sizeof(float); sample++) {
+    peak = fmaxf(peak, fabsf(samples[sample]));
+  }
+  return peak;
+}
+
+@interface GPUImageAudioLaneTests : XCTestCase
+
+@property (nonatomic, strong) GPUImageAudioLimiterProcessor *limiter;
+
+@end
+
+@implementation GPUImageAudioLaneTests
+
+- (void)setUp {
+  [super setUp];
+  self.limiter = [[GPUImageAudioLimiterProcessor alloc] init];
+}
+
+- (NSMutableData *)limitSquareWaveOfFrameCount:(NSUInteger)frameCount amplitude:(float)amplitude {
+  NSMutableData *block = squareWave(frameCount, 2, amplitude);
+  [self.limiter processSamples:[block mutableBytes] frameCount:frameCount channelCount:2 sampleRate:kTestSampleRate];
+  return block;
+}
+
+#pragma mark - Gain
+
+- (void)testGainScalesEverySample {
+  GPUImageAudioGainProcessor *gain = [[GPUImageAudioGainProcessor alloc] init];
+  XCTAssertEqual(gain.gain, 1.0f);
+
+  NSMutableData *block = squareWave(256, 2, 0.5);
+  NSData *original = [block copy];
+  [gain processSamples:[block mutableBytes] frameCount:256 channelCount:2 sampleRate:kTestSampleRate];
+  XCTAssertEqualObjects(block, original);
+
+  gain.gain = 0.25;
+  [gain processSamples:[block mutableBytes] frameCount:256 channelCount:2 sampleRate:kTestSampleRate];
+  const float *samples = [block bytes];
+  for (NSUInteger sample = 0; sample < 512; sample++) {
+    XCTAssertEqualWithAccuracy(samples[sample], ((const float *)[original bytes])[sample] * 0.25f, kSampleAccuracy);
+  }
+}
+
+#pragma mark - Limiter
+
+- (void)testQuietBlocksPassUntouched {
+  NSData *original = squareWave(1024, 2, 0.5);
+  NSMutableData *block = [self limitSquareWaveOfFrameCount:1024 amplitude:0.5];
+  XCTAssertEqualObjects(block, original);
+  XCTAssertEqual(self.limiter.currentGain, 1.0f);
+}
+
+- (void)testLoudBlocksAreLimitedAtOnce {
+  NSMutableData *block = [self limitSquareWaveOfFrameCount:1024 amplitude:1.0];
+  XCTAssertEqualWithAccuracy(self.limiter.currentGain, 0.9, kSampleAccuracy);
+
+  // The whole block, its first sample included, is scaled down to the threshold
+  const float *samples = [block bytes];
+  XCTAssertEqualWithAccuracy(samples[0], 0.9, kSampleAccuracy);
+  XCTAssertEqualWithAccuracy(samples[2047], -0.9, kSampleAccuracy);
+  XCTAssertLessThanOrEqual(peakOfSamples(block), 0.9f);
+}
+
+- (void)testGainRecoversOverTheReleaseTime {
+  [self limitSquareWaveOfFrameCount:1024 amplitude:1.0];
+
+  // A tenth of a second is half the default release time, recovering 1 - e^-0.5 of the way back
+  NSMutableData *block = [self limitSquareWaveOfFrameCount:4800 amplitude:0.5];
+  float expectedGain = 0.9 + 0.1 * (1.0 - exp(-0.5));
+  XCTAssertEqualWithAccuracy(self.limiter.currentGain, expectedGain, kSampleAccuracy);
+
+  // Ramped across the block rather than stepped
+  const float *samples = [block bytes];
+  XCTAssertEqualWithAccuracy(samples[0], 0.45, kSampleAccuracy);
+  XCTAssertEqualWithAccuracy(fabsf(samples[9599]), 0.5 * (0.9 + (expectedGain - 0.9) * 4799.0 / 4800.0), kSampleAccuracy);
+
+  for (NSUInteger releaseBlock = 0; releaseBlock < 30; releaseBlock++) {
+    [self limitSquareWaveOfFrameCount:4800 amplitude:0.5];
+  }
+  XCTAssertEqualWithAccuracy(self.limiter.currentGain, 1.0, 1e-4);
+}
+
+- (void)testPeaksStayUnderTheThresholdWhileReleasing {
+  self.limiter.threshold = 0.5;
+  self.limiter.releaseTime = 0.0;
+  [self limitSquareWaveOfFrameCount:1024 amplitude:1.0];
+  XCTAssertEqualWithAccuracy(self.limiter.currentGain, 0.5, kSampleAccuracy);
+
+  // Without a release time the gain is back to full after a single quiet block
+  NSMutableData *block = [self limitSquareWaveOfFrameCount:1024 amplitude:0.45];
+  XCTAssertEqual(self.limiter.currentGain, 1.0f);
+  XCTAssertLessThanOrEqual(peakOfSamples(block), 0.5f);
+
+  // A single sample far over the threshold brings the whole block down with it
+  NSMutableData *spike = squareWave(1024, 2, 0.1);
+  ((float *)[spike mutableBytes])[700] = 3.0;
+  [self.limiter processSamples:[spike mutableBytes] frameCount:1024 channelCount:2 sampleRate:kTestSampleRate];
+  XCTAssertLessThanOrEqual(peakOfSamples(spike), 0.5f);
+}
+
+- (void)testResetStartsAtFullGain {
+  [self limitSquareWaveOfFrameCount:1024 amplitude:1.0];
+  [self.limiter reset];
+  XCTAssertEqual(self.limiter.currentGain, 1.0f);
+
+  NSData *original = squareWave(1024, 2, 0.5);
+  XCTAssertEqualObjects([self limitSquareWaveOfFrameCount:1024 amplitude:0.5], original);
+}
+
+#pragma mark - 16-bit buffers
+
+- (void)testNonInterleavedChannelsAreProcessedAsFrames {
+  // Left is a full scale square wave, right a quiet ramp, each in a buffer of its own
+  const NSUInteger frameCount = 512;
+  SInt16 left[512], right[512];
+  for (NSUInteger frame = 0; frame < frameCount; frame++) {
+    left[frame] = (frame % 2 == 0) ? 32000 : -32000;
+    right[frame] = (SInt16)(frame * 16);
+  }
+
+  AudioBufferList *bufferList = malloc(offsetof(AudioBufferList, mBuffers) + 2 * sizeof(AudioBuffer));
+  bufferList->mNumberBuffers = 2;
+  bufferList->mBuffers[0] = (AudioBuffer){1, (UInt32)sizeof(left), left};
+  bufferList->mBuffers[1] = (AudioBuffer){1, (UInt32)sizeof(right), right};
+
+  GPUImageTestAudioProcessor *recorder = [[GPUImageTestAudioProcessor alloc] init];
+  self.limiter.threshold = 0.5;
+  GPUImageAudioLane *lane = [[GPUImageAudioLane alloc] initWithAssetWriter:nil input:nil capacity:4];
+  [lane processPCMBufferList:bufferList withProcessors:@[recorder, self.limiter] sampleRate:kTestSampleRate];
+  free(bufferList);
+
+  XCTAssertEqual(recorder.frameCount, frameCount);
+  XCTAssertEqual(recorder.channelCount, (NSUInteger)2);
+  XCTAssertEqual(recorder.sampleRate, kTestSampleRate);
+  const float *interleaved = [recorder.samples bytes];
+  XCTAssertEqualWithAccuracy(interleaved[0], 32000.0 / 32768.0, kSampleAccuracy);
+  XCTAssertEqualWithAccuracy(interleaved[7], 48.0 / 32768.0, kSampleAccuracy);
+
+  // The loud left channel sets the gain, and the right one gets the same
+  float gain = 0.5 / (32000.0 / 32768.0);
+  XCTAssertEqualWithAccuracy(self.limiter.currentGain, gain, kSampleAccuracy);
+  XCTAssertLessThanOrEqual(abs(left[0] - 16384), 1);
+  for (NSUInteger frame = 0; frame < frameCount; frame += 37) {
+    XCTAssertLessThanOrEqual(abs(right[frame] - (SInt16)(frame * 16 * gain)), 1, @"Frame %lu", (unsigned long)frame);
+  }
+}
+
+- (void)testInterleavedSamplesAreScaledAndClamped {
+  SInt16 samples[8] = {1000, -1000, 20000, -20000, 32767, -32768, 0, 2};
+  AudioBufferList bufferList;
+  bufferList.mNumberBuffers = 1;
+  bufferList.mBuffers[0] = (AudioBuffer){2, (UInt32)sizeof(samples), samples};
+
+  GPUImageAudioGainProcessor *gain = [[GPUImageAudioGainProcessor alloc] init];
+  gain.gain = 2.0;
+  GPUImageAudioLane *lane = [[GPUImageAudioLane alloc] initWithAssetWriter:nil input:nil capacity:4];
+  [lane processPCMBufferList:&bufferList withProcessors:@[gain] sampleRate:kTestSampleRate];
+
+  SInt16 expected[8] = {2000, -2000, 32767, -32768, 32767, -32768, 0, 4};
+  for (NSUInteger sample = 0; sample < 8; sample++) {
+    XCTAssertEqual(samples[sample], expected[sample], @"Sample %lu", (unsigned long)sample);
+  }
+}
+
+- (void)testShortestBufferSetsTheFrameCount {
+  SInt16 left[64] = {0}, right[48] = {0};
+  AudioBufferList *bufferList = malloc(offsetof(AudioBufferList, mBuffers) + 3 * sizeof(AudioBuffer));
+  bufferList->mNumberBuffers = 3;
+  bufferList->mBuffers[0] = (AudioBuffer){1, (UInt32)sizeof(left), left};
+  bufferList->mBuffers[1] = (AudioBuffer){0, 0, NULL};
+  bufferList->mBuffers[2] = (AudioBuffer){1, (UInt32)sizeof(right), right};
+
+  GPUImageTestAudioProcessor *recorder = [[GPUImageTestAudioProcessor alloc] init];
+  GPUImageAudioLane *lane = [[GPUImageAudioLane alloc] initWithAssetWriter:nil input:nil capacity:4];
+  [lane processPCMBufferList:bufferList withProcessors:@[recorder] sampleRate:kTestSampleRate];
+  XCTAssertEqual(recorder.frameCount, (NSUInteger)48);
+  XCTAssertEqual(recorder.channelCount, (NSUInteger)2);
+
+  // Nothing to process without channels
+  GPUImageTestAudioProcessor *idleRecorder = [[GPUImageTestAudioProcessor alloc] init];
+  bufferList->mNumberBuffers = 1;
+  bufferList->mBuffers[0] = (AudioBuffer){0, 0, NULL};
+  [lane processPCMBufferList:bufferList withProcessors:@[idleRecorder] sampleRate:kTestSampleRate];
+  XCTAssertNil(idleRecorder.samples);
+  free(bufferList);
+}
+
+@end
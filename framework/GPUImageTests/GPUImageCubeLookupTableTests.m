@@ -0,0 +1,313 @@
+#import <XCTest/XCTest.h>
+#import "GPUImageCubeLookupFilter.h"
+
+static const GLfloat kLookupAccuracy = 1e-5;
+
+typedef void (^GPUImageTestLatticeFunction)(GLfloat red, GLfloat green, GLfloat blue, GLfloat *output);
+
+// latticeSize^3 points of the function sampled at the lattice, red changing fastest
+static NSData *latticeValuesForFunction(NSUInteger latticeSize, GPUImageTestLatticeFunction function) {
+  NSMutableData *values = [NSMutableData dataWithLength:latticeSize * latticeSize * latticeSize * 3 * sizeof(GLfloat)];
+  GLfloat *value = [values mutableBytes];
+  for (NSUInteger blue = 0; blue < latticeSize; blue++) {
+    for (NSUInteger green = 0; green < latticeSize; green++) {
+      for (NSUInteger red = 0; red < latticeSize; red++) {
+        function(red / (GLfloat)(latticeSize - 1), green / (GLfloat)(latticeSize - 1), blue / (GLfloat)(latticeSize - 1), value);
+        value += 3;
+      }
+    }
+  }
+  return values;
+}
+
+static NSString *cubeTextForLatticeValues(NSUInteger latticeSize, NSData *values) {
+  NSMutableString *text = [NSMutableString stringWithFormat:@"LUT_3D_SIZE %lu\n", (unsigned long)latticeSize];
+  const GLfloat *value = [values bytes];
+  for (NSUInteger point = 0; point < latticeSize * latticeSize * latticeSize; point++) {
+    [text appendFormat:@"%.6f %.6f %.6f\n", value[0], value[1], value[2]];
+    value += 3;
+  }
+  return text;
+}
+
+static GPUImageTestLatticeFunction identityFunction(void) {
+  return ^(GLfloat red, GLfloat green, GLfloat blue, GLfloat *output) {
+    output[0] = red;
+    output[1] = green;
+    output[2] = blue;
+  };
+}
+
+@interface GPUImageCubeLookupTableTests : XCTestCase
+@end
+
+@implementation GPUImageCubeLookupTableTests
+
+- (GPUImageCubeLookupTable *)tableFromText:(NSString *)text error:(NSError **)error {
+  return [[GPUImageCubeLookupTable alloc] initWithCubeData:[text dataUsingEncoding:NSUTF8StringEncoding] error:error];
+}
+
+- (void)assertText:(NSString *)text failsOnLine:(NSUInteger)lineNumber {
+  NSError *error = nil;
+  XCTAssertNil([self tableFromText:text error:&error]);
+  XCTAssertEqualObjects(error.domain, NSCocoaErrorDomain);
+  XCTAssertEqual(error.code, (NSInteger)NSFileReadCorruptFileError);
+  NSString *linePrefix = [NSString stringWithFormat:@"Line %lu:", (unsigned long)lineNumber];
+  XCTAssertTrue([error.localizedFailureReason hasPrefix:linePrefix], @"%@", error.localizedFailureReason);
+}
+
+#pragma mark - Parsing
+
+- (void)testParsesHeaderCommentsAndWindowsLineEndings {
+  NSString *text = @"# Written by hand\r\n"
+                   @"TITLE \"Warm look\"\r\n"
+                   @"\r\n"
+                   @"DOMAIN_MIN 0 0 0\r\n"
+                   @"DOMAIN_MAX 1 1 2\r\n"
+                   @"LUT_3D_SIZE 2\r\n"
+                   @"0 0 0\r\n1 0 0\r\n0 1 0\r\n1 1 0\r\n"
+                   @"  0 0 1\t\r\n1 0 1\r\n0 1 1\r\n1.0 1.0 1.0";
+  NSError *error = nil;
+  GPUImageCubeLookupTable *table = [self tableFromText:text error:&error];
+  XCTAssertNotNil(table, @"%@", error);
+  XCTAssertEqualObjects(table.title, @"Warm look");
+  XCTAssertEqual(table.latticeSize, (NSUInteger)2);
+  XCTAssertEqualWithAccuracy(table.domainMax.three, 2.0, kLookupAccuracy);
+  XCTAssertEqual([table.latticeValues length], 8 * 3 * sizeof(GLfloat));
+
+  const GLfloat *values = [table.latticeValues bytes];
+  XCTAssertEqualWithAccuracy(values[3], 1.0, kLookupAccuracy);
+  XCTAssertEqualWithAccuracy(values[4], 0.0, kLookupAccuracy);
+  XCTAssertEqualWithAccuracy(values[23], 1.0, kLookupAccuracy);
+}
+
+- (void)testInputRangeAppliesToEveryChannel {
+  NSString *text = [@"LUT_3D_INPUT_RANGE 0.0 2.0\n" stringByAppendingString:cubeTextForLatticeValues(3, latticeValuesForFunction(3, identityFunction()))];
+  GPUImageCubeLookupTable *table = [self tableFromText:text error:NULL];
+  XCTAssertNotNil(table);
+
+  GPUVector3 color = [table colorForColor:(GPUVector3){1.0, 0.5, 2.0} interpolation:kGPUImageLookupInterpolationTrilinear];
+  XCTAssertEqualWithAccuracy(color.one, 0.5, kLookupAccuracy);
+  XCTAssertEqualWithAccuracy(color.two, 0.25, kLookupAccuracy);
+  XCTAssertEqualWithAccuracy(color.three, 1.0, kLookupAccuracy);
+}
+
+- (void)testMalformedFilesReportTheLine {
+  NSString *points = @"0 0 0\n1 0 0\n0 1 0\n1 1 0\n0 0 1\n1 0 1\n0 1 1\n1 1 1\n";
+  [self assertText:@"LUT_1D_SIZE 1024\n" failsOnLine:1];
+  [self assertText:@"TITLE x\nLUT_3D_SIZE 2\nLUT_3D_INTERPOLATION linear\n" failsOnLine:3];
+  [self assertText:@"0 0 0\nLUT_3D_SIZE 2\n" failsOnLine:1];
+  [self assertText:@"LUT_3D_SIZE 1\n" failsOnLine:1];
+  [self assertText:@"LUT_3D_SIZE 130\n" failsOnLine:1];
+  [self assertText:@"LUT_3D_SIZE two\n" failsOnLine:1];
+  [self assertText:@"LUT_3D_SIZE 2\n0 0 0\n1 0\n" failsOnLine:3];
+  [self assertText:@"LUT_3D_SIZE 2\n0 0 0 0\n" failsOnLine:2];
+  [self assertText:[@"LUT_3D_SIZE 2\n" stringByAppendingString:[points stringByAppendingString:@"1 1 1\n"]] failsOnLine:10];
+  [self assertText:@"DOMAIN_MIN 0 0\nLUT_3D_SIZE 2\n" failsOnLine:1];
+}
+
+- (void)testMissingOrIncompleteLatticeIsRejected {
+  [self assertText:@"TITLE \"Empty\"\n" failsOnLine:1];
+  [self assertText:@"LUT_3D_SIZE 2\n0 0 0\n1 0 0\n" failsOnLine:3];
+  [self assertText:@"DOMAIN_MIN 1 0 0\nDOMAIN_MAX 1 1 1\nLUT_3D_SIZE 2\n0 0 0\n1 0 0\n0 1 0\n1 1 0\n0 0 1\n1 0 1\n0 1 1\n1 1 1\n" failsOnLine:11];
+}
+
+- (void)testTablesLoadedFromTheSameFileAreShared {
+  NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[[NSUUID UUID] UUIDString] stringByAppendingPathExtension:@"cube"]];
+  XCTAssertTrue([cubeTextForLatticeValues(2, latticeValuesForFunction(2, identityFunction())) writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:NULL]);
+
+  NSError *error = nil;
+  NSURL *url = [NSURL fileURLWithPath:path];
+  GPUImageCubeLookupTable *table = [GPUImageCubeLookupTable lookupTableWithContentsOfURL:url error:&error];
+  XCTAssertNotNil(table, @"%@", error);
+  XCTAssertTrue([GPUImageCubeLookupTable lookupTableWithContentsOfURL:url error:NULL] == table);
+  [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+
+  XCTAssertNil([GPUImageCubeLookupTable lookupTableWithContentsOfURL:url error:&error]);
+  XCTAssertNotNil(error);
+}
+
+#pragma mark - Interpolation
+
+- (void)testBothInterpolationsReproduceLinearTables {
+  GPUImageCubeLookupTable *table = [[GPUImageCubeLookupTable alloc] initWithLatticeSize:17 values:latticeValuesForFunction(17, ^(GLfloat red, GLfloat green, GLfloat blue, GLfloat *output) {
+    output[0] = 0.5 * red + 0.25 * green;
+    output[1] = 1.0 - blue;
+    output[2] = 0.2 + 0.6 * green;
+  })];
+
+  uint32_t state = 42;
+  for (NSUInteger sample = 0; sample < 200; sample++) {
+    GLfloat input[3];
+    for (NSUInteger channel = 0; channel < 3; channel++) {
+      state = state * 1664525 + 1013904223;
+      input[channel] = (state >> 8) / (GLfloat)(1 << 24);
+    }
+    for (NSNumber *interpolation in @[@(kGPUImageLookupInterpolationTrilinear), @(kGPUImageLookupInterpolationTetrahedral)]) {
+      GPUVector3 color = [table colorForColor:(GPUVector3){input[0], input[1], input[2]} interpolation:[interpolation unsignedIntegerValue]];
+      XCTAssertEqualWithAccuracy(color.one, 0.5 * input[0] + 0.25 * input[1], kLookupAccuracy);
+      XCTAssertEqualWithAccuracy(color.two, 1.0 - input[2], kLookupAccuracy);
+      XCTAssertEqualWithAccuracy(color.three, 0.2 + 0.6 * input[1], kLookupAccuracy);
+    }
+  }
+}
+
+- (void)testTetrahedralKeepsGreysNeutral {
+  // Greys map to themselves, while the red output bends with the difference between green and blue
+  GPUImageCubeLookupTable *table = [[GPUImageCubeLookupTable alloc] initWithLatticeSize:3 values:latticeValuesForFunction(3, ^(GLfloat red, GLfloat green, GLfloat blue, GLfloat *output) {
+    output[0] = red + 0.5 * (green - blue) * (green - blue);
+    output[1] = green;
+    output[2] = blue;
+  })];
+
+  GPUVector3 grey = {0.25, 0.25, 0.25};
+  GPUVector3 tetrahedral = [table colorForColor:grey interpolation:kGPUImageLookupInterpolationTetrahedral];
+  XCTAssertEqualWithAccuracy(tetrahedral.one, 0.25, kLookupAccuracy);
+  XCTAssertEqualWithAccuracy(tetrahedral.two, 0.25, kLookupAccuracy);
+  XCTAssertEqualWithAccuracy(tetrahedral.three, 0.25, kLookupAccuracy);
+
+  // Half of the cell corners are off the grey diagonal, each lifting red by 0.125
+  GPUVector3 trilinear = [table colorForColor:grey interpolation:kGPUImageLookupInterpolationTrilinear];
+  XCTAssertEqualWithAccuracy(trilinear.one, 0.3125, kLookupAccuracy);
+  XCTAssertEqualWithAccuracy(trilinear.two, 0.25, kLookupAccuracy);
+}
+
+- (void)testInputOutsideTheDomainIsClamped {
+  GPUImageCubeLookupTable *table = [[GPUImageCubeLookupTable alloc] initWithLatticeSize:5 values:latticeValuesForFunction(5, identityFunction())];
+  GPUVector3 color = [table colorForColor:(GPUVector3){-0.5, 1.5, 1.0} interpolation:kGPUImageLookupInterpolationTetrahedral];
+  XCTAssertEqualWithAccuracy(color.one, 0.0, kLookupAccuracy);
+  XCTAssertEqualWithAccuracy(color.two, 1.0, kLookupAccuracy);
+  XCTAssertEqualWithAccuracy(color.three, 1.0, kLookupAccuracy);
+}
+
+- (void)testApplyingAnIdentityTableKeepsPixels {
+  GPUImageCubeLookupTable *table = [[GPUImageCubeLookupTable alloc] initWithLatticeSize:17 values:latticeValuesForFunction(17, identityFunction())];
+  GLubyte source[256 * 4], destination[256 * 4];
+  for (NSUInteger pixel = 0; pixel < 256; pixel++) {
+    source[pixel * 4] = (GLubyte)pixel;
+    source[pixel * 4 + 1] = (GLubyte)(255 - pixel);
+    source[pixel * 4 + 2] = (GLubyte)(pixel * 37);
+    source[pixel * 4 + 3] = (GLubyte)(pixel * 11);
+  }
+
+  [table applyToPixels:source destinationPixels:destination count:256 interpolation:kGPUImageLookupInterpolationTetrahedral];
+  XCTAssertEqual(memcmp(source, destination, sizeof(source)), 0);
+}
+
+#pragma mark - Layouts
+
+- (void)testLookupImageConvertsToItsLattice {
+  // The identity table GPUImageLookupFilter ships as lookup.png, blue picking one of 8x8 squares
+  NSMutableData *image = [NSMutableData dataWithLength:512 * 512 * 4];
+  GLubyte *bytes = [image mutableBytes];
+  for (NSUInteger blue = 0; blue < 64; blue++) {
+    for (NSUInteger green = 0; green < 64; green++) {
+      for (NSUInteger red = 0; red < 64; red++) {
+        GLubyte *pixel = bytes + (((blue / 8) * 64 + green) * 512 + (blue % 8) * 64 + red) * 4;
+        pixel[0] = (GLubyte)lround(red * 255.0 / 63.0);
+        pixel[1] = (GLubyte)lround(green * 255.0 / 63.0);
+        pixel[2] = (GLubyte)lround(blue * 255.0 / 63.0);
+        pixel[3] = 255;
+      }
+    }
+  }
+
+  GPUImageCubeLookupTable *table = [[GPUImageCubeLookupTable alloc] initWithLookupImageBytes:bytes];
+  XCTAssertEqual(table.latticeSize, (NSUInteger)64);
+  GPUVector3 color = [table colorForColor:(GPUVector3){0.2, 0.6, 0.9} interpolation:kGPUImageLookupInterpolationTrilinear];
+  XCTAssertEqualWithAccuracy(color.one, 0.2, 1.0 / 255.0);
+  XCTAssertEqualWithAccuracy(color.two, 0.6, 1.0 / 255.0);
+  XCTAssertEqualWithAccuracy(color.three, 0.9, 1.0 / 255.0);
+}
+
+- (void)testAtlasSplitsSixteenBitChannels {
+  GPUImageCubeLookupTable *table = [[GPUImageCubeLookupTable alloc] initWithLatticeSize:17 values:latticeValuesForFunction(17, ^(GLfloat red, GLfloat green, GLfloat blue, GLfloat *output) {
+    output[0] = 0.5;
+    output[1] = green;
+    output[2] = blue;
+  })];
+  XCTAssertEqual(table.slicesPerRow, (NSUInteger)5);
+  XCTAssertEqual(table.atlasSize.width, (CGFloat)85.0);
+  XCTAssertEqual(table.atlasSize.height, (CGFloat)136.0);
+
+  // Lattice point (3, 16, 6): the second slice of the second slice row
+  const GLubyte *atlas = [table.atlasBytes bytes];
+  NSUInteger width = 85, offset = ((17 + 16) * width + 17 + 3) * 4, lowOffset = offset + width * 68 * 4;
+  XCTAssertEqual(atlas[offset], (GLubyte)0x80);
+  XCTAssertEqual(atlas[lowOffset], (GLubyte)0x00);
+  XCTAssertEqual(atlas[offset + 1], (GLubyte)0xFF);
+  XCTAssertEqual(atlas[lowOffset + 1], (GLubyte)0xFF);
+
+  NSUInteger encodedBlue = (NSUInteger)lroundf(6.0f / 16.0f * 65535.0f);
+  XCTAssertEqual(atlas[offset + 2], (GLubyte)(encodedBlue >> 8));
+  XCTAssertEqual(atlas[lowOffset + 2], (GLubyte)(encodedBlue & 0xFF));
+  XCTAssertEqual(atlas[offset + 3], (GLubyte)255);
+}
+
+#pragma mark - Filter
+
+- (void)testFilterOnlyTakesTablesFittingWithinATexture {
+  GPUImageCubeLookupTable *smallTable = [[GPUImageCubeLookupTable alloc] initWithLatticeSize:17 values:latticeValuesForFunction(17, identityFunction())];
+  NSError *error = nil;
+  GPUImageCubeLookupFilter *filter = [[GPUImageCubeLookupFilter alloc] initWithLookupTable:smallTable interpolation:kGPUImageLookupInterpolationTetrahedral error:&error];
+  XCTAssertNotNil(filter);
+  XCTAssertNil(error);
+
+  // The largest table a file may hold, whose 1548x2838 atlas fits some devices and not others
+  GPUImageCubeLookupTable *largestTable = [[GPUImageCubeLookupTable alloc] initWithLatticeSize:129 values:latticeValuesForFunction(129, identityFunction())];
+  XCTAssertEqual(largestTable.atlasSize.width, 1548.0);
+  XCTAssertEqual(largestTable.atlasSize.height, 2838.0);
+  BOOL fits = (2838 <= [GPUImageContext maximumTextureSizeForThisDevice]);
+  XCTAssertEqual([filter setLookupTable:largestTable error:&error], fits);
+  if (fits) {
+    XCTAssertEqual(filter.lookupTable, largestTable);
+  } else {
+    XCTAssertEqual(filter.lookupTable, smallTable);
+    XCTAssertEqualObjects(error.domain, NSCocoaErrorDomain);
+    XCTAssertEqual(error.code, (NSInteger)NSFileReadTooLargeError);
+  }
+}
+
+#pragma mark - Performance
+
+- (void)testPerformanceOfParsingA65PointTable {
+  NSData *text = [cubeTextForLatticeValues(65, latticeValuesForFunction(65, identityFunction())) dataUsingEncoding:NSUTF8StringEncoding];
+  [self measureBlock:^{
+    XCTAssertNotNil([[GPUImageCubeLookupTable alloc] initWithCubeData:text error:NULL]);
+  }];
+}
+
+- (void)testPerformanceOfTetrahedralLookupPerFrame {
+  GPUImageCubeLookupTable *table = [[GPUImageCubeLookupTable alloc] initWithLatticeSize:33 values:latticeValuesForFunction(33, identityFunction())];
+  NSUInteger pixelCount = 640 * 480;
+  NSMutableData *source = [NSMutableData dataWithLength:pixelCount * 4];
+  NSMutableData *destination = [NSMutableData dataWithLength:pixelCount * 4];
+  arc4random_buf([source mutableBytes], [source length]);
+
+  [self measureBlock:^{
+    [table applyToPixels:[source bytes] destinationPixels:[destination mutableBytes] count:pixelCount interpolation:kGPUImageLookupInterpolationTetrahedral];
+  }];
+}
+
+- (void)testPerformanceOfTheFilterPerFrame {
+  GPUImageCubeLookupTable *table = [[GPUImageCubeLookupTable alloc] initWithLatticeSize:33 values:latticeValuesForFunction(33, identityFunction())];
+  GPUImageCubeLookupFilter *filter = [[GPUImageCubeLookupFilter alloc] initWithLookupTable:table];
+
+  CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+  CGContextRef context = CGBitmapContextCreate(NULL, 1280, 720, 8, 1280 * 4, colorSpace, kCGImageAlphaPremultipliedLast);
+  CGContextSetRGBFillColor(context, 0.8, 0.4, 0.2, 1.0);
+  CGContextFillRect(context, CGRectMake(0.0, 0.0, 1280.0, 720.0));
+  CGImageRef image = CGBitmapContextCreateImage(context);
+  CGContextRelease(context);
+  CGColorSpaceRelease(colorSpace);
+
+  // Upload and readback included, as for a still image
+  [self measureBlock:^{
+    CGImageRef filteredImage = [filter newCGImageByFilteringCGImage:image];
+    XCTAssertTrue(filteredImage != NULL);
+    CGImageRelease(filteredImage);
+  }];
+  CGImageRelease(image);
+}
+
+@end
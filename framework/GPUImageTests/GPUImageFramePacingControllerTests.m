@@ -0,0 +1,210 @@
+#import <XCTest/XCTest.h>
+#import "GPUImageFramePacingController.h"
+
+@interface GPUImageFramePacingControllerTests : XCTestCase
+
+@property (nonatomic, strong) GPUImageFramePacingController *controller;
+
+// The synthetic clock the controller reads, in seconds
+@property (nonatomic, assign) CFTimeInterval now;
+
+// Adaptation steps in the order they were reported, as @[@"scale" or @"rate", value]
+@property (nonatomic, strong) NSMutableArray *adaptationSteps;
+
+@end
+
+@implementation GPUImageFramePacingControllerTests
+
+- (void)setUp {
+  [super setUp];
+  self.now = 0.0;
+  self.adaptationSteps = [NSMutableArray array];
+  self.controller = [[GPUImageFramePacingController alloc] init];
+
+  __weak GPUImageFramePacingControllerTests *weakSelf = self;
+  self.controller.clock = ^CFTimeInterval {
+    return weakSelf.now;
+  };
+  self.controller.resolutionScaleChangedBlock = ^(CGFloat resolutionScale) {
+    [weakSelf.adaptationSteps addObject:@[@"scale", @(resolutionScale)]];
+  };
+  self.controller.frameRateChangedBlock = ^(int32_t frameRate) {
+    [weakSelf.adaptationSteps addObject:@[@"rate", @(frameRate)]];
+  };
+}
+
+// A camera delivering a frame every interval to a chain that takes renderDuration for each, never overlapping
+- (void)runFrames:(NSUInteger)frameCount interval:(CFTimeInterval)interval renderDuration:(CFTimeInterval)renderDuration {
+  for (NSUInteger frame = 0; frame < frameCount; frame++) {
+    CFTimeInterval arrivalTime = self.now;
+    [self.controller receiveFrame:@(frame)];
+    XCTAssertNotNil([self.controller nextFrameToRender]);
+    self.now = arrivalTime + renderDuration;
+    [self.controller didFinishRenderingFrame];
+    self.now = arrivalTime + interval;
+  }
+}
+
+- (NSArray *)stepKinds {
+  NSMutableArray *kinds = [NSMutableArray array];
+  for (NSArray *step in self.adaptationSteps) {
+    [kinds addObject:[step firstObject]];
+  }
+  return kinds;
+}
+
+- (NSArray *)stepValues {
+  NSMutableArray *values = [NSMutableArray array];
+  for (NSArray *step in self.adaptationSteps) {
+    [values addObject:[step lastObject]];
+  }
+  return values;
+}
+
+#pragma mark - Drop policies
+
+- (void)testDropNewestKeepsTheFrameBeingRenderedOnly {
+  [self.controller receiveFrame:@"frame0"];
+  XCTAssertEqualObjects([self.controller nextFrameToRender], @"frame0");
+
+  self.now = 0.010;
+  [self.controller receiveFrame:@"frame1"];
+  self.now = 0.020;
+  [self.controller receiveFrame:@"frame2"];
+  XCTAssertFalse([self.controller hasQueuedFrames]);
+
+  self.now = 0.025;
+  [self.controller didFinishRenderingFrame];
+  XCTAssertNil([self.controller nextFrameToRender]);
+
+  self.now = 0.030;
+  [self.controller receiveFrame:@"frame3"];
+  XCTAssertEqualObjects([self.controller nextFrameToRender], @"frame3");
+
+  XCTAssertEqual(self.controller.receivedFrameCount, (NSUInteger)4);
+  XCTAssertEqual(self.controller.droppedFrameCount, (NSUInteger)2);
+  XCTAssertEqual(self.controller.longestDropRun, (NSUInteger)2);
+}
+
+- (void)testDropOldestQueuesBehindTheRender {
+  self.controller.dropPolicy = kGPUImageFramePacingDropOldest;
+  self.controller.maximumQueueLength = 2;
+
+  [self.controller receiveFrame:@"frame0"];
+  XCTAssertEqualObjects([self.controller nextFrameToRender], @"frame0");
+  [self.controller receiveFrame:@"frame1"];
+  [self.controller receiveFrame:@"frame2"];
+  [self.controller receiveFrame:@"frame3"];
+  XCTAssertEqual(self.controller.droppedFrameCount, (NSUInteger)1);
+
+  [self.controller didFinishRenderingFrame];
+  XCTAssertEqualObjects([self.controller nextFrameToRender], @"frame2");
+  [self.controller didFinishRenderingFrame];
+  XCTAssertEqualObjects([self.controller nextFrameToRender], @"frame3");
+  [self.controller didFinishRenderingFrame];
+  XCTAssertNil([self.controller nextFrameToRender]);
+  XCTAssertEqual(self.controller.renderedFrameCount, (NSUInteger)3);
+}
+
+- (void)testRemovingFramesDoesNotCountThemAsDropped {
+  self.controller.dropPolicy = kGPUImageFramePacingDropOldest;
+  [self.controller receiveFrame:@"frame0"];
+  [self.controller receiveFrame:@"frame1"];
+  XCTAssertTrue([self.controller hasQueuedFrames]);
+
+  [self.controller removeAllFrames];
+  XCTAssertFalse([self.controller hasQueuedFrames]);
+  XCTAssertEqual(self.controller.droppedFrameCount, (NSUInteger)0);
+}
+
+#pragma mark - Latency
+
+- (void)testLatencyStatisticsAndHistogram {
+  NSArray *latencies = @[@0.002, @0.006, @0.150];
+  for (NSNumber *latency in latencies) {
+    [self.controller receiveFrame:latency];
+    [self.controller nextFrameToRender];
+    self.now += [latency doubleValue];
+    [self.controller didFinishRenderingFrame];
+    self.now += 0.1;
+  }
+
+  XCTAssertEqualWithAccuracy(self.controller.averageLatency, 0.158 / 3.0, 1e-9);
+  XCTAssertEqualWithAccuracy(self.controller.maximumLatency, 0.150, 1e-9);
+
+  // 4 ms buckets, with everything from 96 ms on in the last one
+  NSArray *histogram = [self.controller latencyHistogram];
+  XCTAssertEqual([histogram count], (NSUInteger)25);
+  XCTAssertEqualObjects(histogram[0], @1);
+  XCTAssertEqualObjects(histogram[1], @1);
+  XCTAssertEqualObjects(histogram[24], @1);
+  XCTAssertEqual([[histogram valueForKeyPath:@"@sum.self"] integerValue], (NSInteger)3);
+
+  [self.controller resetStatistics];
+  XCTAssertEqual(self.controller.renderedFrameCount, (NSUInteger)0);
+  XCTAssertEqual([[[self.controller latencyHistogram] valueForKeyPath:@"@sum.self"] integerValue], (NSInteger)0);
+}
+
+#pragma mark - Load adaptation
+
+- (void)testLoadFollowsRenderTimeOverFrameInterval {
+  [self runFrames:60 interval:1.0 / 30.0 renderDuration:0.020];
+  XCTAssertEqualWithAccuracy(self.controller.load, 0.6, 1e-6);
+  XCTAssertEqual([self.adaptationSteps count], (NSUInteger)0);
+}
+
+- (void)testNoAdaptationUnlessEnabled {
+  [self runFrames:300 interval:1.0 / 30.0 renderDuration:0.032];
+  XCTAssertGreaterThan(self.controller.load, (CGFloat)0.85);
+  XCTAssertEqual(self.controller.resolutionScale, (CGFloat)1.0);
+  XCTAssertEqual(self.controller.targetFrameRate, (int32_t)30);
+  XCTAssertEqual([self.adaptationSteps count], (NSUInteger)0);
+}
+
+- (void)testOverloadLowersResolutionThenFrameRate {
+  self.controller.adaptsResolution = YES;
+  self.controller.adaptsFrameRate = YES;
+
+  // Steps are at least half a second apart, five seconds are enough to reach both minimums
+  [self runFrames:150 interval:1.0 / 30.0 renderDuration:0.030];
+  XCTAssertEqualObjects([self stepKinds], (@[@"scale", @"scale", @"scale", @"scale", @"rate", @"rate", @"rate"]));
+  XCTAssertEqualWithAccuracy([[self stepValues][0] doubleValue], 0.8, 1e-6);
+  XCTAssertEqualWithAccuracy([[self stepValues][3] doubleValue], 0.5, 1e-6);
+  XCTAssertEqualObjects([[self stepValues] subarrayWithRange:NSMakeRange(4, 3)], (@[@24, @19, @15]));
+  XCTAssertEqualWithAccuracy(self.controller.resolutionScale, 0.5, 1e-6);
+  XCTAssertEqual(self.controller.targetFrameRate, (int32_t)15);
+}
+
+- (void)testRecoveryRestoresFrameRateThenResolution {
+  self.controller.adaptsResolution = YES;
+  self.controller.adaptsFrameRate = YES;
+  [self runFrames:150 interval:1.0 / 30.0 renderDuration:0.030];
+  [self.adaptationSteps removeAllObjects];
+
+  [self runFrames:300 interval:1.0 / 30.0 renderDuration:0.005];
+  XCTAssertEqualObjects([self stepKinds], (@[@"rate", @"rate", @"rate", @"scale", @"scale", @"scale", @"scale"]));
+  XCTAssertEqualObjects([[self stepValues] subarrayWithRange:NSMakeRange(0, 3)], (@[@19, @24, @30]));
+  XCTAssertEqualWithAccuracy(self.controller.resolutionScale, 1.0, 1e-6);
+  XCTAssertEqual(self.controller.targetFrameRate, (int32_t)30);
+}
+
+- (void)testStepsAreSpacedByTheAdaptationInterval {
+  self.controller.adaptsResolution = YES;
+  self.controller.adaptationInterval = 2.0;
+  [self runFrames:90 interval:1.0 / 30.0 renderDuration:0.030];
+  XCTAssertEqual([self.adaptationSteps count], (NSUInteger)1);
+}
+
+- (void)testResetAdaptationReportsFullQuality {
+  self.controller.adaptsResolution = YES;
+  self.controller.adaptsFrameRate = YES;
+  [self runFrames:150 interval:1.0 / 30.0 renderDuration:0.030];
+  [self.adaptationSteps removeAllObjects];
+
+  [self.controller resetAdaptation];
+  XCTAssertEqualObjects(self.adaptationSteps, (@[@[@"scale", @1.0], @[@"rate", @30]]));
+  XCTAssertEqual(self.controller.resolutionScale, (CGFloat)1.0);
+  XCTAssertEqual(self.controller.targetFrameRate, (int32_t)30);
+}
+
+@end
@@ -0,0 +1,212 @@
+#import <XCTest/XCTest.h>
+#import "GPUImageFrameSampler.h"
+#import "GPUImageTwoInputFilter.h"
+#import "GPUImageFrameSyncPolicy.h"
+
+static CMTime frameTimeAtIndex(NSUInteger frameIndex) {
+  return CMTimeMake((int64_t)frameIndex, 30);
+}
+
+// A source handing out a fresh framebuffer from the cache for each frame, the way a camera does
+@interface GPUImageTestFrameSource : GPUImageOutput
+
+- (void)sendFrameAtTime:(CMTime)frameTime;
+
+@end
+
+@implementation GPUImageTestFrameSource
+
+- (CGSize)outputFrameSize {
+  return CGSizeMake(16.0, 16.0);
+}
+
+- (void)sendFrameAtTime:(CMTime)frameTime {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    self.outputFramebuffer = [[GPUImageContext sharedFramebufferCache] fetchFramebufferForSize:[self outputFrameSize] onlyTexture:NO];
+    [self informTargetsAboutNewFrameAtTime:frameTime];
+  });
+}
+
+@end
+
+// A target recording the frames it gets, with its own sampler like GPUImageRawDataOutput
+@interface GPUImageTestFrameSink : NSObject <GPUImageInput>
+
+@property (nonatomic, strong, readonly) GPUImageFrameSampler *frameSampler;
+@property (nonatomic, strong, readonly) NSMutableArray *receivedFrameTimes;
+
+@end
+
+@implementation GPUImageTestFrameSink
+
+- (id)init {
+  if ((self = [super init])) {
+    _frameSampler = [[GPUImageFrameSampler alloc] init];
+    _receivedFrameTimes = [NSMutableArray array];
+  }
+  return self;
+}
+
+- (BOOL)wantsFrameAtTime:(CMTime)frameTime {
+  return [self.frameSampler wantsFrameAtTime:frameTime];
+}
+
+- (void)newFrameReadyAtTime:(CMTime)frameTime atIndex:(NSInteger)textureIndex {
+  [self.receivedFrameTimes addObject:@(frameTime.value)];
+}
+
+- (void)setInputFramebuffer:(GPUImageFramebuffer *)value index:(NSUInteger)index {
+}
+
+- (NSInteger)nextAvailableTextureIndex {
+  return 0;
+}
+
+- (void)setInputSize:(CGSize)value index:(NSUInteger)index {
+}
+
+- (void)setInputRotation:(GPUImageRotationMode)value index:(NSUInteger)index {
+}
+
+- (void)endProcessing {
+}
+
+- (BOOL)shouldIgnoreUpdatesToThisTarget {
+  return NO;
+}
+
+@end
+
+@interface GPUImageFrameSamplerTests : XCTestCase
+
+@end
+
+@implementation GPUImageFrameSamplerTests
+
+#pragma mark - Sampler
+
+- (void)testIntervalTakesTheFirstOfEveryIntervalFrames {
+  GPUImageFrameSampler *sampler = [[GPUImageFrameSampler alloc] init];
+  sampler.interval = 3;
+
+  NSMutableArray *wantedFrames = [NSMutableArray array];
+  for (NSUInteger frameIndex = 0; frameIndex < 10; frameIndex++) {
+    if ([sampler wantsFrameAtTime:frameTimeAtIndex(frameIndex)]) {
+      [wantedFrames addObject:@(frameIndex)];
+    }
+  }
+  XCTAssertEqualObjects(wantedFrames, (@[@0, @3, @6, @9]));
+  XCTAssertEqual(sampler.wantedFrameCount, (NSUInteger)4);
+  XCTAssertEqual(sampler.declinedFrameCount, (NSUInteger)6);
+}
+
+- (void)testFramesAskedAboutAgainKeepTheirAnswerAndCountOnce {
+  GPUImageFrameSampler *sampler = [[GPUImageFrameSampler alloc] init];
+  sampler.interval = 2;
+
+  XCTAssertTrue([sampler wantsFrameAtTime:frameTimeAtIndex(0)]);
+  XCTAssertFalse([sampler wantsFrameAtTime:frameTimeAtIndex(1)]);
+  // Asked again by a second input, and about an older frame after a newer one
+  XCTAssertFalse([sampler wantsFrameAtTime:frameTimeAtIndex(1)]);
+  XCTAssertTrue([sampler wantsFrameAtTime:frameTimeAtIndex(0)]);
+  XCTAssertTrue([sampler wantsFrameAtTime:frameTimeAtIndex(2)]);
+
+  XCTAssertEqual(sampler.wantedFrameCount, (NSUInteger)2);
+  XCTAssertEqual(sampler.declinedFrameCount, (NSUInteger)1);
+}
+
+- (void)testStillImagesAreAlwaysWantedAndInactiveSamplersWantNothing {
+  GPUImageFrameSampler *sampler = [[GPUImageFrameSampler alloc] init];
+  sampler.interval = 4;
+  XCTAssertTrue([sampler wantsFrameAtTime:kCMTimeIndefinite]);
+  XCTAssertTrue([sampler wantsFrameAtTime:kCMTimeInvalid]);
+  XCTAssertEqual(sampler.wantedFrameCount, (NSUInteger)0);
+
+  sampler.active = NO;
+  XCTAssertFalse([sampler wantsFrameAtTime:frameTimeAtIndex(0)]);
+  XCTAssertFalse([sampler wantsFrameAtTime:kCMTimeIndefinite]);
+  XCTAssertEqual(sampler.declinedFrameCount, (NSUInteger)0);
+}
+
+- (void)testResetStartsAnIntervalOnTheNextFrame {
+  GPUImageFrameSampler *sampler = [[GPUImageFrameSampler alloc] init];
+  sampler.interval = 3;
+  XCTAssertTrue([sampler wantsFrameAtTime:frameTimeAtIndex(0)]);
+  XCTAssertFalse([sampler wantsFrameAtTime:frameTimeAtIndex(1)]);
+
+  [sampler reset];
+  XCTAssertEqual(sampler.wantedFrameCount, (NSUInteger)0);
+  XCTAssertEqual(sampler.declinedFrameCount, (NSUInteger)0);
+  XCTAssertTrue([sampler wantsFrameAtTime:frameTimeAtIndex(2)]);
+  XCTAssertFalse([sampler wantsFrameAtTime:frameTimeAtIndex(3)]);
+}
+
+#pragma mark - Graph
+
+- (void)testOutputsWantFramesAnyTargetWantsAndAskEveryTarget {
+  GPUImageTestFrameSource *source = [[GPUImageTestFrameSource alloc] init];
+  GPUImageTestFrameSink *everyOther = [[GPUImageTestFrameSink alloc] init];
+  GPUImageTestFrameSink *everyThird = [[GPUImageTestFrameSink alloc] init];
+  everyOther.frameSampler.interval = 2;
+  everyThird.frameSampler.interval = 3;
+  [source addTarget:everyOther];
+  [source addTarget:everyThird];
+
+  NSMutableArray *wantedFrames = [NSMutableArray array];
+  for (NSUInteger frameIndex = 0; frameIndex < 12; frameIndex++) {
+    if ([source targetsWantFrameAtTime:frameTimeAtIndex(frameIndex)]) {
+      [wantedFrames addObject:@(frameIndex)];
+    }
+  }
+  XCTAssertEqualObjects(wantedFrames, (@[@0, @2, @3, @4, @6, @8, @9, @10]));
+
+  // The second target keeps its own count on frames the first one already wanted
+  XCTAssertEqual(everyOther.frameSampler.wantedFrameCount, (NSUInteger)6);
+  XCTAssertEqual(everyThird.frameSampler.wantedFrameCount, (NSUInteger)4);
+  XCTAssertEqual(everyThird.frameSampler.declinedFrameCount, (NSUInteger)8);
+}
+
+- (void)testFilterSkipsFramesItsSamplerDeclines {
+  GPUImageTestFrameSource *source = [[GPUImageTestFrameSource alloc] init];
+  GPUImageFilter *filter = [[GPUImageFilter alloc] init];
+  GPUImageTestFrameSink *sink = [[GPUImageTestFrameSink alloc] init];
+  filter.frameSampler.interval = 3;
+  [source addTarget:filter];
+  [filter addTarget:sink];
+
+  for (NSUInteger frameIndex = 0; frameIndex < 9; frameIndex++) {
+    [source sendFrameAtTime:frameTimeAtIndex(frameIndex)];
+  }
+  XCTAssertEqualObjects(sink.receivedFrameTimes, (@[@0, @3, @6]));
+  XCTAssertEqual(filter.skippedFrameCount, (NSUInteger)6);
+  XCTAssertEqual(filter.frameSampler.wantedFrameCount, (NSUInteger)3);
+  XCTAssertEqual(filter.frameSampler.declinedFrameCount, (NSUInteger)6);
+}
+
+- (void)testSkippedFrameSetsAreRetiredWithoutCountingAsRendered {
+  GPUImageTestFrameSource *camera = [[GPUImageTestFrameSource alloc] init];
+  GPUImageTestFrameSource *overlay = [[GPUImageTestFrameSource alloc] init];
+  GPUImageTwoInputFilter *filter = [[GPUImageTwoInputFilter alloc] initWithFragmentShaderFromString:kGPUImagePassthroughFragmentShaderString];
+  GPUImageLatestFrameSyncPolicy *policy = [[GPUImageLatestFrameSyncPolicy alloc] init];
+  GPUImageTestFrameSink *sink = [[GPUImageTestFrameSink alloc] init];
+  filter.frameSyncPolicy = policy;
+  filter.frameSampler.interval = 2;
+  [camera addTarget:filter atTextureLocation:0];
+  [overlay addTarget:filter atTextureLocation:1];
+  [filter addTarget:sink];
+
+  // One overlay frame under six camera frames, every other one of which the filter turns down
+  [overlay sendFrameAtTime:frameTimeAtIndex(0)];
+  for (NSUInteger frameIndex = 0; frameIndex < 6; frameIndex++) {
+    [camera sendFrameAtTime:frameTimeAtIndex(frameIndex)];
+  }
+
+  XCTAssertEqualObjects(sink.receivedFrameTimes, (@[@0, @2, @4]));
+  XCTAssertEqual(filter.skippedFrameCount, (NSUInteger)3);
+  XCTAssertEqual(policy.renderedFrameCount, (NSUInteger)3);
+  // Only the renders of frames 2 and 4 reused the overlay frame, and the skipped camera frames were never rendered
+  XCTAssertEqual(policy.reusedFrameCount, (NSUInteger)2);
+  XCTAssertEqual(policy.droppedFrameCount, (NSUInteger)3);
+}
+
+@end
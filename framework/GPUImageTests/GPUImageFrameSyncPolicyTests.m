@@ -0,0 +1,218 @@
+#import <XCTest/XCTest.h>
+#import "GPUImageFrameSyncPolicy.h"
+
+// Frames are plain strings on a 240 Hz clock, so that 60, 30 and 24 fps streams all land on whole ticks
+static CMTime tick(int64_t value) {
+  return CMTimeMake(value, 240);
+}
+
+@interface GPUImageFrameSyncPolicyTests : XCTestCase
+
+@property (nonatomic, strong) NSMutableArray *releasedFrames;
+
+@end
+
+@implementation GPUImageFrameSyncPolicyTests
+
+- (void)setUp {
+  [super setUp];
+  self.releasedFrames = [NSMutableArray array];
+}
+
+- (void)attachPolicy:(GPUImageFrameSyncPolicy *)policy numberOfInputs:(NSUInteger)numberOfInputs {
+  [policy resetWithNumberOfInputs:numberOfInputs];
+  NSMutableArray *releasedFrames = self.releasedFrames;
+  policy.frameReleaseBlock = ^(id frame) {
+    [releasedFrames addObject:frame];
+  };
+}
+
+// Renders every set the policy hands out, returning the sets and adding their timestamps in ticks to times
+- (NSArray *)renderAvailableFrameSetsWithPolicy:(GPUImageFrameSyncPolicy *)policy times:(NSMutableArray *)times {
+  NSMutableArray *frameSets = [NSMutableArray array];
+  CMTime frameTime = kCMTimeInvalid;
+  NSArray *frameSet;
+  while ((frameSet = [policy frameSetToRenderWithTime:&frameTime]) != nil) {
+    [frameSets addObject:frameSet];
+    [times addObject:@(CMTimeConvertScale(frameTime, 240, kCMTimeRoundingMethod_Default).value)];
+    [policy didRenderFrameSet];
+  }
+  return frameSets;
+}
+
+#pragma mark - Latest frame
+
+- (void)testLatestPolicyWaitsForEveryInput {
+  GPUImageLatestFrameSyncPolicy *policy = [[GPUImageLatestFrameSyncPolicy alloc] init];
+  [self attachPolicy:policy numberOfInputs:2];
+
+  CMTime frameTime;
+  [policy receiveFrame:@"camera0" atTime:tick(0) index:0];
+  XCTAssertNil([policy frameSetToRenderWithTime:&frameTime]);
+
+  [policy receiveFrame:@"overlay0" atTime:tick(0) index:1];
+  NSArray *frameSet = [policy frameSetToRenderWithTime:&frameTime];
+  XCTAssertEqualObjects(frameSet, (@[@"camera0", @"overlay0"]));
+  XCTAssertEqual(CMTimeCompare(frameTime, tick(0)), 0);
+}
+
+- (void)testLatestPolicyReusesSlowInputAndDropsSupersededFrames {
+  GPUImageLatestFrameSyncPolicy *policy = [[GPUImageLatestFrameSyncPolicy alloc] init];
+  [self attachPolicy:policy numberOfInputs:2];
+  NSMutableArray *times = [NSMutableArray array];
+
+  [policy receiveFrame:@"camera0" atTime:tick(0) index:0];
+  [policy receiveFrame:@"overlay0" atTime:tick(0) index:1];
+  XCTAssertEqualObjects([self renderAvailableFrameSetsWithPolicy:policy times:times], (@[@[@"camera0", @"overlay0"]]));
+
+  // Nothing new on the overlay, its last frame is rendered again
+  [policy receiveFrame:@"camera1" atTime:tick(4) index:0];
+  XCTAssertEqualObjects([self renderAvailableFrameSetsWithPolicy:policy times:times], (@[@[@"camera1", @"overlay0"]]));
+
+  // Two overlay frames before the next camera frame, only the newer one is rendered
+  [policy receiveFrame:@"overlay1" atTime:tick(10) index:1];
+  [policy receiveFrame:@"overlay2" atTime:tick(20) index:1];
+  [policy receiveFrame:@"camera2" atTime:tick(8) index:0];
+  XCTAssertEqualObjects([self renderAvailableFrameSetsWithPolicy:policy times:times], (@[@[@"camera2", @"overlay2"]]));
+
+  XCTAssertEqual(policy.renderedFrameCount, (NSUInteger)3);
+  XCTAssertEqual(policy.reusedFrameCount, (NSUInteger)1);
+  XCTAssertEqual(policy.droppedFrameCount, (NSUInteger)1);
+  XCTAssertEqualObjects(self.releasedFrames, (@[@"camera0", @"camera1", @"overlay0", @"overlay1", @"camera2"]));
+}
+
+#pragma mark - Timestamp matching
+
+- (void)testTimestampMatchedPolicyPairsFramesWithinTolerance {
+  GPUImageTimestampMatchedFrameSyncPolicy *policy = [[GPUImageTimestampMatchedFrameSyncPolicy alloc] init];
+  [self attachPolicy:policy numberOfInputs:2];
+  NSMutableArray *times = [NSMutableArray array];
+
+  // 30 fps primary, the second input skips a frame and is a tick late on the first
+  [policy receiveFrame:@"primary0" atTime:tick(0) index:0];
+  [policy receiveFrame:@"primary1" atTime:tick(8) index:0];
+  [policy receiveFrame:@"primary2" atTime:tick(16) index:0];
+  [policy receiveFrame:@"secondary0" atTime:tick(1) index:1];
+  [policy receiveFrame:@"secondary2" atTime:tick(16) index:1];
+
+  NSArray *frameSets = [self renderAvailableFrameSetsWithPolicy:policy times:times];
+  XCTAssertEqualObjects(frameSets, (@[@[@"primary0", @"secondary0"], @[@"primary2", @"secondary2"]]));
+  XCTAssertEqualObjects(times, (@[@0, @16]));
+
+  // The unmatched primary frame is dropped, not rendered with a frame out of tolerance
+  XCTAssertEqual(policy.renderedFrameCount, (NSUInteger)2);
+  XCTAssertEqual(policy.droppedFrameCount, (NSUInteger)1);
+  XCTAssertTrue([self.releasedFrames containsObject:@"primary1"]);
+}
+
+- (void)testTimestampMatchedPolicyWaitsForPendingMatch {
+  GPUImageTimestampMatchedFrameSyncPolicy *policy = [[GPUImageTimestampMatchedFrameSyncPolicy alloc] initWithTolerance:tick(2)];
+  [self attachPolicy:policy numberOfInputs:2];
+
+  CMTime frameTime;
+  [policy receiveFrame:@"primary0" atTime:tick(8) index:0];
+  XCTAssertNil([policy frameSetToRenderWithTime:&frameTime]);
+  XCTAssertEqual([self.releasedFrames count], (NSUInteger)0);
+
+  [policy receiveFrame:@"secondary0" atTime:tick(9) index:1];
+  XCTAssertEqualObjects([policy frameSetToRenderWithTime:&frameTime], (@[@"primary0", @"secondary0"]));
+}
+
+- (void)testTimestampMatchedPolicyMatchesStillImagesWithEveryFrame {
+  GPUImageTimestampMatchedFrameSyncPolicy *policy = [[GPUImageTimestampMatchedFrameSyncPolicy alloc] init];
+  [self attachPolicy:policy numberOfInputs:2];
+  NSMutableArray *times = [NSMutableArray array];
+
+  [policy receiveFrame:@"still" atTime:kCMTimeIndefinite index:1];
+  [policy receiveFrame:@"primary0" atTime:tick(0) index:0];
+  [policy receiveFrame:@"primary1" atTime:tick(480) index:0];
+
+  NSArray *frameSets = [self renderAvailableFrameSetsWithPolicy:policy times:times];
+  XCTAssertEqualObjects(frameSets, (@[@[@"primary0", @"still"], @[@"primary1", @"still"]]));
+  XCTAssertEqual(policy.reusedFrameCount, (NSUInteger)1);
+  XCTAssertEqual(policy.droppedFrameCount, (NSUInteger)0);
+}
+
+#pragma mark - Fixed latency
+
+- (void)testFixedLatencyPolicyRendersLateFramesAtTheirTimestamp {
+  GPUImageFixedLatencyFrameSyncPolicy *policy = [[GPUImageFixedLatencyFrameSyncPolicy alloc] initWithLatency:2];
+  [self attachPolicy:policy numberOfInputs:2];
+  NSMutableArray *times = [NSMutableArray array];
+
+  [policy receiveFrame:@"primary0" atTime:tick(0) index:0];
+  [policy receiveFrame:@"primary1" atTime:tick(8) index:0];
+  XCTAssertEqual([[self renderAvailableFrameSetsWithPolicy:policy times:times] count], (NSUInteger)0);
+
+  // The other input only catches up two primary frames later
+  [policy receiveFrame:@"primary2" atTime:tick(16) index:0];
+  [policy receiveFrame:@"secondary0" atTime:tick(0) index:1];
+  [policy receiveFrame:@"secondary1" atTime:tick(8) index:1];
+  XCTAssertEqualObjects([self renderAvailableFrameSetsWithPolicy:policy times:times], (@[@[@"primary0", @"secondary0"]]));
+
+  [policy receiveFrame:@"primary3" atTime:tick(24) index:0];
+  XCTAssertEqualObjects([self renderAvailableFrameSetsWithPolicy:policy times:times], (@[@[@"primary1", @"secondary1"]]));
+  XCTAssertEqualObjects(times, (@[@0, @8]));
+  XCTAssertEqual(policy.droppedFrameCount, (NSUInteger)0);
+}
+
+- (void)testFixedLatencyPolicyHoldsEnoughFramesForItsLatency {
+  GPUImageFixedLatencyFrameSyncPolicy *policy = [[GPUImageFixedLatencyFrameSyncPolicy alloc] initWithLatency:12];
+  XCTAssertGreaterThan(policy.maximumQueueLength, (NSUInteger)12);
+}
+
+#pragma mark - Bookkeeping
+
+- (void)testSkippedFrameSetIsNotCountedAsRendered {
+  GPUImageLatestFrameSyncPolicy *policy = [[GPUImageLatestFrameSyncPolicy alloc] init];
+  [self attachPolicy:policy numberOfInputs:2];
+
+  CMTime frameTime;
+  [policy receiveFrame:@"camera0" atTime:tick(0) index:0];
+  [policy receiveFrame:@"overlay0" atTime:tick(0) index:1];
+  XCTAssertNotNil([policy frameSetToRenderWithTime:&frameTime]);
+  [policy didSkipFrameSet];
+
+  XCTAssertEqual(policy.renderedFrameCount, (NSUInteger)0);
+  XCTAssertEqual(policy.droppedFrameCount, (NSUInteger)1);
+  XCTAssertEqualObjects(self.releasedFrames, (@[@"camera0"]));
+
+  // The overlay frame was never rendered, so using it now is not a reuse
+  [policy receiveFrame:@"camera1" atTime:tick(4) index:0];
+  XCTAssertEqualObjects([policy frameSetToRenderWithTime:&frameTime], (@[@"camera1", @"overlay0"]));
+  [policy didRenderFrameSet];
+  XCTAssertEqual(policy.renderedFrameCount, (NSUInteger)1);
+  XCTAssertEqual(policy.reusedFrameCount, (NSUInteger)0);
+}
+
+- (void)testQueuesAreBoundedByMaximumLength {
+  GPUImageTimestampMatchedFrameSyncPolicy *policy = [[GPUImageTimestampMatchedFrameSyncPolicy alloc] init];
+  [self attachPolicy:policy numberOfInputs:2];
+  policy.maximumQueueLength = 2;
+
+  [policy receiveFrame:@"secondary0" atTime:tick(0) index:1];
+  [policy receiveFrame:@"secondary1" atTime:tick(8) index:1];
+  [policy receiveFrame:@"secondary2" atTime:tick(16) index:1];
+
+  XCTAssertEqual([[policy queueForInput:1] count], (NSUInteger)2);
+  XCTAssertEqual(policy.droppedFrameCount, (NSUInteger)1);
+  XCTAssertEqualObjects(self.releasedFrames, (@[@"secondary0"]));
+}
+
+- (void)testResetReleasesEveryHeldFrameOnce {
+  GPUImageFixedLatencyFrameSyncPolicy *policy = [[GPUImageFixedLatencyFrameSyncPolicy alloc] init];
+  [self attachPolicy:policy numberOfInputs:3];
+
+  [policy receiveFrame:@"a" atTime:tick(0) index:0];
+  [policy receiveFrame:@"b" atTime:tick(0) index:1];
+  [policy receiveFrame:@"c" atTime:tick(0) index:2];
+  [policy receiveFrame:@"d" atTime:tick(8) index:2];
+  [policy resetWithNumberOfInputs:2];
+
+  XCTAssertEqualObjects([self.releasedFrames sortedArrayUsingSelector:@selector(compare:)], (@[@"a", @"b", @"c", @"d"]));
+  XCTAssertEqual(policy.numberOfInputs, (NSUInteger)2);
+  XCTAssertEqual(policy.droppedFrameCount, (NSUInteger)0);
+  XCTAssertEqual([[policy queueForInput:0] count], (NSUInteger)0);
+}
+
+@end
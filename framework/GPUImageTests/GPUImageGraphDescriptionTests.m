@@ -0,0 +1,271 @@
+#import <XCTest/XCTest.h>
+#import "GPUImageGraphDescription.h"
+#import "GPUImageBrightnessFilter.h"
+
+static NSDictionary *graphWithNodes(NSArray *nodes, NSString *output) {
+  return @{@"version": @1, @"nodes": nodes, @"output": output};
+}
+
+static NSDictionary *graphNode(NSString *identifier, NSString *className, NSArray *inputs, NSDictionary *parameters) {
+  NSMutableDictionary *node = [@{@"id": identifier, @"class": className, @"inputs": inputs} mutableCopy];
+  if (parameters != nil) {
+    node[@"parameters"] = parameters;
+  }
+  return node;
+}
+
+// Declared downstream first, so that loading has to sort them
+static NSDictionary *exampleGraph(void) {
+  return graphWithNodes(@[graphNode(@"vignette", @"GPUImageVignetteFilter", @[@"blend"], @{@"vignetteCenter": @{@"point": @[@0.5, @0.4]}, @"vignetteColor": @{@"vec3": @[@0.1, @0.0, @0.2]}}),
+                          graphNode(@"blend", @"GPUImageOverlayBlendFilter", @[kGPUImageGraphInputIdentifier, @"blur"], nil),
+                          graphNode(@"blur", @"GPUImageGaussianBlurFilter", @[kGPUImageGraphInputIdentifier], @{@"blurRadiusInPixels": @{@"float": @4}, @"blurPasses": @{@"int": @2}})],
+                        @"vignette");
+}
+
+// Fixed linear congruential sequence, so that a failing fuzz case can be replayed
+static uint32_t nextFuzzValue(uint32_t *state) {
+  *state = *state * 1664525 + 1013904223;
+  return *state >> 8;
+}
+
+@interface GPUImageGraphDescriptionTests : XCTestCase
+@end
+
+@implementation GPUImageGraphDescriptionTests
+
+- (void)assertGraph:(id)graph failsWithReason:(NSString *)reason {
+  NSError *error = nil;
+  XCTAssertNil([[GPUImageGraphDescription alloc] initWithDictionary:graph error:&error]);
+  XCTAssertEqualObjects(error.domain, NSCocoaErrorDomain);
+  XCTAssertEqual(error.code, (NSInteger)NSFileReadCorruptFileError);
+  XCTAssertTrue([error.localizedFailureReason rangeOfString:reason].location != NSNotFound, @"\"%@\" instead of \"%@\"", error.localizedFailureReason, reason);
+}
+
+- (void)assertParameter:(NSString *)key value:(NSDictionary *)typedValue ofClass:(NSString *)className failsWithReason:(NSString *)reason {
+  [self assertGraph:graphWithNodes(@[graphNode(@"node", className, @[kGPUImageGraphInputIdentifier], @{key: typedValue})], @"node") failsWithReason:reason];
+}
+
+#pragma mark - Loading
+
+- (void)testNodesAreSortedUpstreamFirst {
+  NSError *error = nil;
+  GPUImageGraphDescription *graph = [[GPUImageGraphDescription alloc] initWithDictionary:exampleGraph() error:&error];
+  XCTAssertNotNil(graph, @"%@", error);
+  XCTAssertEqual(graph.version, (NSUInteger)1);
+  XCTAssertEqualObjects(graph.nodeIdentifiers, (@[@"blur", @"blend", @"vignette"]));
+  XCTAssertEqualObjects(graph.outputIdentifier, @"vignette");
+  XCTAssertEqualObjects([graph filterClassOfNode:@"blur"], NSClassFromString(@"GPUImageGaussianBlurFilter"));
+  XCTAssertEqualObjects([graph inputIdentifiersOfNode:@"blend"], (@[kGPUImageGraphInputIdentifier, @"blur"]));
+}
+
+- (void)testEveryParameterTypeLoads {
+  NSDictionary *parameters = @{@"wantsMonochromeInput": @{@"bool": @YES},
+                               @"samplingFootprint": @{@"size": @[@2, @3]},
+                               @"redControlPoints": @{@"points": @[@[@0, @0], @[@0.5, @0.6], @[@1, @1]]}};
+  NSError *error = nil;
+  GPUImageGraphDescription *graph = [[GPUImageGraphDescription alloc] initWithDictionary:graphWithNodes(@[graphNode(@"curve", @"GPUImageToneCurveFilter", @[kGPUImageGraphInputIdentifier], parameters)], @"curve") error:&error];
+  XCTAssertNotNil(graph, @"%@", error);
+}
+
+- (void)testSerializationRoundTrips {
+  GPUImageGraphDescription *graph = [[GPUImageGraphDescription alloc] initWithDictionary:exampleGraph() error:NULL];
+  NSError *error = nil;
+  GPUImageGraphDescription *reloadedGraph = [[GPUImageGraphDescription alloc] initWithJSONData:[graph JSONRepresentation] error:&error];
+  XCTAssertNotNil(reloadedGraph, @"%@", error);
+  XCTAssertEqualObjects([reloadedGraph dictionaryRepresentation], [graph dictionaryRepresentation]);
+  XCTAssertEqualObjects([[graph dictionaryRepresentation][@"nodes"] valueForKey:@"id"], (@[@"blur", @"blend", @"vignette"]));
+}
+
+- (void)testGraphsLoadedFromTheSameFileAreShared {
+  NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[[NSUUID UUID] UUIDString] stringByAppendingPathExtension:@"json"]];
+  XCTAssertTrue([[NSJSONSerialization dataWithJSONObject:exampleGraph() options:0 error:NULL] writeToFile:path atomically:YES]);
+
+  NSURL *url = [NSURL fileURLWithPath:path];
+  NSError *error = nil;
+  GPUImageGraphDescription *graph = [GPUImageGraphDescription graphDescriptionWithContentsOfURL:url error:&error];
+  XCTAssertNotNil(graph, @"%@", error);
+  XCTAssertTrue([GPUImageGraphDescription graphDescriptionWithContentsOfURL:url error:NULL] == graph);
+  [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+}
+
+#pragma mark - Validation
+
+- (void)testGraphStructureIsValidated {
+  NSDictionary *blur = graphNode(@"blur", @"GPUImageGaussianBlurFilter", @[kGPUImageGraphInputIdentifier], nil);
+
+  [self assertGraph:@[] failsWithReason:@"isn't a dictionary"];
+  [self assertGraph:@{@"nodes": @[blur], @"output": @"blur"} failsWithReason:@"Missing or invalid version"];
+  [self assertGraph:@{@"version": @2, @"nodes": @[blur], @"output": @"blur"} failsWithReason:@"Version 2 is newer than the supported 1"];
+  [self assertGraph:graphWithNodes(@[], @"blur") failsWithReason:@"Missing or empty list of nodes"];
+  [self assertGraph:graphWithNodes(@[blur], @"sharpen") failsWithReason:@"Missing or unknown output node"];
+  [self assertGraph:graphWithNodes(@[blur, blur], @"blur") failsWithReason:@"Node \"blur\": duplicate identifier"];
+  [self assertGraph:graphWithNodes(@[graphNode(kGPUImageGraphInputIdentifier, @"GPUImageGaussianBlurFilter", @[kGPUImageGraphInputIdentifier], nil)], @"blur") failsWithReason:@"reserved node identifier"];
+}
+
+- (void)testNodesAreValidated {
+  [self assertGraph:graphWithNodes(@[@"blur"], @"blur") failsWithReason:@"A node isn't a dictionary"];
+  [self assertGraph:graphWithNodes(@[graphNode(@"text", @"NSString", @[kGPUImageGraphInputIdentifier], nil)], @"text") failsWithReason:@"Node \"text\": NSString isn't a filter class"];
+  [self assertGraph:graphWithNodes(@[graphNode(@"blur", @"GPUImageNoSuchFilter", @[kGPUImageGraphInputIdentifier], nil)], @"blur") failsWithReason:@"isn't a filter class"];
+  [self assertGraph:graphWithNodes(@[graphNode(@"blur", @"GPUImageGaussianBlurFilter", @[], nil)], @"blur") failsWithReason:@"missing or empty inputs"];
+  [self assertGraph:graphWithNodes(@[graphNode(@"blur", @"GPUImageGaussianBlurFilter", @[@1], nil)], @"blur") failsWithReason:@"inputs must be node identifiers"];
+  [self assertGraph:graphWithNodes(@[graphNode(@"blend", @"GPUImageOverlayBlendFilter", @[kGPUImageGraphInputIdentifier, kGPUImageGraphInputIdentifier], nil)], @"blend") failsWithReason:@"an input is listed twice"];
+  [self assertGraph:graphWithNodes(@[graphNode(@"blend", @"GPUImageOverlayBlendFilter", @[kGPUImageGraphInputIdentifier, @"sharpen"], nil)], @"blend") failsWithReason:@"Node \"blend\": unknown input \"sharpen\""];
+}
+
+- (void)testEveryNodeMustFeedTheOutputWithoutCycles {
+  NSArray *cycle = @[graphNode(@"first", @"GPUImageGaussianBlurFilter", @[@"second"], nil),
+                     graphNode(@"second", @"GPUImageOverlayBlendFilter", @[kGPUImageGraphInputIdentifier, @"first"], nil),
+                     graphNode(@"output", @"GPUImageOverlayBlendFilter", @[kGPUImageGraphInputIdentifier, @"second"], nil)];
+  [self assertGraph:graphWithNodes(cycle, @"output") failsWithReason:@"Node \"first\": part of a cycle"];
+
+  NSArray *deadEnd = @[graphNode(@"unused", @"GPUImageGaussianBlurFilter", @[kGPUImageGraphInputIdentifier], nil),
+                       graphNode(@"output", @"GPUImageGaussianBlurFilter", @[kGPUImageGraphInputIdentifier], nil)];
+  [self assertGraph:graphWithNodes(deadEnd, @"output") failsWithReason:@"Node \"unused\": doesn't feed the output"];
+}
+
+- (void)testParametersAreValidatedAgainstTheProperties {
+  NSString *blur = @"GPUImageGaussianBlurFilter";
+  [self assertParameter:@"blurRadius" value:@{@"float": @4} ofClass:blur failsWithReason:@"GPUImageGaussianBlurFilter has no property blurRadius"];
+  [self assertParameter:@"skippedFrameCount" value:@{@"int": @4} ofClass:blur failsWithReason:@"property skippedFrameCount is readonly"];
+  [self assertParameter:@"blurRadiusInPixels" value:@{@"point": @[@4, @4]} ofClass:blur failsWithReason:@"the property isn't of type point"];
+  [self assertParameter:@"blurRadiusInPixels" value:@{@"float": @"wide"} ofClass:blur failsWithReason:@"malformed float value"];
+  [self assertParameter:@"blurPasses" value:@{@"int": @2.5} ofClass:blur failsWithReason:@"malformed int value"];
+  [self assertParameter:@"blurRadiusInPixels" value:@{@"double": @4} ofClass:blur failsWithReason:@"unknown parameter type \"double\""];
+  [self assertParameter:@"blurRadiusInPixels" value:@{@"float": @4, @"int": @4} ofClass:blur failsWithReason:@"one typed value"];
+  [self assertParameter:@"blurRadiusInPixels" value:@{@1: @4} ofClass:blur failsWithReason:@"one typed value"];
+  [self assertParameter:@"vignetteColor" value:@{@"vec3": @[@1, @0]} ofClass:@"GPUImageVignetteFilter" failsWithReason:@"malformed vec3 value"];
+  [self assertParameter:@"redControlPoints" value:@{@"points": @[@[@0, @0], @[@1]]} ofClass:@"GPUImageToneCurveFilter" failsWithReason:@"malformed points value"];
+}
+
+#pragma mark - Filters
+
+- (void)testFiltersAreCreatedWithTheirParameters {
+  NSDictionary *dictionary = graphWithNodes(@[graphNode(@"brightness", @"GPUImageBrightnessFilter", @[kGPUImageGraphInputIdentifier], @{@"brightness": @{@"float": @0.25}}),
+                                              graphNode(@"blend", @"GPUImageOverlayBlendFilter", @[@"brightness"], nil)],
+                                            @"blend");
+  GPUImageGraphDescription *graph = [[GPUImageGraphDescription alloc] initWithDictionary:dictionary error:NULL];
+  XCTAssertNotNil(graph);
+
+  NSError *error = nil;
+  GPUImageBrightnessFilter *filter = (GPUImageBrightnessFilter *)[graph newFilterForNode:@"brightness" error:&error];
+  XCTAssertTrue([filter isKindOfClass:[GPUImageBrightnessFilter class]], @"%@", error);
+  XCTAssertEqualWithAccuracy(filter.brightness, 0.25, 1e-6);
+
+  // Only creating the filter tells how many inputs it takes
+  XCTAssertNil([graph newFilterForNode:@"blend" error:&error]);
+  XCTAssertTrue([error.localizedFailureReason rangeOfString:@"takes 2 inputs, 1 given"].location != NSNotFound, @"%@", error);
+}
+
+#pragma mark - Fuzzing
+
+// Either a graph whose nodes come upstream first and end with the output, or an error, never an exception
+- (void)assertLoadingIsWellBehaved:(GPUImageGraphDescription *(^)(NSError **error))loadBlock {
+  GPUImageGraphDescription *graph = nil;
+  NSError *error = nil;
+  XCTAssertNoThrow(graph = loadBlock(&error));
+  if (graph == nil) {
+    XCTAssertEqualObjects(error.domain, NSCocoaErrorDomain);
+    return;
+  }
+
+  XCTAssertEqualObjects([graph.nodeIdentifiers lastObject], graph.outputIdentifier);
+  NSMutableSet *loadedNodes = [NSMutableSet setWithObject:kGPUImageGraphInputIdentifier];
+  for (NSString *identifier in graph.nodeIdentifiers) {
+    XCTAssertFalse([loadedNodes containsObject:identifier]);
+    for (NSString *input in [graph inputIdentifiersOfNode:identifier]) {
+      XCTAssertTrue([loadedNodes containsObject:input], @"%@ comes before its input %@", identifier, input);
+    }
+    [loadedNodes addObject:identifier];
+  }
+}
+
+- (id)mutatedObject:(id)object state:(uint32_t *)state {
+  NSArray *replacements = @[@"", kGPUImageGraphInputIdentifier, @"blur", @"blend", @"vignette", @"GPUImageFilter", @0, @-1, @2, @2.5, @YES, [NSNull null], @[], @{},
+                            @[@"blur"], @[@"blend", @"blur"], @{@"float": @"x"}, @{@1: @2}, @{@"points": @[@[@0]]}, @[@[@0, @1]]];
+  uint32_t choice = nextFuzzValue(state) % 4;
+
+  if ([object isKindOfClass:[NSDictionary class]] && [object count] > 0) {
+    NSMutableDictionary *mutatedDictionary = [object mutableCopy];
+    NSArray *keys = [object allKeys];
+    id key = keys[nextFuzzValue(state) % [keys count]];
+    if (choice == 0) {
+      [mutatedDictionary removeObjectForKey:key];
+    } else if (choice == 1) {
+      mutatedDictionary[replacements[nextFuzzValue(state) % [replacements count]]] = object[key];
+    } else if (choice == 2) {
+      mutatedDictionary[key] = replacements[nextFuzzValue(state) % [replacements count]];
+    } else {
+      mutatedDictionary[key] = [self mutatedObject:object[key] state:state];
+    }
+    return mutatedDictionary;
+  }
+
+  if ([object isKindOfClass:[NSArray class]] && [object count] > 0) {
+    NSMutableArray *mutatedArray = [object mutableCopy];
+    NSUInteger index = nextFuzzValue(state) % [object count];
+    if (choice == 0) {
+      [mutatedArray removeObjectAtIndex:index];
+    } else if (choice == 1) {
+      [mutatedArray addObject:object[index]];
+    } else if (choice == 2) {
+      mutatedArray[index] = replacements[nextFuzzValue(state) % [replacements count]];
+    } else {
+      mutatedArray[index] = [self mutatedObject:object[index] state:state];
+    }
+    return mutatedArray;
+  }
+
+  return replacements[nextFuzzValue(state) % [replacements count]];
+}
+
+- (void)testFuzzedDictionariesAreRejectedCleanly {
+  uint32_t state = 2024;
+  for (NSUInteger iteration = 0; iteration < 3000; iteration++) {
+    id graph = exampleGraph();
+    NSUInteger mutationCount = 1 + nextFuzzValue(&state) % 3;
+    for (NSUInteger mutation = 0; mutation < mutationCount; mutation++) {
+      graph = [self mutatedObject:graph state:&state];
+    }
+    [self assertLoadingIsWellBehaved:^GPUImageGraphDescription *(NSError **error) {
+      return [[GPUImageGraphDescription alloc] initWithDictionary:graph error:error];
+    }];
+  }
+}
+
+- (void)testFuzzedJSONIsRejectedCleanly {
+  NSData *json = [NSJSONSerialization dataWithJSONObject:exampleGraph() options:0 error:NULL];
+  uint32_t state = 7;
+  for (NSUInteger iteration = 0; iteration < 3000; iteration++) {
+    NSMutableData *fuzzedJSON = [json mutableCopy];
+    uint8_t *bytes = [fuzzedJSON mutableBytes];
+    NSUInteger flipCount = 1 + nextFuzzValue(&state) % 4;
+    for (NSUInteger flip = 0; flip < flipCount; flip++) {
+      bytes[nextFuzzValue(&state) % [fuzzedJSON length]] = (uint8_t)nextFuzzValue(&state);
+    }
+    if (nextFuzzValue(&state) % 4 == 0) {
+      [fuzzedJSON setLength:nextFuzzValue(&state) % [fuzzedJSON length]];
+    }
+    [self assertLoadingIsWellBehaved:^GPUImageGraphDescription *(NSError **error) {
+      return [[GPUImageGraphDescription alloc] initWithJSONData:fuzzedJSON error:error];
+    }];
+  }
+}
+
+#pragma mark - Performance
+
+- (void)testPerformanceOfLoadingALongChain {
+  // 200 nodes, declared downstream first
+  NSMutableArray *nodes = [NSMutableArray array];
+  for (NSUInteger node = 200; node > 0; node--) {
+    NSString *input = (node > 1) ? [NSString stringWithFormat:@"node%lu", (unsigned long)(node - 1)] : kGPUImageGraphInputIdentifier;
+    [nodes addObject:graphNode([NSString stringWithFormat:@"node%lu", (unsigned long)node], @"GPUImageVignetteFilter", @[input],
+                               @{@"vignetteCenter": @{@"point": @[@0.5, @0.5]}, @"vignetteStart": @{@"float": @0.3}, @"vignetteEnd": @{@"float": @0.75}})];
+  }
+  NSData *json = [NSJSONSerialization dataWithJSONObject:graphWithNodes(nodes, @"node200") options:0 error:NULL];
+
+  [self measureBlock:^{
+    XCTAssertNotNil([[GPUImageGraphDescription alloc] initWithJSONData:json error:NULL]);
+  }];
+}
+
+@end
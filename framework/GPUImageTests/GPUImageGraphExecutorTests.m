@@ -0,0 +1,259 @@
+#import <XCTest/XCTest.h>
+#import "GPUImageGraphExecutor.h"
+
+// A node that passes a frame on once it has one on each of its inputs, without touching OpenGL
+@interface GPUImageTestGraphNode : GPUImageOutput <GPUImageInput>
+
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, assign) NSUInteger inputCount;
+@property (nonatomic, assign) NSUInteger receivedInputCount;
+@property (nonatomic, assign) NSUInteger emittedFrameCount;
+
+/// Called with every frame received, before the node passes anything on
+@property (nonatomic, copy) void (^frameBlock)(GPUImageTestGraphNode *node);
+
++ (instancetype)nodeNamed:(NSString *)name;
+
+@end
+
+@implementation GPUImageTestGraphNode
+
++ (instancetype)nodeNamed:(NSString *)name {
+  GPUImageTestGraphNode *node = [[self alloc] init];
+  node.name = name;
+  node.inputCount = 1;
+  return node;
+}
+
+- (NSString *)description {
+  return self.name;
+}
+
+- (void)emitFrameAtTime:(CMTime)frameTime {
+  self.emittedFrameCount++;
+  [self informTargetsAboutNewFrameAtTime:frameTime];
+}
+
+- (CGSize)outputFrameSize {
+  return CGSizeMake(16.0, 16.0);
+}
+
+- (void)newFrameReadyAtTime:(CMTime)frameTime atIndex:(NSInteger)textureIndex {
+  if (self.frameBlock != nil) {
+    self.frameBlock(self);
+  }
+  self.receivedInputCount++;
+  if (self.receivedInputCount == self.inputCount) {
+    self.receivedInputCount = 0;
+    [self emitFrameAtTime:frameTime];
+  }
+}
+
+- (void)setInputFramebuffer:(GPUImageFramebuffer *)value index:(NSUInteger)index {
+}
+
+- (NSInteger)nextAvailableTextureIndex {
+  return 0;
+}
+
+- (void)setInputSize:(CGSize)value index:(NSUInteger)index {
+}
+
+- (void)setInputRotation:(GPUImageRotationMode)value index:(NSUInteger)index {
+}
+
+- (void)endProcessing {
+}
+
+- (BOOL)shouldIgnoreUpdatesToThisTarget {
+  return NO;
+}
+
+@end
+
+@interface GPUImageGraphExecutorTests : XCTestCase
+
+@property (nonatomic, strong) GPUImageTestGraphNode *source;
+
+@end
+
+@implementation GPUImageGraphExecutorTests
+
+- (void)setUp {
+  [super setUp];
+  self.source = [GPUImageTestGraphNode nodeNamed:@"source"];
+}
+
+- (void)sendFrame {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [self.source emitFrameAtTime:kCMTimeZero];
+  });
+}
+
+- (NSArray *)namesOfNodes:(NSArray *)nodes {
+  NSMutableArray *names = [NSMutableArray arrayWithCapacity:[nodes count]];
+  for (GPUImageTestGraphNode *node in nodes) {
+    [names addObject:node.name];
+  }
+  return names;
+}
+
+// source -> left -> blend <- right <- source, blend -> output
+- (GPUImageGraphExecutor *)diamondExecutorWithNodes:(NSDictionary **)nodes {
+  GPUImageTestGraphNode *left = [GPUImageTestGraphNode nodeNamed:@"left"];
+  GPUImageTestGraphNode *right = [GPUImageTestGraphNode nodeNamed:@"right"];
+  GPUImageTestGraphNode *blend = [GPUImageTestGraphNode nodeNamed:@"blend"];
+  GPUImageTestGraphNode *output = [GPUImageTestGraphNode nodeNamed:@"output"];
+  blend.inputCount = 2;
+
+  [self.source addTarget:left];
+  [self.source addTarget:right];
+  [left addTarget:blend atTextureLocation:0];
+  [right addTarget:blend atTextureLocation:1];
+  [blend addTarget:output];
+
+  if (nodes != NULL) {
+    *nodes = @{@"left": left, @"right": right, @"blend": blend, @"output": output};
+  }
+  return [[GPUImageGraphExecutor alloc] initWithSources:@[self.source]];
+}
+
+// source -> encoderFilter -> encoder, source -> previewFilter -> preview
+- (GPUImageGraphExecutor *)branchingExecutorWithNodes:(NSDictionary **)nodes {
+  NSMutableDictionary *branchNodes = [NSMutableDictionary dictionary];
+  for (NSString *branch in @[@"encoder", @"preview"]) {
+    GPUImageTestGraphNode *filter = [GPUImageTestGraphNode nodeNamed:[branch stringByAppendingString:@"Filter"]];
+    GPUImageTestGraphNode *sink = [GPUImageTestGraphNode nodeNamed:branch];
+    [self.source addTarget:filter];
+    [filter addTarget:sink];
+    branchNodes[filter.name] = filter;
+    branchNodes[sink.name] = sink;
+  }
+
+  *nodes = branchNodes;
+  return [[GPUImageGraphExecutor alloc] initWithSources:@[self.source]];
+}
+
+#pragma mark - Graph
+
+- (void)testNodesAreSortedUpstreamFirst {
+  NSDictionary *nodes = nil;
+  GPUImageGraphExecutor *executor = [self diamondExecutorWithNodes:&nodes];
+  XCTAssertEqualObjects([self namesOfNodes:executor.sortedNodes], (@[@"source", @"left", @"right", @"blend", @"output"]));
+  XCTAssertFalse(executor.containsCycle);
+  XCTAssertEqual(((GPUImageOutput *)nodes[@"blend"]).graphExecutor, executor);
+}
+
+- (void)testFeedbackLoopsAreSortedLast {
+  GPUImageTestGraphNode *feedback = [GPUImageTestGraphNode nodeNamed:@"feedback"];
+  GPUImageTestGraphNode *delay = [GPUImageTestGraphNode nodeNamed:@"delay"];
+  GPUImageTestGraphNode *output = [GPUImageTestGraphNode nodeNamed:@"output"];
+  [self.source addTarget:output];
+  [self.source addTarget:feedback];
+  [feedback addTarget:delay];
+  [delay addTarget:feedback atTextureLocation:1];
+
+  GPUImageGraphExecutor *executor = [[GPUImageGraphExecutor alloc] initWithSources:@[self.source]];
+  XCTAssertTrue(executor.containsCycle);
+  XCTAssertEqualObjects([self namesOfNodes:executor.sortedNodes], (@[@"source", @"output", @"feedback", @"delay"]));
+}
+
+- (void)testRebuildingFollowsChangedTargets {
+  NSDictionary *nodes = nil;
+  GPUImageGraphExecutor *executor = [self diamondExecutorWithNodes:&nodes];
+  GPUImageTestGraphNode *output = nodes[@"output"];
+  [nodes[@"blend"] removeTarget:output];
+  [executor rebuildGraph];
+
+  XCTAssertEqualObjects([self namesOfNodes:executor.sortedNodes], (@[@"source", @"left", @"right", @"blend"]));
+  XCTAssertNil(output.graphExecutor);
+}
+
+#pragma mark - Delivery order
+
+- (void)testMultipleInputNodesRunOnceAfterAllTheirInputs {
+  NSDictionary *nodes = nil;
+  GPUImageGraphExecutor *executor = [self diamondExecutorWithNodes:&nodes];
+  [self sendFrame];
+
+  // Pushing recursively would have reached the blend between left and right
+  XCTAssertEqualObjects([self namesOfNodes:executor.lastFrameDeliveryOrder], (@[@"left", @"right", @"blend", @"blend", @"output"]));
+  XCTAssertEqual([nodes[@"blend"] emittedFrameCount], (NSUInteger)1);
+  XCTAssertEqual([nodes[@"output"] emittedFrameCount], (NSUInteger)1);
+  XCTAssertEqual(executor.lastFrameSkippedDeliveryCount, (NSUInteger)0);
+}
+
+- (void)testPriorityRunsTheWholeBranchFirst {
+  NSDictionary *nodes = nil;
+  GPUImageGraphExecutor *executor = [self branchingExecutorWithNodes:&nodes];
+  [self sendFrame];
+  XCTAssertEqualObjects([self namesOfNodes:executor.lastFrameDeliveryOrder], (@[@"encoderFilter", @"previewFilter", @"encoder", @"preview"]));
+
+  [executor setPriority:5 forNode:nodes[@"preview"]];
+  XCTAssertEqual([executor priorityForNode:nodes[@"preview"]], (NSInteger)5);
+  XCTAssertEqual([executor priorityForNode:nodes[@"previewFilter"]], (NSInteger)0);
+  [self sendFrame];
+  XCTAssertEqualObjects([self namesOfNodes:executor.lastFrameDeliveryOrder], (@[@"previewFilter", @"preview", @"encoderFilter", @"encoder"]));
+}
+
+- (void)testPausedBranchesAreSkipped {
+  NSDictionary *nodes = nil;
+  GPUImageGraphExecutor *executor = [self branchingExecutorWithNodes:&nodes];
+  [executor setNode:nodes[@"preview"] paused:YES];
+  XCTAssertTrue([executor isNodePaused:nodes[@"preview"]]);
+
+  [self sendFrame];
+  XCTAssertEqualObjects([self namesOfNodes:executor.lastFrameDeliveryOrder], (@[@"encoderFilter", @"encoder"]));
+  XCTAssertEqual(executor.lastFrameSkippedDeliveryCount, (NSUInteger)1);
+  XCTAssertEqual([nodes[@"previewFilter"] emittedFrameCount], (NSUInteger)0);
+
+  // Capturing an image keeps a node live even when all it feeds is paused
+  ((GPUImageOutput *)nodes[@"previewFilter"]).usingNextFrameForImageCapture = YES;
+  [self sendFrame];
+  XCTAssertEqualObjects([self namesOfNodes:executor.lastFrameDeliveryOrder], (@[@"encoderFilter", @"previewFilter", @"encoder"]));
+  ((GPUImageOutput *)nodes[@"previewFilter"]).usingNextFrameForImageCapture = NO;
+
+  [executor setNode:nodes[@"preview"] paused:NO];
+  [self sendFrame];
+  XCTAssertEqual([executor.lastFrameDeliveryOrder count], (NSUInteger)4);
+  XCTAssertEqual(executor.lastFrameSkippedDeliveryCount, (NSUInteger)0);
+}
+
+- (void)testNodesAddedSinceTheLastRebuildStillGetFrames {
+  NSDictionary *nodes = nil;
+  GPUImageGraphExecutor *executor = [self diamondExecutorWithNodes:&nodes];
+  GPUImageTestGraphNode *late = [GPUImageTestGraphNode nodeNamed:@"late"];
+  [self.source addTarget:late];
+
+  [self sendFrame];
+  XCTAssertEqualObjects([executor.lastFrameDeliveryOrder lastObject], late);
+  XCTAssertEqual(late.emittedFrameCount, (NSUInteger)1);
+}
+
+#pragma mark - Cancellation
+
+- (void)testCancellingDropsTheRestOfTheFrame {
+  NSDictionary *nodes = nil;
+  GPUImageGraphExecutor *executor = [self diamondExecutorWithNodes:&nodes];
+  __weak GPUImageGraphExecutor *weakExecutor = executor;
+  ((GPUImageTestGraphNode *)nodes[@"left"]).frameBlock = ^(GPUImageTestGraphNode *node) {
+    [weakExecutor cancelCurrentFrame];
+  };
+
+  // Left still passes its frame on, but neither that delivery nor the one to right is made
+  [self sendFrame];
+  XCTAssertEqualObjects([self namesOfNodes:executor.lastFrameDeliveryOrder], (@[@"left"]));
+  XCTAssertEqual(executor.lastFrameSkippedDeliveryCount, (NSUInteger)2);
+  XCTAssertEqual(executor.cancelledFrameCount, (NSUInteger)1);
+  XCTAssertEqual([nodes[@"output"] emittedFrameCount], (NSUInteger)0);
+
+  // A cancellation only covers the frame in flight
+  ((GPUImageTestGraphNode *)nodes[@"left"]).frameBlock = nil;
+  [executor cancelCurrentFrame];
+  [self sendFrame];
+  XCTAssertEqual([executor.lastFrameDeliveryOrder count], (NSUInteger)5);
+  XCTAssertEqual(executor.cancelledFrameCount, (NSUInteger)1);
+  XCTAssertEqual([nodes[@"output"] emittedFrameCount], (NSUInteger)1);
+}
+
+@end
@@ -0,0 +1,169 @@
+#import <XCTest/XCTest.h>
+#import "GPUImageResamplingFilter.h"
+
+static const NSUInteger kTestMaximumTaps = 32;
+
+// Resamples a row on the CPU the way one filter pass does, with the exact sub-pixel offset instead of the nearest of the 16 tabulated phases
+static NSArray *resampleRow(NSArray *row, NSUInteger outputLength, GPUImageResamplingKernel kernel) {
+  NSUInteger inputLength = [row count];
+  CGFloat ratio = (CGFloat)inputLength / outputLength;
+  CGFloat support = GPUImageResamplingKernelSupport(kernel, ratio);
+  NSUInteger tapCount = GPUImageResamplingTapCount(kernel, ratio);
+
+  NSMutableArray *output = [NSMutableArray arrayWithCapacity:outputLength];
+  CGFloat weights[kTestMaximumTaps];
+  for (NSUInteger pixel = 0; pixel < outputLength; pixel++) {
+    CGFloat center = (pixel + 0.5) * ratio - 0.5;
+    CGFloat start = floor(center - support);
+    GPUImageResamplingKernelWeights(kernel, ratio, center - support - start, weights);
+
+    CGFloat sum = 0.0;
+    for (NSUInteger tap = 0; tap < tapCount; tap++) {
+      NSInteger inputPixel = MIN(MAX((NSInteger)start + 1 + (NSInteger)tap, 0), (NSInteger)inputLength - 1);
+      sum += weights[tap] * [row[inputPixel] doubleValue];
+    }
+    [output addObject:@(sum)];
+  }
+  return output;
+}
+
+// How far a step edge resampled at every sub-pixel alignment goes beyond 0.0 and 1.0
+static CGFloat ringingOfKernel(GPUImageResamplingKernel kernel, CGFloat ratio) {
+  NSUInteger outputLength = 64;
+  NSUInteger inputLength = (NSUInteger)round(outputLength * ratio);
+  CGFloat ringing = 0.0;
+  for (NSUInteger edgeShift = 0; edgeShift < MAX((NSUInteger)ceil(ratio), 1); edgeShift++) {
+    NSMutableArray *step = [NSMutableArray arrayWithCapacity:inputLength];
+    for (NSUInteger pixel = 0; pixel < inputLength; pixel++) {
+      [step addObject:@((pixel < inputLength / 2 + edgeShift) ? 0.0 : 1.0)];
+    }
+    for (NSNumber *value in resampleRow(step, outputLength, kernel)) {
+      ringing = MAX(ringing, MAX([value doubleValue] - 1.0, -[value doubleValue]));
+    }
+  }
+  return ringing;
+}
+
+// The amplitude left of a unit sine above the output's Nyquist frequency, all of which would alias. Point sampling keeps all of it
+static CGFloat aliasingOfKernel(GPUImageResamplingKernel kernel, CGFloat ratio, CGFloat cyclesPerInputPixel) {
+  NSUInteger inputLength = 1024;
+  NSMutableArray *sine = [NSMutableArray arrayWithCapacity:inputLength];
+  for (NSUInteger pixel = 0; pixel < inputLength; pixel++) {
+    [sine addObject:@(sin(2.0 * M_PI * cyclesPerInputPixel * pixel))];
+  }
+
+  NSArray *output = resampleRow(sine, (NSUInteger)round(inputLength / ratio), kernel);
+  CGFloat amplitude = 0.0;
+  // Away from the clamped borders
+  for (NSUInteger pixel = 8; pixel < [output count] - 8; pixel++) {
+    amplitude = MAX(amplitude, fabs([output[pixel] doubleValue]));
+  }
+  return amplitude;
+}
+
+@interface GPUImageResamplingFilterTests : XCTestCase
+
+@end
+
+@implementation GPUImageResamplingFilterTests
+
+#pragma mark - Weights
+
+- (void)testWeightsAreNormalizedAtEveryPhase {
+  CGFloat weights[kTestMaximumTaps];
+  for (NSNumber *kernel in @[@(kGPUImageResamplingAreaKernel), @(kGPUImageResamplingLanczosKernel)]) {
+    for (NSNumber *ratio in @[@0.5, @1.0, @1.5, @2.0, @3.7, @8.0, @16.0]) {
+      NSUInteger tapCount = GPUImageResamplingTapCount([kernel unsignedIntegerValue], [ratio doubleValue]);
+      XCTAssertLessThanOrEqual(tapCount, kTestMaximumTaps);
+      for (NSUInteger phase = 0; phase < 16; phase++) {
+        GPUImageResamplingKernelWeights([kernel unsignedIntegerValue], [ratio doubleValue], phase / 16.0, weights);
+        CGFloat sum = 0.0;
+        for (NSUInteger tap = 0; tap < tapCount; tap++) {
+          sum += weights[tap];
+        }
+        XCTAssertEqualWithAccuracy(sum, 1.0, 1e-9, @"Kernel %@ at ratio %@, phase %lu", kernel, ratio, (unsigned long)phase);
+      }
+    }
+  }
+}
+
+- (void)testAreaWeightsAreTheCoverageOfEachInputPixel {
+  // A whole-number ratio lines the footprint up with pixel edges, four input pixels per output pixel
+  CGFloat weights[kTestMaximumTaps];
+  XCTAssertEqual(GPUImageResamplingTapCount(kGPUImageResamplingAreaKernel, 4.0), (NSUInteger)5);
+  GPUImageResamplingKernelWeights(kGPUImageResamplingAreaKernel, 4.0, 0.0, weights);
+  CGFloat expectedWeights[5] = {0.25, 0.25, 0.25, 0.25, 0.0};
+  for (NSUInteger tap = 0; tap < 5; tap++) {
+    XCTAssertEqualWithAccuracy(weights[tap], expectedWeights[tap], 1e-12, @"Tap %lu", (unsigned long)tap);
+  }
+
+  // Off the pixel grid the edge pixels are partly covered, but no weight is ever negative
+  for (NSUInteger phase = 0; phase < 16; phase++) {
+    GPUImageResamplingKernelWeights(kGPUImageResamplingAreaKernel, 3.3, phase / 16.0, weights);
+    for (NSUInteger tap = 0; tap < GPUImageResamplingTapCount(kGPUImageResamplingAreaKernel, 3.3); tap++) {
+      XCTAssertGreaterThanOrEqual(weights[tap], 0.0);
+    }
+  }
+}
+
+- (void)testLanczosLobesAlternateInSign {
+  CGFloat weights[kTestMaximumTaps];
+  for (NSNumber *ratioValue in @[@1.0, @2.0]) {
+    CGFloat ratio = [ratioValue doubleValue];
+    CGFloat support = GPUImageResamplingKernelSupport(kGPUImageResamplingLanczosKernel, ratio);
+    XCTAssertEqualWithAccuracy(support, 3.0 * ratio, 1e-12);
+
+    // Halfway between pixels, so that no tap falls on a zero crossing
+    GPUImageResamplingKernelWeights(kGPUImageResamplingLanczosKernel, ratio, 0.5, weights);
+    for (NSUInteger tap = 0; tap < GPUImageResamplingTapCount(kGPUImageResamplingLanczosKernel, ratio); tap++) {
+      CGFloat lobe = floor(fabs(tap + 0.5 - support) / ratio);
+      if (lobe >= 3.0) {
+        XCTAssertEqual(weights[tap], 0.0);
+      } else if (fmod(lobe, 2.0) == 0.0) {
+        XCTAssertGreaterThan(weights[tap], 0.0, @"Tap %lu at ratio %@", (unsigned long)tap, ratioValue);
+      } else {
+        XCTAssertLessThan(weights[tap], 0.0, @"Tap %lu at ratio %@", (unsigned long)tap, ratioValue);
+      }
+    }
+  }
+
+  // Symmetric around the center
+  GPUImageResamplingKernelWeights(kGPUImageResamplingLanczosKernel, 1.0, 0.5, weights);
+  for (NSUInteger tap = 0; tap < 3; tap++) {
+    XCTAssertEqualWithAccuracy(weights[tap], weights[5 - tap], 1e-12);
+  }
+}
+
+- (void)testLanczosOnThePixelGridReproducesTheInput {
+  CGFloat weights[kTestMaximumTaps];
+  GPUImageResamplingKernelWeights(kGPUImageResamplingLanczosKernel, 1.0, 0.0, weights);
+  for (NSUInteger tap = 0; tap < 6; tap++) {
+    XCTAssertEqualWithAccuracy(weights[tap], (tap == 2) ? 1.0 : 0.0, 1e-12, @"Tap %lu", (unsigned long)tap);
+  }
+}
+
+#pragma mark - Ringing and aliasing
+
+- (void)testAreaAveragingNeverRings {
+  for (NSNumber *ratio in @[@2.0, @3.5, @8.0, @16.0]) {
+    XCTAssertLessThan(ringingOfKernel(kGPUImageResamplingAreaKernel, [ratio doubleValue]), 1e-9, @"Ratio %@", ratio);
+  }
+}
+
+- (void)testLanczosRingingStaysBounded {
+  // The Lanczos overshoot at a hard edge, never much more than a tenth of the step
+  for (NSNumber *ratio in @[@0.5, @1.5, @2.0]) {
+    CGFloat ringing = ringingOfKernel(kGPUImageResamplingLanczosKernel, [ratio doubleValue]);
+    XCTAssertGreaterThan(ringing, 0.0, @"Ratio %@", ratio);
+    XCTAssertLessThan(ringing, 0.11, @"Ratio %@", ratio);
+  }
+}
+
+- (void)testFrequenciesAboveTheOutputNyquistAreSuppressed {
+  // 0.4 cycles per input pixel lies above the output's Nyquist frequency of 0.25 at a ratio of 2 and 0.0625 at 8
+  XCTAssertLessThan(aliasingOfKernel(kGPUImageResamplingLanczosKernel, 2.0, 0.4), 0.05);
+  XCTAssertLessThan(aliasingOfKernel(kGPUImageResamplingAreaKernel, 8.0, 0.4), 0.1);
+  XCTAssertLessThan(aliasingOfKernel(kGPUImageResamplingAreaKernel, 16.0, 0.4), 0.1);
+}
+
+@end
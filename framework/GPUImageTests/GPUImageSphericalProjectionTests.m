@@ -0,0 +1,113 @@
+#import <XCTest/XCTest.h>
+#import "GPUImageSphericalProjection.h"
+
+static const CGFloat kProjectionAccuracy = 1e-5;
+
+#define GPUImageAssertDirection(direction, x, y, z) \
+  XCTAssertEqualWithAccuracy((direction).one, (x), kProjectionAccuracy); \
+  XCTAssertEqualWithAccuracy((direction).two, (y), kProjectionAccuracy); \
+  XCTAssertEqualWithAccuracy((direction).three, (z), kProjectionAccuracy)
+
+@interface GPUImageSphericalProjectionTests : XCTestCase
+@end
+
+@implementation GPUImageSphericalProjectionTests
+
+#pragma mark - Equirectangular
+
+- (void)testEquirectangularPointsAtKnownAngles {
+  GPUImageAssertDirection(GPUImageSphericalDirectionForEquirectangularPoint(CGPointMake(0.5, 0.5)), 0.0, 0.0, 1.0);
+  GPUImageAssertDirection(GPUImageSphericalDirectionForEquirectangularPoint(CGPointMake(0.75, 0.5)), 1.0, 0.0, 0.0);
+  GPUImageAssertDirection(GPUImageSphericalDirectionForEquirectangularPoint(CGPointMake(0.25, 0.5)), -1.0, 0.0, 0.0);
+  GPUImageAssertDirection(GPUImageSphericalDirectionForEquirectangularPoint(CGPointMake(0.0, 0.5)), 0.0, 0.0, -1.0);
+  GPUImageAssertDirection(GPUImageSphericalDirectionForEquirectangularPoint(CGPointMake(0.5, 0.0)), 0.0, 1.0, 0.0);
+  GPUImageAssertDirection(GPUImageSphericalDirectionForEquirectangularPoint(CGPointMake(0.5, 1.0)), 0.0, -1.0, 0.0);
+
+  // 45 degrees up, straight ahead
+  GPUImageAssertDirection(GPUImageSphericalDirectionForEquirectangularPoint(CGPointMake(0.5, 0.25)), 0.0, M_SQRT1_2, M_SQRT1_2);
+}
+
+- (void)testEquirectangularRoundTrip {
+  for (NSUInteger row = 1; row < 16; row++) {
+    for (NSUInteger column = 1; column < 32; column++) {
+      CGPoint point = CGPointMake(column / 32.0, row / 16.0);
+      CGPoint roundTrip = GPUImageEquirectangularPointForSphericalDirection(GPUImageSphericalDirectionForEquirectangularPoint(point));
+      XCTAssertEqualWithAccuracy(roundTrip.x, point.x, kProjectionAccuracy);
+      XCTAssertEqualWithAccuracy(roundTrip.y, point.y, kProjectionAccuracy);
+    }
+  }
+}
+
+#pragma mark - Cube faces
+
+- (void)testCubeFaceCentersPointAlongTheirAxis {
+  CGPoint center = CGPointMake(0.5, 0.5);
+  GPUImageAssertDirection(GPUImageSphericalDirectionForCubeFacePoint(kGPUImageCubeFacePositiveX, center), 1.0, 0.0, 0.0);
+  GPUImageAssertDirection(GPUImageSphericalDirectionForCubeFacePoint(kGPUImageCubeFaceNegativeX, center), -1.0, 0.0, 0.0);
+  GPUImageAssertDirection(GPUImageSphericalDirectionForCubeFacePoint(kGPUImageCubeFacePositiveY, center), 0.0, 1.0, 0.0);
+  GPUImageAssertDirection(GPUImageSphericalDirectionForCubeFacePoint(kGPUImageCubeFaceNegativeY, center), 0.0, -1.0, 0.0);
+  GPUImageAssertDirection(GPUImageSphericalDirectionForCubeFacePoint(kGPUImageCubeFacePositiveZ, center), 0.0, 0.0, 1.0);
+  GPUImageAssertDirection(GPUImageSphericalDirectionForCubeFacePoint(kGPUImageCubeFaceNegativeZ, center), 0.0, 0.0, -1.0);
+}
+
+- (void)testCubeFaceEdgeIsFortyFiveDegreesOff {
+  // The right edge of the front face, 45 degrees right on the horizon
+  GPUVector3 direction = GPUImageSphericalDirectionForCubeFacePoint(kGPUImageCubeFacePositiveZ, CGPointMake(1.0, 0.5));
+  GPUImageAssertDirection(direction, M_SQRT1_2, 0.0, M_SQRT1_2);
+
+  CGPoint equirectangularPoint = GPUImageEquirectangularPointForSphericalDirection(direction);
+  XCTAssertEqualWithAccuracy(equirectangularPoint.x, 0.625, kProjectionAccuracy);
+  XCTAssertEqualWithAccuracy(equirectangularPoint.y, 0.5, kProjectionAccuracy);
+}
+
+- (void)testCubeFaceRoundTrip {
+  for (GPUImageCubeFace face = kGPUImageCubeFacePositiveX; face <= kGPUImageCubeFaceNegativeZ; face++) {
+    for (NSUInteger row = 1; row < 8; row++) {
+      for (NSUInteger column = 1; column < 8; column++) {
+        CGPoint point = CGPointMake(column / 8.0, row / 8.0);
+        GPUImageCubeFace roundTripFace;
+        CGPoint roundTrip = GPUImageCubeFacePointForSphericalDirection(GPUImageSphericalDirectionForCubeFacePoint(face, point), &roundTripFace);
+        XCTAssertEqual(roundTripFace, face);
+        XCTAssertEqualWithAccuracy(roundTrip.x, point.x, kProjectionAccuracy);
+        XCTAssertEqualWithAccuracy(roundTrip.y, point.y, kProjectionAccuracy);
+      }
+    }
+  }
+}
+
+- (void)testCubeAtlasLayout {
+  CGRect front = GPUImageCubeAtlasRectForFace(kGPUImageCubeFacePositiveZ);
+  XCTAssertEqualWithAccuracy(CGRectGetMinX(front), 1.0 / 3.0, kProjectionAccuracy);
+  XCTAssertEqualWithAccuracy(CGRectGetMinY(front), 0.5, kProjectionAccuracy);
+  XCTAssertEqualWithAccuracy(CGRectGetWidth(front), 1.0 / 3.0, kProjectionAccuracy);
+  XCTAssertEqualWithAccuracy(CGRectGetHeight(front), 0.5, kProjectionAccuracy);
+
+  CGRect right = GPUImageCubeAtlasRectForFace(kGPUImageCubeFacePositiveX);
+  XCTAssertEqualWithAccuracy(CGRectGetMinX(right), 0.0, kProjectionAccuracy);
+  XCTAssertEqualWithAccuracy(CGRectGetMinY(right), 0.0, kProjectionAccuracy);
+}
+
+#pragma mark - View rotation
+
+- (void)testViewRotationsAtRightAngles {
+  GPUVector3 ahead = {0.0, 0.0, 1.0};
+  GPUVector3 up = {0.0, 1.0, 0.0};
+
+  GPUImageAssertDirection(GPUImageRotateSphericalDirection(GPUImageSphericalRotation(M_PI_2, 0.0, 0.0), ahead), 1.0, 0.0, 0.0);
+  GPUImageAssertDirection(GPUImageRotateSphericalDirection(GPUImageSphericalRotation(0.0, M_PI_2, 0.0), ahead), 0.0, 1.0, 0.0);
+  GPUImageAssertDirection(GPUImageRotateSphericalDirection(GPUImageSphericalRotation(0.0, 0.0, M_PI_2), up), 1.0, 0.0, 0.0);
+  GPUImageAssertDirection(GPUImageRotateSphericalDirection(GPUImageSphericalRotation(M_PI, 0.0, 0.0), ahead), 0.0, 0.0, -1.0);
+}
+
+- (void)testViewRotationKeepsDirectionsOnTheSphere {
+  GPUMatrix3x3 rotation = GPUImageSphericalRotation(0.3, -0.7, 1.1);
+  for (NSUInteger row = 1; row < 8; row++) {
+    for (NSUInteger column = 0; column < 16; column++) {
+      GPUVector3 direction = GPUImageRotateSphericalDirection(rotation, GPUImageSphericalDirectionForEquirectangularPoint(CGPointMake(column / 16.0, row / 8.0)));
+      GLfloat length = sqrt(direction.one * direction.one + direction.two * direction.two + direction.three * direction.three);
+      XCTAssertEqualWithAccuracy(length, 1.0, kProjectionAccuracy);
+    }
+  }
+}
+
+@end
@@ -0,0 +1,270 @@
+#import <XCTest/XCTest.h>
+#import "GPUImageTileScheduler.h"
+
+/** In-memory pyramid of 1000x600 pixels in 256 pixel tiles: 4x3 tiles at level 0, 2x2 at level 1, one at level 2
+
+ Records the order tiles are read in, and can fail or hold back reads.
+ */
+@interface GPUImageTestTileStore : NSObject <GPUImageTileStore>
+
+@property (nonatomic, assign, readonly) CGSize imageSize;
+@property (nonatomic, assign, readonly) NSUInteger tileSize;
+@property (nonatomic, assign, readonly) NSUInteger numberOfLevels;
+
+@property (nonatomic, assign) BOOL failsReads;
+
+/// Reads wait for the semaphore when set
+@property (nonatomic, strong) dispatch_semaphore_t readSemaphore;
+
+- (NSArray *)readKeys;
+
+@end
+
+@implementation GPUImageTestTileStore
+{
+  NSMutableArray *readKeys;
+}
+
+- (id)init {
+  if ((self = [super init])) {
+    _imageSize = CGSizeMake(1000.0, 600.0);
+    _tileSize = 256;
+    _numberOfLevels = 3;
+    readKeys = [NSMutableArray array];
+  }
+  return self;
+}
+
+- (NSArray *)readKeys {
+  @synchronized(self) {
+    return [readKeys copy];
+  }
+}
+
+- (NSData *)tileDataForKey:(GPUImageTileKey)key {
+  if (self.readSemaphore != NULL) {
+    dispatch_semaphore_wait(self.readSemaphore, DISPATCH_TIME_FOREVER);
+  }
+  @synchronized(self) {
+    [readKeys addObject:@(key)];
+  }
+  return self.failsReads ? nil : [NSMutableData dataWithLength:self.tileSize * self.tileSize * 4];
+}
+
+@end
+
+@interface GPUImageTileSchedulerTests : XCTestCase
+
+@property (nonatomic, strong) GPUImageTestTileStore *store;
+@property (nonatomic, strong) GPUImageTileCache *cache;
+@property (nonatomic, strong) GPUImageTileScheduler *scheduler;
+
+@end
+
+@implementation GPUImageTileSchedulerTests
+
+// Callbacks go to the main queue, so the tests run the scheduler on the main thread and spin its run loop while waiting
+- (void)setUp {
+  [super setUp];
+  self.store = [[GPUImageTestTileStore alloc] init];
+  self.cache = [[GPUImageTileCache alloc] initWithCapacity:64];
+  self.scheduler = [[GPUImageTileScheduler alloc] initWithStore:self.store cache:self.cache callbackQueue:dispatch_get_main_queue()];
+  self.scheduler.tileUploadBlock = ^id(GPUImageTileKey key, NSData *data) {
+    return data;
+  };
+}
+
+- (void)waitForPendingLoads {
+  NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:5.0];
+  while (self.scheduler.pendingLoadCount > 0 && [timeout timeIntervalSinceNow] > 0.0) {
+    [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+  }
+  XCTAssertEqual(self.scheduler.pendingLoadCount, (NSUInteger)0, @"Tile loads didn't finish");
+}
+
+#pragma mark - Keys and levels
+
+- (void)testTileKeysRoundTrip {
+  GPUImageTileKey key = GPUImageTileKeyMake(7, 123456, 654321);
+  XCTAssertEqual(GPUImageTileKeyLevel(key), (NSUInteger)7);
+  XCTAssertEqual(GPUImageTileKeyColumn(key), (NSUInteger)123456);
+  XCTAssertEqual(GPUImageTileKeyRow(key), (NSUInteger)654321);
+  XCTAssertNotEqual(GPUImageTileKeyMake(0, 1, 0), GPUImageTileKeyMake(0, 0, 1));
+}
+
+- (void)testLevelSizesRoundUp {
+  CGSize levelSize = GPUImageTileLevelSize(CGSizeMake(1001.0, 601.0), 1);
+  XCTAssertEqual(levelSize.width, (CGFloat)501.0);
+  XCTAssertEqual(levelSize.height, (CGFloat)301.0);
+
+  CGSize smallestSize = GPUImageTileLevelSize(CGSizeMake(1000.0, 600.0), 12);
+  XCTAssertEqual(smallestSize.width, (CGFloat)1.0);
+  XCTAssertEqual(smallestSize.height, (CGFloat)1.0);
+}
+
+#pragma mark - Cache
+
+- (void)testCacheEvictsLeastRecentlyUsedTile {
+  GPUImageTileCache *cache = [[GPUImageTileCache alloc] initWithCapacity:2];
+  NSMutableArray *evictedTiles = [NSMutableArray array];
+  cache.evictionBlock = ^(GPUImageTileKey key, id tile) {
+    [evictedTiles addObject:tile];
+  };
+
+  [cache setTile:@"a" forKey:1];
+  [cache setTile:@"b" forKey:2];
+  XCTAssertEqualObjects([cache tileForKey:1], @"a");
+  [cache setTile:@"c" forKey:3];
+
+  XCTAssertEqualObjects(evictedTiles, (@[@"b"]));
+  XCTAssertEqual(cache.evictionCount, (NSUInteger)1);
+  XCTAssertEqual(cache.count, (NSUInteger)2);
+  XCTAssertTrue([cache containsTileForKey:1]);
+  XCTAssertFalse([cache containsTileForKey:2]);
+}
+
+- (void)testContainsDoesNotCountAsUse {
+  GPUImageTileCache *cache = [[GPUImageTileCache alloc] initWithCapacity:2];
+  [cache setTile:@"a" forKey:1];
+  [cache setTile:@"b" forKey:2];
+  XCTAssertTrue([cache containsTileForKey:1]);
+  [cache setTile:@"c" forKey:3];
+
+  XCTAssertFalse([cache containsTileForKey:1]);
+  XCTAssertTrue([cache containsTileForKey:2]);
+}
+
+- (void)testReplacingATileReleasesTheOldOneWithoutEviction {
+  GPUImageTileCache *cache = [[GPUImageTileCache alloc] initWithCapacity:2];
+  NSMutableArray *releasedTiles = [NSMutableArray array];
+  cache.evictionBlock = ^(GPUImageTileKey key, id tile) {
+    [releasedTiles addObject:tile];
+  };
+
+  [cache setTile:@"a" forKey:1];
+  [cache setTile:@"b" forKey:2];
+  [cache setTile:@"a2" forKey:1];
+  XCTAssertEqualObjects(releasedTiles, (@[@"a"]));
+  XCTAssertEqual(cache.evictionCount, (NSUInteger)0);
+  XCTAssertEqual(cache.count, (NSUInteger)2);
+
+  [cache removeAllTiles];
+  XCTAssertEqual(cache.count, (NSUInteger)0);
+  XCTAssertEqual([releasedTiles count], (NSUInteger)3);
+}
+
+#pragma mark - Geometry
+
+- (void)testLevelMatchesTheZoom {
+  CGRect wholeImage = CGRectMake(0.0, 0.0, 1.0, 1.0);
+  XCTAssertEqual([self.scheduler levelForRegion:wholeImage outputSize:CGSizeMake(1000.0, 600.0)], (NSUInteger)0);
+  XCTAssertEqual([self.scheduler levelForRegion:wholeImage outputSize:CGSizeMake(500.0, 300.0)], (NSUInteger)1);
+  XCTAssertEqual([self.scheduler levelForRegion:wholeImage outputSize:CGSizeMake(300.0, 200.0)], (NSUInteger)1);
+  XCTAssertEqual([self.scheduler levelForRegion:wholeImage outputSize:CGSizeMake(10.0, 10.0)], (NSUInteger)2);
+
+  // Zoomed in on a quarter, shown at half size
+  XCTAssertEqual([self.scheduler levelForRegion:CGRectMake(0.0, 0.0, 0.5, 0.5) outputSize:CGSizeMake(500.0, 300.0)], (NSUInteger)0);
+}
+
+- (void)testKeysCoverTheRegion {
+  XCTAssertEqual([[self.scheduler keysOfTilesAtLevel:0 inRegion:CGRectMake(0.0, 0.0, 1.0, 1.0)] count], (NSUInteger)12);
+  XCTAssertEqual([[self.scheduler keysOfTilesAtLevel:1 inRegion:CGRectMake(0.0, 0.0, 1.0, 1.0)] count], (NSUInteger)4);
+  XCTAssertEqual([[self.scheduler keysOfTilesAtLevel:2 inRegion:CGRectMake(0.0, 0.0, 1.0, 1.0)] count], (NSUInteger)1);
+
+  NSArray *keys = [self.scheduler keysOfTilesAtLevel:0 inRegion:CGRectMake(0.3, 0.5, 0.3, 0.1)];
+  XCTAssertEqualObjects(keys, (@[@(GPUImageTileKeyMake(0, 1, 1)), @(GPUImageTileKeyMake(0, 2, 1))]));
+}
+
+- (void)testEdgeTilesOnlyPartlyCoverTheirTexture {
+  GPUImageTileKey corner = GPUImageTileKeyMake(0, 3, 2);
+  CGRect region = [self.scheduler regionOfTile:corner];
+  XCTAssertEqualWithAccuracy(CGRectGetMinX(region), 0.768, 1e-6);
+  XCTAssertEqualWithAccuracy(CGRectGetMaxX(region), 1.0, 1e-6);
+  XCTAssertEqualWithAccuracy(CGRectGetMaxY(region), 1.0, 1e-6);
+
+  CGRect textureRegion = [self.scheduler textureRegionOfTile:corner];
+  XCTAssertEqualWithAccuracy(CGRectGetWidth(textureRegion), 232.0 / 256.0, 1e-6);
+  XCTAssertEqualWithAccuracy(CGRectGetHeight(textureRegion), 88.0 / 256.0, 1e-6);
+
+  CGRect innerTextureRegion = [self.scheduler textureRegionOfTile:GPUImageTileKeyMake(0, 1, 1)];
+  XCTAssertEqualWithAccuracy(CGRectGetWidth(innerTextureRegion), 1.0, 1e-6);
+}
+
+#pragma mark - Scheduling
+
+- (void)testCoarsestLevelLoadsFirstThenTilesClosestToTheCenter {
+  self.scheduler.maximumConcurrentLoads = 1;
+  CGRect wholeImage = CGRectMake(0.0, 0.0, 1.0, 1.0);
+  NSArray *drawnKeys = [self.scheduler tilesToDrawForRegion:wholeImage outputSize:CGSizeMake(1000.0, 600.0)];
+  XCTAssertEqual([drawnKeys count], (NSUInteger)0);
+  XCTAssertEqual(self.scheduler.pendingLoadCount, (NSUInteger)13);
+
+  [self waitForPendingLoads];
+  NSArray *readKeys = [self.store readKeys];
+  XCTAssertEqual([readKeys count], (NSUInteger)13);
+  XCTAssertEqualObjects(readKeys[0], @(GPUImageTileKeyMake(2, 0, 0)));
+  XCTAssertEqualObjects(readKeys[1], @(GPUImageTileKeyMake(0, 1, 1)));
+  XCTAssertEqual(self.scheduler.loadedTileCount, (NSUInteger)13);
+
+  // Everything is resident now, only the finest tiles are drawn and nothing is read again
+  drawnKeys = [self.scheduler tilesToDrawForRegion:wholeImage outputSize:CGSizeMake(1000.0, 600.0)];
+  XCTAssertEqual([drawnKeys count], (NSUInteger)12);
+  XCTAssertEqual(self.scheduler.pendingLoadCount, (NSUInteger)0);
+}
+
+- (void)testMissingTilesFallBackToResidentAncestors {
+  self.store.failsReads = YES;
+  [self.cache setTile:@"coarse" forKey:GPUImageTileKeyMake(2, 0, 0)];
+  [self.cache setTile:@"fine" forKey:GPUImageTileKeyMake(0, 0, 0)];
+
+  NSArray *drawnKeys = [self.scheduler tilesToDrawForRegion:CGRectMake(0.0, 0.0, 1.0, 1.0) outputSize:CGSizeMake(1000.0, 600.0)];
+  XCTAssertEqualObjects(drawnKeys, (@[@(GPUImageTileKeyMake(2, 0, 0)), @(GPUImageTileKeyMake(0, 0, 0))]));
+  [self waitForPendingLoads];
+}
+
+- (void)testFailedTilesAreNotReadAgain {
+  self.store.failsReads = YES;
+  CGRect region = CGRectMake(0.0, 0.0, 0.2, 0.2);
+  [self.scheduler tilesToDrawForRegion:region outputSize:CGSizeMake(200.0, 120.0)];
+  [self waitForPendingLoads];
+  NSUInteger readCount = [[self.store readKeys] count];
+  XCTAssertGreaterThan(readCount, (NSUInteger)0);
+
+  [self.scheduler tilesToDrawForRegion:region outputSize:CGSizeMake(200.0, 120.0)];
+  XCTAssertEqual(self.scheduler.pendingLoadCount, (NSUInteger)0);
+  XCTAssertEqual(self.scheduler.loadedTileCount, (NSUInteger)0);
+  XCTAssertEqual([[self.store readKeys] count], readCount);
+}
+
+- (void)testCancellingDropsRequestsThatHaventStarted {
+  self.scheduler.maximumConcurrentLoads = 1;
+  self.store.readSemaphore = dispatch_semaphore_create(0);
+
+  [self.scheduler tilesToDrawForRegion:CGRectMake(0.0, 0.0, 1.0, 1.0) outputSize:CGSizeMake(1000.0, 600.0)];
+  XCTAssertEqual(self.scheduler.pendingLoadCount, (NSUInteger)13);
+  [self.scheduler cancelPendingLoads];
+  XCTAssertEqual(self.scheduler.pendingLoadCount, (NSUInteger)1);
+
+  dispatch_semaphore_signal(self.store.readSemaphore);
+  [self waitForPendingLoads];
+  XCTAssertEqualObjects([self.store readKeys], (@[@(GPUImageTileKeyMake(2, 0, 0))]));
+  XCTAssertTrue([self.cache containsTileForKey:GPUImageTileKeyMake(2, 0, 0)]);
+}
+
+- (void)testNewViewsReplaceQueuedRequests {
+  self.scheduler.maximumConcurrentLoads = 1;
+  self.store.readSemaphore = dispatch_semaphore_create(0);
+
+  // The first view's coarse tile starts loading, then the view moves into the lower right tile
+  [self.scheduler tilesToDrawForRegion:CGRectMake(0.0, 0.0, 0.25, 0.25) outputSize:CGSizeMake(250.0, 150.0)];
+  [self.scheduler tilesToDrawForRegion:CGRectMake(0.8, 0.9, 0.2, 0.1) outputSize:CGSizeMake(200.0, 60.0)];
+  XCTAssertEqual(self.scheduler.pendingLoadCount, (NSUInteger)2);
+
+  for (NSUInteger read = 0; read < 2; read++) {
+    dispatch_semaphore_signal(self.store.readSemaphore);
+  }
+  [self waitForPendingLoads];
+  XCTAssertEqualObjects([self.store readKeys], (@[@(GPUImageTileKeyMake(2, 0, 0)), @(GPUImageTileKeyMake(0, 3, 2))]));
+}
+
+@end
@@ -0,0 +1,228 @@
+#import <XCTest/XCTest.h>
+#import "GPUImageTiledImageWriter.h"
+
+// Every pixel is distinct enough to catch swapped rows, columns or tiles
+static void tiledImageTestPixel(NSUInteger x, NSUInteger y, uint8_t *pixel) {
+  pixel[0] = (uint8_t)x;
+  pixel[1] = (uint8_t)y;
+  pixel[2] = (uint8_t)(7 * x + 3 * y);
+  pixel[3] = 255;
+}
+
+@interface GPUImageTiledImageFileTests : XCTestCase
+
+@property (nonatomic, copy) NSString *path;
+
+@end
+
+@implementation GPUImageTiledImageFileTests
+
+- (void)setUp {
+  [super setUp];
+  self.path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+}
+
+- (void)tearDown {
+  [[NSFileManager defaultManager] removeItemAtPath:self.path error:NULL];
+  [super tearDown];
+}
+
+- (GPUImageTiledImageFile *)writeTestImageOfSize:(CGSize)imageSize tileSize:(NSUInteger)tileSize {
+  NSUInteger width = (NSUInteger)imageSize.width, height = (NSUInteger)imageSize.height;
+  NSMutableData *imageData = [NSMutableData dataWithLength:width * height * 4];
+  uint8_t *bytes = [imageData mutableBytes];
+  for (NSUInteger y = 0; y < height; y++) {
+    for (NSUInteger x = 0; x < width; x++) {
+      tiledImageTestPixel(x, y, bytes + (y * width + x) * 4);
+    }
+  }
+
+  NSError *error = nil;
+  GPUImageTiledImageWriter *writer = [[GPUImageTiledImageWriter alloc] initWithPath:self.path imageSize:imageSize tileSize:tileSize error:&error];
+  XCTAssertNotNil(writer, @"%@", error);
+  [writer writeImageBytes:bytes bytesPerRow:width * 4];
+  XCTAssertTrue([writer finishWritingWithError:&error], @"%@", error);
+
+  GPUImageTiledImageFile *file = [[GPUImageTiledImageFile alloc] initWithPath:self.path error:&error];
+  XCTAssertNotNil(file, @"%@", error);
+  return file;
+}
+
+#pragma mark - Round trip
+
+- (void)testFullResolutionTilesRoundTrip {
+  GPUImageTiledImageFile *file = [self writeTestImageOfSize:CGSizeMake(300.0, 200.0) tileSize:64];
+  XCTAssertEqual(file.imageSize.width, (CGFloat)300.0);
+  XCTAssertEqual(file.imageSize.height, (CGFloat)200.0);
+  XCTAssertEqual(file.tileSize, (NSUInteger)64);
+  XCTAssertEqual(file.numberOfLevels, (NSUInteger)4);
+
+  // Pixels past the right and bottom edges repeat the last column and row
+  uint8_t expected[4];
+  for (NSUInteger row = 0; row < 4; row++) {
+    for (NSUInteger column = 0; column < 5; column++) {
+      NSData *tile = [file tileDataForKey:GPUImageTileKeyMake(0, column, row)];
+      XCTAssertEqual([tile length], (NSUInteger)(64 * 64 * 4));
+      const uint8_t *tileBytes = [tile bytes];
+      for (NSUInteger y = 0; y < 64; y++) {
+        for (NSUInteger x = 0; x < 64; x++) {
+          tiledImageTestPixel(MIN(column * 64 + x, 299), MIN(row * 64 + y, 199), expected);
+          if (memcmp(tileBytes + (y * 64 + x) * 4, expected, 4) != 0) {
+            XCTFail(@"Pixel %lu, %lu of tile %lu, %lu differs", (unsigned long)x, (unsigned long)y, (unsigned long)column, (unsigned long)row);
+            return;
+          }
+        }
+      }
+    }
+  }
+}
+
+- (void)testCoarserLevelsAverageTwoByTwoBlocks {
+  GPUImageTiledImageFile *file = [self writeTestImageOfSize:CGSizeMake(300.0, 200.0) tileSize:64];
+
+  // Level 1 is 150x100
+  for (NSUInteger row = 0; row < 2; row++) {
+    for (NSUInteger column = 0; column < 3; column++) {
+      const uint8_t *tileBytes = [[file tileDataForKey:GPUImageTileKeyMake(1, column, row)] bytes];
+      XCTAssertTrue(tileBytes != NULL);
+      for (NSUInteger y = 0; y < 64 && row * 64 + y < 100; y++) {
+        for (NSUInteger x = 0; x < 64 && column * 64 + x < 150; x++) {
+          NSUInteger levelX = column * 64 + x, levelY = row * 64 + y;
+          uint8_t block[4][4];
+          tiledImageTestPixel(2 * levelX, 2 * levelY, block[0]);
+          tiledImageTestPixel(2 * levelX + 1, 2 * levelY, block[1]);
+          tiledImageTestPixel(2 * levelX, 2 * levelY + 1, block[2]);
+          tiledImageTestPixel(2 * levelX + 1, 2 * levelY + 1, block[3]);
+          for (NSUInteger channel = 0; channel < 4; channel++) {
+            NSUInteger average = (block[0][channel] + block[1][channel] + block[2][channel] + block[3][channel] + 2) / 4;
+            if (tileBytes[(y * 64 + x) * 4 + channel] != average) {
+              XCTFail(@"Channel %lu of level 1 pixel %lu, %lu differs", (unsigned long)channel, (unsigned long)levelX, (unsigned long)levelY);
+              return;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // The coarsest level fits in one tile
+  XCTAssertNotNil([file tileDataForKey:GPUImageTileKeyMake(3, 0, 0)]);
+  XCTAssertNil([file tileDataForKey:GPUImageTileKeyMake(3, 1, 0)]);
+}
+
+- (void)testKeysOutsideThePyramidReturnNothing {
+  GPUImageTiledImageFile *file = [self writeTestImageOfSize:CGSizeMake(300.0, 200.0) tileSize:64];
+  XCTAssertNil([file tileDataForKey:GPUImageTileKeyMake(0, 5, 0)]);
+  XCTAssertNil([file tileDataForKey:GPUImageTileKeyMake(0, 0, 4)]);
+  XCTAssertNil([file tileDataForKey:GPUImageTileKeyMake(4, 0, 0)]);
+}
+
+- (void)testTilesStartOnPageBoundaries {
+  GPUImageTiledImageFile *file = [self writeTestImageOfSize:CGSizeMake(300.0, 200.0) tileSize:64];
+  NSData *fileData = [NSData dataWithContentsOfFile:self.path];
+  const uint8_t *fileBytes = [fileData bytes];
+  const uint8_t *tileBytes = [[file tileDataForKey:GPUImageTileKeyMake(0, 2, 1)] bytes];
+
+  // The tile points into the mapping, compare its position in the file through its contents
+  const GPUImageTiledImageHeader *header = (const GPUImageTiledImageHeader *)fileBytes;
+  const GPUImageTiledImageIndexEntry *index = (const GPUImageTiledImageIndexEntry *)(fileBytes + header->indexOffset);
+  GPUImageTiledImageIndexEntry entry = index[1 * 5 + 2];
+  XCTAssertEqual(entry.offset % kGPUImageTiledImageAlignment, (uint64_t)0);
+  XCTAssertEqual(header->dataOffset % kGPUImageTiledImageAlignment, (uint64_t)0);
+  XCTAssertEqual(memcmp(fileBytes + entry.offset, tileBytes, 64 * 64 * 4), 0);
+}
+
+#pragma mark - Writing
+
+- (void)testPartialFileOnlyAppearsWhenFinished {
+  NSFileManager *fileManager = [NSFileManager defaultManager];
+  GPUImageTiledImageWriter *writer = [[GPUImageTiledImageWriter alloc] initWithPath:self.path imageSize:CGSizeMake(100.0, 100.0) tileSize:64 error:NULL];
+  XCTAssertFalse([fileManager fileExistsAtPath:self.path]);
+
+  [writer cancelWriting];
+  XCTAssertFalse([fileManager fileExistsAtPath:self.path]);
+  XCTAssertFalse([fileManager fileExistsAtPath:[self.path stringByAppendingString:@".partial"]]);
+}
+
+- (void)testLevelCount {
+  XCTAssertEqual(GPUImageTiledImageNumberOfLevels(CGSizeMake(64.0, 64.0), 64), (NSUInteger)1);
+  XCTAssertEqual(GPUImageTiledImageNumberOfLevels(CGSizeMake(65.0, 10.0), 64), (NSUInteger)2);
+  XCTAssertEqual(GPUImageTiledImageNumberOfLevels(CGSizeMake(16384.0, 8192.0), 256), (NSUInteger)7);
+}
+
+#pragma mark - Invalid files
+
+- (void)testMissingFileFails {
+  NSError *error = nil;
+  XCTAssertNil([[GPUImageTiledImageFile alloc] initWithPath:self.path error:&error]);
+  XCTAssertEqualObjects(error.domain, NSPOSIXErrorDomain);
+  XCTAssertEqual(error.code, (NSInteger)ENOENT);
+}
+
+- (void)testCorruptFilesFail {
+  [self writeTestImageOfSize:CGSizeMake(300.0, 200.0) tileSize:64];
+  NSData *validData = [NSData dataWithContentsOfFile:self.path];
+
+  NSMutableData *wrongMagic = [validData mutableCopy];
+  ((uint8_t *)[wrongMagic mutableBytes])[0] = 'X';
+
+  NSMutableData *wrongLevels = [validData mutableCopy];
+  ((GPUImageTiledImageHeader *)[wrongLevels mutableBytes])->numberOfLevels = 9;
+
+  NSMutableData *truncatedIndex = [[validData subdataWithRange:NSMakeRange(0, sizeof(GPUImageTiledImageHeader) + 8)] mutableCopy];
+  NSData *truncatedHeader = [validData subdataWithRange:NSMakeRange(0, 10)];
+
+  for (NSData *corruptData in @[wrongMagic, wrongLevels, truncatedIndex, truncatedHeader]) {
+    XCTAssertTrue([corruptData writeToFile:self.path atomically:NO]);
+    NSError *error = nil;
+    XCTAssertNil([[GPUImageTiledImageFile alloc] initWithPath:self.path error:&error]);
+    XCTAssertEqual(error.code, (NSInteger)EINVAL);
+  }
+}
+
+- (void)testTruncatedTileDataIsNotServed {
+  [self writeTestImageOfSize:CGSizeMake(300.0, 200.0) tileSize:64];
+  NSData *validData = [NSData dataWithContentsOfFile:self.path];
+  const GPUImageTiledImageHeader *header = [validData bytes];
+  [[validData subdataWithRange:NSMakeRange(0, (NSUInteger)header->dataOffset + 100)] writeToFile:self.path atomically:NO];
+
+  GPUImageTiledImageFile *file = [[GPUImageTiledImageFile alloc] initWithPath:self.path error:NULL];
+  XCTAssertNotNil(file);
+  XCTAssertNil([file tileDataForKey:GPUImageTileKeyMake(0, 0, 0)]);
+}
+
+#pragma mark - Performance
+
+- (void)testPerformanceOfWritingAndReopening {
+  NSUInteger width = 2048, height = 1024;
+  NSMutableData *imageData = [NSMutableData dataWithLength:width * height * 4];
+  memset([imageData mutableBytes], 0x80, [imageData length]);
+
+  [self measureBlock:^{
+    GPUImageTiledImageWriter *writer = [[GPUImageTiledImageWriter alloc] initWithPath:self.path imageSize:CGSizeMake(width, height) tileSize:256 error:NULL];
+    [writer writeImageBytes:[imageData bytes] bytesPerRow:width * 4];
+    [writer finishWritingWithError:NULL];
+    XCTAssertNotNil([[GPUImageTiledImageFile alloc] initWithPath:self.path error:NULL]);
+  }];
+}
+
+- (void)testPerformanceOfRandomAccessReads {
+  GPUImageTiledImageFile *file = [self writeTestImageOfSize:CGSizeMake(4096.0, 2048.0) tileSize:256];
+
+  // Fixed pseudo-random walk over the 16x8 full resolution tiles, summing a byte of every page as an upload would touch them
+  [self measureBlock:^{
+    uint32_t state = 12345;
+    NSUInteger checksum = 0;
+    for (NSUInteger read = 0; read < 2000; read++) {
+      state = state * 1664525 + 1013904223;
+      NSData *tile = [file tileDataForKey:GPUImageTileKeyMake(0, (state >> 8) % 16, (state >> 16) % 8)];
+      const uint8_t *tileBytes = [tile bytes];
+      for (NSUInteger offset = 0; offset < [tile length]; offset += 4096) {
+        checksum += tileBytes[offset];
+      }
+    }
+    XCTAssertGreaterThan(checksum, (NSUInteger)0);
+  }];
+}
+
+@end
@@ -0,0 +1,152 @@
+#import <XCTest/XCTest.h>
+#import "GPUImageTiledMedianFilter.h"
+
+// A radius of 3 at the default quality gives 40 bins and tiles 5 pixels apart, so tile centers fall on pixels 2, 7, 12...
+static const NSUInteger kTestImageSize = 35;
+static const NSUInteger kTestRadius = 3;
+static const NSUInteger kTestTileStride = 5;
+static const NSUInteger kTestHistogramBins = 40;
+
+typedef uint8_t (^GPUImageTestGreyFunction)(NSUInteger x, NSUInteger y);
+
+static CGImageRef newGreyImage(GPUImageTestGreyFunction greyFunction) {
+  CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+  CGContextRef context = CGBitmapContextCreate(NULL, kTestImageSize, kTestImageSize, 8, kTestImageSize * 4, colorSpace, kCGImageAlphaPremultipliedLast);
+  uint8_t *bytes = CGBitmapContextGetData(context);
+  for (NSUInteger y = 0; y < kTestImageSize; y++) {
+    for (NSUInteger x = 0; x < kTestImageSize; x++) {
+      uint8_t *pixel = bytes + (y * kTestImageSize + x) * 4;
+      pixel[0] = pixel[1] = pixel[2] = greyFunction(x, y);
+      pixel[3] = 255;
+    }
+  }
+
+  CGImageRef image = CGBitmapContextCreateImage(context);
+  CGContextRelease(context);
+  CGColorSpaceRelease(colorSpace);
+  return image;
+}
+
+static NSData *greyValuesOfImage(CGImageRef image) {
+  NSMutableData *pixels = [NSMutableData dataWithLength:kTestImageSize * kTestImageSize * 4];
+  CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+  CGContextRef context = CGBitmapContextCreate([pixels mutableBytes], kTestImageSize, kTestImageSize, 8, kTestImageSize * 4, colorSpace, kCGImageAlphaPremultipliedLast);
+  CGContextDrawImage(context, CGRectMake(0.0, 0.0, kTestImageSize, kTestImageSize), image);
+  CGContextRelease(context);
+  CGColorSpaceRelease(colorSpace);
+
+  NSMutableData *greys = [NSMutableData dataWithLength:kTestImageSize * kTestImageSize];
+  const uint8_t *bytes = [pixels bytes];
+  uint8_t *grey = [greys mutableBytes];
+  for (NSUInteger pixel = 0; pixel < kTestImageSize * kTestImageSize; pixel++) {
+    grey[pixel] = bytes[pixel * 4];
+  }
+  return greys;
+}
+
+static int compareGreys(const void *a, const void *b) {
+  return (int)*(const uint8_t *)a - (int)*(const uint8_t *)b;
+}
+
+// The brute-force reference: sorts each window, clamping to the image edges the way the texture sampler does
+static uint8_t referenceMedian(const uint8_t *greys, NSInteger centerX, NSInteger centerY) {
+  const NSInteger radius = kTestRadius;
+  uint8_t window[(2 * kTestRadius + 1) * (2 * kTestRadius + 1)];
+  NSUInteger count = 0;
+  for (NSInteger y = centerY - radius; y <= centerY + radius; y++) {
+    for (NSInteger x = centerX - radius; x <= centerX + radius; x++) {
+      NSInteger clampedX = MIN(MAX(x, 0), (NSInteger)kTestImageSize - 1);
+      NSInteger clampedY = MIN(MAX(y, 0), (NSInteger)kTestImageSize - 1);
+      window[count++] = greys[clampedY * kTestImageSize + clampedX];
+    }
+  }
+  qsort(window, count, sizeof(uint8_t), compareGreys);
+  return window[count / 2];
+}
+
+@interface GPUImageTiledMedianFilterTests : XCTestCase
+
+@end
+
+@implementation GPUImageTiledMedianFilterTests
+
+- (NSData *)filteredGreysOfImage:(CGImageRef)image {
+  GPUImageTiledMedianFilter *filter = [[GPUImageTiledMedianFilter alloc] init];
+  filter.radius = kTestRadius;
+  filter.quality = 0.5;
+
+  CGImageRef filteredImage = [filter newCGImageByFilteringCGImage:image];
+  XCTAssertTrue(filteredImage != NULL);
+  NSData *greys = greyValuesOfImage(filteredImage);
+  CGImageRelease(filteredImage);
+  return greys;
+}
+
+// A noisy ramp, so that every window has a different median
+- (CGImageRef)newNoisyRamp {
+  uint32_t seed = 12345;
+  NSMutableData *noise = [NSMutableData dataWithLength:kTestImageSize * kTestImageSize];
+  uint8_t *noiseBytes = [noise mutableBytes];
+  for (NSUInteger pixel = 0; pixel < [noise length]; pixel++) {
+    seed = seed * 1664525 + 1013904223;
+    noiseBytes[pixel] = (uint8_t)((seed >> 24) % 48);
+  }
+
+  return newGreyImage(^uint8_t(NSUInteger x, NSUInteger y) {
+    return (uint8_t)(x * 4 + y * 2 + noiseBytes[y * kTestImageSize + x]);
+  });
+}
+
+- (void)testFlatImagesStayFlat {
+  CGImageRef image = newGreyImage(^uint8_t(NSUInteger x, NSUInteger y) {
+    return 128;
+  });
+  NSData *filtered = [self filteredGreysOfImage:image];
+  CGImageRelease(image);
+
+  // Every window is the same, so every pixel gets the exact median to within a bin
+  const uint8_t *greys = [filtered bytes];
+  for (NSUInteger pixel = 0; pixel < [filtered length]; pixel++) {
+    XCTAssertEqualWithAccuracy(greys[pixel] / 255.0, 128.0 / 255.0, 1.0 / kTestHistogramBins + 2.0 / 255.0, @"Pixel %lu", (unsigned long)pixel);
+  }
+}
+
+- (void)testTileCentersMatchTheReferenceMedian {
+  CGImageRef image = [self newNoisyRamp];
+  NSData *original = greyValuesOfImage(image);
+  NSData *filtered = [self filteredGreysOfImage:image];
+  CGImageRelease(image);
+
+  const uint8_t *originalGreys = [original bytes];
+  const uint8_t *filteredGreys = [filtered bytes];
+  for (NSUInteger y = kTestTileStride / 2; y < kTestImageSize; y += kTestTileStride) {
+    for (NSUInteger x = kTestTileStride / 2; x < kTestImageSize; x += kTestTileStride) {
+      uint8_t median = referenceMedian(originalGreys, x, y);
+      XCTAssertEqualWithAccuracy(filteredGreys[y * kTestImageSize + x] / 255.0, median / 255.0, 1.0 / kTestHistogramBins + 2.0 / 255.0, @"Tile center (%lu, %lu)", (unsigned long)x, (unsigned long)y);
+    }
+  }
+}
+
+- (void)testPixelsBetweenTileCentersStayCloseToTheReferenceMedian {
+  CGImageRef image = [self newNoisyRamp];
+  NSData *original = greyValuesOfImage(image);
+  NSData *filtered = [self filteredGreysOfImage:image];
+  CGImageRelease(image);
+
+  // Blending neighboring windows only approximates the median in between, but on a smooth ramp the error stays small
+  const uint8_t *originalGreys = [original bytes];
+  const uint8_t *filteredGreys = [filtered bytes];
+  double totalError = 0.0;
+  double maximumError = 0.0;
+  for (NSUInteger y = 0; y < kTestImageSize; y++) {
+    for (NSUInteger x = 0; x < kTestImageSize; x++) {
+      double error = fabs((double)filteredGreys[y * kTestImageSize + x] - (double)referenceMedian(originalGreys, x, y)) / 255.0;
+      totalError += error;
+      maximumError = MAX(maximumError, error);
+    }
+  }
+  XCTAssertLessThan(totalError / (kTestImageSize * kTestImageSize), 0.04);
+  XCTAssertLessThan(maximumError, 0.15);
+}
+
+@end
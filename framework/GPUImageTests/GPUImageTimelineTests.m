@@ -0,0 +1,276 @@
+#import <XCTest/XCTest.h>
+#import "GPUImageTimeline.h"
+#import "GPUImageOutput.h"
+
+static const GLfloat kCurveAccuracy = 1e-5;
+
+static CMTime timeAtSeconds(Float64 seconds) {
+  return CMTimeMakeWithSeconds(seconds, 600);
+}
+
+static GLfloat scalarAtSeconds(GPUImageKeyframeCurve *curve, Float64 seconds) {
+  GLfloat value;
+  [curve evaluateAtTime:timeAtSeconds(seconds) values:&value];
+  return value;
+}
+
+// One property of every type a timeline can drive, logging the intensities it was set to
+@interface GPUImageTimelineTestTarget : NSObject
+
+@property (nonatomic, assign) CGFloat intensity;
+@property (nonatomic, assign) NSInteger level;
+@property (nonatomic, assign) CGPoint center;
+@property (nonatomic, assign) CGSize size;
+@property (nonatomic, assign) GPUVector3 color;
+@property (nonatomic, assign) GPUVector4 tint;
+@property (nonatomic, strong) NSMutableArray *intensityLog;
+
+@end
+
+@implementation GPUImageTimelineTestTarget
+
+- (id)init {
+  if (!(self = [super init])) {
+    return nil;
+  }
+  _intensityLog = [NSMutableArray array];
+  return self;
+}
+
+- (void)setIntensity:(CGFloat)intensity {
+  _intensity = intensity;
+  [self.intensityLog addObject:@(intensity)];
+}
+
+@end
+
+@interface GPUImageTimelineTestOutput : GPUImageOutput
+
+@property (nonatomic, assign) CGFloat intensity;
+@property (nonatomic, assign) CGFloat radius;
+
+@end
+
+@implementation GPUImageTimelineTestOutput
+@end
+
+@interface GPUImageTimelineTests : XCTestCase
+@end
+
+@implementation GPUImageTimelineTests
+
+- (GPUImageKeyframeCurve *)rampWithInterpolation:(GPUImageKeyframeInterpolation)interpolation {
+  GPUImageKeyframeCurve *curve = [[GPUImageKeyframeCurve alloc] initWithNumberOfComponents:1];
+  [curve addKeyframeAtTime:timeAtSeconds(1.0) value:0.0 interpolation:interpolation];
+  [curve addKeyframeAtTime:timeAtSeconds(5.0) value:1.0 interpolation:interpolation];
+  return curve;
+}
+
+#pragma mark - Keyframe curves
+
+- (void)testCurveHoldsItsEndsAndZeroWhenEmpty {
+  GPUImageKeyframeCurve *curve = [[GPUImageKeyframeCurve alloc] initWithNumberOfComponents:1];
+  XCTAssertEqual(scalarAtSeconds(curve, 2.0), (GLfloat)0.0);
+
+  curve = [self rampWithInterpolation:kGPUImageKeyframeInterpolationLinear];
+  XCTAssertEqualWithAccuracy(scalarAtSeconds(curve, 0.0), 0.0, kCurveAccuracy);
+  XCTAssertEqualWithAccuracy(scalarAtSeconds(curve, 9.0), 1.0, kCurveAccuracy);
+
+  GLfloat value;
+  [curve evaluateAtTime:kCMTimeInvalid values:&value];
+  XCTAssertEqualWithAccuracy(value, 0.0, kCurveAccuracy);
+}
+
+- (void)testInterpolationModes {
+  XCTAssertEqualWithAccuracy(scalarAtSeconds([self rampWithInterpolation:kGPUImageKeyframeInterpolationHold], 4.9), 0.0, kCurveAccuracy);
+  XCTAssertEqualWithAccuracy(scalarAtSeconds([self rampWithInterpolation:kGPUImageKeyframeInterpolationLinear], 2.0), 0.25, kCurveAccuracy);
+
+  // Smoothstep: 0.25 eases to 0.15625, the middle stays in the middle
+  GPUImageKeyframeCurve *smooth = [self rampWithInterpolation:kGPUImageKeyframeInterpolationSmooth];
+  XCTAssertEqualWithAccuracy(scalarAtSeconds(smooth, 2.0), 0.15625, kCurveAccuracy);
+  XCTAssertEqualWithAccuracy(scalarAtSeconds(smooth, 3.0), 0.5, kCurveAccuracy);
+}
+
+- (void)testInterpolationOfAKeyframeAppliesUpToTheNextOne {
+  GPUImageKeyframeCurve *curve = [[GPUImageKeyframeCurve alloc] initWithNumberOfComponents:1];
+  [curve addKeyframeAtTime:timeAtSeconds(0.0) value:0.0 interpolation:kGPUImageKeyframeInterpolationHold];
+  [curve addKeyframeAtTime:timeAtSeconds(1.0) value:1.0 interpolation:kGPUImageKeyframeInterpolationLinear];
+  [curve addKeyframeAtTime:timeAtSeconds(2.0) value:3.0 interpolation:kGPUImageKeyframeInterpolationHold];
+
+  XCTAssertEqualWithAccuracy(scalarAtSeconds(curve, 0.5), 0.0, kCurveAccuracy);
+  XCTAssertEqualWithAccuracy(scalarAtSeconds(curve, 1.0), 1.0, kCurveAccuracy);
+  XCTAssertEqualWithAccuracy(scalarAtSeconds(curve, 1.5), 2.0, kCurveAccuracy);
+  XCTAssertEqualWithAccuracy(scalarAtSeconds(curve, 2.5), 3.0, kCurveAccuracy);
+}
+
+- (void)testKeyframesAreSortedAndReplacedByTime {
+  GPUImageKeyframeCurve *curve = [[GPUImageKeyframeCurve alloc] initWithNumberOfComponents:1];
+  [curve addKeyframeAtTime:timeAtSeconds(2.0) value:2.0 interpolation:kGPUImageKeyframeInterpolationLinear];
+  [curve addKeyframeAtTime:timeAtSeconds(0.0) value:0.0 interpolation:kGPUImageKeyframeInterpolationLinear];
+  [curve addKeyframeAtTime:timeAtSeconds(1.0) value:5.0 interpolation:kGPUImageKeyframeInterpolationLinear];
+  [curve addKeyframeAtTime:timeAtSeconds(1.0) value:1.0 interpolation:kGPUImageKeyframeInterpolationLinear];
+  XCTAssertEqual(curve.keyframeCount, (NSUInteger)3);
+  XCTAssertEqualWithAccuracy(scalarAtSeconds(curve, 0.5), 0.5, kCurveAccuracy);
+  XCTAssertEqualWithAccuracy(scalarAtSeconds(curve, 1.5), 1.5, kCurveAccuracy);
+
+  [curve removeAllKeyframes];
+  XCTAssertEqual(curve.keyframeCount, (NSUInteger)0);
+}
+
+- (void)testEveryComponentIsInterpolated {
+  GPUImageKeyframeCurve *curve = [[GPUImageKeyframeCurve alloc] initWithNumberOfComponents:4];
+  GLfloat first[4] = {0.0, 1.0, -2.0, 10.0};
+  GLfloat second[4] = {1.0, 1.0, 2.0, 20.0};
+  [curve addKeyframeAtTime:timeAtSeconds(0.0) values:first interpolation:kGPUImageKeyframeInterpolationLinear];
+  [curve addKeyframeAtTime:timeAtSeconds(2.0) values:second interpolation:kGPUImageKeyframeInterpolationLinear];
+
+  GLfloat values[4];
+  [curve evaluateAtTime:timeAtSeconds(0.5) values:values];
+  XCTAssertEqualWithAccuracy(values[0], 0.25, kCurveAccuracy);
+  XCTAssertEqualWithAccuracy(values[1], 1.0, kCurveAccuracy);
+  XCTAssertEqualWithAccuracy(values[2], -1.0, kCurveAccuracy);
+  XCTAssertEqualWithAccuracy(values[3], 12.5, kCurveAccuracy);
+}
+
+- (void)testSequentialAndRandomEvaluationAgree {
+  GPUImageKeyframeCurve *curve = [[GPUImageKeyframeCurve alloc] initWithNumberOfComponents:1];
+  for (NSUInteger keyframe = 0; keyframe < 50; keyframe++) {
+    [curve addKeyframeAtTime:timeAtSeconds(keyframe * 0.4) value:(GLfloat)((keyframe * 7) % 11) interpolation:(GPUImageKeyframeInterpolation)(keyframe % 3)];
+  }
+
+  // A fresh copy of the curve for every time has no segment hint to go by
+  GLfloat (^referenceValue)(Float64) = ^GLfloat(Float64 seconds) {
+    GPUImageKeyframeCurve *reference = [[GPUImageKeyframeCurve alloc] initWithNumberOfComponents:1];
+    for (NSUInteger keyframe = 0; keyframe < 50; keyframe++) {
+      [reference addKeyframeAtTime:timeAtSeconds(keyframe * 0.4) value:(GLfloat)((keyframe * 7) % 11) interpolation:(GPUImageKeyframeInterpolation)(keyframe % 3)];
+    }
+    return scalarAtSeconds(reference, seconds);
+  };
+
+  for (NSUInteger frame = 0; frame < 600; frame += 7) {
+    Float64 seconds = frame / 30.0;
+    XCTAssertEqual(scalarAtSeconds(curve, seconds), referenceValue(seconds), @"At %f s", seconds);
+  }
+
+  uint32_t state = 99;
+  for (NSUInteger sample = 0; sample < 200; sample++) {
+    state = state * 1664525 + 1013904223;
+    Float64 seconds = (state >> 8) / (Float64)(1 << 24) * 21.0 - 0.5;
+    XCTAssertEqual(scalarAtSeconds(curve, seconds), referenceValue(seconds), @"At %f s", seconds);
+  }
+}
+
+#pragma mark - Timelines
+
+- (void)testEveryPropertyTypeIsDriven {
+  GPUImageTimelineTestTarget *target = [[GPUImageTimelineTestTarget alloc] init];
+  GPUImageTimeline *timeline = [[GPUImageTimeline alloc] init];
+
+  GPUImageKeyframeCurve *level = [self rampWithInterpolation:kGPUImageKeyframeInterpolationLinear];
+  [level addKeyframeAtTime:timeAtSeconds(5.0) value:8.0 interpolation:kGPUImageKeyframeInterpolationLinear];
+  GPUImageKeyframeCurve *center = [[GPUImageKeyframeCurve alloc] initWithNumberOfComponents:2];
+  [center addKeyframeAtTime:timeAtSeconds(1.0) point:CGPointMake(0.0, 1.0) interpolation:kGPUImageKeyframeInterpolationLinear];
+  [center addKeyframeAtTime:timeAtSeconds(5.0) point:CGPointMake(1.0, 0.0) interpolation:kGPUImageKeyframeInterpolationLinear];
+  GPUImageKeyframeCurve *color = [[GPUImageKeyframeCurve alloc] initWithNumberOfComponents:3];
+  GLfloat colorValues[3] = {0.1, 0.2, 0.3};
+  [color addKeyframeAtTime:timeAtSeconds(0.0) values:colorValues interpolation:kGPUImageKeyframeInterpolationHold];
+  GPUImageKeyframeCurve *tint = [[GPUImageKeyframeCurve alloc] initWithNumberOfComponents:4];
+  GLfloat tintValues[4] = {0.4, 0.5, 0.6, 0.7};
+  [tint addKeyframeAtTime:timeAtSeconds(0.0) values:tintValues interpolation:kGPUImageKeyframeInterpolationHold];
+
+  [timeline bindCurve:[self rampWithInterpolation:kGPUImageKeyframeInterpolationLinear] toKey:@"intensity" ofObject:target];
+  [timeline bindCurve:level toKey:@"level" ofObject:target];
+  [timeline bindCurve:center toKey:@"center" ofObject:target];
+  [timeline bindCurve:center toKey:@"size" ofObject:target];
+  [timeline bindCurve:color toKey:@"color" ofObject:target];
+  [timeline bindCurve:tint toKey:@"tint" ofObject:target];
+  [timeline applyAtTime:timeAtSeconds(3.0)];
+
+  XCTAssertEqualWithAccuracy(target.intensity, 0.5, kCurveAccuracy);
+  XCTAssertEqual(target.level, (NSInteger)4);
+  XCTAssertEqualWithAccuracy(target.center.x, 0.5, kCurveAccuracy);
+  XCTAssertEqualWithAccuracy(target.size.height, 0.5, kCurveAccuracy);
+  XCTAssertEqualWithAccuracy(target.color.two, 0.2, kCurveAccuracy);
+  XCTAssertEqualWithAccuracy(target.tint.four, 0.7, kCurveAccuracy);
+  XCTAssertEqual(timeline.propertyUpdateCount, (NSUInteger)6);
+}
+
+- (void)testEachFrameTimeIsAppliedOnce {
+  GPUImageTimelineTestTarget *target = [[GPUImageTimelineTestTarget alloc] init];
+  GPUImageTimeline *timeline = [[GPUImageTimeline alloc] init];
+  GPUImageKeyframeCurve *curve = [self rampWithInterpolation:kGPUImageKeyframeInterpolationLinear];
+  [timeline bindCurve:curve toKey:@"intensity" ofObject:target];
+  XCTAssertFalse(CMTIME_IS_VALID(timeline.lastAppliedTime));
+
+  [timeline advanceToTime:timeAtSeconds(2.0)];
+  [curve addKeyframeAtTime:timeAtSeconds(2.0) value:0.9 interpolation:kGPUImageKeyframeInterpolationLinear];
+  [timeline advanceToTime:timeAtSeconds(2.0)];
+  XCTAssertEqual([target.intensityLog count], (NSUInteger)1);
+  XCTAssertEqualWithAccuracy(target.intensity, 0.25, kCurveAccuracy);
+
+  // Timestamps that aren't numeric don't move the timeline
+  [timeline advanceToTime:kCMTimeInvalid];
+  XCTAssertEqual(CMTimeCompare(timeline.lastAppliedTime, timeAtSeconds(2.0)), (int32_t)0);
+
+  [timeline applyAtTime:timeAtSeconds(2.0)];
+  XCTAssertEqualWithAccuracy(target.intensity, 0.9, kCurveAccuracy);
+  XCTAssertEqual([target.intensityLog count], (NSUInteger)2);
+}
+
+- (void)testUnchangedValuesAreNotSetAgain {
+  GPUImageTimelineTestTarget *target = [[GPUImageTimelineTestTarget alloc] init];
+  GPUImageTimeline *timeline = [[GPUImageTimeline alloc] init];
+  [timeline bindCurve:[self rampWithInterpolation:kGPUImageKeyframeInterpolationLinear] toKey:@"intensity" ofObject:target];
+
+  for (NSUInteger frame = 0; frame < 30; frame++) {
+    [timeline advanceToTime:timeAtSeconds(frame / 30.0)];
+  }
+  XCTAssertEqual([target.intensityLog count], (NSUInteger)1);
+  XCTAssertEqual(timeline.propertyUpdateCount, (NSUInteger)1);
+}
+
+- (void)testRenderingTheSameTimesGivesTheSameValues {
+  NSMutableArray *runs = [NSMutableArray array];
+  for (NSUInteger run = 0; run < 2; run++) {
+    GPUImageTimelineTestTarget *target = [[GPUImageTimelineTestTarget alloc] init];
+    GPUImageTimeline *timeline = [[GPUImageTimeline alloc] init];
+    [timeline bindCurve:[self rampWithInterpolation:kGPUImageKeyframeInterpolationSmooth] toKey:@"intensity" ofObject:target];
+
+    // A movie read at 24 fps, with some frames repeated as a slow reader would
+    for (NSUInteger frame = 0; frame < 150; frame++) {
+      [timeline advanceToTime:CMTimeMake(frame, 24)];
+      if (frame % 10 == 0) {
+        [timeline advanceToTime:CMTimeMake(frame, 24)];
+      }
+    }
+    [runs addObject:target.intensityLog];
+  }
+
+  XCTAssertEqualObjects(runs[0], runs[1]);
+  XCTAssertEqualObjects([runs[0] lastObject], @1.0);
+}
+
+- (void)testBindingsAttachTheTimelineToOutputs {
+  GPUImageTimelineTestOutput *output = [[GPUImageTimelineTestOutput alloc] init];
+  GPUImageTimeline *timeline = [[GPUImageTimeline alloc] init];
+  [timeline bindCurve:[self rampWithInterpolation:kGPUImageKeyframeInterpolationLinear] toKey:@"intensity" ofObject:output];
+  [timeline bindCurve:[self rampWithInterpolation:kGPUImageKeyframeInterpolationHold] toKey:@"radius" ofObject:output];
+  XCTAssertEqual(output.timeline, timeline);
+
+  // Binding a key again replaces its curve
+  [timeline bindCurve:[self rampWithInterpolation:kGPUImageKeyframeInterpolationHold] toKey:@"intensity" ofObject:output];
+  [timeline applyAtTime:timeAtSeconds(3.0)];
+  XCTAssertEqualWithAccuracy(output.intensity, 0.0, kCurveAccuracy);
+  XCTAssertEqual(timeline.propertyUpdateCount, (NSUInteger)2);
+
+  [timeline unbindKey:@"intensity" ofObject:output];
+  XCTAssertEqual(output.timeline, timeline);
+  [timeline unbindKey:@"radius" ofObject:output];
+  XCTAssertNil(output.timeline);
+
+  [timeline bindCurve:[self rampWithInterpolation:kGPUImageKeyframeInterpolationLinear] toKey:@"intensity" ofObject:output];
+  [timeline removeAllBindings];
+  XCTAssertNil(output.timeline);
+}
+
+@end
@@ -0,0 +1,105 @@
+#import <XCTest/XCTest.h>
+#import "GPUImageToneCurveFilter.h"
+
+// Output levels are in 0...255, the legacy path solves in double precision and the C solver in float
+static const GLfloat kTestLevelAccuracy = 0.01f;
+
+static NSArray *boxedPoints(const CGPoint *points, NSUInteger pointCount) {
+  NSMutableArray *boxed = [NSMutableArray arrayWithCapacity:pointCount];
+  for (NSUInteger point = 0; point < pointCount; point++) {
+    [boxed addObject:[NSValue valueWithCGPoint:points[point]]];
+  }
+  return boxed;
+}
+
+@interface GPUImageToneCurveFilterTests : XCTestCase
+
+@end
+
+@implementation GPUImageToneCurveFilterTests
+
+// Checks GPUImageSolveToneCurve() level by level against getPreparedSplineCurve:, whose entries are each level's offset from the diagonal
+- (void)assertSolvedCurveOfPoints:(const CGPoint *)points count:(NSUInteger)pointCount matchesPreparedSplineCurveOfFilter:(GPUImageToneCurveFilter *)filter {
+  GLfloat curve[256];
+  GPUImageSolveToneCurve(points, pointCount, curve);
+
+  NSArray *preparedCurve = [filter getPreparedSplineCurve:boxedPoints(points, pointCount)];
+  XCTAssertEqual([preparedCurve count], (NSUInteger)256);
+  for (NSUInteger level = 0; level < MIN([preparedCurve count], 256); level++) {
+    GLfloat preparedLevel = MIN(MAX(level + [preparedCurve[level] floatValue], 0.0f), 255.0f);
+    XCTAssertEqualWithAccuracy(curve[level], preparedLevel, kTestLevelAccuracy, @"Level %lu", (unsigned long)level);
+  }
+}
+
+- (void)testSolvedCurvesMatchThePreparedSplineCurve {
+  GPUImageToneCurveFilter *filter = [[GPUImageToneCurveFilter alloc] init];
+
+  CGPoint diagonal[3] = {{0.0, 0.0}, {128.0 / 255.0, 128.0 / 255.0}, {1.0, 1.0}};
+  [self assertSolvedCurveOfPoints:diagonal count:3 matchesPreparedSplineCurveOfFilter:filter];
+
+  CGPoint sCurve[5] = {{0.0, 0.0}, {64.0 / 255.0, 40.0 / 255.0}, {128.0 / 255.0, 128.0 / 255.0}, {192.0 / 255.0, 216.0 / 255.0}, {1.0, 1.0}};
+  [self assertSolvedCurveOfPoints:sCurve count:5 matchesPreparedSplineCurveOfFilter:filter];
+
+  // Steep enough that the spline overshoots and has to be clamped
+  CGPoint overshoot[4] = {{0.0, 0.0}, {32.0 / 255.0, 1.0}, {224.0 / 255.0, 0.0}, {1.0, 1.0}};
+  [self assertSolvedCurveOfPoints:overshoot count:4 matchesPreparedSplineCurveOfFilter:filter];
+
+  CGPoint inverted[2] = {{0.0, 1.0}, {1.0, 0.0}};
+  [self assertSolvedCurveOfPoints:inverted count:2 matchesPreparedSplineCurveOfFilter:filter];
+}
+
+- (void)testPointsAreSortedBeforeSolving {
+  // The legacy comparator never reports ascending order, so the solver's own sorting is checked against presorted points
+  CGPoint unsorted[5] = {{128.0 / 255.0, 100.0 / 255.0}, {1.0, 1.0}, {0.0, 0.0}, {192.0 / 255.0, 216.0 / 255.0}, {64.0 / 255.0, 40.0 / 255.0}};
+  CGPoint sorted[5] = {{0.0, 0.0}, {64.0 / 255.0, 40.0 / 255.0}, {128.0 / 255.0, 100.0 / 255.0}, {192.0 / 255.0, 216.0 / 255.0}, {1.0, 1.0}};
+  GLfloat curve[256];
+  GPUImageSolveToneCurve(unsorted, 5, curve);
+  GPUImageToneCurveFilter *filter = [[GPUImageToneCurveFilter alloc] init];
+  [self assertSolvedCurveOfPoints:sorted count:5 matchesPreparedSplineCurveOfFilter:filter];
+
+  GLfloat sortedCurve[256];
+  GPUImageSolveToneCurve(sorted, 5, sortedCurve);
+  for (NSUInteger level = 0; level < 256; level++) {
+    XCTAssertEqual(curve[level], sortedCurve[level], @"Level %lu", (unsigned long)level);
+  }
+}
+
+- (void)testCurvesNotSpanningTheFullRangeMatchTheSplineBetweenTheirEnds {
+  // getPreparedSplineCurve: pads such curves with an extra entry, so compare against the spline points themselves
+  GPUImageToneCurveFilter *filter = [[GPUImageToneCurveFilter alloc] init];
+  CGPoint points[3] = {{50.0 / 255.0, 20.0 / 255.0}, {120.0 / 255.0, 150.0 / 255.0}, {200.0 / 255.0, 230.0 / 255.0}};
+  GLfloat curve[256];
+  GPUImageSolveToneCurve(points, 3, curve);
+
+  NSMutableArray *levelPoints = [NSMutableArray arrayWithCapacity:3];
+  for (NSUInteger point = 0; point < 3; point++) {
+    [levelPoints addObject:[NSValue valueWithCGPoint:CGPointMake(points[point].x * 255.0, points[point].y * 255.0)]];
+  }
+  NSArray *splinePoints = [filter splineCurve:levelPoints];
+  XCTAssertEqual([splinePoints count], (NSUInteger)151);
+  for (NSValue *splinePoint in splinePoints) {
+    CGPoint point = [splinePoint CGPointValue];
+    XCTAssertEqualWithAccuracy(curve[(NSUInteger)point.x], point.y, kTestLevelAccuracy, @"Level %g", point.x);
+  }
+
+  // Black below the first point, white above the last
+  for (NSUInteger level = 0; level < 50; level++) {
+    XCTAssertEqual(curve[level], 0.0f, @"Level %lu", (unsigned long)level);
+  }
+  for (NSUInteger level = 201; level < 256; level++) {
+    XCTAssertEqual(curve[level], 255.0f, @"Level %lu", (unsigned long)level);
+  }
+}
+
+- (void)testRepeatedPointsAreSolvedOnce {
+  CGPoint points[4] = {{0.0, 0.0}, {0.5, 0.75}, {0.5, 0.75}, {1.0, 1.0}};
+  CGPoint uniquePoints[3] = {{0.0, 0.0}, {0.5, 0.75}, {1.0, 1.0}};
+  GLfloat curve[256], uniqueCurve[256];
+  GPUImageSolveToneCurve(points, 4, curve);
+  GPUImageSolveToneCurve(uniquePoints, 3, uniqueCurve);
+  for (NSUInteger level = 0; level < 256; level++) {
+    XCTAssertEqual(curve[level], uniqueCurve[level], @"Level %lu", (unsigned long)level);
+  }
+}
+
+@end
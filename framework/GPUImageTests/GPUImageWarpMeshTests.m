@@ -0,0 +1,146 @@
+#import <XCTest/XCTest.h>
+#import "GPUImageWarpMesh.h"
+
+static const GLfloat kMeshAccuracy = 1e-5;
+
+@interface GPUImageWarpMeshTests : XCTestCase
+@end
+
+@implementation GPUImageWarpMeshTests
+
+#pragma mark - Topology
+
+- (void)testGridHasOneVertexPerGridPointAndTwoTrianglesPerCell {
+  GPUImageWarpMesh *mesh = [[GPUImageWarpMesh alloc] initWithColumns:3 rows:2];
+  XCTAssertEqual(mesh.vertexCount, (NSUInteger)12);
+  XCTAssertEqual(mesh.indexCount, (NSUInteger)36);
+
+  // Row-major from the lower left corner, in normalized device coordinates
+  XCTAssertEqualWithAccuracy(mesh.vertices[0].x, -1.0, kMeshAccuracy);
+  XCTAssertEqualWithAccuracy(mesh.vertices[0].y, -1.0, kMeshAccuracy);
+  XCTAssertEqualWithAccuracy(mesh.vertices[1].x, -1.0 / 3.0, kMeshAccuracy);
+  XCTAssertEqualWithAccuracy(mesh.vertices[4].y, 0.0, kMeshAccuracy);
+  XCTAssertEqualWithAccuracy(mesh.vertices[11].x, 1.0, kMeshAccuracy);
+  XCTAssertEqualWithAccuracy(mesh.vertices[11].y, 1.0, kMeshAccuracy);
+}
+
+- (void)testTrianglesAreCounterClockwiseAndInRange {
+  for (NSNumber *wraps in @[@NO, @YES]) {
+    GPUImageWarpMesh *mesh = [[GPUImageWarpMesh alloc] initWithColumns:5 rows:4 wrapsHorizontally:[wraps boolValue]];
+    for (NSUInteger index = 0; index < mesh.indexCount; index += 3) {
+      XCTAssertLessThan(mesh.indices[index], mesh.vertexCount);
+      XCTAssertLessThan(mesh.indices[index + 1], mesh.vertexCount);
+      XCTAssertLessThan(mesh.indices[index + 2], mesh.vertexCount);
+
+      Vertex3D a = mesh.vertices[mesh.indices[index]], b = mesh.vertices[mesh.indices[index + 1]], c = mesh.vertices[mesh.indices[index + 2]];
+      GLfloat signedArea = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+      XCTAssertGreaterThan(signedArea, 0.0, @"Triangle %lu is clockwise or degenerate", (unsigned long)(index / 3));
+    }
+  }
+}
+
+- (void)testLargestMeshStaysAddressableWithShortIndices {
+  NSUInteger cells = [GPUImageWarpMesh maximumNumberOfCellsPerAxis];
+  GPUImageWarpMesh *mesh = [[GPUImageWarpMesh alloc] initWithColumns:cells rows:cells];
+  XCTAssertLessThanOrEqual(mesh.vertexCount, (NSUInteger)65536);
+  XCTAssertEqual(mesh.indices[mesh.indexCount - 1], (GLushort)(mesh.vertexCount - 1));
+
+  NSUInteger wrappingCells = [GPUImageWarpMesh maximumNumberOfCellsPerAxisWrappingHorizontally];
+  GPUImageWarpMesh *wrappingMesh = [[GPUImageWarpMesh alloc] initWithColumns:wrappingCells rows:wrappingCells wrapsHorizontally:YES];
+  XCTAssertLessThanOrEqual(wrappingMesh.vertexCount, (NSUInteger)65536);
+  XCTAssertEqual(wrappingMesh.indices[wrappingMesh.indexCount - 1], (GLushort)(wrappingMesh.vertexCount - 1));
+}
+
+#pragma mark - Texture coordinates
+
+- (void)testNewMeshReproducesTheInput {
+  GPUImageWarpMesh *mesh = [[GPUImageWarpMesh alloc] initWithColumns:4 rows:3];
+  for (NSUInteger vertex = 0; vertex < mesh.vertexCount; vertex++) {
+    XCTAssertEqualWithAccuracy(mesh.vertices[vertex].u, 0.5 * (mesh.vertices[vertex].x + 1.0), kMeshAccuracy);
+    XCTAssertEqualWithAccuracy(mesh.vertices[vertex].v, 0.5 * (mesh.vertices[vertex].y + 1.0), kMeshAccuracy);
+  }
+}
+
+- (void)testMappingIsEvaluatedOncePerGridPoint {
+  GPUImageWarpMesh *mesh = [[GPUImageWarpMesh alloc] initWithColumns:4 rows:3];
+  __block NSUInteger mappedCount = 0;
+  [mesh updateTextureCoordinatesWithMapping:^(const GLfloat *x, const GLfloat *y, GLfloat *u, GLfloat *v, NSUInteger count) {
+    mappedCount += count;
+    for (NSUInteger point = 0; point < count; point++) {
+      u[point] = 0.5 * x[point] + 0.25;
+      v[point] = 1.0 - y[point];
+    }
+  } rotation:kGPUImageNoRotation];
+
+  XCTAssertEqual(mappedCount, (NSUInteger)20);
+  for (NSUInteger vertex = 0; vertex < mesh.vertexCount; vertex++) {
+    GLfloat x = 0.5 * (mesh.vertices[vertex].x + 1.0), y = 0.5 * (mesh.vertices[vertex].y + 1.0);
+    XCTAssertEqualWithAccuracy(mesh.vertices[vertex].u, 0.5 * x + 0.25, kMeshAccuracy);
+    XCTAssertEqualWithAccuracy(mesh.vertices[vertex].v, 1.0 - y, kMeshAccuracy);
+  }
+}
+
+- (void)testRotationIsAppliedAfterTheMapping {
+  GPUImageWarpMesh *mesh = [[GPUImageWarpMesh alloc] initWithColumns:2 rows:2];
+  [mesh updateTextureCoordinatesWithMapping:nil rotation:kGPUImageRotateRight];
+  for (NSUInteger vertex = 0; vertex < mesh.vertexCount; vertex++) {
+    CGPoint expected = rotatedPoint(CGPointMake(0.5 * (mesh.vertices[vertex].x + 1.0), 0.5 * (mesh.vertices[vertex].y + 1.0)), kGPUImageRotateRight);
+    XCTAssertEqualWithAccuracy(mesh.vertices[vertex].u, expected.x, kMeshAccuracy);
+    XCTAssertEqualWithAccuracy(mesh.vertices[vertex].v, expected.y, kMeshAccuracy);
+  }
+}
+
+- (void)testWrappingCellsInterpolateTheShortWayAcrossTheSeam {
+  GPUImageWarpMesh *mesh = [[GPUImageWarpMesh alloc] initWithColumns:4 rows:1 wrapsHorizontally:YES];
+  XCTAssertEqual(mesh.vertexCount, (NSUInteger)16);
+
+  // Longitudes shifted so that the seam runs through the first cell
+  [mesh updateTextureCoordinatesWithMapping:^(const GLfloat *x, const GLfloat *y, GLfloat *u, GLfloat *v, NSUInteger count) {
+    for (NSUInteger point = 0; point < count; point++) {
+      u[point] = x[point] + 0.9 - floorf(x[point] + 0.9);
+      v[point] = y[point];
+    }
+  } rotation:kGPUImageNoRotation];
+
+  for (NSUInteger cell = 0; cell < 4; cell++) {
+    const Vertex3D *corners = mesh.vertices + 4 * cell;
+    XCTAssertEqualWithAccuracy(corners[1].u - corners[0].u, 0.25, kMeshAccuracy, @"Cell %lu", (unsigned long)cell);
+    XCTAssertEqualWithAccuracy(corners[3].u - corners[2].u, 0.25, kMeshAccuracy, @"Cell %lu", (unsigned long)cell);
+  }
+  XCTAssertEqualWithAccuracy(mesh.vertices[1].u, 1.15, kMeshAccuracy);
+}
+
+#pragma mark - Bounds
+
+- (void)testBoundsCoverEveryCellTouchingTheRegion {
+  GPUImageWarpMesh *mesh = [[GPUImageWarpMesh alloc] initWithColumns:4 rows:4];
+
+  CGRect aligned = [mesh textureCoordinateBoundsForRegion:CGRectMake(0.25, 0.25, 0.5, 0.5)];
+  XCTAssertEqualWithAccuracy(CGRectGetMinX(aligned), 0.25, kMeshAccuracy);
+  XCTAssertEqualWithAccuracy(CGRectGetMaxY(aligned), 0.75, kMeshAccuracy);
+
+  CGRect inside = [mesh textureCoordinateBoundsForRegion:CGRectMake(0.3, 0.3, 0.1, 0.1)];
+  XCTAssertEqualWithAccuracy(CGRectGetMinX(inside), 0.25, kMeshAccuracy);
+  XCTAssertEqualWithAccuracy(CGRectGetWidth(inside), 0.25, kMeshAccuracy);
+  XCTAssertEqualWithAccuracy(CGRectGetHeight(inside), 0.25, kMeshAccuracy);
+
+  XCTAssertTrue(CGRectIsNull([mesh textureCoordinateBoundsForRegion:CGRectMake(1.5, 0.0, 0.5, 1.0)]));
+}
+
+- (void)testBoundsFollowTheMapping {
+  GPUImageWarpMesh *mesh = [[GPUImageWarpMesh alloc] initWithColumns:4 rows:4];
+  [mesh updateTextureCoordinatesWithMapping:^(const GLfloat *x, const GLfloat *y, GLfloat *u, GLfloat *v, NSUInteger count) {
+    for (NSUInteger point = 0; point < count; point++) {
+      u[point] = 0.5 * x[point];
+      v[point] = 0.5 * y[point] + 0.5;
+    }
+  } rotation:kGPUImageNoRotation];
+
+  CGRect bounds = [mesh textureCoordinateBoundsForRegion:CGRectMake(0.0, 0.0, 0.5, 0.5)];
+  XCTAssertEqualWithAccuracy(CGRectGetMinX(bounds), 0.0, kMeshAccuracy);
+  XCTAssertEqualWithAccuracy(CGRectGetMaxX(bounds), 0.25, kMeshAccuracy);
+  XCTAssertEqualWithAccuracy(CGRectGetMinY(bounds), 0.5, kMeshAccuracy);
+  XCTAssertEqualWithAccuracy(CGRectGetMaxY(bounds), 0.75, kMeshAccuracy);
+}
+
+@end
@@ -155,4 +155,39 @@
 #import "GPUImageZoomBlurFilter.h"
 #import "GPUImageLaplacianFilter.h"
 #import "GPUImageiOSBlurFilter.h"
-#import "GPUImageLuminanceRangeFilter.h"
\ No newline at end of file
+#import "GPUImageLuminanceRangeFilter.h"
+#import "GPUImageBilateralGridFilter.h"
+#import "GPUImageTiledMedianFilter.h"
+#import "GPUImageSummedAreaTableFilter.h"
+#import "GPUImageSummedAreaTableWindowFilter.h"
+#import "GPUImageIntegralBoxBlurFilter.h"
+#import "GPUImageLocalStandardDeviationFilter.h"
+#import "GPUImageIntegralKuwaharaFilter.h"
+#import "GPUImageResamplingFilter.h"
+#import "GPUImageMultiInputFilter.h"
+#import "GPUImageMultiLayerBlendFilter.h"
+#import "GPUImageFrameSyncPolicy.h"
+#import "GPUImageWarpMesh.h"
+#import "GPUImageMeshWarpFilter.h"
+#import "GPUImageLensCorrectionFilter.h"
+#import "GPUImageSphericalProjection.h"
+#import "GPUImageEquirectangularProjectionFilter.h"
+#import "GPUImageCubeReprojectionFilter.h"
+#import "GPUImageTileStore.h"
+#import "GPUImageTileCache.h"
+#import "GPUImageTileScheduler.h"
+#import "GPUImageTiledPicture.h"
+#import "GPUImageTiledImageFile.h"
+#import "GPUImageTiledImageWriter.h"
+#import "GPUImageFramePacingController.h"
+#import "GPUImageDisplayCompositor.h"
+#import "GPUImageDualResolutionPipeline.h"
+#import "GPUImageBakedLookupFilter.h"
+#import "GPUImageCubeLookupTable.h"
+#import "GPUImageCubeLookupFilter.h"
+#import "GPUImageGraphExecutor.h"
+#import "GPUImageFrameSampler.h"
+#import "GPUImageGraphDescription.h"
+#import "GPUImageTimeline.h"
+#import "GPUImageAudioLane.h"
+#import "GPUImageBatchProcessor.h"
\ No newline at end of file
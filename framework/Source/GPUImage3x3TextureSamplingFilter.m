@@ -95,6 +95,16 @@ NSString *const kGPUImageNearbyTexelSamplingVertexShaderString = SHADER_STRING
     }
 }
 
+#pragma mark -
+#pragma mark Region of interest
+
+- (CGSize)samplingFootprint {
+    // The neighbours are a texel step away, which may be along either axis of the input once it is rotated
+    CGSize inputSize = [self getInputSize:0];
+    CGFloat step = ceil(MAX(_texelWidth * inputSize.width, _texelHeight * inputSize.height));
+    return CGSizeMake(step, step);
+}
+
 #pragma mark -
 #pragma mark Accessors
 
@@ -3,6 +3,8 @@
 #import "GPUImageTwoInputFilter.h"
 #import "GPUImageGrayscaleFilter.h"
 #import "GPUImageBoxBlurFilter.h"
+#import "GPUImageIntegralBoxBlurFilter.h"
+#import "GPUImageSummedAreaTableFilter.h"
 
 #if TARGET_IPHONE_SIMULATOR || TARGET_OS_IPHONE
 NSString *const kGPUImageAdaptiveThresholdFragmentShaderString = SHADER_STRING
@@ -45,6 +47,8 @@ NSString *const kGPUImageAdaptiveThresholdFragmentShaderString = SHADER_STRING
 @interface GPUImageAdaptiveThresholdFilter()
 {
     GPUImageBoxBlurFilter *boxBlurFilter;
+    GPUImageIntegralBoxBlurFilter *integralBoxBlurFilter;
+    GLfloat blurRadius;
 }
 @end
 
@@ -64,23 +68,37 @@ NSString *const kGPUImageAdaptiveThresholdFragmentShaderString = SHADER_STRING
     GPUImageGrayscaleFilter *luminanceFilter = [[GPUImageGrayscaleFilter alloc] init];
     [self addFilter:luminanceFilter];
     
-    // Second pass: perform a box blur
-    boxBlurFilter = [[GPUImageBoxBlurFilter alloc] init];
-    [self addFilter:boxBlurFilter];
+    // Second pass: perform a box blur, through a summed-area table where possible so that large radii cost the same as small ones
+    GPUImageOutput<GPUImageInput> *backgroundFilter;
+    if ([GPUImageSummedAreaTableFilter isSupported])
+    {
+        integralBoxBlurFilter = [[GPUImageIntegralBoxBlurFilter alloc] init];
+        backgroundFilter = integralBoxBlurFilter;
+    }
+    else
+    {
+        boxBlurFilter = [[GPUImageBoxBlurFilter alloc] init];
+        backgroundFilter = boxBlurFilter;
+    }
+    [self addFilter:backgroundFilter];
     
     // Third pass: compare the blurred background luminance to the local value
     GPUImageFilter *adaptiveThresholdFilter = [[GPUImageTwoInputFilter alloc] initWithFragmentShaderFromString:kGPUImageAdaptiveThresholdFragmentShaderString];
     [self addFilter:adaptiveThresholdFilter];
     
-    [luminanceFilter addTarget:boxBlurFilter];
+    [luminanceFilter addTarget:backgroundFilter];
     
-    [boxBlurFilter addTarget:adaptiveThresholdFilter];
+    [backgroundFilter addTarget:adaptiveThresholdFilter];
     // To prevent double updating of this filter, disable updates from the sharp luminance image side
     [luminanceFilter addTarget:adaptiveThresholdFilter];
     
     self.initialFilters = [NSArray arrayWithObject:luminanceFilter];
     self.terminalFilter = adaptiveThresholdFilter;
     
+    // Matches the window of the box blur's default shader
+    blurRadius = 4.0;
+    integralBoxBlurFilter.radius = 4;
+    
     return self;
 }
 
@@ -89,12 +107,14 @@ NSString *const kGPUImageAdaptiveThresholdFragmentShaderString = SHADER_STRING
 
 - (void)setBlurRadiusInPixels:(GLfloat)newValue;
 {
+    blurRadius = newValue;
     boxBlurFilter.blurRadiusInPixels = newValue;
+    integralBoxBlurFilter.radius = (NSUInteger)round(MAX(newValue, 0.0));
 }
 
 - (GLfloat)blurRadiusInPixels;
 {
-    return boxBlurFilter.blurRadiusInPixels;
+    return blurRadius;
 }
 
 @end
@@ -0,0 +1,92 @@
+#import <Foundation/Foundation.h>
+#import <AVFoundation/AVFoundation.h>
+
+/** A processing stage of GPUImageAudioLane, run on the lane's queue for every block of samples before it is appended
+ */
+@protocol GPUImageAudioProcessor <NSObject>
+
+/** Process a block of samples in place
+ @param samples Interleaved, frameCount * channelCount of them, nominally within [-1, 1]
+ */
+- (void)processSamples:(float *)samples frameCount:(NSUInteger)frameCount channelCount:(NSUInteger)channelCount sampleRate:(Float64)sampleRate;
+
+/// Forget the state carried from block to block, at the start of a recording
+- (void)reset;
+
+@end
+
+/// Scales every sample
+@interface GPUImageAudioGainProcessor : NSObject <GPUImageAudioProcessor>
+
+/// Linear, 1.0 by default
+@property (atomic, assign) float gain;
+
+@end
+
+/** Keeps peaks under a threshold, reducing the gain at once when a block would exceed it and recovering over the release time
+ */
+@interface GPUImageAudioLimiterProcessor : NSObject <GPUImageAudioProcessor>
+
+/// Linear peak level, 0.9 by default
+@property (atomic, assign) float threshold;
+
+/// Seconds for the gain to recover most of the way after a peak, 0.2 by default
+@property (atomic, assign) NSTimeInterval releaseTime;
+
+/// The gain applied to the last block, 1.0 when not limiting
+@property (atomic, assign, readonly) float currentGain;
+
+@end
+
+/** Carries audio from its producer to an AVAssetWriterInput on a queue of its own
+
+ Sample buffers are handed over through a single-producer single-consumer ring of fixed capacity, without locks on the producer's side, so a capture callback never waits on the video encoder. The lane's queue runs the processors and the sample callback on 16-bit linear PCM, then appends. Other formats are appended untouched.
+
+ Live, blocks arriving while the ring is full or while the writer input isn't ready are dropped and counted. Offline, with waitsForWriterInput set, the producer waits for room in the ring and the lane waits for the writer input instead.
+ */
+@interface GPUImageAudioLane : NSObject
+
+/// Run in order on every block of 16-bit PCM, converted to float for them. The channels of non-interleaved audio are interleaved into one block, so that each frame is processed as a whole
+@property (atomic, copy) NSArray *processors;
+
+/// Called after the processors with the samples in place, as -[GPUImageMovieWriter audioProcessingCallback] always was
+@property (atomic, copy) void(^sampleCallback)(SInt16 **samplesRef, CMItemCount numSamplesInBuffer);
+
+/// Wait instead of dropping, for offline writing. NO by default
+@property (atomic, assign) BOOL waitsForWriterInput;
+
+/// Invalidate sample buffers once appended or dropped
+@property (atomic, assign) BOOL invalidatesSampleBuffers;
+
+#pragma mark - Statistics
+
+@property (atomic, assign, readonly) NSUInteger appendedSampleBufferCount;
+
+/// Blocks lost to a full ring or a writer input that wasn't ready
+@property (atomic, assign, readonly) NSUInteger droppedSampleBufferCount;
+
+/// Blocks starting later than the previous one ended, leaving a gap in the audio track
+@property (atomic, assign, readonly) NSUInteger underrunCount;
+
+/// How far the end of the last appended audio is ahead of the last video frame, in seconds. Grows negative when audio falls behind
+@property (atomic, assign, readonly) NSTimeInterval drift;
+
+/// @param capacity Sample buffers the ring holds, rounded up to a power of two
+- (id)initWithAssetWriter:(AVAssetWriter *)assetWriter input:(AVAssetWriterInput *)input capacity:(NSUInteger)capacity;
+
+/// Hand a sample buffer to the lane. Call from one thread at a time. Returns NO when it was dropped
+- (BOOL)enqueueSampleBuffer:(CMSampleBufferRef)sampleBuffer;
+
+/// Tell the lane about appended video, for drift
+- (void)noteVideoFrameAtTime:(CMTime)frameTime;
+
+/// Append whatever is still queued, returning once done. Don't call from the producer while it waits for room
+- (void)flush;
+
+/// Drop whatever is still queued, e.g. when cancelling a recording
+- (void)discardQueuedSampleBuffers;
+
+/// Reset the statistics and the processors for a new recording
+- (void)reset;
+
+@end
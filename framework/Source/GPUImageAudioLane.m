@@ -0,0 +1,546 @@
+#import "GPUImageAudioLane.h"
+#import <stdatomic.h>
+#import <math.h>
+
+#pragma mark - Processors
+
+// Parameters are set from any thread and read by the lane's queue without ever blocking it
+
+@implementation GPUImageAudioGainProcessor
+{
+  _Atomic(float) _gain;
+}
+
+- (id)init;
+{
+  if (!(self = [super init]))
+  {
+    return nil;
+  }
+
+  atomic_init(&_gain, 1.0f);
+
+  return self;
+}
+
+- (float)gain;
+{
+  return atomic_load_explicit(&_gain, memory_order_relaxed);
+}
+
+- (void)setGain:(float)gain;
+{
+  atomic_store_explicit(&_gain, gain, memory_order_relaxed);
+}
+
+- (void)processSamples:(float *)samples frameCount:(NSUInteger)frameCount channelCount:(NSUInteger)channelCount sampleRate:(Float64)sampleRate;
+{
+  const float gain = self.gain;
+  if (gain == 1.0)
+  {
+    return;
+  }
+
+  const NSUInteger sampleCount = frameCount * channelCount;
+  for (NSUInteger sampleIndex = 0; sampleIndex < sampleCount; sampleIndex++)
+  {
+    samples[sampleIndex] *= gain;
+  }
+}
+
+- (void)reset;
+{
+}
+
+@end
+
+@implementation GPUImageAudioLimiterProcessor
+{
+  _Atomic(float) _threshold;
+  _Atomic(double) _releaseTime;
+
+  // Only written on the lane's queue, published for readers elsewhere. Resets are picked up at the start of the next block
+  _Atomic(float) _currentGain;
+  atomic_bool _resetPending;
+}
+
+- (id)init;
+{
+  if (!(self = [super init]))
+  {
+    return nil;
+  }
+
+  atomic_init(&_threshold, 0.9f);
+  atomic_init(&_releaseTime, 0.2);
+  atomic_init(&_currentGain, 1.0f);
+  atomic_init(&_resetPending, false);
+
+  return self;
+}
+
+- (float)threshold;
+{
+  return atomic_load_explicit(&_threshold, memory_order_relaxed);
+}
+
+- (void)setThreshold:(float)threshold;
+{
+  atomic_store_explicit(&_threshold, threshold, memory_order_relaxed);
+}
+
+- (NSTimeInterval)releaseTime;
+{
+  return atomic_load_explicit(&_releaseTime, memory_order_relaxed);
+}
+
+- (void)setReleaseTime:(NSTimeInterval)releaseTime;
+{
+  atomic_store_explicit(&_releaseTime, releaseTime, memory_order_relaxed);
+}
+
+- (float)currentGain;
+{
+  return atomic_load_explicit(&_currentGain, memory_order_relaxed);
+}
+
+- (void)processSamples:(float *)samples frameCount:(NSUInteger)frameCount channelCount:(NSUInteger)channelCount sampleRate:(Float64)sampleRate;
+{
+  const NSUInteger sampleCount = frameCount * channelCount;
+  if (sampleCount == 0)
+  {
+    return;
+  }
+
+  const float threshold = self.threshold;
+  const NSTimeInterval releaseTime = self.releaseTime;
+
+  float peak = 0.0;
+  for (NSUInteger sampleIndex = 0; sampleIndex < sampleCount; sampleIndex++)
+  {
+    peak = fmaxf(peak, fabsf(samples[sampleIndex]));
+  }
+
+  const float previousGain = atomic_exchange(&_resetPending, false) ? 1.0f : atomic_load_explicit(&_currentGain, memory_order_relaxed);
+  float targetGain = (peak > threshold) ? (threshold / peak) : 1.0;
+  if (targetGain >= previousGain)
+  {
+    const NSTimeInterval blockDuration = (sampleRate > 0.0) ? (frameCount / sampleRate) : 0.0;
+    const float recovery = (releaseTime > 0.0) ? (1.0 - exp(-blockDuration / releaseTime)) : 1.0;
+    targetGain = previousGain + (targetGain - previousGain) * recovery;
+  }
+  // Otherwise attack at once, a block late is already a clipped block
+  atomic_store_explicit(&_currentGain, targetGain, memory_order_relaxed);
+
+  // Ramp up across the block while releasing so the gain change doesn't click, then clip what the ramp let through
+  const float startGain = (targetGain < previousGain) ? targetGain : previousGain;
+  const float gainStep = (targetGain - startGain) / (float)frameCount;
+  for (NSUInteger frameIndex = 0; frameIndex < frameCount; frameIndex++)
+  {
+    const float gain = startGain + gainStep * (float)frameIndex;
+    float *frame = samples + frameIndex * channelCount;
+    for (NSUInteger channel = 0; channel < channelCount; channel++)
+    {
+      frame[channel] = fminf(fmaxf(frame[channel] * gain, -threshold), threshold);
+    }
+  }
+}
+
+- (void)reset;
+{
+  atomic_store_explicit(&_currentGain, 1.0f, memory_order_relaxed);
+  atomic_store(&_resetPending, true);
+}
+
+@end
+
+#pragma mark - Lane
+
+@interface GPUImageAudioLane ()
+{
+  __weak AVAssetWriter *_assetWriter;
+  AVAssetWriterInput *_input;
+  dispatch_queue_t _appendQueue;
+
+  // The ring. The producer alone advances the tail and the lane's queue alone the head
+  CMSampleBufferRef *_slots;
+  NSUInteger _slotMask;
+  _Atomic(NSUInteger) _head, _tail;
+  atomic_bool _drainScheduled, _discarding;
+
+  _Atomic(NSUInteger) _appendedCount, _droppedCount, _underrunCount;
+
+  // Only touched on the lane's queue
+  NSMutableData *_floatSamples;
+  CMTime _expectedNextAudioTime;
+
+  // In seconds for drift, NAN until known
+  _Atomic(double) _lastAudioEndSeconds, _lastVideoSeconds;
+}
+
+- (void)drainRing;
+- (void)appendSampleBuffer:(CMSampleBufferRef)sampleBuffer;
+- (void)processSamplesOfSampleBuffer:(CMSampleBufferRef)sampleBuffer;
+- (void)processPCMBufferList:(AudioBufferList *)bufferList withProcessors:(NSArray *)processors sampleRate:(Float64)sampleRate;
+
+@end
+
+@implementation GPUImageAudioLane
+
+@synthesize processors = _processors;
+@synthesize sampleCallback = _sampleCallback;
+@synthesize waitsForWriterInput = _waitsForWriterInput;
+@synthesize invalidatesSampleBuffers = _invalidatesSampleBuffers;
+
+- (id)initWithAssetWriter:(AVAssetWriter *)assetWriter input:(AVAssetWriterInput *)input capacity:(NSUInteger)capacity;
+{
+  if (!(self = [super init]))
+  {
+    return nil;
+  }
+
+  _assetWriter = assetWriter;
+  _input = input;
+  _appendQueue = dispatch_queue_create("com.sunsetlakesoftware.GPUImage.audioAppendQueue", NULL);
+
+  NSUInteger slotCount = 2;
+  while (slotCount < capacity)
+  {
+    slotCount <<= 1;
+  }
+  _slots = calloc(slotCount, sizeof(CMSampleBufferRef));
+  _slotMask = slotCount - 1;
+  atomic_init(&_head, 0);
+  atomic_init(&_tail, 0);
+  atomic_init(&_drainScheduled, false);
+  atomic_init(&_discarding, false);
+  atomic_init(&_appendedCount, 0);
+  atomic_init(&_droppedCount, 0);
+  atomic_init(&_underrunCount, 0);
+
+  _floatSamples = [[NSMutableData alloc] init];
+  _expectedNextAudioTime = kCMTimeInvalid;
+  atomic_init(&_lastAudioEndSeconds, NAN);
+  atomic_init(&_lastVideoSeconds, NAN);
+
+  return self;
+}
+
+- (void)dealloc;
+{
+  NSUInteger head = atomic_load_explicit(&_head, memory_order_relaxed);
+  NSUInteger tail = atomic_load_explicit(&_tail, memory_order_relaxed);
+  for (; head != tail; head++)
+  {
+    CFRelease(_slots[head & _slotMask]);
+  }
+  free(_slots);
+}
+
+#pragma mark - Producer
+
+- (BOOL)enqueueSampleBuffer:(CMSampleBufferRef)sampleBuffer;
+{
+  const NSUInteger tail = atomic_load_explicit(&_tail, memory_order_relaxed);
+  while ((tail - atomic_load_explicit(&_head, memory_order_acquire)) > _slotMask)
+  {
+    if (!self.waitsForWriterInput || atomic_load(&_discarding))
+    {
+      atomic_fetch_add(&_droppedCount, 1);
+      if (self.invalidatesSampleBuffers)
+      {
+        CMSampleBufferInvalidate(sampleBuffer);
+      }
+      return NO;
+    }
+    usleep(1000);
+  }
+
+  CFRetain(sampleBuffer);
+  _slots[tail & _slotMask] = sampleBuffer;
+  atomic_store_explicit(&_tail, tail + 1, memory_order_release);
+
+  if (!atomic_exchange(&_drainScheduled, true))
+  {
+    dispatch_async(_appendQueue, ^{
+      [self drainRing];
+    });
+  }
+
+  return YES;
+}
+
+- (void)noteVideoFrameAtTime:(CMTime)frameTime;
+{
+  if (!CMTIME_IS_NUMERIC(frameTime))
+  {
+    return;
+  }
+
+  atomic_store(&_lastVideoSeconds, CMTimeGetSeconds(frameTime));
+}
+
+#pragma mark - Consumer
+
+- (void)drainRing;
+{
+  // Cleared before popping, so a buffer pushed after the ring reads empty schedules another drain
+  atomic_store(&_drainScheduled, false);
+
+  NSUInteger head = atomic_load_explicit(&_head, memory_order_relaxed);
+  while (head != atomic_load_explicit(&_tail, memory_order_acquire))
+  {
+    CMSampleBufferRef sampleBuffer = _slots[head & _slotMask];
+    _slots[head & _slotMask] = NULL;
+
+    if (atomic_load(&_discarding))
+    {
+      atomic_fetch_add(&_droppedCount, 1);
+      if (self.invalidatesSampleBuffers)
+      {
+        CMSampleBufferInvalidate(sampleBuffer);
+      }
+    }
+    else
+    {
+      [self appendSampleBuffer:sampleBuffer];
+    }
+    CFRelease(sampleBuffer);
+
+    head++;
+    atomic_store_explicit(&_head, head, memory_order_release);
+  }
+}
+
+- (void)appendSampleBuffer:(CMSampleBufferRef)sampleBuffer;
+{
+  AVAssetWriter *assetWriter = _assetWriter;
+  CMTime presentationTime = CMSampleBufferGetOutputPresentationTimeStamp(sampleBuffer);
+  CMTime duration = CMSampleBufferGetOutputDuration(sampleBuffer);
+
+  [self processSamplesOfSampleBuffer:sampleBuffer];
+
+  while (self.waitsForWriterInput && !_input.readyForMoreMediaData && assetWriter.status == AVAssetWriterStatusWriting && !atomic_load(&_discarding))
+  {
+    usleep(10000);
+  }
+
+  BOOL appended = NO;
+  if (assetWriter.status == AVAssetWriterStatusWriting && _input.readyForMoreMediaData)
+  {
+    appended = [_input appendSampleBuffer:sampleBuffer];
+    if (!appended)
+    {
+      NSLog(@"Problem appending audio buffer at time: %@", CFBridgingRelease(CMTimeCopyDescription(kCFAllocatorDefault, presentationTime)));
+    }
+  }
+
+  if (appended)
+  {
+    atomic_fetch_add(&_appendedCount, 1);
+
+    if (CMTIME_IS_NUMERIC(presentationTime) && CMTIME_IS_NUMERIC(duration))
+    {
+      // A block starting more than half a block after the previous one ended means the producer fell behind the hardware
+      if (CMTIME_IS_VALID(_expectedNextAudioTime) && CMTIME_COMPARE_INLINE(CMTimeSubtract(presentationTime, _expectedNextAudioTime), >, CMTimeMultiplyByRatio(duration, 1, 2)))
+      {
+        atomic_fetch_add(&_underrunCount, 1);
+      }
+      _expectedNextAudioTime = CMTimeAdd(presentationTime, duration);
+
+      atomic_store(&_lastAudioEndSeconds, CMTimeGetSeconds(_expectedNextAudioTime));
+    }
+  }
+  else
+  {
+    atomic_fetch_add(&_droppedCount, 1);
+  }
+
+  if (self.invalidatesSampleBuffers)
+  {
+    CMSampleBufferInvalidate(sampleBuffer);
+  }
+}
+
+- (void)processSamplesOfSampleBuffer:(CMSampleBufferRef)sampleBuffer;
+{
+  NSArray *processors = self.processors;
+  void(^sampleCallback)(SInt16 **, CMItemCount) = self.sampleCallback;
+  if (([processors count] == 0) && (sampleCallback == nil))
+  {
+    return;
+  }
+
+  // Introspect into the opaque CMBlockBuffer structure to process its raw samples in place
+  size_t bufferListSize = 0;
+  if (CMSampleBufferGetAudioBufferListWithRetainedBlockBuffer(sampleBuffer, &bufferListSize, NULL, 0, NULL, NULL, kCMSampleBufferFlag_AudioBufferList_Assure16ByteAlignment, NULL) != noErr)
+  {
+    return;
+  }
+
+  AudioBufferList *bufferList = malloc(bufferListSize);
+  CMBlockBufferRef blockBuffer = NULL;
+  if (CMSampleBufferGetAudioBufferListWithRetainedBlockBuffer(sampleBuffer, NULL, bufferList, bufferListSize, NULL, NULL, kCMSampleBufferFlag_AudioBufferList_Assure16ByteAlignment, &blockBuffer) != noErr)
+  {
+    free(bufferList);
+    return;
+  }
+
+  const AudioStreamBasicDescription *streamDescription = CMAudioFormatDescriptionGetStreamBasicDescription(CMSampleBufferGetFormatDescription(sampleBuffer));
+  const BOOL isSigned16BitPCM = (streamDescription != NULL) && (streamDescription->mFormatID == kAudioFormatLinearPCM) && (streamDescription->mBitsPerChannel == 16) && (streamDescription->mFormatFlags & kAudioFormatFlagIsSignedInteger) && !(streamDescription->mFormatFlags & kAudioFormatFlagIsBigEndian);
+  const CMItemCount numSamplesInBuffer = CMSampleBufferGetNumSamples(sampleBuffer);
+
+  if (isSigned16BitPCM && ([processors count] > 0))
+  {
+    [self processPCMBufferList:bufferList withProcessors:processors sampleRate:streamDescription->mSampleRate];
+  }
+
+  if (sampleCallback != nil)
+  {
+    for (UInt32 bufferIndex = 0; bufferIndex < bufferList->mNumberBuffers; bufferIndex++)
+    {
+      SInt16 *samples = (SInt16 *)bufferList->mBuffers[bufferIndex].mData;
+      sampleCallback(&samples, numSamplesInBuffer);
+    }
+  }
+
+  free(bufferList);
+  if (blockBuffer != NULL)
+  {
+    CFRelease(blockBuffer);
+  }
+}
+
+// Non-interleaved audio comes as one buffer per channel. The channels of all buffers are interleaved into one block, so that processors see every channel of a frame together and e.g. a limiter applies the same gain to all of them
+- (void)processPCMBufferList:(AudioBufferList *)bufferList withProcessors:(NSArray *)processors sampleRate:(Float64)sampleRate;
+{
+  NSUInteger channelCount = 0;
+  NSUInteger frameCount = NSUIntegerMax;
+  for (UInt32 bufferIndex = 0; bufferIndex < bufferList->mNumberBuffers; bufferIndex++)
+  {
+    const AudioBuffer *audioBuffer = &bufferList->mBuffers[bufferIndex];
+    if (audioBuffer->mNumberChannels == 0)
+    {
+      continue;
+    }
+    channelCount += audioBuffer->mNumberChannels;
+    frameCount = MIN(frameCount, audioBuffer->mDataByteSize / sizeof(SInt16) / audioBuffer->mNumberChannels);
+  }
+  if ((channelCount == 0) || (frameCount == 0) || (frameCount == NSUIntegerMax))
+  {
+    return;
+  }
+
+  const NSUInteger sampleCount = frameCount * channelCount;
+  if ([_floatSamples length] < sampleCount * sizeof(float))
+  {
+    [_floatSamples setLength:sampleCount * sizeof(float)];
+  }
+  float *floatSamples = (float *)[_floatSamples mutableBytes];
+
+  const float toFloat = 1.0 / 32768.0;
+  NSUInteger firstChannel = 0;
+  for (UInt32 bufferIndex = 0; bufferIndex < bufferList->mNumberBuffers; bufferIndex++)
+  {
+    const AudioBuffer *audioBuffer = &bufferList->mBuffers[bufferIndex];
+    const SInt16 *samples = (const SInt16 *)audioBuffer->mData;
+    const NSUInteger bufferChannelCount = audioBuffer->mNumberChannels;
+    for (NSUInteger frameIndex = 0; frameIndex < frameCount; frameIndex++)
+    {
+      for (NSUInteger channel = 0; channel < bufferChannelCount; channel++)
+      {
+        floatSamples[frameIndex * channelCount + firstChannel + channel] = (float)samples[frameIndex * bufferChannelCount + channel] * toFloat;
+      }
+    }
+    firstChannel += bufferChannelCount;
+  }
+
+  for (id<GPUImageAudioProcessor> processor in processors)
+  {
+    [processor processSamples:floatSamples frameCount:frameCount channelCount:channelCount sampleRate:sampleRate];
+  }
+
+  firstChannel = 0;
+  for (UInt32 bufferIndex = 0; bufferIndex < bufferList->mNumberBuffers; bufferIndex++)
+  {
+    const AudioBuffer *audioBuffer = &bufferList->mBuffers[bufferIndex];
+    SInt16 *samples = (SInt16 *)audioBuffer->mData;
+    const NSUInteger bufferChannelCount = audioBuffer->mNumberChannels;
+    for (NSUInteger frameIndex = 0; frameIndex < frameCount; frameIndex++)
+    {
+      for (NSUInteger channel = 0; channel < bufferChannelCount; channel++)
+      {
+        const float scaledSample = floatSamples[frameIndex * channelCount + firstChannel + channel] * 32768.0;
+        samples[frameIndex * bufferChannelCount + channel] = (SInt16)fminf(fmaxf(scaledSample, -32768.0), 32767.0);
+      }
+    }
+    firstChannel += bufferChannelCount;
+  }
+}
+
+#pragma mark - Control
+
+- (void)flush;
+{
+  dispatch_sync(_appendQueue, ^{
+    [self drainRing];
+  });
+}
+
+- (void)discardQueuedSampleBuffers;
+{
+  atomic_store(&_discarding, true);
+  dispatch_sync(_appendQueue, ^{
+    [self drainRing];
+  });
+  atomic_store(&_discarding, false);
+}
+
+- (void)reset;
+{
+  [self discardQueuedSampleBuffers];
+
+  dispatch_sync(_appendQueue, ^{
+    _expectedNextAudioTime = kCMTimeInvalid;
+    for (id<GPUImageAudioProcessor> processor in self.processors)
+    {
+      [processor reset];
+    }
+  });
+
+  atomic_store(&_appendedCount, 0);
+  atomic_store(&_droppedCount, 0);
+  atomic_store(&_underrunCount, 0);
+  atomic_store(&_lastAudioEndSeconds, NAN);
+  atomic_store(&_lastVideoSeconds, NAN);
+}
+
+#pragma mark - Statistics
+
+- (NSUInteger)appendedSampleBufferCount;
+{
+  return atomic_load(&_appendedCount);
+}
+
+- (NSUInteger)droppedSampleBufferCount;
+{
+  return atomic_load(&_droppedCount);
+}
+
+- (NSUInteger)underrunCount;
+{
+  return atomic_load(&_underrunCount);
+}
+
+- (NSTimeInterval)drift;
+{
+  const double lastAudioEndSeconds = atomic_load(&_lastAudioEndSeconds);
+  const double lastVideoSeconds = atomic_load(&_lastVideoSeconds);
+  if (isnan(lastAudioEndSeconds) || isnan(lastVideoSeconds))
+  {
+    return 0.0;
+  }
+  return lastAudioEndSeconds - lastVideoSeconds;
+}
+
+@end
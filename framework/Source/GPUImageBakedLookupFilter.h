@@ -0,0 +1,49 @@
+#import "GPUImageFilterGroup.h"
+
+@class GPUImageLookupFilter;
+
+/// Side of the 512x512 lookup tables GPUImageLookupFilter reads, 8x8 squares of 64x64
+extern const NSUInteger kGPUImageLookupTableSize;
+
+/** Applies a 512x512 RGBA lookup table to RGBA pixels on the CPU, interpolating the same way GPUImageLookupFilter does
+ @param lookupTable Rows of kGPUImageLookupTableSize * 4 bytes, the first row being the one at texture coordinate 0
+ */
+void GPUImageApplyLookupTable(const GLubyte *lookupTable, const GLubyte *sourcePixels, GLubyte *destinationPixels, NSUInteger pixelCount);
+
+/** Replaces a chain of colour-only filters by a single lookup pass
+
+ An identity lattice is rendered through the chain once, and the result becomes the lookup table of a GPUImageLookupFilter. Frames then only go through that one pass, whatever the length of the chain. The table is baked again only when the chain changes through -updateColorFilters:, or on -bakeLookupTable.
+
+ Every filter has to map each pixel on its own colour alone: tone curves, levels, HSB, white balance, colour matrices, or lookup based filters such as GPUImageAmatorkaFilter. Blurs and other filters reading neighbouring pixels can't be baked. The colours in between lattice points are interpolated, see -measureMaximumError:averageError: for how close the result stays to the live chain.
+ */
+@interface GPUImageBakedLookupFilter : GPUImageFilterGroup
+
+/// The baked chain, in order. Only change its filters through -updateColorFilters:
+@property (nonatomic, strong, readonly) NSArray *colorFilters;
+
+@property (nonatomic, strong, readonly) GPUImageLookupFilter *lookupFilter;
+
+/// The current lookup table as RGBA bytes, kGPUImageLookupTableSize rows of kGPUImageLookupTableSize * 4 bytes, for applying it on the CPU with GPUImageApplyLookupTable()
+@property (nonatomic, strong, readonly) NSData *lookupTableData;
+
+/// Times the table has been baked
+@property (nonatomic, assign, readonly) NSUInteger bakeCount;
+
+/** Chain the filters and bake them
+ @param colorFilters Filters or filter groups, applied in order. They must not have targets of their own
+ */
+- (id)initWithColorFilters:(NSArray *)colorFilters;
+
+/// Change parameters of the chain, then bake it again. The block is called on the video processing queue
+- (void)updateColorFilters:(void (^)(NSArray *colorFilters))updateBlock;
+
+/// Bake the chain again, after changing its filters some other way
+- (void)bakeLookupTable;
+
+/** Compare the baked table against the live chain, over a fixed set of colours away from the lattice points
+ @param maximumError Set to the largest difference of any channel, in 8-bit steps
+ @param averageError Set to the mean difference over all channels, in 8-bit steps
+ */
+- (void)measureMaximumError:(GLfloat *)maximumError averageError:(GLfloat *)averageError;
+
+@end
@@ -0,0 +1,223 @@
+#import "GPUImageBakedLookupFilter.h"
+#import "GPUImageLookupFilter.h"
+#import "GPUImageRawDataInput.h"
+#import "GPUImageRawDataOutput.h"
+#import "GPUImageFrameSyncPolicy.h"
+
+const NSUInteger kGPUImageLookupTableSize = 512;
+
+// Lattice points per channel, and squares per row of the table
+static const NSUInteger kGPUImageLookupLatticeSteps = 64;
+static const NSUInteger kGPUImageLookupSquaresPerRow = 8;
+
+// Side of the square image of colours the error measurement runs through both paths
+static const NSUInteger kGPUImageLookupProbeSize = 64;
+
+#pragma mark - Lookup on the CPU
+
+// Bilinear sample of one channel within the square of a blue lattice step, red and green in lattice steps
+static GLfloat GPUImageSampleLookupSquare(const GLubyte *lookupTable, NSUInteger square, GLfloat red, GLfloat green, NSUInteger channel) {
+  NSUInteger squareX = (square % kGPUImageLookupSquaresPerRow) * kGPUImageLookupLatticeSteps;
+  NSUInteger squareY = (square / kGPUImageLookupSquaresPerRow) * kGPUImageLookupLatticeSteps;
+  NSUInteger lowerRed = (NSUInteger)red;
+  NSUInteger lowerGreen = (NSUInteger)green;
+  NSUInteger upperRed = MIN(lowerRed + 1, kGPUImageLookupLatticeSteps - 1);
+  NSUInteger upperGreen = MIN(lowerGreen + 1, kGPUImageLookupLatticeSteps - 1);
+  GLfloat redFraction = red - lowerRed;
+  GLfloat greenFraction = green - lowerGreen;
+
+  const GLubyte *lowerRow = lookupTable + (squareY + lowerGreen) * kGPUImageLookupTableSize * 4;
+  const GLubyte *upperRow = lookupTable + (squareY + upperGreen) * kGPUImageLookupTableSize * 4;
+  GLfloat lower = lowerRow[(squareX + lowerRed) * 4 + channel] * (1.0 - redFraction) + lowerRow[(squareX + upperRed) * 4 + channel] * redFraction;
+  GLfloat upper = upperRow[(squareX + lowerRed) * 4 + channel] * (1.0 - redFraction) + upperRow[(squareX + upperRed) * 4 + channel] * redFraction;
+  return lower * (1.0 - greenFraction) + upper * greenFraction;
+}
+
+void GPUImageApplyLookupTable(const GLubyte *lookupTable, const GLubyte *sourcePixels, GLubyte *destinationPixels, NSUInteger pixelCount) {
+  GLfloat latticeScale = (kGPUImageLookupLatticeSteps - 1) / 255.0;
+  for (NSUInteger pixel = 0; pixel < pixelCount; pixel++) {
+    const GLubyte *source = sourcePixels + pixel * 4;
+    GLubyte *destination = destinationPixels + pixel * 4;
+
+    GLfloat red = source[0] * latticeScale;
+    GLfloat green = source[1] * latticeScale;
+    GLfloat blue = source[2] * latticeScale;
+    NSUInteger lowerSquare = (NSUInteger)floorf(blue);
+    NSUInteger upperSquare = (NSUInteger)ceilf(blue);
+    GLfloat blueFraction = blue - lowerSquare;
+
+    for (NSUInteger channel = 0; channel < 3; channel++) {
+      GLfloat lower = GPUImageSampleLookupSquare(lookupTable, lowerSquare, red, green, channel);
+      GLfloat upper = GPUImageSampleLookupSquare(lookupTable, upperSquare, red, green, channel);
+      destination[channel] = (GLubyte)(lower + (upper - lower) * blueFraction + 0.5);
+    }
+    destination[3] = source[3];
+  }
+}
+
+#pragma mark -
+
+@interface GPUImageBakedLookupFilter()
+
+@property (nonatomic, strong, readwrite) NSArray *colorFilters;
+@property (nonatomic, strong, readwrite) GPUImageLookupFilter *lookupFilter;
+@property (nonatomic, strong, readwrite) NSData *lookupTableData;
+
+@property (nonatomic, strong) GPUImageRawDataInput *latticeInput;
+@property (nonatomic, strong) GPUImageRawDataOutput *lookupTableOutput;
+
+// Created on the first error measurement, it stays a source of the chain like the lattice
+@property (nonatomic, strong) GPUImageRawDataInput *probeInput;
+@property (nonatomic, assign) GLubyte *probeBytes;
+
+@end
+
+@implementation GPUImageBakedLookupFilter
+
+#pragma mark - Initialization and teardown
+
+- (id)initWithColorFilters:(NSArray *)colorFilters {
+  NSParameterAssert([colorFilters count] > 0);
+  if (!(self = [super init])) {
+    return nil;
+  }
+
+  self.colorFilters = [colorFilters copy];
+
+  // The table stays in the second input until a newer one is baked, and each frame renders against the latest
+  self.lookupFilter = [[GPUImageLookupFilter alloc] init];
+  self.lookupFilter.frameSyncPolicy = [[GPUImageLatestFrameSyncPolicy alloc] init];
+  [self addFilter:self.lookupFilter];
+  self.initialFilters = [NSArray arrayWithObject:self.lookupFilter];
+  self.terminalFilter = self.lookupFilter;
+
+  // Identity lattice, laid out as documented in GPUImageLookupFilter.h
+  GLubyte *latticeBytes = (GLubyte *)malloc(kGPUImageLookupTableSize * kGPUImageLookupTableSize * 4);
+  for (NSUInteger row = 0; row < kGPUImageLookupTableSize; row++) {
+    for (NSUInteger column = 0; column < kGPUImageLookupTableSize; column++) {
+      NSUInteger square = (row / kGPUImageLookupLatticeSteps) * kGPUImageLookupSquaresPerRow + column / kGPUImageLookupLatticeSteps;
+      GLubyte *pixel = latticeBytes + (row * kGPUImageLookupTableSize + column) * 4;
+      pixel[0] = (GLubyte)((column % kGPUImageLookupLatticeSteps) * 255.0 / (kGPUImageLookupLatticeSteps - 1) + 0.5);
+      pixel[1] = (GLubyte)((row % kGPUImageLookupLatticeSteps) * 255.0 / (kGPUImageLookupLatticeSteps - 1) + 0.5);
+      pixel[2] = (GLubyte)(square * 255.0 / (kGPUImageLookupLatticeSteps - 1) + 0.5);
+      pixel[3] = 255;
+    }
+  }
+  CGSize latticeSize = CGSizeMake(kGPUImageLookupTableSize, kGPUImageLookupTableSize);
+  self.latticeInput = [[GPUImageRawDataInput alloc] initWithBytes:latticeBytes size:latticeSize pixelFormat:GPUPixelFormatRGBA];
+  free(latticeBytes);
+
+  GPUImageOutput *previousFilter = self.latticeInput;
+  for (GPUImageOutput<GPUImageInput> *colorFilter in self.colorFilters) {
+    [previousFilter addTarget:colorFilter];
+    previousFilter = colorFilter;
+  }
+  [previousFilter addTarget:self.lookupFilter atTextureLocation:1];
+
+  self.lookupTableOutput = [[GPUImageRawDataOutput alloc] initWithImageSize:latticeSize resultsInBGRAFormat:NO];
+  [previousFilter addTarget:self.lookupTableOutput];
+
+  [self bakeLookupTable];
+
+  return self;
+}
+
+- (void)dealloc {
+  free(_probeBytes);
+}
+
+#pragma mark - Baking
+
+// Runs the chain on the image of a raw data input right away, unlike -processData which may skip a frame
+- (void)renderImageFromInput:(GPUImageRawDataInput *)input {
+  CGSize imageSize = [input outputImageSize];
+  [input loopTargetsWithTargetAndTextureIndex:^(id<GPUImageInput> target, NSUInteger textureIndex) {
+    [input setInputFramebufferForTarget:target atIndex:textureIndex];
+    [target setInputSize:imageSize index:textureIndex];
+    [target newFrameReadyAtTime:kCMTimeZero atIndex:textureIndex];
+  }];
+}
+
+- (NSMutableData *)copyBytesFromOutput:(GPUImageRawDataOutput *)output size:(NSUInteger)size {
+  NSMutableData *data = [NSMutableData dataWithLength:size * size * 4];
+  [output lockFramebufferForReading];
+  const GLubyte *outputBytes = output.rawBytesForImage;
+  NSUInteger bytesPerRow = [output bytesPerRowInOutput];
+  for (NSUInteger row = 0; row < size; row++) {
+    memcpy((GLubyte *)[data mutableBytes] + row * size * 4, outputBytes + row * bytesPerRow, size * 4);
+  }
+  [output unlockFramebufferAfterReading];
+  return data;
+}
+
+- (void)bakeLookupTable {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [self renderImageFromInput:self.latticeInput];
+    self.lookupTableData = [self copyBytesFromOutput:self.lookupTableOutput size:kGPUImageLookupTableSize];
+    _bakeCount++;
+  });
+}
+
+- (void)updateColorFilters:(void (^)(NSArray *colorFilters))updateBlock {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    updateBlock(self.colorFilters);
+    [self bakeLookupTable];
+  });
+}
+
+#pragma mark - Accuracy
+
+- (void)measureMaximumError:(GLfloat *)maximumError averageError:(GLfloat *)averageError {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    NSUInteger pixelCount = kGPUImageLookupProbeSize * kGPUImageLookupProbeSize;
+    CGSize probeSize = CGSizeMake(kGPUImageLookupProbeSize, kGPUImageLookupProbeSize);
+
+    if (self.probeInput == nil) {
+      // Fixed pseudo-random colours, which hardly ever land on lattice points
+      self.probeBytes = (GLubyte *)malloc(pixelCount * 4);
+      uint32_t state = 1;
+      for (NSUInteger pixel = 0; pixel < pixelCount; pixel++) {
+        state = state * 1664525 + 1013904223;
+        self.probeBytes[pixel * 4] = (GLubyte)(state >> 8);
+        self.probeBytes[pixel * 4 + 1] = (GLubyte)(state >> 16);
+        self.probeBytes[pixel * 4 + 2] = (GLubyte)(state >> 24);
+        self.probeBytes[pixel * 4 + 3] = 255;
+      }
+      self.probeInput = [[GPUImageRawDataInput alloc] initWithBytes:self.probeBytes size:probeSize pixelFormat:GPUPixelFormatRGBA];
+      [self.probeInput addTarget:[self.colorFilters firstObject]];
+    }
+
+    // The probe also reaches the lookup filter as a table, the lattice goes through again below to put the real one back
+    GPUImageOutput *lastFilter = [self.colorFilters lastObject];
+    GPUImageRawDataOutput *liveOutput = [[GPUImageRawDataOutput alloc] initWithImageSize:probeSize resultsInBGRAFormat:NO];
+    [lastFilter addTarget:liveOutput];
+    [self renderImageFromInput:self.probeInput];
+    NSData *liveData = [self copyBytesFromOutput:liveOutput size:kGPUImageLookupProbeSize];
+    [lastFilter removeTarget:liveOutput];
+    [self bakeLookupTable];
+
+    NSMutableData *bakedData = [NSMutableData dataWithLength:pixelCount * 4];
+    GPUImageApplyLookupTable([self.lookupTableData bytes], self.probeBytes, [bakedData mutableBytes], pixelCount);
+
+    const GLubyte *liveBytes = [liveData bytes];
+    const GLubyte *bakedBytes = [bakedData bytes];
+    NSUInteger largestDifference = 0;
+    NSUInteger totalDifference = 0;
+    for (NSUInteger pixel = 0; pixel < pixelCount; pixel++) {
+      for (NSUInteger channel = 0; channel < 3; channel++) {
+        NSUInteger difference = (NSUInteger)abs((int)liveBytes[pixel * 4 + channel] - (int)bakedBytes[pixel * 4 + channel]);
+        largestDifference = MAX(largestDifference, difference);
+        totalDifference += difference;
+      }
+    }
+
+    if (maximumError != NULL) {
+      *maximumError = largestDifference;
+    }
+    if (averageError != NULL) {
+      *averageError = (GLfloat)totalDifference / (pixelCount * 3);
+    }
+  });
+}
+
+@end
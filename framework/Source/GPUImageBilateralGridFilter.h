@@ -0,0 +1,23 @@
+#import "GPUImageFilterGroup.h"
+
+/** An edge-preserving smoothing filter built on a bilateral grid
+
+ Unlike GPUImageBilateralFilter, the per-pixel cost doesn't depend on the spatial extent of the filter: the image is splatted into a low-resolution (x, y, luminance) grid, the grid is blurred and then sliced back at full resolution.
+
+ Based on Chen, Paris and Durand, "Real-time Edge-Aware Image Processing with the Bilateral Grid" (SIGGRAPH 2007). Half-float grid storage is used when the device supports rendering to it and filtering it linearly. On images too large for the grid to fit within a texture, the grid cells are made larger.
+ */
+@interface GPUImageBilateralGridFilter : GPUImageFilterGroup
+
+/** The spatial standard deviation of the filter, in pixels. Default of 8.0
+ */
+@property (nonatomic, assign) CGFloat spatialSigmaInPixels;
+
+/** The range standard deviation of the filter, as a fraction of the luminance range. Default of 0.1
+ */
+@property (nonatomic, assign) CGFloat rangeSigma;
+
+/** Trades speed for accuracy by refining the grid sampling, from 0.0 (coarsest grid, fastest) to 1.0 (grid twice as dense in every dimension). Default of 0.5
+ */
+@property (nonatomic, assign) CGFloat quality;
+
+@end
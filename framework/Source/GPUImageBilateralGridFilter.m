@@ -0,0 +1,372 @@
+#import "GPUImageBilateralGridFilter.h"
+#import "GPUImageTwoInputFilter.h"
+
+// Samples taken along each axis of a grid cell while splatting, larger cells are subsampled
+static const NSUInteger kGPUImageBilateralGridMaximumSamplesPerCell = 16;
+static const NSUInteger kGPUImageBilateralGridMaximumRangeBins = 32;
+
+#if TARGET_IPHONE_SIMULATOR || TARGET_OS_IPHONE
+NSString *const kGPUImageBilateralGridShaderPrecision = @"precision highp float;\n";
+#else
+NSString *const kGPUImageBilateralGridShaderPrecision = @"";
+#endif
+
+// The grid is stored as an atlas of rangeBins slices, each slice gridSize cells large, wrapped into rows of atlasSlices.x slices so that it fits within a texture.
+// Every cell holds the luminance-weighted sum of colors in .rgb and the sum of weights in .a
+NSString *const kGPUImageBilateralGridSplatFragmentShaderString = SHADER_STRING
+(
+ varying vec2 textureCoordinate;
+
+ uniform sampler2D inputImageTexture;
+ uniform vec2 gridSize;
+ uniform vec2 atlasSlices;
+ uniform vec2 texelSize;
+ uniform float cellSize;
+ uniform float sampleStep;
+
+ const vec3 luminanceWeighting = vec3(0.2125, 0.7154, 0.0721);
+
+ void main()
+ {
+     vec2 atlasPosition = textureCoordinate * gridSize * atlasSlices;
+     vec2 atlasSlice = floor(atlasPosition / gridSize);
+     float slice = atlasSlice.y * atlasSlices.x + atlasSlice.x;
+     vec2 cell = floor(atlasPosition - atlasSlice * gridSize);
+     vec2 origin = (cell * cellSize + 0.5 * sampleStep) * texelSize;
+
+     vec4 sum = vec4(0.0);
+     for (int y = 0; y < samplesPerCell; y++)
+     {
+         for (int x = 0; x < samplesPerCell; x++)
+         {
+             vec3 color = texture2D(inputImageTexture, origin + vec2(float(x), float(y)) * sampleStep * texelSize).rgb;
+             float weight = max(1.0 - abs(dot(color, luminanceWeighting) * float(rangeBins - 1) - slice), 0.0);
+             sum += vec4(color * weight, weight);
+         }
+     }
+
+     gl_FragColor = sum / float(samplesPerCell * samplesPerCell);
+ }
+);
+
+NSString *const kGPUImageBilateralGridBlurFragmentShaderString = SHADER_STRING
+(
+ varying vec2 textureCoordinate;
+
+ uniform sampler2D inputImageTexture;
+ uniform vec2 gridSize;
+ uniform vec2 atlasSlices;
+
+ vec2 atlasCoordinate(float slice, vec2 cell)
+ {
+     float sliceRow = floor((slice + 0.5) / atlasSlices.x);
+     return (vec2(slice - sliceRow * atlasSlices.x, sliceRow) * gridSize + cell) / (gridSize * atlasSlices);
+ }
+
+ void main()
+ {
+     vec2 atlasPosition = textureCoordinate * gridSize * atlasSlices;
+     vec2 atlasSlice = floor(atlasPosition / gridSize);
+     float slice = atlasSlice.y * atlasSlices.x + atlasSlice.x;
+     vec2 cellCenter = atlasPosition - atlasSlice * gridSize;
+
+     // Separable [1 2 1] tent in x, y and luminance
+     vec4 sum = vec4(0.0);
+     for (int z = -1; z <= 1; z++)
+     {
+         float neighborSlice = clamp(slice + float(z), 0.0, float(rangeBins - 1));
+         for (int y = -1; y <= 1; y++)
+         {
+             for (int x = -1; x <= 1; x++)
+             {
+                 vec2 neighbor = clamp(cellCenter + vec2(float(x), float(y)), vec2(0.5), gridSize - 0.5);
+                 float weight = (2.0 - abs(float(x))) * (2.0 - abs(float(y))) * (2.0 - abs(float(z)));
+                 sum += weight * texture2D(inputImageTexture, atlasCoordinate(neighborSlice, neighbor));
+             }
+         }
+     }
+
+     gl_FragColor = sum / 64.0;
+ }
+);
+
+NSString *const kGPUImageBilateralGridSliceFragmentShaderString = SHADER_STRING
+(
+ varying vec2 textureCoordinate;
+ varying vec2 textureCoordinate2;
+
+ uniform sampler2D inputImageTexture;
+ uniform sampler2D inputImageTexture2;
+ uniform vec2 gridSize;
+ uniform vec2 atlasSlices;
+ uniform vec2 gridScale;
+
+ const vec3 luminanceWeighting = vec3(0.2125, 0.7154, 0.0721);
+
+ vec4 sampleGrid(float slice, vec2 cell)
+ {
+     float sliceRow = floor((slice + 0.5) / atlasSlices.x);
+     return texture2D(inputImageTexture2, (vec2(slice - sliceRow * atlasSlices.x, sliceRow) * gridSize + cell) / (gridSize * atlasSlices));
+ }
+
+ void main()
+ {
+     vec4 color = texture2D(inputImageTexture, textureCoordinate);
+
+     float binPosition = dot(color.rgb, luminanceWeighting) * float(rangeBins - 1);
+     float lowerSlice = floor(binPosition);
+     float upperSlice = min(lowerSlice + 1.0, float(rangeBins - 1));
+     vec2 cell = clamp(textureCoordinate2 * gridScale, vec2(0.5), gridSize - 0.5);
+
+     vec4 grid = mix(sampleGrid(lowerSlice, cell), sampleGrid(upperSlice, cell), binPosition - lowerSlice);
+     vec3 filtered = (grid.a > 0.0001) ? grid.rgb / grid.a : color.rgb;
+
+     gl_FragColor = vec4(filtered, color.a);
+ }
+);
+
+typedef struct {
+  CGSize gridSize;
+  CGFloat cellSize;
+  NSUInteger slicesPerRow;
+  NSUInteger sliceRows;
+} GPUImageBilateralGridAtlasLayout;
+
+// Wraps the slices into as many rows as needed, and only coarsens the cells when even that doesn't fit within a texture
+static GPUImageBilateralGridAtlasLayout bilateralGridAtlasLayout(CGSize imageSize, NSUInteger cellSize, NSUInteger rangeBins) {
+  CGFloat maximumTextureSize = (CGFloat)[GPUImageContext maximumTextureSizeForThisDevice];
+  GPUImageBilateralGridAtlasLayout layout;
+  layout.cellSize = cellSize;
+  while (YES) {
+    layout.gridSize = CGSizeMake(ceil(imageSize.width / layout.cellSize), ceil(imageSize.height / layout.cellSize));
+    layout.slicesPerRow = MIN(rangeBins, (NSUInteger)floor(maximumTextureSize / layout.gridSize.width));
+    if (layout.slicesPerRow > 0) {
+      layout.sliceRows = (rangeBins + layout.slicesPerRow - 1) / layout.slicesPerRow;
+      if (layout.sliceRows * layout.gridSize.height <= maximumTextureSize) {
+        return layout;
+      }
+    }
+    layout.cellSize = ceil(layout.cellSize * 1.25);
+  }
+}
+
+static NSString *bilateralGridShader(NSString *shaderBody, NSUInteger cellSize, NSUInteger rangeBins) {
+  NSUInteger samplesPerCell = MIN(cellSize, kGPUImageBilateralGridMaximumSamplesPerCell);
+  return [NSString stringWithFormat:@"%@const int samplesPerCell = %lu;\nconst int rangeBins = %lu;\n%@", kGPUImageBilateralGridShaderPrecision, (unsigned long)samplesPerCell, (unsigned long)rangeBins, shaderBody];
+}
+
+#pragma mark - Grid stages
+
+@interface GPUImageBilateralGridSplatFilter : GPUImageFilter
+
+@property (nonatomic, assign) NSUInteger cellSize;
+@property (nonatomic, assign) NSUInteger rangeBins;
+@property (nonatomic, assign) GPUImageBilateralGridAtlasLayout atlasLayout;
+
+@end
+
+@implementation GPUImageBilateralGridSplatFilter
+
+- (id)initWithCellSize:(NSUInteger)cellSize rangeBins:(NSUInteger)rangeBins {
+  if ((self = [super initWithFragmentShaderFromString:bilateralGridShader(kGPUImageBilateralGridSplatFragmentShaderString, cellSize, rangeBins)])) {
+    self.cellSize = cellSize;
+    self.rangeBins = rangeBins;
+  }
+  return self;
+}
+
+- (void)setCellSize:(NSUInteger)cellSize rangeBins:(NSUInteger)rangeBins {
+  self.cellSize = cellSize;
+  self.rangeBins = rangeBins;
+  [self switchToVertexShader:kGPUImageVertexShaderString fragmentShader:bilateralGridShader(kGPUImageBilateralGridSplatFragmentShaderString, cellSize, rangeBins)];
+  // The new program starts from default uniforms
+  [self setupFilterForSize:[self sizeOfFBO]];
+}
+
+- (CGSize)sizeOfFBO {
+  CGSize imageSize = [self getInputSize:0];
+  if (imageSize.width * imageSize.height <= 0.0) {
+    return imageSize;
+  }
+  GPUImageBilateralGridAtlasLayout layout = bilateralGridAtlasLayout(imageSize, self.cellSize, self.rangeBins);
+  return CGSizeMake(layout.gridSize.width * layout.slicesPerRow, layout.gridSize.height * layout.sliceRows);
+}
+
+- (void)setupFilterForSize:(CGSize)filterFrameSize {
+  CGSize imageSize = [self getInputSize:0];
+  if (imageSize.width * imageSize.height > 0.0) {
+    GPUImageBilateralGridAtlasLayout layout = bilateralGridAtlasLayout(imageSize, self.cellSize, self.rangeBins);
+    self.atlasLayout = layout;
+    NSUInteger samplesPerCell = MIN(self.cellSize, kGPUImageBilateralGridMaximumSamplesPerCell);
+    [self setSize:layout.gridSize forUniformName:@"gridSize"];
+    [self setSize:CGSizeMake(layout.slicesPerRow, layout.sliceRows) forUniformName:@"atlasSlices"];
+    [self setSize:CGSizeMake(1.0 / imageSize.width, 1.0 / imageSize.height) forUniformName:@"texelSize"];
+    [self setFloat:layout.cellSize forUniformName:@"cellSize"];
+    [self setFloat:layout.cellSize / samplesPerCell forUniformName:@"sampleStep"];
+  }
+}
+
+@end
+
+@interface GPUImageBilateralGridBlurFilter : GPUImageFilter
+
+@property (nonatomic, assign) NSUInteger rangeBins;
+/// Lays out the atlas this filter receives
+@property (nonatomic, weak) GPUImageBilateralGridSplatFilter *splatFilter;
+
+@end
+
+@implementation GPUImageBilateralGridBlurFilter
+
+- (id)initWithRangeBins:(NSUInteger)rangeBins {
+  if ((self = [super initWithFragmentShaderFromString:bilateralGridShader(kGPUImageBilateralGridBlurFragmentShaderString, 1, rangeBins)])) {
+    self.rangeBins = rangeBins;
+  }
+  return self;
+}
+
+- (void)setRangeBinsAndUpdateProgram:(NSUInteger)rangeBins {
+  self.rangeBins = rangeBins;
+  [self switchToVertexShader:kGPUImageVertexShaderString fragmentShader:bilateralGridShader(kGPUImageBilateralGridBlurFragmentShaderString, 1, rangeBins)];
+  // The new program starts from default uniforms
+  [self setupFilterForSize:[self sizeOfFBO]];
+}
+
+- (void)setupFilterForSize:(CGSize)filterFrameSize {
+  GPUImageBilateralGridAtlasLayout layout = self.splatFilter.atlasLayout;
+  if (layout.slicesPerRow > 0) {
+    [self setSize:layout.gridSize forUniformName:@"gridSize"];
+    [self setSize:CGSizeMake(layout.slicesPerRow, layout.sliceRows) forUniformName:@"atlasSlices"];
+  }
+}
+
+@end
+
+@interface GPUImageBilateralGridSliceFilter : GPUImageTwoInputFilter
+
+@property (nonatomic, assign) NSUInteger cellSize;
+@property (nonatomic, assign) NSUInteger rangeBins;
+
+@end
+
+@implementation GPUImageBilateralGridSliceFilter
+
+- (id)initWithCellSize:(NSUInteger)cellSize rangeBins:(NSUInteger)rangeBins {
+  if ((self = [super initWithFragmentShaderFromString:bilateralGridShader(kGPUImageBilateralGridSliceFragmentShaderString, cellSize, rangeBins)])) {
+    self.cellSize = cellSize;
+    self.rangeBins = rangeBins;
+  }
+  return self;
+}
+
+- (void)setCellSize:(NSUInteger)cellSize rangeBins:(NSUInteger)rangeBins {
+  self.cellSize = cellSize;
+  self.rangeBins = rangeBins;
+  [self switchToVertexShader:kGPUImageTwoInputTextureVertexShaderString fragmentShader:bilateralGridShader(kGPUImageBilateralGridSliceFragmentShaderString, cellSize, rangeBins)];
+  // The new program starts from default uniforms
+  [self setupFilterForSize:[self sizeOfFBO]];
+}
+
+- (void)setupFilterForSize:(CGSize)filterFrameSize {
+  if (filterFrameSize.width * filterFrameSize.height > 0.0) {
+    GPUImageBilateralGridAtlasLayout layout = bilateralGridAtlasLayout(filterFrameSize, self.cellSize, self.rangeBins);
+    [self setSize:layout.gridSize forUniformName:@"gridSize"];
+    [self setSize:CGSizeMake(layout.slicesPerRow, layout.sliceRows) forUniformName:@"atlasSlices"];
+    [self setSize:CGSizeMake(filterFrameSize.width / layout.cellSize, filterFrameSize.height / layout.cellSize) forUniformName:@"gridScale"];
+  }
+}
+
+@end
+
+#pragma mark - Filter group
+
+@interface GPUImageBilateralGridFilter()
+
+@property (nonatomic, strong) GPUImageBilateralGridSplatFilter *splatFilter;
+@property (nonatomic, strong) GPUImageBilateralGridBlurFilter *blurFilter;
+@property (nonatomic, strong) GPUImageBilateralGridSliceFilter *sliceFilter;
+
+@end
+
+@implementation GPUImageBilateralGridFilter
+
+#pragma mark - Initialization and teardown
+
+- (id)init {
+  if ((self = [super init])) {
+    _spatialSigmaInPixels = 8.0;
+    _rangeSigma = 0.1;
+    _quality = 0.5;
+
+    NSUInteger cellSize = [self cellSize];
+    NSUInteger rangeBins = [self rangeBins];
+
+    self.splatFilter = [[GPUImageBilateralGridSplatFilter alloc] initWithCellSize:cellSize rangeBins:rangeBins];
+    self.blurFilter = [[GPUImageBilateralGridBlurFilter alloc] initWithRangeBins:rangeBins];
+    self.sliceFilter = [[GPUImageBilateralGridSliceFilter alloc] initWithCellSize:cellSize rangeBins:rangeBins];
+
+    self.blurFilter.splatFilter = self.splatFilter;
+
+    // The slice pass samples the grid bilinearly, which half float textures don't support everywhere
+    GPUTextureOptions gridTextureOptions = self.splatFilter.outputTextureOptions;
+    if ([GPUImageContext deviceSupportsHalfFloatRenderTargets] && [GPUImageContext deviceSupportsHalfFloatLinearFiltering]) {
+      gridTextureOptions.internalFormat = GL_RGBA;
+      gridTextureOptions.format = GL_RGBA;
+      gridTextureOptions.type = GL_HALF_FLOAT_OES;
+    }
+    self.splatFilter.outputTextureOptions = gridTextureOptions;
+    self.blurFilter.outputTextureOptions = gridTextureOptions;
+
+    [self addFilter:self.splatFilter];
+    [self addFilter:self.blurFilter];
+    [self addFilter:self.sliceFilter];
+
+    [self.splatFilter addTarget:self.blurFilter];
+    [self.blurFilter addTarget:self.sliceFilter atTextureLocation:1];
+
+    // The slice pass reads the full resolution frame directly, it only renders once the grid arrives as well
+    self.initialFilters = @[self.splatFilter, self.sliceFilter];
+    self.terminalFilter = self.sliceFilter;
+  }
+  return self;
+}
+
+#pragma mark - Grid sampling
+
+- (NSUInteger)cellSize {
+  return MAX(1, (NSUInteger)round(self.spatialSigmaInPixels / (1.0 + self.quality)));
+}
+
+- (NSUInteger)rangeBins {
+  NSUInteger rangeBins = (NSUInteger)round((1.0 + self.quality) / MAX(self.rangeSigma, 0.01)) + 1;
+  return MIN(MAX(rangeBins, 2), kGPUImageBilateralGridMaximumRangeBins);
+}
+
+- (void)updateGrid {
+  NSUInteger cellSize = [self cellSize];
+  NSUInteger rangeBins = [self rangeBins];
+  if ((cellSize != self.splatFilter.cellSize) || (rangeBins != self.splatFilter.rangeBins)) {
+    [self.splatFilter setCellSize:cellSize rangeBins:rangeBins];
+    [self.blurFilter setRangeBinsAndUpdateProgram:rangeBins];
+    [self.sliceFilter setCellSize:cellSize rangeBins:rangeBins];
+  }
+}
+
+#pragma mark - Accessors
+
+- (void)setSpatialSigmaInPixels:(CGFloat)newValue {
+  _spatialSigmaInPixels = newValue;
+  [self updateGrid];
+}
+
+- (void)setRangeSigma:(CGFloat)newValue {
+  _rangeSigma = newValue;
+  [self updateGrid];
+}
+
+- (void)setQuality:(CGFloat)newValue {
+  _quality = MIN(MAX(newValue, 0.0), 1.0);
+  [self updateGrid];
+}
+
+@end
@@ -45,6 +45,8 @@ NSString *const kGPUImageBrightnessFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     brightnessUniform = [self.filterProgram uniformIndex:@"brightness"];
     self.brightness = 0.0;
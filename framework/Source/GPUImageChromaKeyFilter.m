@@ -73,6 +73,8 @@ NSString *const kGPUImageChromaKeyFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     thresholdSensitivityUniform = [self.filterProgram uniformIndex:@"thresholdSensitivity"];
     smoothingUniform = [self.filterProgram uniformIndex:@"smoothing"];
@@ -38,6 +38,8 @@ NSString *const kGPUImageInvertFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     return self;
 }
@@ -52,6 +52,8 @@ NSString *const kGPUImageColorMatrixFragmentShaderString = SHADER_STRING
     {
         return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     colorMatrixUniform = [self.filterProgram uniformIndex:@"colorMatrix"];
     intensityUniform = [self.filterProgram uniformIndex:@"intensity"];
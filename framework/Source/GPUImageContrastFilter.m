@@ -45,6 +45,8 @@ NSString *const kGPUImageContrastFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     contrastUniform = [self.filterProgram uniformIndex:@"contrast"];
     self.contrast = 1.0;
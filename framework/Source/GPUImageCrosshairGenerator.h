@@ -3,6 +3,7 @@
 @interface GPUImageCrosshairGenerator : GPUImageFilter
 {
     GLint crosshairWidthUniform, crosshairColorUniform;
+    NSData *lastCrosshairCoordinates;
 }
 
 // The width of the displayed crosshairs, in pixels. Currently this only works well for odd widths. The default is 5.
@@ -11,7 +12,7 @@
 // The color of the crosshairs is specified using individual red, green, and blue components (normalized to 1.0). The default is green: (0.0, 1.0, 0.0).
 - (void)setCrosshairColorRed:(GLfloat)redComponent green:(GLfloat)greenComponent blue:(GLfloat)blueComponent;
 
-// Rendering
+// Rendering. With hasStaticContent, set by default, the same crosshairs as last time are passed on without rendering them again
 - (void)renderCrosshairsFromArray:(GLfloat *)crosshairCoordinates count:(NSUInteger)numberOfCrosshairs frameTime:(CMTime)frameTime;
 
 @end
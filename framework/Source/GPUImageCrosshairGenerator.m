@@ -74,6 +74,7 @@ NSString *const kGPUImageCrosshairFragmentShaderString = SHADER_STRING
         crosshairWidthUniform = [self.filterProgram uniformIndex:@"crosshairWidth"];
         crosshairColorUniform = [self.filterProgram uniformIndex:@"crosshairColor"];
         
+        self.hasStaticContent = YES;
         self.crosshairWidth = 5.0f;
         [self setCrosshairColorRed:0.0f green:1.0f blue:0.0f];
     });
@@ -86,7 +87,17 @@ NSString *const kGPUImageCrosshairFragmentShaderString = SHADER_STRING
 
 - (void)renderCrosshairsFromArray:(GLfloat *)crosshairCoordinates count:(NSUInteger)numberOfCrosshairs frameTime:(CMTime)frameTime {
     if (!self.preventRendering) {
+        NSData *coordinates = [NSData dataWithBytes:crosshairCoordinates length:numberOfCrosshairs * 2 * sizeof(GLfloat)];
         runSynchronouslyOnVideoProcessingQueue(^{
+            if (![coordinates isEqualToData:lastCrosshairCoordinates]) {
+                [self invalidateStaticContent];
+                lastCrosshairCoordinates = coordinates;
+            }
+            if ([self reuseStaticContent]) {
+                [self informTargetsAboutNewFrameAtTime:frameTime];
+                return;
+            }
+
             [GPUImageContext setActiveShaderProgram:self.filterProgram];
             self.outputFramebuffer = [[GPUImageContext sharedFramebufferCache] fetchFramebufferForSize:[self sizeOfFBO] textureOptions:self.outputTextureOptions onlyTexture:NO];
             [self.outputFramebuffer activateFramebuffer];
@@ -98,6 +109,7 @@ NSString *const kGPUImageCrosshairFragmentShaderString = SHADER_STRING
 
             glDrawArrays(GL_POINTS, 0, (GLsizei)numberOfCrosshairs);
 
+            [self keepStaticContent];
             [self informTargetsAboutNewFrameAtTime:frameTime];
         });
     }
@@ -0,0 +1,32 @@
+#import "GPUImageFilter.h"
+#import "GPUImageCubeLookupTable.h"
+
+/** Applies a 3D lookup table of any lattice size, typically loaded from a .cube file
+
+ Unlike GPUImageLookupFilter, the table doesn't come as a second input but is uploaded once as a texture, see GPUImageCubeLookupTable for its layout. Lattice points are stored with 16 bits per channel and interpolated in high precision, so 33^3 and 65^3 grading tables keep their smooth gradients instead of snapping to a 64^3 lattice of 8-bit colours. Tetrahedral interpolation reads four lattice points per pixel against eight for trilinear, and matches what grading tools preview.
+ */
+@interface GPUImageCubeLookupFilter : GPUImageFilter
+{
+    GLuint lookupTexture;
+}
+
+/// Swapping the table uploads the new atlas and keeps the shader. A table whose atlas doesn't fit within a texture is logged and ignored, see -setLookupTable:error:
+@property (nonatomic, strong) GPUImageCubeLookupTable *lookupTable;
+
+/// Tetrahedral by default. Changing it switches shaders
+@property (nonatomic, assign) GPUImageLookupInterpolation interpolation;
+
+- (id)initWithLookupTable:(GPUImageCubeLookupTable *)lookupTable;
+/// As below, logging the error and returning nil when the table doesn't fit
+- (id)initWithLookupTable:(GPUImageCubeLookupTable *)lookupTable interpolation:(GPUImageLookupInterpolation)interpolation;
+/** Returns nil when the table's atlas is larger than the maximum texture size of the device
+ @param error Set to NSFileReadTooLargeError in NSCocoaErrorDomain when the table doesn't fit
+ */
+- (id)initWithLookupTable:(GPUImageCubeLookupTable *)lookupTable interpolation:(GPUImageLookupInterpolation)interpolation error:(NSError **)error;
+
+/** Uploads the table, or leaves the current one in place when its atlas is larger than the maximum texture size of the device
+ @param error Set to NSFileReadTooLargeError in NSCocoaErrorDomain when the table doesn't fit
+ */
+- (BOOL)setLookupTable:(GPUImageCubeLookupTable *)lookupTable error:(NSError **)error;
+
+@end
@@ -0,0 +1,227 @@
+#import "GPUImageCubeLookupFilter.h"
+
+// Lattice coordinates run up to the lattice size and need their fraction intact
+#if TARGET_IPHONE_SIMULATOR || TARGET_OS_IPHONE
+static NSString *const kGPUImageCubeLookupShaderPrecision = @"precision highp float;\n";
+#else
+static NSString *const kGPUImageCubeLookupShaderPrecision = @"";
+#endif
+
+// Shared by both interpolations: decodes a lattice point, or the bilinear blend of four, from the two halves of the atlas
+NSString *const kGPUImageCubeLookupSamplingShaderString = SHADER_STRING
+(
+ varying vec2 textureCoordinate;
+
+ uniform sampler2D inputImageTexture;
+ uniform sampler2D lookupTexture;
+
+ uniform float latticeSize;
+ uniform float slicesPerRow;
+ uniform vec2 atlasTexelSize;
+ uniform vec3 domainMin;
+ uniform vec3 domainScale;
+
+ vec3 latticeColor(float blue, vec2 redGreen)
+ {
+     float sliceRow = floor((blue + 0.5) / slicesPerRow);
+     vec2 slicePosition = vec2(blue - sliceRow * slicesPerRow, sliceRow) * latticeSize;
+     vec2 coordinate = (slicePosition + redGreen + 0.5) * atlasTexelSize;
+     vec3 highBytes = texture2D(lookupTexture, coordinate).rgb;
+     vec3 lowBytes = texture2D(lookupTexture, coordinate + vec2(0.0, 0.5)).rgb;
+     return (highBytes * 65280.0 + lowBytes * 255.0) / 65535.0;
+ }
+
+ vec3 latticePosition(vec3 color)
+ {
+     return clamp((color - domainMin) * domainScale, 0.0, latticeSize - 1.0);
+ }
+);
+
+// Filtering within the slices is linear, so it applies to the high and low bytes separately
+NSString *const kGPUImageCubeLookupTrilinearFragmentShaderString = SHADER_STRING
+(
+ void main()
+ {
+     vec4 color = texture2D(inputImageTexture, textureCoordinate);
+     vec3 lattice = latticePosition(color.rgb);
+
+     float lowerBlue = floor(lattice.b);
+     vec3 lower = latticeColor(lowerBlue, lattice.rg);
+     vec3 upper = latticeColor(min(lowerBlue + 1.0, latticeSize - 1.0), lattice.rg);
+     gl_FragColor = vec4(mix(lower, upper, lattice.b - lowerBlue), color.a);
+ }
+);
+
+// The cell is split along its grey diagonal, the tetrahedron holding the colour is given by the order of its fractions
+NSString *const kGPUImageCubeLookupTetrahedralFragmentShaderString = SHADER_STRING
+(
+ void main()
+ {
+     vec4 color = texture2D(inputImageTexture, textureCoordinate);
+     vec3 lattice = latticePosition(color.rgb);
+
+     vec3 base = min(floor(lattice), latticeSize - 2.0);
+     vec3 fraction = lattice - base;
+
+     vec3 firstStep;
+     vec3 secondStep;
+     vec3 weights;
+     if (fraction.r >= fraction.g) {
+         if (fraction.g >= fraction.b) {
+             firstStep = vec3(1.0, 0.0, 0.0);
+             secondStep = vec3(1.0, 1.0, 0.0);
+             weights = fraction.rgb;
+         } else if (fraction.r >= fraction.b) {
+             firstStep = vec3(1.0, 0.0, 0.0);
+             secondStep = vec3(1.0, 0.0, 1.0);
+             weights = fraction.rbg;
+         } else {
+             firstStep = vec3(0.0, 0.0, 1.0);
+             secondStep = vec3(1.0, 0.0, 1.0);
+             weights = fraction.brg;
+         }
+     } else {
+         if (fraction.b >= fraction.g) {
+             firstStep = vec3(0.0, 0.0, 1.0);
+             secondStep = vec3(0.0, 1.0, 1.0);
+             weights = fraction.bgr;
+         } else if (fraction.b >= fraction.r) {
+             firstStep = vec3(0.0, 1.0, 0.0);
+             secondStep = vec3(0.0, 1.0, 1.0);
+             weights = fraction.gbr;
+         } else {
+             firstStep = vec3(0.0, 1.0, 0.0);
+             secondStep = vec3(1.0, 1.0, 0.0);
+             weights = fraction.grb;
+         }
+     }
+
+     vec3 corner000 = latticeColor(base.b, base.rg);
+     vec3 firstCorner = latticeColor(base.b + firstStep.b, base.rg + firstStep.rg);
+     vec3 secondCorner = latticeColor(base.b + secondStep.b, base.rg + secondStep.rg);
+     vec3 corner111 = latticeColor(base.b + 1.0, base.rg + 1.0);
+
+     vec3 result = corner000 * (1.0 - weights.x) + firstCorner * (weights.x - weights.y) + secondCorner * (weights.y - weights.z) + corner111 * weights.z;
+     gl_FragColor = vec4(result, color.a);
+ }
+);
+
+static NSString *cubeLookupFragmentShader(GPUImageLookupInterpolation interpolation) {
+  NSString *mainString = (interpolation == kGPUImageLookupInterpolationTetrahedral) ? kGPUImageCubeLookupTetrahedralFragmentShaderString : kGPUImageCubeLookupTrilinearFragmentShaderString;
+  return [NSString stringWithFormat:@"%@%@\n%@", kGPUImageCubeLookupShaderPrecision, kGPUImageCubeLookupSamplingShaderString, mainString];
+}
+
+@implementation GPUImageCubeLookupFilter
+
+#pragma mark - Initialization and teardown
+
+- (id)initWithLookupTable:(GPUImageCubeLookupTable *)lookupTable {
+  return [self initWithLookupTable:lookupTable interpolation:kGPUImageLookupInterpolationTetrahedral];
+}
+
+- (id)initWithLookupTable:(GPUImageCubeLookupTable *)lookupTable interpolation:(GPUImageLookupInterpolation)interpolation {
+  NSError *error = nil;
+  self = [self initWithLookupTable:lookupTable interpolation:interpolation error:&error];
+  if (self == nil) {
+    NSLog(@"Couldn't create the lookup filter: %@", [error localizedFailureReason]);
+  }
+  return self;
+}
+
+- (id)initWithLookupTable:(GPUImageCubeLookupTable *)lookupTable interpolation:(GPUImageLookupInterpolation)interpolation error:(NSError **)error {
+  NSParameterAssert(lookupTable != nil);
+  if (!(self = [super initWithFragmentShaderFromString:cubeLookupFragmentShader(interpolation)])) {
+    return nil;
+  }
+
+  _interpolation = interpolation;
+  self.samplingFootprint = CGSizeZero;
+  if (![self setLookupTable:lookupTable error:error]) {
+    return nil;
+  }
+
+  return self;
+}
+
+- (void)dealloc {
+  GLuint texture = lookupTexture;
+  if (texture != 0) {
+    runSynchronouslyOnVideoProcessingQueue(^{
+      [GPUImageContext useImageProcessingContext];
+      GLuint deletedTexture = texture;
+      glDeleteTextures(1, &deletedTexture);
+    });
+  }
+}
+
+#pragma mark - Lookup table
+
+- (void)updateLookupUniforms {
+  GPUImageCubeLookupTable *table = self.lookupTable;
+  GLfloat latticeSteps = table.latticeSize - 1;
+
+  [self setInteger:3 forUniformName:@"lookupTexture"];
+  [self setFloat:table.latticeSize forUniformName:@"latticeSize"];
+  [self setFloat:table.slicesPerRow forUniformName:@"slicesPerRow"];
+  [self setSize:CGSizeMake(1.0 / table.atlasSize.width, 1.0 / table.atlasSize.height) forUniformName:@"atlasTexelSize"];
+  [self setFloatVec3:table.domainMin forUniformName:@"domainMin"];
+  [self setFloatVec3:(GPUVector3){latticeSteps / (table.domainMax.one - table.domainMin.one), latticeSteps / (table.domainMax.two - table.domainMin.two), latticeSteps / (table.domainMax.three - table.domainMin.three)} forUniformName:@"domainScale"];
+}
+
+- (void)setLookupTable:(GPUImageCubeLookupTable *)lookupTable {
+  NSError *error = nil;
+  if (![self setLookupTable:lookupTable error:&error]) {
+    NSLog(@"Keeping the previous lookup table: %@", [error localizedFailureReason]);
+  }
+}
+
+- (BOOL)setLookupTable:(GPUImageCubeLookupTable *)lookupTable error:(NSError **)error {
+  NSParameterAssert(lookupTable != nil);
+  CGSize atlasSize = lookupTable.atlasSize;
+  GLint maximumTextureSize = [GPUImageContext maximumTextureSizeForThisDevice];
+  if ((atlasSize.width > maximumTextureSize) || (atlasSize.height > maximumTextureSize)) {
+    if (error != NULL) {
+      NSString *failureReason = [NSString stringWithFormat:@"The %lu^3 table needs a %.0fx%.0f atlas, larger than the %d texel textures of this device", (unsigned long)lookupTable.latticeSize, atlasSize.width, atlasSize.height, maximumTextureSize];
+      *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadTooLargeError userInfo:@{NSLocalizedFailureReasonErrorKey: failureReason}];
+    }
+    return NO;
+  }
+  _lookupTable = lookupTable;
+
+  NSData *atlasBytes = lookupTable.atlasBytes;
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [GPUImageContext useImageProcessingContext];
+    if (lookupTexture == 0) {
+      glGenTextures(1, &lookupTexture);
+    }
+    glBindTexture(GL_TEXTURE_2D, lookupTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, (GLsizei)atlasSize.width, (GLsizei)atlasSize.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, [atlasBytes bytes]);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  });
+
+  [self updateLookupUniforms];
+  return YES;
+}
+
+- (void)setInterpolation:(GPUImageLookupInterpolation)interpolation {
+  if (interpolation == _interpolation) {
+    return;
+  }
+  _interpolation = interpolation;
+  [self switchToVertexShader:kGPUImageVertexShaderString fragmentShader:cubeLookupFragmentShader(interpolation)];
+  [self updateLookupUniforms];
+}
+
+#pragma mark - Rendering
+
+- (void)render {
+  glActiveTexture(GL_TEXTURE3);
+  glBindTexture(GL_TEXTURE_2D, lookupTexture);
+  [super render];
+}
+
+@end
@@ -0,0 +1,65 @@
+#import "GPUImageSupport.h"
+
+typedef NS_ENUM(NSUInteger, GPUImageLookupInterpolation) {
+    /// Bilinear within the two nearest blue slices, then linear between them. Eight lattice points per pixel
+    kGPUImageLookupInterpolationTrilinear,
+    /// Splits each lattice cell into six tetrahedra along its grey diagonal and blends four lattice points. Keeps neutral colours neutral, as colour grading tools do
+    kGPUImageLookupInterpolationTetrahedral
+};
+
+/** A 3D colour lookup table, as exported by grading tools in the .cube format
+
+ The lattice is kept in float for -colorForColor:interpolation:, the CPU reference of GPUImageCubeLookupFilter. OpenGL ES 2 has no 3D textures, so the filter reads the table from a 2D atlas: the blue slices are laid out slicesPerRow to a row, each slice holding red along x and green along y. Every channel is stored with 16 bits, the high bytes in the top half of the atlas and the low bytes in the bottom half.
+
+ Tables loaded through +lookupTableWithContentsOfURL:error: are shared until the file changes, so filters using the same .cube file only parse it once.
+ */
+@interface GPUImageCubeLookupTable : NSObject
+
+/// Lattice points along each channel, typically 17, 33 or 65
+@property (nonatomic, assign, readonly) NSUInteger latticeSize;
+
+@property (nonatomic, copy, readonly) NSString *title;
+
+/// Input colours mapped to the first and last lattice points, 0 and 1 unless the file says otherwise
+@property (nonatomic, assign, readonly) GPUVector3 domainMin;
+@property (nonatomic, assign, readonly) GPUVector3 domainMax;
+
+/// latticeSize^3 RGB triplets of GLfloat, red changing fastest, then green, then blue
+@property (nonatomic, strong, readonly) NSData *latticeValues;
+
+/// Blue slices per row of the atlas
+@property (nonatomic, assign, readonly) NSUInteger slicesPerRow;
+
+/// Size of the atlas texture in pixels, both halves included
+@property (nonatomic, assign, readonly) CGSize atlasSize;
+
+/// RGBA bytes of the atlas, row by row from texture coordinate 0. Built on first use
+@property (nonatomic, strong, readonly) NSData *atlasBytes;
+
+/** Load a .cube file, or return the table already loaded from it if the file hasn't changed since
+ @param error Set to an NSCocoaErrorDomain error if the file can't be read or isn't a valid 3D table
+ */
++ (instancetype)lookupTableWithContentsOfURL:(NSURL *)url error:(NSError **)error;
+
+/** Parse the text of a .cube file
+ @param error Set to NSFileReadCorruptFileError in NSCocoaErrorDomain for 1D tables, a LUT_3D_SIZE outside 2...129, unknown or malformed lines, or a number of lattice points not matching LUT_3D_SIZE
+ */
+- (id)initWithCubeData:(NSData *)data error:(NSError **)error;
+
+/** Wrap lattice values computed elsewhere
+ @param values latticeSize^3 RGB triplets of GLfloat, red changing fastest
+ */
+- (id)initWithLatticeSize:(NSUInteger)latticeSize values:(NSData *)values;
+
+/** Convert a 512x512 table laid out for GPUImageLookupFilter into its 64^3 lattice, to compare both filters on the same table
+ @param bytes RGBA, rows of 512 * 4 bytes
+ */
+- (id)initWithLookupImageBytes:(const GLubyte *)bytes;
+
+/// The colour the table maps an RGB colour to, computed in float as GPUImageCubeLookupFilter does on the GPU
+- (GPUVector3)colorForColor:(GPUVector3)color interpolation:(GPUImageLookupInterpolation)interpolation;
+
+/// Apply the table to RGBA pixels on the CPU, alpha passing through
+- (void)applyToPixels:(const GLubyte *)sourcePixels destinationPixels:(GLubyte *)destinationPixels count:(NSUInteger)pixelCount interpolation:(GPUImageLookupInterpolation)interpolation;
+
+@end
@@ -0,0 +1,363 @@
+#import "GPUImageCubeLookupTable.h"
+
+// Largest lattice accepted from a file, the largest grading tools export. Its 1548x2838 atlas fits the 4096 texel textures of most iOS GPUs
+static const NSUInteger kGPUImageCubeMaximumLatticeSize = 129;
+
+// Layout of the 512x512 tables GPUImageLookupFilter reads
+static const NSUInteger kGPUImageLookupImageSize = 512;
+static const NSUInteger kGPUImageLookupImageLatticeSize = 64;
+
+static NSError *cubeFileError(NSUInteger lineNumber, NSString *reason) {
+  NSString *failureReason = [NSString stringWithFormat:@"Line %lu: %@", (unsigned long)lineNumber, reason];
+  return [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadCorruptFileError userInfo:@{NSLocalizedFailureReasonErrorKey: failureReason}];
+}
+
+static const char *skipBlanks(const char *cursor) {
+  while (*cursor == ' ' || *cursor == '\t' || *cursor == '\r') {
+    cursor++;
+  }
+  return cursor;
+}
+
+// Whether the line starts with the keyword followed by a blank, moving past both
+static BOOL scanKeyword(const char **cursor, const char *keyword) {
+  size_t length = strlen(keyword);
+  if (strncmp(*cursor, keyword, length) != 0 || ((*cursor)[length] != ' ' && (*cursor)[length] != '\t')) {
+    return NO;
+  }
+  *cursor = skipBlanks(*cursor + length);
+  return YES;
+}
+
+// Reads count floats separated by blanks, and nothing else up to the end of the line
+static BOOL scanFloats(const char *cursor, const char *lineEnd, GLfloat *values, NSUInteger count) {
+  for (NSUInteger index = 0; index < count; index++) {
+    char *end;
+    values[index] = strtof(cursor, &end);
+    if (end == cursor) {
+      return NO;
+    }
+    cursor = skipBlanks(end);
+  }
+  return cursor == lineEnd;
+}
+
+static const GLfloat *latticePoint(const GLfloat *values, NSUInteger latticeSize, NSUInteger red, NSUInteger green, NSUInteger blue) {
+  return values + ((blue * latticeSize + green) * latticeSize + red) * 3;
+}
+
+@interface GPUImageCubeLookupTable()
+
+@property (nonatomic, assign, readwrite) NSUInteger latticeSize;
+@property (nonatomic, copy, readwrite) NSString *title;
+@property (nonatomic, assign, readwrite) GPUVector3 domainMin;
+@property (nonatomic, assign, readwrite) GPUVector3 domainMax;
+@property (nonatomic, strong, readwrite) NSData *latticeValues;
+@property (nonatomic, strong, readwrite) NSData *atlasBytes;
+
+@end
+
+@implementation GPUImageCubeLookupTable
+
+#pragma mark - Initialization and teardown
+
++ (instancetype)lookupTableWithContentsOfURL:(NSURL *)url error:(NSError **)error {
+  static dispatch_once_t pred;
+  static NSCache *lookupTableCache = nil;
+  dispatch_once(&pred, ^{
+    lookupTableCache = [[NSCache alloc] init];
+  });
+
+  NSDate *modificationDate = nil;
+  if (![url getResourceValue:&modificationDate forKey:NSURLContentModificationDateKey error:error]) {
+    return nil;
+  }
+  NSString *key = [NSString stringWithFormat:@"%@:%f", [url path], [modificationDate timeIntervalSinceReferenceDate]];
+  GPUImageCubeLookupTable *cachedTable = [lookupTableCache objectForKey:key];
+  if (cachedTable != nil) {
+    return cachedTable;
+  }
+
+  NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedIfSafe error:error];
+  if (data == nil) {
+    return nil;
+  }
+  GPUImageCubeLookupTable *table = [[self alloc] initWithCubeData:data error:error];
+  if (table != nil) {
+    [lookupTableCache setObject:table forKey:key cost:[table.latticeValues length]];
+  }
+  return table;
+}
+
+- (id)initWithLatticeSize:(NSUInteger)latticeSize values:(NSData *)values {
+  NSParameterAssert(latticeSize >= 2);
+  NSParameterAssert([values length] == latticeSize * latticeSize * latticeSize * 3 * sizeof(GLfloat));
+  if (!(self = [super init])) {
+    return nil;
+  }
+
+  _latticeSize = latticeSize;
+  _latticeValues = [values copy];
+  _domainMin = (GPUVector3){0.0, 0.0, 0.0};
+  _domainMax = (GPUVector3){1.0, 1.0, 1.0};
+  _slicesPerRow = (NSUInteger)ceil(sqrt((double)latticeSize));
+  NSUInteger sliceRows = (latticeSize + _slicesPerRow - 1) / _slicesPerRow;
+  _atlasSize = CGSizeMake(latticeSize * _slicesPerRow, latticeSize * sliceRows * 2);
+
+  return self;
+}
+
+- (id)initWithCubeData:(NSData *)data error:(NSError **)error {
+  // strtof needs the text NUL terminated, which mapped file data isn't
+  NSMutableData *text = [NSMutableData dataWithCapacity:[data length] + 1];
+  [text appendData:data];
+  [text appendBytes:"" length:1];
+
+  NSUInteger latticeSize = 0;
+  NSMutableData *values = nil;
+  NSUInteger valueCount = 0;
+  NSString *title = nil;
+  GPUVector3 domainMin = {0.0, 0.0, 0.0};
+  GPUVector3 domainMax = {1.0, 1.0, 1.0};
+  NSError *parseError = nil;
+
+  const char *line = [text bytes];
+  const char *textEnd = line + [data length];
+  NSUInteger lineNumber = 0;
+  while (line < textEnd && parseError == nil) {
+    lineNumber++;
+    const char *lineEnd = memchr(line, '\n', textEnd - line);
+    if (lineEnd == NULL) {
+      lineEnd = textEnd;
+    }
+    const char *nextLine = lineEnd + 1;
+    // Trailing blanks, and the \r of Windows line endings
+    while (lineEnd > line && (lineEnd[-1] == ' ' || lineEnd[-1] == '\t' || lineEnd[-1] == '\r')) {
+      lineEnd--;
+    }
+    const char *cursor = skipBlanks(line);
+    line = nextLine;
+
+    if (cursor >= lineEnd || *cursor == '#') {
+      continue;
+    }
+
+    // Lattice points make up nearly all of the file, so they are checked for first
+    if ((*cursor >= '0' && *cursor <= '9') || *cursor == '-' || *cursor == '+' || *cursor == '.') {
+      if (values == nil) {
+        parseError = cubeFileError(lineNumber, @"Lattice point before LUT_3D_SIZE");
+      } else if (valueCount == latticeSize * latticeSize * latticeSize) {
+        parseError = cubeFileError(lineNumber, @"More lattice points than LUT_3D_SIZE allows");
+      } else if (!scanFloats(cursor, lineEnd, (GLfloat *)[values mutableBytes] + valueCount * 3, 3)) {
+        parseError = cubeFileError(lineNumber, @"Malformed lattice point");
+      } else {
+        valueCount++;
+      }
+      continue;
+    }
+
+    GLfloat range[3];
+    if (scanKeyword(&cursor, "LUT_3D_SIZE")) {
+      char *end;
+      long size = strtol(cursor, &end, 10);
+      if (values != nil || end == cursor || skipBlanks(end) != lineEnd || size < 2 || size > (long)kGPUImageCubeMaximumLatticeSize) {
+        parseError = cubeFileError(lineNumber, @"Invalid LUT_3D_SIZE");
+      } else {
+        latticeSize = (NSUInteger)size;
+        values = [NSMutableData dataWithLength:latticeSize * latticeSize * latticeSize * 3 * sizeof(GLfloat)];
+      }
+    } else if (scanKeyword(&cursor, "LUT_1D_SIZE")) {
+      parseError = cubeFileError(lineNumber, @"1D tables aren't supported");
+    } else if (scanKeyword(&cursor, "TITLE")) {
+      const char *titleStart = (*cursor == '"') ? cursor + 1 : cursor;
+      const char *titleEnd = (lineEnd > titleStart && lineEnd[-1] == '"') ? lineEnd - 1 : lineEnd;
+      title = [[NSString alloc] initWithBytes:titleStart length:titleEnd - titleStart encoding:NSUTF8StringEncoding];
+    } else if (scanKeyword(&cursor, "DOMAIN_MIN")) {
+      if (!scanFloats(cursor, lineEnd, range, 3)) {
+        parseError = cubeFileError(lineNumber, @"Malformed DOMAIN_MIN");
+      }
+      domainMin = (GPUVector3){range[0], range[1], range[2]};
+    } else if (scanKeyword(&cursor, "DOMAIN_MAX")) {
+      if (!scanFloats(cursor, lineEnd, range, 3)) {
+        parseError = cubeFileError(lineNumber, @"Malformed DOMAIN_MAX");
+      }
+      domainMax = (GPUVector3){range[0], range[1], range[2]};
+    } else if (scanKeyword(&cursor, "LUT_3D_INPUT_RANGE")) {
+      // Resolve's variant of the domain, the same range for all channels
+      if (!scanFloats(cursor, lineEnd, range, 2)) {
+        parseError = cubeFileError(lineNumber, @"Malformed LUT_3D_INPUT_RANGE");
+      }
+      domainMin = (GPUVector3){range[0], range[0], range[0]};
+      domainMax = (GPUVector3){range[1], range[1], range[1]};
+    } else {
+      parseError = cubeFileError(lineNumber, @"Unknown keyword");
+    }
+  }
+
+  if (parseError == nil && values == nil) {
+    parseError = cubeFileError(lineNumber, @"Missing LUT_3D_SIZE");
+  }
+  if (parseError == nil && valueCount != latticeSize * latticeSize * latticeSize) {
+    parseError = cubeFileError(lineNumber, [NSString stringWithFormat:@"%lu lattice points instead of %lu", (unsigned long)valueCount, (unsigned long)(latticeSize * latticeSize * latticeSize)]);
+  }
+  if (parseError == nil && (domainMax.one <= domainMin.one || domainMax.two <= domainMin.two || domainMax.three <= domainMin.three)) {
+    parseError = cubeFileError(lineNumber, @"Empty domain");
+  }
+  if (parseError != nil) {
+    if (error != NULL) {
+      *error = parseError;
+    }
+    return nil;
+  }
+
+  if (!(self = [self initWithLatticeSize:latticeSize values:values])) {
+    return nil;
+  }
+
+  _title = [title copy];
+  _domainMin = domainMin;
+  _domainMax = domainMax;
+
+  return self;
+}
+
+- (id)initWithLookupImageBytes:(const GLubyte *)bytes {
+  NSUInteger latticeSize = kGPUImageLookupImageLatticeSize;
+  NSUInteger squaresPerRow = kGPUImageLookupImageSize / latticeSize;
+  NSMutableData *values = [NSMutableData dataWithLength:latticeSize * latticeSize * latticeSize * 3 * sizeof(GLfloat)];
+  GLfloat *value = [values mutableBytes];
+
+  for (NSUInteger blue = 0; blue < latticeSize; blue++) {
+    NSUInteger squareX = (blue % squaresPerRow) * latticeSize;
+    NSUInteger squareY = (blue / squaresPerRow) * latticeSize;
+    for (NSUInteger green = 0; green < latticeSize; green++) {
+      const GLubyte *pixel = bytes + ((squareY + green) * kGPUImageLookupImageSize + squareX) * 4;
+      for (NSUInteger red = 0; red < latticeSize; red++) {
+        value[0] = pixel[0] / 255.0;
+        value[1] = pixel[1] / 255.0;
+        value[2] = pixel[2] / 255.0;
+        value += 3;
+        pixel += 4;
+      }
+    }
+  }
+
+  return [self initWithLatticeSize:latticeSize values:values];
+}
+
+#pragma mark - Atlas
+
+- (NSData *)atlasBytes {
+  @synchronized(self) {
+    if (_atlasBytes != nil) {
+      return _atlasBytes;
+    }
+
+    NSUInteger width = (NSUInteger)self.atlasSize.width;
+    NSUInteger halfHeight = (NSUInteger)self.atlasSize.height / 2;
+    NSMutableData *atlas = [NSMutableData dataWithLength:width * halfHeight * 2 * 4];
+    GLubyte *highBytes = [atlas mutableBytes];
+    GLubyte *lowBytes = highBytes + width * halfHeight * 4;
+    const GLfloat *values = [self.latticeValues bytes];
+    NSUInteger latticeSize = self.latticeSize;
+
+    // Unused slices at the end of the last row stay transparent black, they are never sampled
+    for (NSUInteger blue = 0; blue < latticeSize; blue++) {
+      NSUInteger sliceX = (blue % self.slicesPerRow) * latticeSize;
+      NSUInteger sliceY = (blue / self.slicesPerRow) * latticeSize;
+      for (NSUInteger green = 0; green < latticeSize; green++) {
+        NSUInteger offset = ((sliceY + green) * width + sliceX) * 4;
+        const GLfloat *value = latticePoint(values, latticeSize, 0, green, blue);
+        for (NSUInteger red = 0; red < latticeSize; red++) {
+          for (NSUInteger channel = 0; channel < 3; channel++) {
+            NSUInteger encoded = (NSUInteger)lroundf(MIN(MAX(value[channel], 0.0f), 1.0f) * 65535.0f);
+            highBytes[offset + channel] = (GLubyte)(encoded >> 8);
+            lowBytes[offset + channel] = (GLubyte)(encoded & 0xFF);
+          }
+          highBytes[offset + 3] = 255;
+          lowBytes[offset + 3] = 255;
+          value += 3;
+          offset += 4;
+        }
+      }
+    }
+
+    _atlasBytes = atlas;
+    return _atlasBytes;
+  }
+}
+
+#pragma mark - Lookup on the CPU
+
+- (GPUVector3)colorForColor:(GPUVector3)color interpolation:(GPUImageLookupInterpolation)interpolation {
+  NSUInteger latticeSize = self.latticeSize;
+  const GLfloat *values = [self.latticeValues bytes];
+  GLfloat input[3] = {color.one, color.two, color.three};
+  GLfloat minimum[3] = {self.domainMin.one, self.domainMin.two, self.domainMin.three};
+  GLfloat maximum[3] = {self.domainMax.one, self.domainMax.two, self.domainMax.three};
+
+  // Lower corner of the lattice cell, and the position within it. The last cell takes the upper edge
+  NSUInteger base[3];
+  GLfloat fraction[3];
+  for (NSUInteger channel = 0; channel < 3; channel++) {
+    GLfloat lattice = (input[channel] - minimum[channel]) / (maximum[channel] - minimum[channel]) * (latticeSize - 1);
+    lattice = MIN(MAX(lattice, 0.0f), (GLfloat)(latticeSize - 1));
+    base[channel] = MIN((NSUInteger)lattice, latticeSize - 2);
+    fraction[channel] = lattice - base[channel];
+  }
+
+  GLfloat result[3] = {0.0, 0.0, 0.0};
+  if (interpolation == kGPUImageLookupInterpolationTetrahedral) {
+    // Walk from the lower corner to the upper one along the channels in decreasing order of their fraction
+    NSUInteger order[3] = {0, 1, 2};
+    for (NSUInteger first = 0; first < 2; first++) {
+      for (NSUInteger second = first + 1; second < 3; second++) {
+        if (fraction[order[second]] > fraction[order[first]]) {
+          NSUInteger swapped = order[first];
+          order[first] = order[second];
+          order[second] = swapped;
+        }
+      }
+    }
+
+    NSUInteger corner[3] = {base[0], base[1], base[2]};
+    GLfloat previousFraction = 1.0;
+    for (NSUInteger step = 0; step <= 3; step++) {
+      GLfloat stepFraction = (step < 3) ? fraction[order[step]] : 0.0f;
+      const GLfloat *value = latticePoint(values, latticeSize, corner[0], corner[1], corner[2]);
+      for (NSUInteger channel = 0; channel < 3; channel++) {
+        result[channel] += value[channel] * (previousFraction - stepFraction);
+      }
+      if (step < 3) {
+        corner[order[step]]++;
+      }
+      previousFraction = stepFraction;
+    }
+  } else {
+    for (NSUInteger corner = 0; corner < 8; corner++) {
+      NSUInteger red = corner & 1, green = (corner >> 1) & 1, blue = (corner >> 2) & 1;
+      GLfloat weight = (red ? fraction[0] : 1.0f - fraction[0]) * (green ? fraction[1] : 1.0f - fraction[1]) * (blue ? fraction[2] : 1.0f - fraction[2]);
+      const GLfloat *value = latticePoint(values, latticeSize, base[0] + red, base[1] + green, base[2] + blue);
+      for (NSUInteger channel = 0; channel < 3; channel++) {
+        result[channel] += value[channel] * weight;
+      }
+    }
+  }
+
+  return (GPUVector3){result[0], result[1], result[2]};
+}
+
+- (void)applyToPixels:(const GLubyte *)sourcePixels destinationPixels:(GLubyte *)destinationPixels count:(NSUInteger)pixelCount interpolation:(GPUImageLookupInterpolation)interpolation {
+  for (NSUInteger pixel = 0; pixel < pixelCount; pixel++) {
+    const GLubyte *source = sourcePixels + pixel * 4;
+    GLubyte *destination = destinationPixels + pixel * 4;
+
+    GPUVector3 color = [self colorForColor:(GPUVector3){source[0] / 255.0f, source[1] / 255.0f, source[2] / 255.0f} interpolation:interpolation];
+    destination[0] = (GLubyte)lroundf(MIN(MAX(color.one, 0.0f), 1.0f) * 255.0f);
+    destination[1] = (GLubyte)lroundf(MIN(MAX(color.two, 0.0f), 1.0f) * 255.0f);
+    destination[2] = (GLubyte)lroundf(MIN(MAX(color.three, 0.0f), 1.0f) * 255.0f);
+    destination[3] = source[3];
+  }
+}
+
+@end
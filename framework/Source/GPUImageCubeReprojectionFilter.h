@@ -0,0 +1,26 @@
+#import "GPUImageFilter.h"
+#import "GPUImageSphericalProjection.h"
+
+typedef NS_ENUM(NSUInteger, GPUImageCubeReprojection) {
+    /// Equirectangular input to a cube atlas with faces a quarter of the input width
+    kGPUImageEquirectangularToCubeAtlas,
+    /// Cube atlas input to an equirectangular image four faces wide
+    kGPUImageCubeAtlasToEquirectangular
+};
+
+/** Converts 360 degree content between the equirectangular and cube atlas layouts, see GPUImageSphericalProjection.h for both
+
+ The conversion is fixed for a given pair of sizes, so it is computed once on the CPU into a lookup texture holding a 16-bit input coordinate for every output pixel. Lookup tables are shared by every filter converting between the same sizes, and each frame costs a single draw with one dependent texture read per pixel.
+ */
+@interface GPUImageCubeReprojectionFilter : GPUImageFilter
+{
+    GLint lookupTextureUniform;
+    GLuint lookupTexture;
+    GLuint lookupVertexBuffer;
+}
+
+@property (nonatomic, assign) GPUImageCubeReprojection reprojection;
+
+- (id)initWithReprojection:(GPUImageCubeReprojection)reprojection;
+
+@end
@@ -0,0 +1,214 @@
+#import "GPUImageCubeReprojectionFilter.h"
+
+#if TARGET_IPHONE_SIMULATOR || TARGET_OS_IPHONE
+NSString *const kGPUImageCubeReprojectionShaderPrecision = @"precision highp float;\n";
+#else
+NSString *const kGPUImageCubeReprojectionShaderPrecision = @"";
+#endif
+
+// lookupTexture holds the input coordinate for each output pixel, x in red and green, y in blue and alpha, 16 bits each
+NSString *const kGPUImageCubeReprojectionFragmentShaderString = SHADER_STRING
+(
+ varying vec2 textureCoordinate;
+
+ uniform sampler2D inputImageTexture;
+ uniform sampler2D lookupTexture;
+
+ void main()
+ {
+     vec4 encodedCoordinate = texture2D(lookupTexture, textureCoordinate);
+     vec2 coordinate = vec2(dot(encodedCoordinate.rg, vec2(65280.0, 255.0)), dot(encodedCoordinate.ba, vec2(65280.0, 255.0))) / 65535.0;
+     gl_FragColor = texture2D(inputImageTexture, coordinate);
+ }
+);
+
+static CGSize cubeReprojectionOutputSize(GPUImageCubeReprojection reprojection, CGSize inputSize) {
+  switch (reprojection) {
+    case kGPUImageEquirectangularToCubeAtlas: {
+      CGFloat faceSize = MAX(round(inputSize.width / 4.0), 1.0);
+      return CGSizeMake(faceSize * kGPUImageCubeAtlasColumns, faceSize * kGPUImageCubeAtlasRows);
+    }
+    case kGPUImageCubeAtlasToEquirectangular: {
+      CGFloat faceSize = MAX(round(inputSize.width / kGPUImageCubeAtlasColumns), 1.0);
+      return CGSizeMake(faceSize * 4.0, faceSize * 2.0);
+    }
+  }
+}
+
+static CGPoint cubeReprojectionInputPoint(GPUImageCubeReprojection reprojection, CGPoint outputPoint, CGSize inputSize) {
+  switch (reprojection) {
+    case kGPUImageEquirectangularToCubeAtlas: {
+      NSUInteger column = MIN((NSUInteger)(outputPoint.x * kGPUImageCubeAtlasColumns), kGPUImageCubeAtlasColumns - 1);
+      NSUInteger row = MIN((NSUInteger)(outputPoint.y * kGPUImageCubeAtlasRows), kGPUImageCubeAtlasRows - 1);
+      GPUImageCubeFace face = row * kGPUImageCubeAtlasColumns + column;
+      CGRect faceRect = GPUImageCubeAtlasRectForFace(face);
+      CGPoint facePoint = CGPointMake((outputPoint.x - faceRect.origin.x) / faceRect.size.width, (outputPoint.y - faceRect.origin.y) / faceRect.size.height);
+      return GPUImageEquirectangularPointForSphericalDirection(GPUImageSphericalDirectionForCubeFacePoint(face, facePoint));
+    }
+    case kGPUImageCubeAtlasToEquirectangular: {
+      GPUImageCubeFace face;
+      CGPoint facePoint = GPUImageCubeFacePointForSphericalDirection(GPUImageSphericalDirectionForEquirectangularPoint(outputPoint), &face);
+      CGRect faceRect = GPUImageCubeAtlasRectForFace(face);
+
+      // Stay half a texel inside the face, so that filtering doesn't bleed in the neighbouring face of the atlas
+      CGFloat insetX = 0.5 / (inputSize.width * faceRect.size.width);
+      CGFloat insetY = 0.5 / (inputSize.height * faceRect.size.height);
+      facePoint.x = MIN(MAX(facePoint.x, insetX), 1.0 - insetX);
+      facePoint.y = MIN(MAX(facePoint.y, insetY), 1.0 - insetY);
+      return CGPointMake(faceRect.origin.x + facePoint.x * faceRect.size.width, faceRect.origin.y + facePoint.y * faceRect.size.height);
+    }
+  }
+}
+
+// RGBA texels, one per output pixel. Shared by every filter converting between the same sizes
+static NSData *cubeReprojectionLookupTable(GPUImageCubeReprojection reprojection, CGSize inputSize, CGSize outputSize, GPUImageRotationMode rotation) {
+  static dispatch_once_t pred;
+  static NSCache *lookupTableCache = nil;
+  dispatch_once(&pred, ^{
+    lookupTableCache = [[NSCache alloc] init];
+  });
+
+  NSString *key = [NSString stringWithFormat:@"%lu:%.0fx%.0f:%.0fx%.0f:%lu", (unsigned long)reprojection, inputSize.width, inputSize.height, outputSize.width, outputSize.height, (unsigned long)rotation];
+  NSData *cachedTable = [lookupTableCache objectForKey:key];
+  if (cachedTable != nil) {
+    return cachedTable;
+  }
+
+  NSUInteger width = (NSUInteger)outputSize.width, height = (NSUInteger)outputSize.height;
+  NSMutableData *table = [NSMutableData dataWithLength:width * height * 4];
+  GLubyte *texel = [table mutableBytes];
+
+  for (NSUInteger y = 0; y < height; y++) {
+    for (NSUInteger x = 0; x < width; x++) {
+      CGPoint outputPoint = CGPointMake((x + 0.5) / width, (y + 0.5) / height);
+      CGPoint inputPoint = rotatedPoint(cubeReprojectionInputPoint(reprojection, outputPoint, inputSize), rotation);
+      NSUInteger encodedX = (NSUInteger)round(MIN(MAX(inputPoint.x, 0.0), 1.0) * 65535.0);
+      NSUInteger encodedY = (NSUInteger)round(MIN(MAX(inputPoint.y, 0.0), 1.0) * 65535.0);
+      texel[0] = (GLubyte)(encodedX >> 8);
+      texel[1] = (GLubyte)(encodedX & 0xFF);
+      texel[2] = (GLubyte)(encodedY >> 8);
+      texel[3] = (GLubyte)(encodedY & 0xFF);
+      texel += 4;
+    }
+  }
+
+  [lookupTableCache setObject:table forKey:key cost:[table length]];
+  return table;
+}
+
+@interface GPUImageCubeReprojectionFilter()
+
+@property (nonatomic, assign) CGSize lookupInputSize;
+@property (nonatomic, assign) CGSize lookupOutputSize;
+@property (nonatomic, assign) GPUImageRotationMode lookupRotation;
+@property (nonatomic, assign) GPUImageCubeReprojection lookupReprojection;
+
+@end
+
+@implementation GPUImageCubeReprojectionFilter
+
+#pragma mark - Initialization and teardown
+
+- (id)init {
+  return [self initWithReprojection:kGPUImageEquirectangularToCubeAtlas];
+}
+
+- (id)initWithReprojection:(GPUImageCubeReprojection)reprojection {
+  NSString *fragmentShader = [NSString stringWithFormat:@"%@%@", kGPUImageCubeReprojectionShaderPrecision, kGPUImageCubeReprojectionFragmentShaderString];
+  if (!(self = [super initWithFragmentShaderFromString:fragmentShader])) {
+    return nil;
+  }
+
+  _reprojection = reprojection;
+
+  lookupTextureUniform = [self.filterProgram uniformIndex:@"lookupTexture"];
+  [self setInteger:3 forUniform:lookupTextureUniform program:self.filterProgram];
+
+  // The lookup table is indexed by output position and already accounts for the input rotation
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [GPUImageContext useImageProcessingContext];
+    glGenBuffers(1, &lookupVertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, lookupVertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, 4 * sizeof(Vertex2D), verticesAndTextureCoordinatesForRotation(kGPUImageNoRotation), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  });
+
+  return self;
+}
+
+- (void)dealloc {
+  GLuint vertexBuffer = lookupVertexBuffer;
+  GLuint texture = lookupTexture;
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [GPUImageContext useImageProcessingContext];
+    GLuint buffer = vertexBuffer;
+    glDeleteBuffers(1, &buffer);
+    if (texture != 0) {
+      GLuint deletedTexture = texture;
+      glDeleteTextures(1, &deletedTexture);
+    }
+  });
+}
+
+#pragma mark - Sizing
+
+- (CGSize)sizeOfFBO {
+  return cubeReprojectionOutputSize(self.reprojection, [self getInputSize:0]);
+}
+
+- (CGSize)outputFrameSize {
+  return [self sizeOfFBO];
+}
+
+- (void)setupFilterForSize:(CGSize)filterFrameSize {
+  CGSize inputSize = [self getInputSize:0];
+  if (inputSize.width * inputSize.height <= 0.0) {
+    return;
+  }
+  GPUImageRotationMode rotation = [self getInputRotation:0];
+  if (lookupTexture != 0 && CGSizeEqualToSize(inputSize, self.lookupInputSize) && CGSizeEqualToSize(filterFrameSize, self.lookupOutputSize) && rotation == self.lookupRotation && self.reprojection == self.lookupReprojection) {
+    return;
+  }
+  self.lookupInputSize = inputSize;
+  self.lookupOutputSize = filterFrameSize;
+  self.lookupRotation = rotation;
+  self.lookupReprojection = self.reprojection;
+
+  NSData *lookupTable = cubeReprojectionLookupTable(self.reprojection, inputSize, filterFrameSize, rotation);
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [GPUImageContext useImageProcessingContext];
+    if (lookupTexture == 0) {
+      glGenTextures(1, &lookupTexture);
+    }
+    glBindTexture(GL_TEXTURE_2D, lookupTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, (GLsizei)filterFrameSize.width, (GLsizei)filterFrameSize.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, [lookupTable bytes]);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  });
+}
+
+#pragma mark - Rendering
+
+- (void)bindVerticesAndIndices {
+  glBindBuffer(GL_ARRAY_BUFFER, lookupVertexBuffer);
+  glVertexAttribPointer(self.filterPositionAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), 0);
+  glVertexAttribPointer([self getInputTextureCoordinateAttribute:0], 2, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), (GLvoid*)(sizeof(GLfloat) * 2));
+}
+
+- (void)render {
+  glActiveTexture(GL_TEXTURE3);
+  glBindTexture(GL_TEXTURE_2D, lookupTexture);
+  [super render];
+}
+
+#pragma mark - Accessors
+
+- (void)setReprojection:(GPUImageCubeReprojection)newValue {
+  _reprojection = newValue;
+  [self setupFilterForSize:[self sizeOfFBO]];
+}
+
+@end
@@ -0,0 +1,62 @@
+#import "GPUImageOutput.h"
+#import "GPUImageResamplingFilter.h"
+
+/** Runs the same filter graph at preview and at full resolution, e.g. to show a 4K camera feed on screen while recording it
+
+ The graph is built twice by the factory block: once behind a downscaler for the preview targets, once at the input size for the recording targets. Each frame renders through the preview branch on the video processing queue. The full resolution render is queued on the queue of recordingContext, which shares the input textures through its sharegroup, so the display doesn't sit behind the encode and the next frame's preview runs while the previous one is being recorded. At most maximumPendingRecordingFrames full resolution frames wait at once, further ones are dropped and counted.
+
+ The recording branch and its targets are called on the queue of recordingContext. A movie writer added as a recording target is switched to that context, other targets have to render in it as well.
+
+ Change parameters through -updateParameters:, never on the branches directly. The change applies to the preview from the next frame on, and to the recording branch right after the full resolution renders of the frames already previewed, so every frame is rendered with the same parameters in both branches.
+ */
+@interface GPUImageDualResolutionPipeline : NSObject <GPUImageInput>
+
+/// The preview graph, fed by previewDownscaler
+@property (nonatomic, strong, readonly) GPUImageOutput<GPUImageInput> *previewBranch;
+@property (nonatomic, strong, readonly) GPUImageOutput<GPUImageInput> *recordingBranch;
+@property (nonatomic, strong, readonly) GPUImageResamplingFilter *previewDownscaler;
+
+/// The context the recording branch renders in, on a queue of its own
+@property (nonatomic, strong, readonly) GPUImageContext *recordingContext;
+
+/// The size the preview is processed at, fitting the input's aspect ratio inside it
+@property (nonatomic, assign) CGSize previewSize;
+
+/// Whether frames go through the full resolution branch at all, YES by default. Turn it off while not recording to only pay for the preview
+@property (nonatomic, assign, getter=isRecordingEnabled) BOOL recordingEnabled;
+
+/// Full resolution frames waiting to be rendered before new ones are dropped, 2 by default
+@property (nonatomic, assign) NSUInteger maximumPendingRecordingFrames;
+
+/** Build both branches
+ @param branchFactory Returns a new instance of the graph, with the filter frames enter through. Called twice
+ @param previewSize Size the preview is processed at
+ */
+- (id)initWithBranchFactory:(GPUImageOutput<GPUImageInput> *(^)(void))branchFactory previewSize:(CGSize)previewSize;
+
+- (void)addPreviewTarget:(id<GPUImageInput>)target;
+- (void)addRecordingTarget:(id<GPUImageInput>)target;
+
+/// Apply a parameter change to both branches, in step with the frames. The block is called once per branch, on the queue the branch renders on
+- (void)updateParameters:(void (^)(GPUImageOutput<GPUImageInput> *branch))updateBlock;
+
+#pragma mark - Statistics
+
+@property (nonatomic, assign, readonly) NSUInteger previewFrameCount;
+
+/// Time from a frame arriving at the pipeline until the preview branch and its targets are done with it
+@property (nonatomic, assign, readonly) CFTimeInterval averagePreviewLatency;
+@property (nonatomic, assign, readonly) CFTimeInterval maximumPreviewLatency;
+
+@property (nonatomic, assign, readonly) NSUInteger recordedFrameCount;
+@property (nonatomic, assign, readonly) NSUInteger droppedRecordingFrameCount;
+
+/// Full resolution frames rendered per second, between the first and the last one since the statistics were reset
+@property (nonatomic, assign, readonly) CGFloat recordingThroughput;
+
+/// Time the full resolution branch and its targets take per frame
+@property (nonatomic, assign, readonly) CFTimeInterval averageRecordingRenderDuration;
+
+- (void)resetStatistics;
+
+@end
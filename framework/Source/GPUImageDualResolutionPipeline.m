@@ -0,0 +1,241 @@
+#import "GPUImageDualResolutionPipeline.h"
+#import "GPUImageMovieWriter.h"
+#import <QuartzCore/QuartzCore.h>
+#import <stdatomic.h>
+
+@interface GPUImageDualResolutionPipeline()
+{
+  // Counted up on the video processing queue, down on the recording queue
+  atomic_ulong pendingRecordingFrameCount;
+}
+
+@property (nonatomic, strong, readwrite) GPUImageOutput<GPUImageInput> *previewBranch;
+@property (nonatomic, strong, readwrite) GPUImageOutput<GPUImageInput> *recordingBranch;
+@property (nonatomic, strong, readwrite) GPUImageResamplingFilter *previewDownscaler;
+@property (nonatomic, strong, readwrite) GPUImageContext *recordingContext;
+
+@property (nonatomic, strong) GPUImageFramebuffer *inputFramebuffer;
+@property (nonatomic, assign) CGSize inputSize;
+@property (nonatomic, assign) GPUImageRotationMode inputRotation;
+
+// Input size and rotation last passed on to the recording branch, which lags behind the preview
+@property (nonatomic, assign) CGSize recordingInputSize;
+@property (nonatomic, assign) GPUImageRotationMode recordingInputRotation;
+
+@property (nonatomic, assign) CFTimeInterval totalPreviewLatency;
+@property (nonatomic, assign) CFTimeInterval totalRecordingRenderDuration;
+@property (nonatomic, assign) CFTimeInterval firstRecordingTime;
+@property (nonatomic, assign) CFTimeInterval lastRecordingTime;
+
+@end
+
+@implementation GPUImageDualResolutionPipeline
+
+#pragma mark - Initialization and teardown
+
+- (id)initWithBranchFactory:(GPUImageOutput<GPUImageInput> *(^)(void))branchFactory previewSize:(CGSize)previewSize {
+  NSParameterAssert(branchFactory != NULL);
+  if (!(self = [super init])) {
+    return nil;
+  }
+
+  // Built on its own queue, so that the recording branch creates its framebuffers in its own context
+  self.recordingContext = [GPUImageContext contextSharingResourcesWithContext:[GPUImageContext sharedImageProcessingContext] label:@"com.sunsetlakesoftware.GPUImage.recordingContextQueue"];
+  self.previewBranch = branchFactory();
+  runSynchronouslyOnContextQueue(self.recordingContext, ^{
+    self.recordingBranch = branchFactory();
+  });
+  NSAssert(self.previewBranch != nil && self.recordingBranch != nil && self.previewBranch != self.recordingBranch, @"The factory has to return a new graph each time");
+
+  self.previewDownscaler = [[GPUImageResamplingFilter alloc] init];
+  [self.previewDownscaler addTarget:self.previewBranch];
+  self.previewSize = previewSize;
+
+  _recordingEnabled = YES;
+  _maximumPendingRecordingFrames = 2;
+  atomic_init(&pendingRecordingFrameCount, 0);
+  _inputRotation = kGPUImageNoRotation;
+  _recordingInputRotation = kGPUImageNoRotation;
+
+  return self;
+}
+
+- (void)dealloc {
+  [_inputFramebuffer unlock];
+}
+
+#pragma mark - Targets and parameters
+
+- (void)setPreviewSize:(CGSize)previewSize {
+  _previewSize = previewSize;
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [self.previewDownscaler forceProcessingAtSizeRespectingAspectRatio:previewSize];
+  });
+}
+
+- (void)addPreviewTarget:(id<GPUImageInput>)target {
+  [self.previewBranch addTarget:target];
+}
+
+- (void)addRecordingTarget:(id<GPUImageInput>)target {
+  runSynchronouslyOnContextQueue(self.recordingContext, ^{
+    if ([(id)target isKindOfClass:[GPUImageMovieWriter class]]) {
+      [(GPUImageMovieWriter *)target setMovieWriterContext:self.recordingContext];
+    }
+    [self.recordingBranch addTarget:target];
+  });
+}
+
+// The recording queue runs blocks in order, so a change queued from the video processing queue behind the pending full resolution renders reaches the recording branch exactly after the frames previewed without it
+- (void)updateParameters:(void (^)(GPUImageOutput<GPUImageInput> *branch))updateBlock {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    updateBlock(self.previewBranch);
+    runAsynchronouslyOnContextQueue(self.recordingContext, ^{
+      updateBlock(self.recordingBranch);
+    });
+  });
+}
+
+#pragma mark - Statistics
+
+- (CFTimeInterval)averagePreviewLatency {
+  return (self.previewFrameCount > 0) ? self.totalPreviewLatency / self.previewFrameCount : 0.0;
+}
+
+- (CFTimeInterval)averageRecordingRenderDuration {
+  return (self.recordedFrameCount > 0) ? self.totalRecordingRenderDuration / self.recordedFrameCount : 0.0;
+}
+
+- (CGFloat)recordingThroughput {
+  CFTimeInterval recordingDuration = self.lastRecordingTime - self.firstRecordingTime;
+  return (self.recordedFrameCount > 1 && recordingDuration > 0.0) ? (self.recordedFrameCount - 1) / recordingDuration : 0.0;
+}
+
+// Each counter is reset on the queue it is counted on
+- (void)resetStatistics {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    _previewFrameCount = 0;
+    _maximumPreviewLatency = 0.0;
+    _droppedRecordingFrameCount = 0;
+    self.totalPreviewLatency = 0.0;
+  });
+  runSynchronouslyOnContextQueue(self.recordingContext, ^{
+    _recordedFrameCount = 0;
+    self.totalRecordingRenderDuration = 0.0;
+    self.firstRecordingTime = 0.0;
+    self.lastRecordingTime = 0.0;
+  });
+}
+
+#pragma mark - Recording branch
+
+- (void)renderRecordingFramebuffer:(GPUImageFramebuffer *)framebuffer size:(CGSize)size rotation:(GPUImageRotationMode)rotation atTime:(CMTime)frameTime {
+  if (![self recordingBranchWantsFrameAtTime:frameTime]) {
+    [framebuffer unlock];
+    atomic_fetch_sub(&pendingRecordingFrameCount, 1);
+    return;
+  }
+
+  CFTimeInterval startTime = CACurrentMediaTime();
+
+  // Setting sizes recomputes filter state, so only pass on changes
+  if (rotation != self.recordingInputRotation) {
+    self.recordingInputRotation = rotation;
+    [self.recordingBranch setInputRotation:rotation index:0];
+  }
+  if (!CGSizeEqualToSize(size, self.recordingInputSize)) {
+    self.recordingInputSize = size;
+    [self.recordingBranch setInputSize:size index:0];
+  }
+  [self.recordingBranch setInputFramebuffer:framebuffer index:0];
+  [self.recordingBranch newFrameReadyAtTime:frameTime atIndex:0];
+  [framebuffer unlock];
+  atomic_fetch_sub(&pendingRecordingFrameCount, 1);
+
+  CFTimeInterval endTime = CACurrentMediaTime();
+  _recordedFrameCount++;
+  self.totalRecordingRenderDuration += endTime - startTime;
+  if (self.recordedFrameCount == 1) {
+    self.firstRecordingTime = endTime;
+  }
+  self.lastRecordingTime = endTime;
+}
+
+#pragma mark - GPUImageInput protocol
+
+- (void)newFrameReadyAtTime:(CMTime)frameTime atIndex:(NSInteger)textureIndex {
+  CFTimeInterval arrivalTime = CACurrentMediaTime();
+  GPUImageFramebuffer *framebuffer = self.inputFramebuffer;
+  self.inputFramebuffer = nil;
+
+  [self.previewDownscaler newFrameReadyAtTime:frameTime atIndex:0];
+
+  CFTimeInterval previewLatency = CACurrentMediaTime() - arrivalTime;
+  _previewFrameCount++;
+  self.totalPreviewLatency += previewLatency;
+  _maximumPreviewLatency = MAX(self.maximumPreviewLatency, previewLatency);
+
+  if (!self.isRecordingEnabled) {
+    [framebuffer unlock];
+    return;
+  }
+  if (atomic_load(&pendingRecordingFrameCount) >= MAX(self.maximumPendingRecordingFrames, 1)) {
+    _droppedRecordingFrameCount++;
+    [framebuffer unlock];
+    return;
+  }
+
+  // Our lock keeps the frame alive until the full resolution branch gets to it. The recording context only sees what this one wrote into the frame once it is flushed
+  atomic_fetch_add(&pendingRecordingFrameCount, 1);
+  CGSize size = self.inputSize;
+  GPUImageRotationMode rotation = self.inputRotation;
+  glFlush();
+  runAsynchronouslyOnContextQueue(self.recordingContext, ^{
+    [self renderRecordingFramebuffer:framebuffer size:size rotation:rotation atTime:frameTime];
+  });
+}
+
+- (void)setInputFramebuffer:(GPUImageFramebuffer *)value index:(NSUInteger)index {
+  [self.inputFramebuffer unlock];
+  self.inputFramebuffer = value;
+  [value lock];
+  [self.previewDownscaler setInputFramebuffer:value index:0];
+}
+
+- (NSInteger)nextAvailableTextureIndex {
+  return 0;
+}
+
+- (void)setInputSize:(CGSize)value index:(NSUInteger)index {
+  self.inputSize = value;
+  [self.previewDownscaler setInputSize:value index:0];
+}
+
+- (void)setInputRotation:(GPUImageRotationMode)value index:(NSUInteger)index {
+  self.inputRotation = value;
+  [self.previewDownscaler setInputRotation:value index:0];
+}
+
+- (void)endProcessing {
+  [self.previewDownscaler endProcessing];
+  runAsynchronouslyOnContextQueue(self.recordingContext, ^{
+    [self.recordingBranch endProcessing];
+  });
+}
+
+- (BOOL)shouldIgnoreUpdatesToThisTarget {
+  return NO;
+}
+
+// The recording branch lags behind and is only asked on its own queue, once the frame gets there
+- (BOOL)wantsFrameAtTime:(CMTime)frameTime {
+  BOOL previewWantsFrame = [self.previewDownscaler wantsFrameAtTime:frameTime];
+  return previewWantsFrame || self.isRecordingEnabled;
+}
+
+- (BOOL)recordingBranchWantsFrameAtTime:(CMTime)frameTime {
+  GPUImageOutput<GPUImageInput> *recordingBranch = self.recordingBranch;
+  return ![recordingBranch respondsToSelector:@selector(wantsFrameAtTime:)] || [recordingBranch wantsFrameAtTime:frameTime];
+}
+
+@end
@@ -0,0 +1,34 @@
+#import "GPUImageMeshWarpFilter.h"
+#import "GPUImageSphericalProjection.h"
+
+typedef NS_ENUM(NSUInteger, GPUImageEquirectangularProjection) {
+    /// A pinhole camera view, as in a 360 degree viewer
+    kGPUImageEquirectangularToPerspective,
+    /// Stereographic projection centered below the camera, the ground becomes a small planet surrounded by sky
+    kGPUImageEquirectangularToLittlePlanet
+};
+
+/** Renders a view of an equirectangular 360 degree image
+
+ The projection is evaluated per mesh vertex whenever the view changes, so each frame costs a single textured draw. Moving the view every frame, as a viewer following device motion does, costs one mesh update of a few thousand vertices per frame.
+ See GPUImageSphericalProjection.h for the conventions of the equirectangular input.
+ */
+@interface GPUImageEquirectangularProjectionFilter : GPUImageMeshWarpFilter
+
+@property (nonatomic, assign) GPUImageEquirectangularProjection projection;
+
+/// Degrees to the right of the center of the input. Default of 0.0
+@property (nonatomic, assign) CGFloat yaw;
+
+/// Degrees up from the horizon. Default of 0.0
+@property (nonatomic, assign) CGFloat pitch;
+
+/// Degrees the view is turned clockwise. Default of 0.0
+@property (nonatomic, assign) CGFloat roll;
+
+/// Horizontal field of view in degrees for perspective views, the angle across the shorter side for little planets. Default of 90.0, little planets look best around 240.0
+@property (nonatomic, assign) CGFloat fieldOfView;
+
+- (id)initWithProjection:(GPUImageEquirectangularProjection)projection;
+
+@end
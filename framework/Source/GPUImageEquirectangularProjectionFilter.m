@@ -0,0 +1,107 @@
+#import "GPUImageEquirectangularProjectionFilter.h"
+
+@interface GPUImageEquirectangularProjectionFilter()
+
+@property (nonatomic, assign) CGFloat aspectRatio;
+
+@end
+
+@implementation GPUImageEquirectangularProjectionFilter
+
+#pragma mark - Initialization and teardown
+
+- (id)init {
+  return [self initWithProjection:kGPUImageEquirectangularToPerspective];
+}
+
+- (id)initWithProjection:(GPUImageEquirectangularProjection)projection {
+  if (!(self = [super initWithMeshColumns:32 rows:32])) {
+    return nil;
+  }
+
+  _projection = projection;
+  _yaw = 0.0;
+  _pitch = 0.0;
+  _roll = 0.0;
+  _fieldOfView = 90.0;
+  _aspectRatio = 1.0;
+  self.wrapsTextureHorizontally = YES;
+
+  return self;
+}
+
+- (void)setupFilterForSize:(CGSize)filterFrameSize {
+  if (filterFrameSize.width * filterFrameSize.height > 0.0) {
+    CGFloat aspectRatio = filterFrameSize.width / filterFrameSize.height;
+    if (aspectRatio != self.aspectRatio) {
+      self.aspectRatio = aspectRatio;
+      [self invalidateMesh];
+    }
+  }
+}
+
+#pragma mark - Mesh
+
+- (void)mapTextureCoordinatesFromX:(const GLfloat *)x y:(const GLfloat *)y toU:(GLfloat *)u v:(GLfloat *)v count:(NSUInteger)count {
+  // Parameters are still unset while GPUImageFilter's initializer builds the first mesh
+  CGFloat aspectRatio = (self.aspectRatio > 0.0) ? self.aspectRatio : 1.0;
+  CGFloat fieldOfView = MIN(MAX(self.fieldOfView, 1.0), (self.projection == kGPUImageEquirectangularToPerspective) ? 179.0 : 359.0) * M_PI / 180.0;
+  GPUMatrix3x3 rotation = GPUImageSphericalRotation(self.yaw * M_PI / 180.0, self.pitch * M_PI / 180.0, self.roll * M_PI / 180.0);
+
+  for (NSUInteger vertex = 0; vertex < count; vertex++) {
+    GLfloat viewX = 2.0 * x[vertex] - 1.0;
+    GLfloat viewY = 1.0 - 2.0 * y[vertex];
+    GPUVector3 direction;
+
+    switch (self.projection) {
+      case kGPUImageEquirectangularToPerspective: {
+        GLfloat tangentX = tan(fieldOfView * 0.5);
+        direction = (GPUVector3){viewX * tangentX, viewY * tangentX / aspectRatio, 1.0};
+        break;
+      }
+      case kGPUImageEquirectangularToLittlePlanet: {
+        // Stereographic projection from the zenith, the shorter side spans fieldOfView
+        GLfloat planeX = viewX * MAX(aspectRatio, 1.0);
+        GLfloat planeY = viewY * MAX(1.0 / aspectRatio, 1.0);
+        GLfloat radius = sqrt(planeX * planeX + planeY * planeY) * tan(fieldOfView * 0.25);
+        GLfloat polarAngle = 2.0 * atan(radius);
+        GLfloat azimuth = atan2(planeY, planeX);
+        direction = (GPUVector3){sin(polarAngle) * cos(azimuth), -cos(polarAngle), sin(polarAngle) * sin(azimuth)};
+        break;
+      }
+    }
+
+    CGPoint point = GPUImageEquirectangularPointForSphericalDirection(GPUImageRotateSphericalDirection(rotation, direction));
+    u[vertex] = point.x;
+    v[vertex] = point.y;
+  }
+}
+
+#pragma mark - Accessors
+
+- (void)setProjection:(GPUImageEquirectangularProjection)newValue {
+  _projection = newValue;
+  [self invalidateMesh];
+}
+
+- (void)setYaw:(CGFloat)newValue {
+  _yaw = newValue;
+  [self invalidateMesh];
+}
+
+- (void)setPitch:(CGFloat)newValue {
+  _pitch = newValue;
+  [self invalidateMesh];
+}
+
+- (void)setRoll:(CGFloat)newValue {
+  _roll = newValue;
+  [self invalidateMesh];
+}
+
+- (void)setFieldOfView:(CGFloat)newValue {
+  _fieldOfView = newValue;
+  [self invalidateMesh];
+}
+
+@end
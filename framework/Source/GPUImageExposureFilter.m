@@ -45,6 +45,8 @@ NSString *const kGPUImageExposureFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     exposureUniform = [self.filterProgram uniformIndex:@"exposure"];
     self.exposure = 0.0f;
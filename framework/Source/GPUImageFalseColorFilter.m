@@ -56,6 +56,8 @@ NSString *const kGPUFalseColorFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     firstColorUniform = [self.filterProgram uniformIndex:@"firstColor"];
     secondColorUniform = [self.filterProgram uniformIndex:@"secondColor"];
@@ -1,4 +1,6 @@
 #import "GPUImageFilterInput.h"
+#import "GPUImageFrameSyncPolicy.h"
+#import "GPUImageFrameSampler.h"
 
 #define STRINGIZE(x) #x
 #define STRINGIZE2(x) STRINGIZE(x)
@@ -11,6 +13,8 @@
 extern NSString *const kGPUImageVertexShaderString;
 extern NSString *const kGPUImagePassthroughFragmentShaderString;
 
+#define kGPUImageUnboundedSamplingFootprint CGSizeMake(INFINITY, INFINITY)
+
 /** GPUImage's base filter class
  
  Filters and other subsequent elements in the chain conform to the GPUImageInput protocol, which lets them take in the supplied or processed texture from the previous link in the chain and do something with it. Objects one step further down the chain are considered targets, and processing can be branched by adding multiple targets to a single output or filter.
@@ -35,6 +39,36 @@ extern NSString *const kGPUImagePassthroughFragmentShaderString;
 @property (readonly) CVPixelBufferRef renderTarget;
 @property (readwrite, nonatomic) BOOL preventRendering;
 
+/** How far around its own position each output pixel reads the inputs, in input pixels
+
+ Used to work out the regions of interest of the inputs from the one of the output, see -regionOfInterestForInputAtIndex: of GPUImageInput. The default of kGPUImageUnboundedSamplingFootprint is for shaders that may read anywhere and always needs whole inputs, pointwise filters such as colour adjustments set CGSizeZero.
+ */
+@property (nonatomic, assign) CGSize samplingFootprint;
+
+/** Whether the shader only depends on the luminance of its inputs, see -wantsMonochromeInput of GPUImageInput. NO by default, luminance based filters such as edge detection and thresholding set it
+ */
+@property (nonatomic, assign) BOOL wantsMonochromeInput;
+
+/** How frames of inputs running at different rates are paired up. The default of nil renders once every input has delivered a frame
+ */
+@property (nonatomic, strong) GPUImageFrameSyncPolicy *frameSyncPolicy;
+
+/** The filter's own demand for frames, see -wantsFrameAtTime: of GPUImageInput. Deactivate it or raise its interval to run the filter, and whatever only feeds it, on fewer frames
+ */
+@property (nonatomic, strong, readonly) GPUImageFrameSampler *frameSampler;
+
+/// Frames the filter received but didn't render, because neither its sampler nor any of its targets wanted them
+@property (nonatomic, assign, readonly) NSUInteger skippedFrameCount;
+
+/** Whether the output only depends on the filter's parameters and size, not on the contents of its inputs, as for generators
+
+ The output is then rendered once and the same framebuffer passed on again for later frames, until a uniform or the background color is set, the output size changes or -invalidateStaticContent is called. NO by default, generators such as the Perlin noise and the solid color generator set it
+ */
+@property (nonatomic, assign) BOOL hasStaticContent;
+
+/// Frames passed on with the kept output instead of rendering
+@property (nonatomic, assign, readonly) NSUInteger reusedFrameCount;
+
 - (BOOL)isFilterReady;
 
 - (BOOL)preRender;
@@ -70,6 +104,11 @@ extern NSString *const kGPUImagePassthroughFragmentShaderString;
 - (void)initializeAttributes;
 - (void)setupFilterForSize:(CGSize)filterFrameSize;
 
+/**
+ Replace the filter program, e.g. for shaders generated for a specific radius. Uniform values set earlier are dropped.
+ */
+- (void)switchToVertexShader:(NSString *)newVertexShader fragmentShader:(NSString *)newFragmentShader;
+
 #pragma mark - Inputs
 
 - (GPUImageFramebuffer *)getInputFramebuffer:(NSUInteger)index;
@@ -92,6 +131,38 @@ extern NSString *const kGPUImagePassthroughFragmentShaderString;
 - (CGSize)getInputSize:(NSUInteger)index;
 - (void)setInputSize:(CGSize)value index:(NSUInteger)index;
 
+#pragma mark - Vertices & Indices
+
+// Override to draw something other than a quad per input. The buffers go into the inputs' vertexbuffer and indexbuffer, which are deleted on teardown and on rotation changes
+- (void)setupVerticesAndTextureCoordinates;
+- (void)clearVerticesAndTextureCoordinates;
+- (void)bindVerticesAndIndices;
+- (void)unbindVerticesAndIndices;
+
+#pragma mark - Region of interest
+
+/** The region of an input needed to render a region of the output, both normalized
+
+ The default grows the output region by samplingFootprint and applies the input rotation. Override it for filters that read their inputs somewhere else than at the output position.
+ */
+- (CGRect)inputRegionForOutputRegion:(CGRect)outputRegion index:(NSUInteger)index;
+
+/** For -render drawing intermediate passes into framebuffers of their own. Activates the framebuffer, scissored to the region of interest only if it is the output framebuffer
+ */
+- (void)activatePassFramebuffer:(GPUImageFramebuffer *)framebuffer;
+
+#pragma mark - Static content
+
+/// Render the next frame again, for changes the filter can't see such as new contents of an input meant to be static
+- (void)invalidateStaticContent;
+
+/** For subclasses rendering outside of -newFrameReadyAtTime:atIndex:, on the video processing queue
+
+ -reuseStaticContent makes the kept output the output framebuffer, locked once for -informTargetsAboutNewFrameAtTime:, and returns NO if there is none to reuse. -keepStaticContent keeps the output framebuffer after rendering it
+ */
+- (BOOL)reuseStaticContent;
+- (void)keepStaticContent;
+
 #pragma mark - Buffers management
 
 - (CGSize)outputFrameSize;
@@ -1,5 +1,6 @@
 #import "GPUImageFilter.h"
 #import "GPUImagePicture.h"
+#import "GPUImageTimeline.h"
 #import <AVFoundation/AVFoundation.h>
 
 static const GLuint NUMBER_OF_INPUT_FRAME_BUFFERS = 1;
@@ -60,9 +61,16 @@ typedef NS_ENUM(NSUInteger, SizeOverride) {
 
 @property (nonatomic, assign) CGSize currentFilterSize;
 
+@property (nonatomic, assign) BOOL isRenderingRegionOfInterest;
+@property (nonatomic, assign) BOOL isComputingRegionOfInterest;
+@property (nonatomic, assign) BOOL isComputingFrameDemand;
+
 @property (nonatomic, assign) SizeOverride sizeOverride;
 @property (nonatomic, assign) CGSize sizeOverrideLimit;
 
+// The output kept for static content, holding a lock of its own
+@property (nonatomic, strong) GPUImageFramebuffer *staticFramebuffer;
+
 @end
 
 @implementation GPUImageFilter
@@ -78,6 +86,8 @@ typedef NS_ENUM(NSUInteger, SizeOverride) {
     self.backgroundColorGreen = 0.0;
     self.backgroundColorBlue = 0.0;
     self.backgroundColorAlpha = 0.0;
+    self.samplingFootprint = kGPUImageUnboundedSamplingFootprint;
+    _frameSampler = [[GPUImageFrameSampler alloc] init];
 
     [self initFrameBuffers];
 
@@ -118,13 +128,16 @@ typedef NS_ENUM(NSUInteger, SizeOverride) {
   self.filterPositionAttribute = [self.filterProgram attributeIndex:@"position"];
   glEnableVertexAttribArray(self.filterPositionAttribute);
 
-  GLuint textureCoordinateAttribute = [self.filterProgram attributeIndex:@"inputTextureCoordinate"];
-  [self setInputTextureCoordinateAttribute:textureCoordinateAttribute index:0];
-  glEnableVertexAttribArray(textureCoordinateAttribute);
+  // Input i reads inputImageTexture<i+1> from texture unit 2 + i at inputTextureCoordinate<i+1>, the suffix is omitted for the first input
+  for (NSUInteger input = 0; input < self.numberOfInputs; input++) {
+    GLuint textureCoordinateAttribute = [self.filterProgram attributeIndex:inputVariableName(@"inputTextureCoordinate", input)];
+    [self setInputTextureCoordinateAttribute:textureCoordinateAttribute index:input];
+    glEnableVertexAttribArray(textureCoordinateAttribute);
 
-  GLuint textureUniform = [self.filterProgram uniformIndex:@"inputImageTexture"];
-  [self setInputTextureUniform:textureUniform index:0];
-  glUniform1i(textureUniform, 2);
+    GLuint textureUniform = [self.filterProgram uniformIndex:inputVariableName(@"inputImageTexture", input)];
+    [self setInputTextureUniform:textureUniform index:input];
+    glUniform1i(textureUniform, (GLint)(2 + input));
+  }
 
   for (NSUInteger rotation = 0; rotation < self.numberOfInputs; rotation++) {
     [self setInputRotation:kGPUImageNoRotation index:rotation];
@@ -186,7 +199,9 @@ typedef NS_ENUM(NSUInteger, SizeOverride) {
 
 - (void)initializeAttributes {
   [self.filterProgram addAttribute:@"position"];
-  [self.filterProgram addAttribute:@"inputTextureCoordinate"];
+  for (NSUInteger input = 0; input < self.numberOfInputs; input++) {
+    [self.filterProgram addAttribute:inputVariableName(@"inputTextureCoordinate", input)];
+  }
   // Override this, calling back to this super method, in order to add new attributes to your vertex shader
 }
 
@@ -194,7 +209,28 @@ typedef NS_ENUM(NSUInteger, SizeOverride) {
   // This is where you can override to provide some custom setup, if your filter has a size-dependent element
 }
 
+- (void)switchToVertexShader:(NSString *)newVertexShader fragmentShader:(NSString *)newFragmentShader {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [GPUImageContext useImageProcessingContext];
+
+    self.filterProgram = [[GLProgram alloc] initWithVertexShaderString:newVertexShader fragmentShaderString:newFragmentShader];
+    NSAssert(self.filterProgram, @"filter program init error");
+
+    if (!self.filterProgram.initialized) {
+      [self initializeAttributes];
+      [self.filterProgram link];
+    }
+
+    // Uniform locations belong to the old program, so the subclass has to push its values again
+    [self.uniformStateRestorationBlocks removeAllObjects];
+    [self configGL];
+    [self invalidateStaticContent];
+  });
+}
+
 - (void)dealloc {
+  [_frameSyncPolicy removeAllFrames];
+  [_staticFramebuffer unlock];
   [self clearVerticesAndTextureCoordinates];
 }
 
@@ -367,11 +403,26 @@ typedef NS_ENUM(NSUInteger, SizeOverride) {
     [self.outputFramebuffer lock];
   }
 
-  [self setUniformsForProgramAtIndex:0];
-
+  // Cleared whole, so that pixels outside of what the targets read don't keep whatever the recycled framebuffer held
   glClearColor(self.backgroundColorRed, self.backgroundColorGreen, self.backgroundColorBlue, self.backgroundColorAlpha);
   glClear(GL_COLOR_BUFFER_BIT);
 
+  // Only what the targets read is rendered. Static content is kept whole for whoever reads it later
+  CGRect region = self.hasStaticContent ? kGPUImageFullRegionOfInterest : [self regionOfInterestOfOutput];
+  self.isRenderingRegionOfInterest = !CGRectEqualToRect(region, kGPUImageFullRegionOfInterest);
+  if (self.isRenderingRegionOfInterest) {
+    // One pixel more on each side for targets filtering linearly at the edge of their region
+    CGSize framebufferSize = self.outputFramebuffer.size;
+    GLint minX = MAX((GLint)floor(CGRectGetMinX(region) * framebufferSize.width) - 1, 0);
+    GLint minY = MAX((GLint)floor(CGRectGetMinY(region) * framebufferSize.height) - 1, 0);
+    GLint maxX = MIN((GLint)ceil(CGRectGetMaxX(region) * framebufferSize.width) + 1, (GLint)framebufferSize.width);
+    GLint maxY = MIN((GLint)ceil(CGRectGetMaxY(region) * framebufferSize.height) + 1, (GLint)framebufferSize.height);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(minX, minY, MAX(maxX - minX, 0), MAX(maxY - minY, 0));
+  }
+
+  [self setUniformsForProgramAtIndex:0];
+
   [self bindVerticesAndIndices];
 
   return YES;
@@ -385,9 +436,26 @@ typedef NS_ENUM(NSUInteger, SizeOverride) {
   glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 }
 
+- (void)activatePassFramebuffer:(GPUImageFramebuffer *)framebuffer {
+  [framebuffer activateFramebuffer];
+  // The scissor box is in output pixels, intermediate passes of other sizes need all of theirs
+  if (self.isRenderingRegionOfInterest) {
+    if (framebuffer == self.outputFramebuffer) {
+      glEnable(GL_SCISSOR_TEST);
+    } else {
+      glDisable(GL_SCISSOR_TEST);
+    }
+  }
+}
+
 - (void)postRender {
   [self unbindVerticesAndIndices];
 
+  if (self.isRenderingRegionOfInterest) {
+    glDisable(GL_SCISSOR_TEST);
+    self.isRenderingRegionOfInterest = NO;
+  }
+
   [self unlockBuffers];
 
   if (self.usingNextFrameForImageCapture) {
@@ -426,6 +494,104 @@ typedef NS_ENUM(NSUInteger, SizeOverride) {
   return YES;
 }
 
+#pragma mark - Region of interest
+
+- (CGRect)inputRegionForOutputRegion:(CGRect)outputRegion index:(NSUInteger)index {
+  CGSize inputSize = [self getInputSize:index];
+  if (inputSize.width * inputSize.height <= 0.0) {
+    return kGPUImageFullRegionOfInterest;
+  }
+
+  CGRect region = outsetRegionOfInterest(outputRegion, self.samplingFootprint.width / inputSize.width, self.samplingFootprint.height / inputSize.height);
+  return rotatedRect(region, [self getInputRotation:index]);
+}
+
+- (CGRect)regionOfInterestForInputAtIndex:(NSInteger)textureIndex {
+  // Chains feeding back into themselves, like the low pass filter, need everything
+  if (self.isComputingRegionOfInterest) {
+    return kGPUImageFullRegionOfInterest;
+  }
+  self.isComputingRegionOfInterest = YES;
+  CGRect outputRegion = [self regionOfInterestOfOutput];
+  self.isComputingRegionOfInterest = NO;
+
+  return [self inputRegionForOutputRegion:outputRegion index:textureIndex];
+}
+
+#pragma mark - Static content
+
+- (void)setHasStaticContent:(BOOL)newValue {
+  _hasStaticContent = newValue;
+  if (!newValue) {
+    [self invalidateStaticContent];
+  }
+}
+
+- (void)invalidateStaticContent {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [self.staticFramebuffer unlock];
+    self.staticFramebuffer = nil;
+  });
+}
+
+- (BOOL)reuseStaticContent {
+  GPUImageFramebuffer *framebuffer = self.staticFramebuffer;
+  if (!self.hasStaticContent || framebuffer == nil || self.preventRendering) {
+    return NO;
+  }
+  if (!CGSizeEqualToSize(framebuffer.size, [self sizeOfFBO])) {
+    [self invalidateStaticContent];
+    return NO;
+  }
+
+  self.outputFramebuffer = framebuffer;
+  [framebuffer lock];
+  if (self.usingNextFrameForImageCapture) {
+    [framebuffer lock];
+    dispatch_semaphore_signal(self.imageCaptureSemaphore);
+  }
+  _reusedFrameCount++;
+  return YES;
+}
+
+- (void)keepStaticContent {
+  GPUImageFramebuffer *framebuffer = self.outputFramebuffer;
+  if (!self.hasStaticContent || framebuffer == nil || framebuffer == self.staticFramebuffer) {
+    return;
+  }
+  [framebuffer lock];
+  [self.staticFramebuffer unlock];
+  self.staticFramebuffer = framebuffer;
+}
+
+- (void)renderOrReuseStaticContent {
+  if ([self reuseStaticContent]) {
+    [self unlockBuffers];
+    return;
+  }
+  if ([self preRender]) {
+    [self render];
+    [self postRender];
+    [self keepStaticContent];
+  }
+}
+
+#pragma mark - Frame demand
+
+- (BOOL)wantsFrameAtTime:(CMTime)frameTime {
+  // Chains feeding back into themselves want what they wanted on the way in
+  if (self.isComputingFrameDemand) {
+    return YES;
+  }
+  if (![self.frameSampler wantsFrameAtTime:frameTime]) {
+    return NO;
+  }
+  self.isComputingFrameDemand = YES;
+  BOOL wantsFrame = [self targetsWantFrameAtTime:frameTime];
+  self.isComputingFrameDemand = NO;
+  return wantsFrame;
+}
+
 #pragma mark - Buffers management
 
 - (void)unlockBuffers {
@@ -487,19 +653,74 @@ typedef NS_ENUM(NSUInteger, SizeOverride) {
 
 - (void)newFrameReadyAtTime:(CMTime)frameTime atIndex:(NSInteger)textureIndex {
   runSynchronouslyOnVideoProcessingQueue(^{
+    if (self.frameSyncPolicy != nil) {
+      [self synchronizeFrameAtTime:frameTime index:textureIndex];
+      return;
+    }
+
     [self setFrame:textureIndex];
     if ([self hasReceivedAllFrames]) {
-      if ([self preRender]) {
-        [self render];
-        [self postRender];
+      // Nothing downstream uses the frame, so neither rendering nor passing it on is worth it
+      if (![self wantsFrameAtTime:frameTime]) {
+        [self unlockBuffers];
+        [self dropFrames];
+        _skippedFrameCount++;
+        return;
       }
+      [self.timeline advanceToTime:frameTime];
+      [self renderOrReuseStaticContent];
       [self informTargetsAboutNewFrameAtTime:frameTime];
       [self dropFrames];
     }
   });
 }
 
+- (void)synchronizeFrameAtTime:(CMTime)frameTime index:(NSUInteger)textureIndex {
+  // The policy takes over the lock the framebuffer got in -setInputFramebuffer:index: and gives it back through its release block
+  GPUImageFramebuffer *framebuffer = [self getInputFramebuffer:textureIndex];
+  if (framebuffer == nil) {
+    return;
+  }
+  [self.frameSyncPolicy receiveFrame:framebuffer atTime:frameTime index:textureIndex];
+
+  NSArray *frameSet;
+  CMTime renderTime;
+  while ((frameSet = [self.frameSyncPolicy frameSetToRenderWithTime:&renderTime])) {
+    // Every render locks its inputs once more for -postRender to unlock
+    if (![self wantsFrameAtTime:renderTime]) {
+      [self.frameSyncPolicy didSkipFrameSet];
+      _skippedFrameCount++;
+      continue;
+    }
+    for (NSUInteger input = 0; input < self.numberOfInputs; input++) {
+      [self setInputFramebuffer:frameSet[input] index:input];
+    }
+    [self.timeline advanceToTime:renderTime];
+    [self renderOrReuseStaticContent];
+    // Retired before informing targets, in case the chain loops back into this filter
+    [self.frameSyncPolicy didRenderFrameSet];
+    [self informTargetsAboutNewFrameAtTime:renderTime];
+  }
+}
+
+- (void)setFrameSyncPolicy:(GPUImageFrameSyncPolicy *)newValue {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [_frameSyncPolicy removeAllFrames];
+    _frameSyncPolicy = newValue;
+    newValue.frameReleaseBlock = ^(id frame) {
+      [(GPUImageFramebuffer *)frame unlock];
+    };
+    [newValue resetWithNumberOfInputs:self.numberOfInputs];
+    [self dropFrames];
+  });
+}
+
 - (void)forceProcessingAtSize:(CGSize)frameSize {
+  if (CGSizeEqualToSize(frameSize, CGSizeZero)) {
+    self.sizeOverride = SIZE_NO_LIMIT;
+    [self updateOldSizes];
+    return;
+  }
   NSAssert(frameSize.width * frameSize.height > 0.0, @"Invalid input size");
   self.sizeOverride = SIZE_LIMIT;
   self.sizeOverrideLimit = frameSize;
@@ -507,12 +728,24 @@ typedef NS_ENUM(NSUInteger, SizeOverride) {
 }
 
 - (void)forceProcessingAtSizeRespectingAspectRatio:(CGSize)frameSize {
+  if (CGSizeEqualToSize(frameSize, CGSizeZero)) {
+    [self forceProcessingAtSize:CGSizeZero];
+    return;
+  }
   NSAssert(frameSize.width * frameSize.height > 0.0, @"Invalid input size");
   self.sizeOverride = SIZE_LIMIT_AR;
   self.sizeOverrideLimit = frameSize;
   [self updateOldSizes];
 }
 
+- (CGSize)forcedProcessingSize {
+  return (self.sizeOverride == SIZE_NO_LIMIT) ? CGSizeZero : self.sizeOverrideLimit;
+}
+
+- (BOOL)forcedProcessingRespectsAspectRatio {
+  return self.sizeOverride == SIZE_LIMIT_AR;
+}
+
 - (void)updateOldSizes {
   for (NSUInteger input = 0; input < self.numberOfInputs; input++) {
     [self setInputSize:[self getInputSize:input] index:input];
@@ -535,6 +768,9 @@ typedef NS_ENUM(NSUInteger, SizeOverride) {
   self.backgroundColorGreen = greenComponent;
   self.backgroundColorBlue = blueComponent;
   self.backgroundColorAlpha = alphaComponent;
+  if (self.hasStaticContent) {
+    [self invalidateStaticContent];
+  }
 }
 
 - (void)setInteger:(GLint)newInteger forUniformName:(NSString *)uniformName {
@@ -700,6 +936,9 @@ typedef NS_ENUM(NSUInteger, SizeOverride) {
 - (void)setAndExecuteUniformStateCallbackAtIndex:(GLint)uniform forProgram:(GLProgram *)shaderProgram toBlock:(dispatch_block_t)uniformStateBlock {
   [self.uniformStateRestorationBlocks setObject:[uniformStateBlock copy] forKey:[NSNumber numberWithInt:uniform]];
   uniformStateBlock();
+  if (self.hasStaticContent) {
+    [self invalidateStaticContent];
+  }
 }
 
 - (void)setUniformsForProgramAtIndex:(NSUInteger)programIndex {
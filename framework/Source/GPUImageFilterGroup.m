@@ -47,6 +47,14 @@
     [self.terminalFilter setTargetToIgnoreForUpdates:targetToIgnoreForUpdates];
 }
 
+- (void)setTimeline:(GPUImageTimeline *)timeline {
+    // The group doesn't render itself, so its filters advance the timeline for properties bound on the group
+    [super setTimeline:timeline];
+    for (GPUImageOutput *currentFilter in self.filters) {
+        currentFilter.timeline = timeline;
+    }
+}
+
 - (void)addTarget:(id<GPUImageInput>)newTarget atTextureLocation:(NSInteger)textureLocation {
     [self.terminalFilter addTarget:newTarget atTextureLocation:textureLocation];
 }
@@ -117,6 +125,54 @@
     }
 }
 
+- (CGSize)forcedProcessingSize {
+    return [[self.filters firstObject] forcedProcessingSize];
+}
+
+- (BOOL)forcedProcessingRespectsAspectRatio {
+    return [[self.filters firstObject] forcedProcessingRespectsAspectRatio];
+}
+
+- (CGRect)regionOfInterestForInputAtIndex:(NSInteger)textureIndex {
+    CGRect region = CGRectNull;
+    for (GPUImageOutput<GPUImageInput> *currentFilter in self.initialFilters) {
+        CGRect filterRegion = kGPUImageFullRegionOfInterest;
+        if ([currentFilter respondsToSelector:@selector(regionOfInterestForInputAtIndex:)]) {
+            filterRegion = [currentFilter regionOfInterestForInputAtIndex:textureIndex];
+        }
+        region = CGRectUnion(region, filterRegion);
+    }
+    return CGRectIsNull(region) ? kGPUImageFullRegionOfInterest : region;
+}
+
+- (BOOL)wantsMonochromeInput {
+    if ([self.initialFilters count] == 0) {
+        return NO;
+    }
+    for (GPUImageOutput<GPUImageInput> *currentFilter in self.initialFilters) {
+        if (![currentFilter respondsToSelector:@selector(wantsMonochromeInput)] || ![currentFilter wantsMonochromeInput]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+- (BOOL)wantsFrameAtTime:(CMTime)frameTime {
+    if ([self.initialFilters count] == 0) {
+        return YES;
+    }
+    BOOL wantsFrame = NO;
+    for (GPUImageOutput<GPUImageInput> *currentFilter in self.initialFilters) {
+        if (currentFilter == self.inputFilterToIgnoreForUpdates) {
+            continue;
+        }
+        if (![currentFilter respondsToSelector:@selector(wantsFrameAtTime:)] || [currentFilter wantsFrameAtTime:frameTime]) {
+            wantsFrame = YES;
+        }
+    }
+    return wantsFrame;
+}
+
 - (CGSize)maximumOutputSize {
     // I'm temporarily disabling adjustments for smaller output sizes until I figure out how to make this work better
     return CGSizeZero;
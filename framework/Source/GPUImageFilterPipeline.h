@@ -1,5 +1,6 @@
 #import <Foundation/Foundation.h>
 #import "GPUImageOutput.h"
+#import "GPUImageGraphDescription.h"
 
 @interface GPUImageFilterPipeline : NSObject
 {
@@ -11,10 +12,31 @@
 @property (strong) GPUImageOutput *input;
 @property (strong) id <GPUImageInput> output;
 
+/// The graph the pipeline was built from, until filters are edited and the pipeline becomes a linear chain of them
+@property (strong, readonly) GPUImageGraphDescription *graphDescription;
+
 - (id) initWithOrderedFilters:(NSArray*) filters input:(GPUImageOutput*)input output:(id <GPUImageInput>)output;
+
+/** Build the filters of a graph, upstream first in filters, and link them between input and output
+ @param error Set when a filter doesn't take as many inputs as its node lists
+ */
+- (id) initWithGraphDescription:(GPUImageGraphDescription *)graphDescription input:(GPUImageOutput*)input output:(id <GPUImageInput>)output error:(NSError **)error;
+
+/** Either a graph in the format of GPUImageGraphDescription, or the older property list of a linear chain: a Filters array of FilterName and Attributes, the attributes being setter selectors with float(…), CGPoint(…) or NSString(…) arguments
+ @param error Set to an NSFileReadCorruptFileError in NSCocoaErrorDomain when the configuration can't be loaded
+ */
+- (id) initWithConfiguration:(NSDictionary*) configuration input:(GPUImageOutput*)input output:(id <GPUImageInput>)output error:(NSError **)error;
+
+/// A .json file is loaded as a GPUImageGraphDescription, anything else as a property list
+- (id) initWithConfigurationFile:(NSURL*) configuration input:(GPUImageOutput*)input output:(id <GPUImageInput>)output error:(NSError **)error;
+
+/// As above, logging the error and returning nil when the configuration can't be loaded
 - (id) initWithConfiguration:(NSDictionary*) configuration input:(GPUImageOutput*)input output:(id <GPUImageInput>)output;
 - (id) initWithConfigurationFile:(NSURL*) configuration input:(GPUImageOutput*)input output:(id <GPUImageInput>)output;
 
+/// The filter of a node, for pipelines built from a graph
+- (GPUImageOutput<GPUImageInput> *) filterWithIdentifier:(NSString *)identifier;
+
 - (void) addFilter:(GPUImageOutput<GPUImageInput> *)filter;
 - (void) addFilter:(GPUImageOutput<GPUImageInput> *)filter atIndex:(NSUInteger)insertIndex;
 - (void) replaceFilterAtIndex:(NSUInteger)index withFilter:(GPUImageOutput<GPUImageInput> *)filter;
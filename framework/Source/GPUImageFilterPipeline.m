@@ -1,13 +1,21 @@
 #import "GPUImageFilterPipeline.h"
 
 @interface GPUImageFilterPipeline ()
+{
+    NSDictionary *filtersByIdentifier;
+}
 
-- (BOOL)_parseConfiguration:(NSDictionary *)configuration;
+- (BOOL)_parseConfiguration:(NSDictionary *)configuration error:(NSError **)error;
 
+- (void)_linkGraph;
 - (void)_refreshFilters;
 
 @end
 
+static NSError *configurationError(NSString *reason) {
+    return [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadCorruptFileError userInfo:@{NSLocalizedFailureReasonErrorKey: reason}];
+}
+
 @implementation GPUImageFilterPipeline
 
 @synthesize filters = _filters, input = _input, output = _output;
@@ -15,13 +23,30 @@
 #pragma mark Config file init
 
 - (id)initWithConfiguration:(NSDictionary *)configuration input:(GPUImageOutput *)input output:(id <GPUImageInput>)output {
+    NSError *error = nil;
+    self = [self initWithConfiguration:configuration input:input output:output error:&error];
+    if (!self) {
+        NSLog(@"Couldn't load the filter pipeline: %@", [error localizedFailureReason]);
+    }
+    return self;
+}
+
+- (id)initWithConfiguration:(NSDictionary *)configuration input:(GPUImageOutput *)input output:(id <GPUImageInput>)output error:(NSError **)error {
+    // Graphs carry a version, the older format doesn't
+    if ([configuration isKindOfClass:[NSDictionary class]] && [configuration objectForKey:@"version"] != nil) {
+        GPUImageGraphDescription *graphDescription = [[GPUImageGraphDescription alloc] initWithDictionary:configuration error:error];
+        if (!graphDescription) {
+            return nil;
+        }
+        return [self initWithGraphDescription:graphDescription input:input output:output error:error];
+    }
+
     self = [super init];
     if (self) {
         self.input = input;
         self.output = output;
-        if (![self _parseConfiguration:configuration]) {
-            NSLog(@"Sorry, a parsing error occurred.");
-            abort();
+        if (![self _parseConfiguration:configuration error:error]) {
+            return nil;
         }
         [self _refreshFilters];
     }
@@ -29,25 +54,61 @@
 }
 
 - (id)initWithConfigurationFile:(NSURL *)configuration input:(GPUImageOutput *)input output:(id <GPUImageInput>)output {
-    return [self initWithConfiguration:[NSDictionary dictionaryWithContentsOfURL:configuration] input:input output:output];
+    NSError *error = nil;
+    self = [self initWithConfigurationFile:configuration input:input output:output error:&error];
+    if (!self) {
+        NSLog(@"Couldn't load the filter pipeline from %@: %@", configuration, [error localizedFailureReason]);
+    }
+    return self;
+}
+
+- (id)initWithConfigurationFile:(NSURL *)configuration input:(GPUImageOutput *)input output:(id <GPUImageInput>)output error:(NSError **)error {
+    if ([[[configuration pathExtension] lowercaseString] isEqualToString:@"json"]) {
+        GPUImageGraphDescription *graphDescription = [GPUImageGraphDescription graphDescriptionWithContentsOfURL:configuration error:error];
+        if (!graphDescription) {
+            return nil;
+        }
+        return [self initWithGraphDescription:graphDescription input:input output:output error:error];
+    }
+
+    NSDictionary *configurationDictionary = [NSDictionary dictionaryWithContentsOfURL:configuration];
+    if (!configurationDictionary) {
+        if (error) {
+            *error = configurationError(@"The file isn't a property list");
+        }
+        return nil;
+    }
+    return [self initWithConfiguration:configurationDictionary input:input output:output error:error];
 }
 
-- (BOOL)_parseConfiguration:(NSDictionary *)configuration {
-    NSArray *filters = [configuration objectForKey:@"Filters"];
-    if (!filters) {
+- (BOOL)_parseConfiguration:(NSDictionary *)configuration error:(NSError **)error {
+    NSArray *filters = [configuration isKindOfClass:[NSDictionary class]] ? [configuration objectForKey:@"Filters"] : nil;
+    if (![filters isKindOfClass:[NSArray class]]) {
+        if (error) {
+            *error = configurationError(@"Missing Filters array");
+        }
         return NO;
     }
     
-    NSError *regexError = nil;
-    NSRegularExpression *parsingRegex = [NSRegularExpression regularExpressionWithPattern:@"(float|CGPoint|NSString)\\((.*?)(?:,\\s*(.*?))*\\)"
-                                                                                  options:0
-                                                                                    error:&regexError];
+    static NSRegularExpression *parsingRegex = nil;
+    static dispatch_once_t pred;
+    dispatch_once(&pred, ^{
+        parsingRegex = [NSRegularExpression regularExpressionWithPattern:@"(float|CGPoint|NSString)\\((.*?)(?:,\\s*(.*?))*\\)"
+                                                                 options:0
+                                                                   error:NULL];
+    });
     
     // It's faster to put them into an array and then pass it to the filters property than it is to call [self addFilter:] every time
     NSMutableArray *orderedFilters = [NSMutableArray arrayWithCapacity:[filters count]];
     for (NSDictionary *filter in filters) {
-        NSString *filterName = [filter objectForKey:@"FilterName"];
-        Class theClass = NSClassFromString(filterName);
+        NSString *filterName = [filter isKindOfClass:[NSDictionary class]] ? [filter objectForKey:@"FilterName"] : nil;
+        Class theClass = [filterName isKindOfClass:[NSString class]] ? NSClassFromString(filterName) : Nil;
+        if (![theClass isSubclassOfClass:[GPUImageOutput class]] || ![theClass conformsToProtocol:@protocol(GPUImageInput)]) {
+            if (error) {
+                *error = configurationError([NSString stringWithFormat:@"%@ isn't a filter class", filterName]);
+            }
+            return NO;
+        }
         GPUImageOutput<GPUImageInput> *genericFilter = [[theClass alloc] init];
         // Set up the properties
         NSDictionary *filterAttributes;
@@ -55,7 +116,14 @@
             for (NSString *propertyKey in filterAttributes) {
                 // Set up the selector
                 SEL theSelector = NSSelectorFromString(propertyKey);
-                NSInvocation *inv = [NSInvocation invocationWithMethodSignature:[theClass instanceMethodSignatureForSelector:theSelector]];
+                NSMethodSignature *signature = [theClass instanceMethodSignatureForSelector:theSelector];
+                if (!signature || [signature numberOfArguments] != ([propertyKey hasSuffix:@":"] ? 3 : 2)) {
+                    if (error) {
+                        *error = configurationError([NSString stringWithFormat:@"%@ has no method %@ taking one argument", filterName, propertyKey]);
+                    }
+                    return NO;
+                }
+                NSInvocation *inv = [NSInvocation invocationWithMethodSignature:signature];
                 [inv setSelector:theSelector];
                 [inv setTarget:genericFilter];
                 
@@ -65,63 +133,49 @@
                     stringValue = nil;
                     
                     // Then parse the arguments
-                    NSMutableArray *parsedArray;
-                    if ([[filterAttributes objectForKey:propertyKey] isKindOfClass:[NSArray class]]) {
-                        NSArray *array = [filterAttributes objectForKey:propertyKey];
-                        parsedArray = [NSMutableArray arrayWithCapacity:[array count]];
-                        for (NSString *string in array) {
-                            NSTextCheckingResult *parse = [parsingRegex firstMatchInString:string
-                                                                                   options:0
-                                                                                     range:NSMakeRange(0, [string length])];
-
-                            NSString *modifier = [string substringWithRange:[parse rangeAtIndex:1]];
-                            if ([modifier isEqualToString:@"float"]) {
-                                // Float modifier, one argument
-                                GLfloat value = [[string substringWithRange:[parse rangeAtIndex:2]] floatValue];
-                                [parsedArray addObject:[NSNumber numberWithFloat:value]];
-                                [inv setArgument:&value atIndex:2];
-                            } else if ([modifier isEqualToString:@"CGPoint"]) {
-                                // CGPoint modifier, two float arguments
-                                GLfloat x = [[string substringWithRange:[parse rangeAtIndex:2]] floatValue];
-                                GLfloat y = [[string substringWithRange:[parse rangeAtIndex:3]] floatValue];
-                                CGPoint value = CGPointMake(x, y);
-                                [parsedArray addObject:[NSValue valueWithCGPoint:value]];
-                            } else if ([modifier isEqualToString:@"NSString"]) {
-                                // NSString modifier, one string argument
-                                stringValue = [[string substringWithRange:[parse rangeAtIndex:2]] copy];
-                                [inv setArgument:&stringValue atIndex:2];
-                                
-                            } else {
-                                return NO;
+                    id attributeValue = [filterAttributes objectForKey:propertyKey];
+                    NSArray *strings = [attributeValue isKindOfClass:[NSArray class]] ? attributeValue : @[attributeValue];
+                    NSMutableArray *parsedArray = [NSMutableArray arrayWithCapacity:[strings count]];
+                    for (NSString *string in strings) {
+                        NSTextCheckingResult *parse = [string isKindOfClass:[NSString class]] ? [parsingRegex firstMatchInString:string
+                                                                                                                          options:0
+                                                                                                                            range:NSMakeRange(0, [string length])] : nil;
+                        if (!parse) {
+                            if (error) {
+                                *error = configurationError([NSString stringWithFormat:@"Can't parse %@ of %@", propertyKey, filterName]);
                             }
+                            return NO;
                         }
-                        [inv setArgument:&parsedArray atIndex:2];
-                    } else {
-                        NSString *string = [filterAttributes objectForKey:propertyKey];
-                        NSTextCheckingResult *parse = [parsingRegex firstMatchInString:string
-                                                                               options:0
-                                                                                 range:NSMakeRange(0, [string length])];
-                        
+
                         NSString *modifier = [string substringWithRange:[parse rangeAtIndex:1]];
                         if ([modifier isEqualToString:@"float"]) {
                             // Float modifier, one argument
                             GLfloat value = [[string substringWithRange:[parse rangeAtIndex:2]] floatValue];
+                            [parsedArray addObject:[NSNumber numberWithFloat:value]];
                             [inv setArgument:&value atIndex:2];
                         } else if ([modifier isEqualToString:@"CGPoint"]) {
                             // CGPoint modifier, two float arguments
+                            if ([parse rangeAtIndex:3].location == NSNotFound) {
+                                if (error) {
+                                    *error = configurationError([NSString stringWithFormat:@"%@ of %@ needs two coordinates", propertyKey, filterName]);
+                                }
+                                return NO;
+                            }
                             GLfloat x = [[string substringWithRange:[parse rangeAtIndex:2]] floatValue];
                             GLfloat y = [[string substringWithRange:[parse rangeAtIndex:3]] floatValue];
                             CGPoint value = CGPointMake(x, y);
+                            [parsedArray addObject:[NSValue valueWithCGPoint:value]];
                             [inv setArgument:&value atIndex:2];
-                        } else if ([modifier isEqualToString:@"NSString"]) {
+                        } else {
                             // NSString modifier, one string argument
                             stringValue = [[string substringWithRange:[parse rangeAtIndex:2]] copy];
                             [inv setArgument:&stringValue atIndex:2];
-                            
-                        } else {
-                            return NO;
                         }
                     }
+                    // Setters given a list take all the parsed values at once
+                    if ([attributeValue isKindOfClass:[NSArray class]]) {
+                        [inv setArgument:&parsedArray atIndex:2];
+                    }
                 }
                 
 
@@ -135,6 +189,58 @@
     return YES;
 }
 
+#pragma mark Graph init
+
+- (id)initWithGraphDescription:(GPUImageGraphDescription *)graphDescription input:(GPUImageOutput *)input output:(id <GPUImageInput>)output error:(NSError **)error {
+    self = [super init];
+    if (self) {
+        self.input = input;
+        self.output = output;
+
+        NSMutableArray *orderedFilters = [NSMutableArray arrayWithCapacity:[graphDescription.nodeIdentifiers count]];
+        NSMutableDictionary *filtersForNodes = [NSMutableDictionary dictionaryWithCapacity:[graphDescription.nodeIdentifiers count]];
+        for (NSString *identifier in graphDescription.nodeIdentifiers) {
+            GPUImageOutput<GPUImageInput> *filter = [graphDescription newFilterForNode:identifier error:error];
+            if (!filter) {
+                return nil;
+            }
+            [orderedFilters addObject:filter];
+            [filtersForNodes setObject:filter forKey:identifier];
+        }
+        self.filters = orderedFilters;
+        filtersByIdentifier = filtersForNodes;
+        _graphDescription = graphDescription;
+        [self _linkGraph];
+    }
+    return self;
+}
+
+- (GPUImageOutput<GPUImageInput> *)filterWithIdentifier:(NSString *)identifier {
+    return [filtersByIdentifier objectForKey:identifier];
+}
+
+- (void)_linkGraph {
+    [self.input removeAllTargets];
+    for (GPUImageOutput<GPUImageInput> *filter in self.filters) {
+        [filter removeAllTargets];
+    }
+
+    for (NSString *identifier in self.graphDescription.nodeIdentifiers) {
+        GPUImageOutput<GPUImageInput> *filter = [filtersByIdentifier objectForKey:identifier];
+        NSArray *inputs = [self.graphDescription inputIdentifiersOfNode:identifier];
+        for (NSUInteger textureIndex = 0; textureIndex < [inputs count]; textureIndex++) {
+            NSString *inputIdentifier = [inputs objectAtIndex:textureIndex];
+            GPUImageOutput *inputFilter = [inputIdentifier isEqualToString:kGPUImageGraphInputIdentifier] ? self.input : [filtersByIdentifier objectForKey:inputIdentifier];
+            [inputFilter addTarget:filter atTextureLocation:textureIndex];
+        }
+    }
+
+    // The output node sorts last
+    if (self.output != nil) {
+        [[self.filters lastObject] addTarget:self.output];
+    }
+}
+
 #pragma mark Regular init
 
 - (id)initWithOrderedFilters:(NSArray *)filters input:(GPUImageOutput *)input output:(id <GPUImageInput>)output {
@@ -185,6 +291,9 @@
 }
 
 - (void)_refreshFilters {
+    // Edited filters are chained in order, whatever graph they came from
+    _graphDescription = nil;
+    filtersByIdentifier = nil;
     
     id prevFilter = self.input;
     GPUImageOutput<GPUImageInput> *theFilter = nil;
@@ -0,0 +1,104 @@
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+
+typedef enum {
+  /// Frames arriving while one is rendering are dropped, so the output is always as fresh as possible
+  kGPUImageFramePacingDropNewest,
+  /// Frames arriving while one is rendering wait in a short queue, and the oldest waiting frame is dropped when it is full. Fewer drops under bursty load, for up to maximumQueueLength frames of extra latency
+  kGPUImageFramePacingDropOldest
+} GPUImageFramePacingDropPolicy;
+
+/** Decides which camera frames get rendered when the filter chain can't keep up, and measures how it copes
+
+ The owner offers every arriving frame with -receiveFrame:, takes frames to render with -nextFrameToRender and reports each finished one with -didFinishRenderingFrame. Frames are opaque objects and all times come from the clock block, so the controller can be driven by a synthetic clock and frame source.
+
+ From the render durations and arrival intervals the controller estimates the load of the chain. Under sustained overload it first lowers the processing resolution, then the frame rate, and it restores them in the opposite order once there is headroom again. It only reports the new values through the change blocks, applying them is up to the owner.
+ All methods are thread safe.
+ */
+@interface GPUImageFramePacingController : NSObject
+
+/// kGPUImageFramePacingDropNewest by default, which matches a camera without a controller
+@property (nonatomic, assign) GPUImageFramePacingDropPolicy dropPolicy;
+
+/// Frames waiting behind the one rendering under kGPUImageFramePacingDropOldest, 2 by default
+@property (nonatomic, assign) NSUInteger maximumQueueLength;
+
+/// Returns the current time in seconds, CACurrentMediaTime() by default
+@property (nonatomic, copy) CFTimeInterval (^clock)(void);
+
+#pragma mark - Statistics
+
+@property (nonatomic, assign, readonly) NSUInteger receivedFrameCount;
+@property (nonatomic, assign, readonly) NSUInteger renderedFrameCount;
+@property (nonatomic, assign, readonly) NSUInteger droppedFrameCount;
+
+/// The most frames dropped in a row, which shows whether drops are spread out or clustered
+@property (nonatomic, assign, readonly) NSUInteger longestDropRun;
+
+/// Time from the arrival of a frame to the end of its render, averaged over the rendered frames
+@property (nonatomic, assign, readonly) CFTimeInterval averageLatency;
+@property (nonatomic, assign, readonly) CFTimeInterval maximumLatency;
+
+/// Width of the latency histogram buckets, 4 ms by default
+@property (nonatomic, assign) CFTimeInterval latencyHistogramBucketWidth;
+
+/// Number of latency histogram buckets, the last one also counting every longer latency, 25 by default
+@property (nonatomic, assign) NSUInteger latencyHistogramBucketCount;
+
+/// Rendered frames per latency bucket, as NSNumbers
+- (NSArray *)latencyHistogram;
+
+- (void)resetStatistics;
+
+#pragma mark - Frames
+
+- (void)receiveFrame:(id)frame;
+
+/// The frame to render next, or nil when none is waiting. Call it only when no other frame is rendering
+- (id)nextFrameToRender;
+
+- (void)didFinishRenderingFrame;
+
+- (BOOL)hasQueuedFrames;
+
+/// Drops every waiting frame without counting them
+- (void)removeAllFrames;
+
+#pragma mark - Load adaptation
+
+/// Render time as a fraction of the time between frames, smoothed over recent frames
+@property (nonatomic, assign, readonly) CGFloat load;
+
+/// Load above which the controller steps down, 0.85 by default
+@property (nonatomic, assign) CGFloat overloadThreshold;
+
+/// Shortest time between two adaptation steps, 0.5 s by default
+@property (nonatomic, assign) CFTimeInterval adaptationInterval;
+
+/// Whether to scale the processing resolution with the load, NO by default
+@property (nonatomic, assign) BOOL adaptsResolution;
+
+/// Scale of the processing size relative to the full size, 1.0 without adaptation
+@property (nonatomic, assign, readonly) CGFloat resolutionScale;
+
+/// Lowest resolution scale, 0.5 by default
+@property (nonatomic, assign) CGFloat minimumResolutionScale;
+
+@property (nonatomic, copy) void (^resolutionScaleChangedBlock)(CGFloat resolutionScale);
+
+/// Whether to lower the frame rate when scaling the resolution isn't possible or enough, NO by default
+@property (nonatomic, assign) BOOL adaptsFrameRate;
+
+/// Frame rate the controller asks for, maximumFrameRate without adaptation
+@property (nonatomic, assign, readonly) int32_t targetFrameRate;
+
+/// Frame rate range of the adaptation, 15 to 30 by default
+@property (nonatomic, assign) int32_t minimumFrameRate;
+@property (nonatomic, assign) int32_t maximumFrameRate;
+
+@property (nonatomic, copy) void (^frameRateChangedBlock)(int32_t frameRate);
+
+/// Go back to full resolution and the maximum frame rate, calling the change blocks if needed
+- (void)resetAdaptation;
+
+@end
@@ -0,0 +1,327 @@
+#import "GPUImageFramePacingController.h"
+#import <QuartzCore/QuartzCore.h>
+
+// Weight of the newest sample in the smoothed render duration and arrival interval
+static const CFTimeInterval kGPUImageFramePacingSmoothing = 0.1;
+
+// Each step scales the resolution or the frame rate by this, and steps back up are only taken if the predicted load stays below this fraction of the overload threshold
+static const CGFloat kGPUImageFramePacingStep = 0.8;
+static const CGFloat kGPUImageFramePacingHeadroom = 0.75;
+
+@interface GPUImageFramePacingEntry : NSObject
+
+@property (nonatomic, strong) id frame;
+@property (nonatomic, assign) CFTimeInterval arrivalTime;
+
+@end
+
+@implementation GPUImageFramePacingEntry
+
+@end
+
+@interface GPUImageFramePacingController()
+{
+  NSUInteger *latencyBuckets;
+}
+
+@property (nonatomic, strong) dispatch_queue_t pacingQueue;
+@property (nonatomic, strong) NSMutableArray *queuedEntries;
+@property (nonatomic, strong) GPUImageFramePacingEntry *renderingEntry;
+@property (nonatomic, assign) CFTimeInterval renderStartTime;
+
+@property (nonatomic, assign) CFTimeInterval lastArrivalTime;
+@property (nonatomic, assign) CFTimeInterval smoothedArrivalInterval;
+@property (nonatomic, assign) CFTimeInterval smoothedRenderDuration;
+@property (nonatomic, assign) CFTimeInterval totalLatency;
+@property (nonatomic, assign) NSUInteger currentDropRun;
+@property (nonatomic, assign) CFTimeInterval lastAdaptationTime;
+
+@end
+
+@implementation GPUImageFramePacingController
+
+#pragma mark - Initialization and teardown
+
+- (id)init {
+  if (!(self = [super init])) {
+    return nil;
+  }
+
+  self.pacingQueue = dispatch_queue_create("com.sunsetlakesoftware.GPUImage.framePacingQueue", DISPATCH_QUEUE_SERIAL);
+  self.queuedEntries = [NSMutableArray array];
+  self.clock = ^CFTimeInterval {
+    return CACurrentMediaTime();
+  };
+
+  _dropPolicy = kGPUImageFramePacingDropNewest;
+  _maximumQueueLength = 2;
+  _latencyHistogramBucketWidth = 0.004;
+  _latencyHistogramBucketCount = 25;
+  latencyBuckets = calloc(_latencyHistogramBucketCount, sizeof(NSUInteger));
+
+  _overloadThreshold = 0.85;
+  _adaptationInterval = 0.5;
+  _resolutionScale = 1.0;
+  _minimumResolutionScale = 0.5;
+  _minimumFrameRate = 15;
+  _maximumFrameRate = 30;
+  _targetFrameRate = 30;
+
+  [self resetStatistics];
+
+  return self;
+}
+
+- (void)dealloc {
+  free(latencyBuckets);
+}
+
+#pragma mark - Statistics
+
+- (void)setLatencyHistogramBucketWidth:(CFTimeInterval)latencyHistogramBucketWidth {
+  NSAssert(latencyHistogramBucketWidth > 0.0, @"Invalid bucket width");
+  dispatch_sync(self.pacingQueue, ^{
+    _latencyHistogramBucketWidth = latencyHistogramBucketWidth;
+    memset(latencyBuckets, 0, _latencyHistogramBucketCount * sizeof(NSUInteger));
+  });
+}
+
+- (void)setLatencyHistogramBucketCount:(NSUInteger)latencyHistogramBucketCount {
+  NSAssert(latencyHistogramBucketCount > 0, @"The histogram needs at least one bucket");
+  dispatch_sync(self.pacingQueue, ^{
+    _latencyHistogramBucketCount = latencyHistogramBucketCount;
+    free(latencyBuckets);
+    latencyBuckets = calloc(latencyHistogramBucketCount, sizeof(NSUInteger));
+  });
+}
+
+- (NSArray *)latencyHistogram {
+  __block NSMutableArray *histogram;
+  dispatch_sync(self.pacingQueue, ^{
+    histogram = [NSMutableArray arrayWithCapacity:self.latencyHistogramBucketCount];
+    for (NSUInteger bucket = 0; bucket < self.latencyHistogramBucketCount; bucket++) {
+      [histogram addObject:@(latencyBuckets[bucket])];
+    }
+  });
+  return histogram;
+}
+
+- (void)resetStatistics {
+  dispatch_sync(self.pacingQueue, ^{
+    _receivedFrameCount = 0;
+    _renderedFrameCount = 0;
+    _droppedFrameCount = 0;
+    _longestDropRun = 0;
+    _averageLatency = 0.0;
+    _maximumLatency = 0.0;
+    self.totalLatency = 0.0;
+    self.currentDropRun = 0;
+    memset(latencyBuckets, 0, self.latencyHistogramBucketCount * sizeof(NSUInteger));
+  });
+}
+
+- (void)recordDroppedEntry {
+  _droppedFrameCount++;
+  self.currentDropRun++;
+  _longestDropRun = MAX(self.longestDropRun, self.currentDropRun);
+}
+
+- (void)recordLatency:(CFTimeInterval)latency {
+  _renderedFrameCount++;
+  self.totalLatency += latency;
+  _averageLatency = self.totalLatency / self.renderedFrameCount;
+  _maximumLatency = MAX(self.maximumLatency, latency);
+
+  NSUInteger bucket = (NSUInteger)MAX(floor(latency / self.latencyHistogramBucketWidth), 0.0);
+  latencyBuckets[MIN(bucket, self.latencyHistogramBucketCount - 1)]++;
+}
+
+#pragma mark - Frames
+
+- (void)receiveFrame:(id)frame {
+  NSParameterAssert(frame != nil);
+  CFTimeInterval now = self.clock();
+
+  dispatch_sync(self.pacingQueue, ^{
+    _receivedFrameCount++;
+    if (self.receivedFrameCount > 1) {
+      CFTimeInterval arrivalInterval = MAX(now - self.lastArrivalTime, 0.0);
+      self.smoothedArrivalInterval = (self.smoothedArrivalInterval > 0.0) ? self.smoothedArrivalInterval + kGPUImageFramePacingSmoothing * (arrivalInterval - self.smoothedArrivalInterval) : arrivalInterval;
+    }
+    self.lastArrivalTime = now;
+
+    if (self.dropPolicy == kGPUImageFramePacingDropNewest && (self.renderingEntry != nil || [self.queuedEntries count] > 0)) {
+      [self recordDroppedEntry];
+      return;
+    }
+
+    GPUImageFramePacingEntry *entry = [[GPUImageFramePacingEntry alloc] init];
+    entry.frame = frame;
+    entry.arrivalTime = now;
+    [self.queuedEntries addObject:entry];
+
+    while ([self.queuedEntries count] > MAX(self.maximumQueueLength, 1)) {
+      [self.queuedEntries removeObjectAtIndex:0];
+      [self recordDroppedEntry];
+    }
+  });
+}
+
+- (id)nextFrameToRender {
+  CFTimeInterval now = self.clock();
+
+  __block id frame = nil;
+  dispatch_sync(self.pacingQueue, ^{
+    NSAssert(self.renderingEntry == nil, @"Finish the previous frame with -didFinishRenderingFrame first");
+    GPUImageFramePacingEntry *entry = [self.queuedEntries firstObject];
+    if (entry == nil) {
+      return;
+    }
+
+    [self.queuedEntries removeObjectAtIndex:0];
+    self.renderingEntry = entry;
+    self.renderStartTime = now;
+    self.currentDropRun = 0;
+    frame = entry.frame;
+  });
+  return frame;
+}
+
+- (void)didFinishRenderingFrame {
+  CFTimeInterval now = self.clock();
+
+  __block void (^changeBlock)(void) = nil;
+  dispatch_sync(self.pacingQueue, ^{
+    GPUImageFramePacingEntry *entry = self.renderingEntry;
+    if (entry == nil) {
+      return;
+    }
+    self.renderingEntry = nil;
+
+    [self recordLatency:MAX(now - entry.arrivalTime, 0.0)];
+    CFTimeInterval renderDuration = MAX(now - self.renderStartTime, 0.0);
+    self.smoothedRenderDuration = (self.renderedFrameCount > 1) ? self.smoothedRenderDuration + kGPUImageFramePacingSmoothing * (renderDuration - self.smoothedRenderDuration) : renderDuration;
+
+    changeBlock = [self adaptationStepAtTime:now];
+  });
+
+  // Called outside of the lock, so that the owner can query the controller from it
+  if (changeBlock != nil) {
+    changeBlock();
+  }
+}
+
+- (BOOL)hasQueuedFrames {
+  __block BOOL hasQueuedFrames;
+  dispatch_sync(self.pacingQueue, ^{
+    hasQueuedFrames = [self.queuedEntries count] > 0;
+  });
+  return hasQueuedFrames;
+}
+
+- (void)removeAllFrames {
+  dispatch_sync(self.pacingQueue, ^{
+    [self.queuedEntries removeAllObjects];
+  });
+}
+
+#pragma mark - Load adaptation
+
+- (CGFloat)load {
+  __block CGFloat load;
+  dispatch_sync(self.pacingQueue, ^{
+    load = [self currentLoad];
+  });
+  return load;
+}
+
+- (CGFloat)currentLoad {
+  return (self.smoothedArrivalInterval > 0.0) ? self.smoothedRenderDuration / self.smoothedArrivalInterval : 0.0;
+}
+
+- (void)setMaximumFrameRate:(int32_t)maximumFrameRate {
+  NSAssert(maximumFrameRate > 0, @"Invalid frame rate");
+  dispatch_sync(self.pacingQueue, ^{
+    if (_targetFrameRate == _maximumFrameRate || _targetFrameRate > maximumFrameRate) {
+      _targetFrameRate = maximumFrameRate;
+    }
+    _maximumFrameRate = maximumFrameRate;
+  });
+}
+
+// Returns a block calling the change block of the step taken, or nil
+- (void (^)(void))adaptationStepAtTime:(CFTimeInterval)now {
+  CGFloat load = [self currentLoad];
+  if (load <= 0.0 || now - self.lastAdaptationTime < self.adaptationInterval) {
+    return nil;
+  }
+
+  CGFloat resolutionScale = self.resolutionScale;
+  int32_t frameRate = self.targetFrameRate;
+  CGFloat minimumScale = MIN(MAX(self.minimumResolutionScale, 0.01), 1.0);
+  int32_t minimumFrameRate = MIN(MAX(self.minimumFrameRate, 1), self.maximumFrameRate);
+
+  // Render time goes with the pixel count, so with the square of the resolution scale
+  if (load > self.overloadThreshold) {
+    if (self.adaptsResolution && resolutionScale > minimumScale) {
+      resolutionScale = MAX(resolutionScale * kGPUImageFramePacingStep, minimumScale);
+    } else if (self.adaptsFrameRate && frameRate > minimumFrameRate) {
+      frameRate = MAX((int32_t)floor(frameRate * kGPUImageFramePacingStep), minimumFrameRate);
+    }
+  } else {
+    CGFloat headroom = self.overloadThreshold * kGPUImageFramePacingHeadroom;
+    if (self.adaptsFrameRate && frameRate < self.maximumFrameRate) {
+      int32_t raisedFrameRate = MIN((int32_t)ceil(frameRate / kGPUImageFramePacingStep), self.maximumFrameRate);
+      if (load * raisedFrameRate / frameRate < headroom) {
+        frameRate = raisedFrameRate;
+      }
+    } else if (self.adaptsResolution && resolutionScale < 1.0) {
+      CGFloat raisedScale = MIN(resolutionScale / kGPUImageFramePacingStep, 1.0);
+      if (load * (raisedScale * raisedScale) / (resolutionScale * resolutionScale) < headroom) {
+        resolutionScale = raisedScale;
+      }
+    }
+  }
+
+  return [self changeBlockForResolutionScale:resolutionScale frameRate:frameRate atTime:now];
+}
+
+- (void (^)(void))changeBlockForResolutionScale:(CGFloat)resolutionScale frameRate:(int32_t)frameRate atTime:(CFTimeInterval)now {
+  void (^resolutionScaleChangedBlock)(CGFloat) = nil;
+  void (^frameRateChangedBlock)(int32_t) = nil;
+  if (resolutionScale != self.resolutionScale) {
+    _resolutionScale = resolutionScale;
+    resolutionScaleChangedBlock = self.resolutionScaleChangedBlock;
+  }
+  if (frameRate != self.targetFrameRate) {
+    _targetFrameRate = frameRate;
+    frameRateChangedBlock = self.frameRateChangedBlock;
+  }
+  if (resolutionScaleChangedBlock == nil && frameRateChangedBlock == nil) {
+    return nil;
+  }
+
+  self.lastAdaptationTime = now;
+  return ^{
+    if (resolutionScaleChangedBlock != nil) {
+      resolutionScaleChangedBlock(resolutionScale);
+    }
+    if (frameRateChangedBlock != nil) {
+      frameRateChangedBlock(frameRate);
+    }
+  };
+}
+
+- (void)resetAdaptation {
+  CFTimeInterval now = self.clock();
+
+  __block void (^changeBlock)(void) = nil;
+  dispatch_sync(self.pacingQueue, ^{
+    changeBlock = [self changeBlockForResolutionScale:1.0 frameRate:self.maximumFrameRate atTime:now];
+  });
+  if (changeBlock != nil) {
+    changeBlock();
+  }
+}
+
+@end
@@ -0,0 +1,25 @@
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+
+/** The demand of a target that only needs some of the frames offered to it, e.g. an analysis branch reading one frame in ten
+
+ A target answers -[GPUImageInput wantsFrameAtTime:] through its sampler. Frames are counted by timestamp, so a target asked several times about the same recent frame, by several inputs or before and after it arrives, gets the same answer and counts it once. Frames without a numeric timestamp, such as still images, are all wanted while the sampler is active.
+ */
+@interface GPUImageFrameSampler : NSObject
+
+/// NO turns the target off: upstream filters render nothing for it. YES by default
+@property (nonatomic, assign, getter=isActive) BOOL active;
+
+/// Take the first of every interval frames, 1 by default for every frame
+@property (nonatomic, assign) NSUInteger interval;
+
+/// Frames wanted and turned down since the last reset
+@property (nonatomic, assign, readonly) NSUInteger wantedFrameCount;
+@property (nonatomic, assign, readonly) NSUInteger declinedFrameCount;
+
+- (BOOL)wantsFrameAtTime:(CMTime)frameTime;
+
+/// Start counting intervals over from the next frame, and reset the counters
+- (void)reset;
+
+@end
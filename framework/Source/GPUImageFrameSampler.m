@@ -0,0 +1,79 @@
+#import "GPUImageFrameSampler.h"
+
+// Frames asked about again after newer ones, e.g. by a branch rendering asynchronously, get the answer they got the first time
+enum { kGPUImageFrameSamplerHistoryLength = 16 };
+
+typedef struct {
+  CMTime frameTime;
+  BOOL wanted;
+} GPUImageFrameSamplerDecision;
+
+@interface GPUImageFrameSampler()
+{
+  GPUImageFrameSamplerDecision history[kGPUImageFrameSamplerHistoryLength];
+}
+
+@property (nonatomic, assign) NSUInteger framesSinceLastWanted;
+@property (nonatomic, assign) NSUInteger historyCount;
+
+@end
+
+@implementation GPUImageFrameSampler
+
+#pragma mark - Initialization and teardown
+
+- (id)init {
+  if (!(self = [super init])) {
+    return nil;
+  }
+
+  _active = YES;
+  _interval = 1;
+  [self reset];
+
+  return self;
+}
+
+- (void)reset {
+  @synchronized(self) {
+    _wantedFrameCount = 0;
+    _declinedFrameCount = 0;
+    self.historyCount = 0;
+    // The next frame starts an interval
+    self.framesSinceLastWanted = NSUIntegerMax;
+  }
+}
+
+#pragma mark - Demand
+
+- (BOOL)wantsFrameAtTime:(CMTime)frameTime {
+  @synchronized(self) {
+    if (!self.isActive) {
+      return NO;
+    }
+    if (!CMTIME_IS_NUMERIC(frameTime)) {
+      return YES;
+    }
+    NSUInteger recentCount = MIN(self.historyCount, kGPUImageFrameSamplerHistoryLength);
+    for (NSUInteger age = 1; age <= recentCount; age++) {
+      GPUImageFrameSamplerDecision decision = history[(self.historyCount - age) % kGPUImageFrameSamplerHistoryLength];
+      if (CMTIME_COMPARE_INLINE(frameTime, ==, decision.frameTime)) {
+        return decision.wanted;
+      }
+    }
+
+    BOOL wanted = (self.framesSinceLastWanted >= MAX(self.interval, 1) - 1);
+    if (wanted) {
+      self.framesSinceLastWanted = 0;
+      _wantedFrameCount++;
+    } else {
+      self.framesSinceLastWanted++;
+      _declinedFrameCount++;
+    }
+    history[self.historyCount % kGPUImageFrameSamplerHistoryLength] = (GPUImageFrameSamplerDecision){frameTime, wanted};
+    self.historyCount++;
+    return wanted;
+  }
+}
+
+@end
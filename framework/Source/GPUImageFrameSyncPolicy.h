@@ -0,0 +1,110 @@
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+
+/** A frame held by a GPUImageFrameSyncPolicy
+ */
+@interface GPUImageFrameSyncEntry : NSObject
+
+@property (nonatomic, strong, readonly) id frame;
+@property (nonatomic, assign, readonly) CMTime frameTime;
+
+/// How many rendered frame sets this frame has been part of
+@property (nonatomic, assign) NSUInteger renderCount;
+
+- (id)initWithFrame:(id)frame frameTime:(CMTime)frameTime;
+
+@end
+
+/** Decides which frames of a multi-input filter are rendered together
+
+ Without a policy a multi-input filter renders once every input has delivered a frame, which stalls or drops unpredictably when the inputs run at different rates, e.g. a 60 fps camera with a 24 fps movie overlay.
+ A policy keeps a queue of frames per input and picks one frame from each queue for every render. Frames are opaque objects tagged with their presentation time, so policies can be driven with synthetic timestamps outside of a filter chain.
+
+ The owner feeds frames with -receiveFrame:atTime:index:, then renders every set returned by -frameSetToRenderWithTime: and reports each one with -didRenderFrameSet, or with -didSkipFrameSet if it decided not to render it. Frames the policy lets go of are passed to frameReleaseBlock.
+
+ This class is abstract, use one of the subclasses below or override -selectFrameSetWithTime:.
+ */
+@interface GPUImageFrameSyncPolicy : NSObject
+
+@property (nonatomic, assign, readonly) NSUInteger numberOfInputs;
+
+/// The input whose frames set the pace and the timestamps of the output, 0 by default
+@property (nonatomic, assign) NSUInteger primaryInput;
+
+/// Frames held per input before the oldest one is dropped, 8 by default
+@property (nonatomic, assign) NSUInteger maximumQueueLength;
+
+/// Called with each frame the policy no longer holds, rendered or not
+@property (nonatomic, copy) void (^frameReleaseBlock)(id frame);
+
+/// Frame sets rendered since the last reset
+@property (nonatomic, assign, readonly) NSUInteger renderedFrameCount;
+
+/// Frames released without ever being rendered
+@property (nonatomic, assign, readonly) NSUInteger droppedFrameCount;
+
+/// Times a frame was rendered again because its input had nothing newer
+@property (nonatomic, assign, readonly) NSUInteger reusedFrameCount;
+
+/// Release every held frame and start over with empty queues and counters
+- (void)resetWithNumberOfInputs:(NSUInteger)numberOfInputs;
+- (void)resetCounters;
+- (void)removeAllFrames;
+
+- (void)receiveFrame:(id)frame atTime:(CMTime)frameTime index:(NSUInteger)index;
+
+/** The frames to render next, one per input, or nil when the policy is waiting for more frames
+ @param frameTime Set to the timestamp of the output frame
+ */
+- (NSArray *)frameSetToRenderWithTime:(CMTime *)frameTime;
+
+/// Retires the frame set returned last, releasing the frames no later render can use
+- (void)didRenderFrameSet;
+
+/// Retires the frame set returned last like -didRenderFrameSet, for a set that wasn't rendered after all. It isn't counted as rendered, and frames released without another render count as dropped
+- (void)didSkipFrameSet;
+
+#pragma mark - Subclassing
+
+/// Queued entries of an input, oldest first
+- (NSMutableArray *)queueForInput:(NSUInteger)index;
+
+/// Returns one GPUImageFrameSyncEntry per input, or nil to wait. Entries older than the chosen one are released after the render, and so is the primary entry
+- (NSArray *)selectFrameSetWithTime:(CMTime *)frameTime;
+
+/// Removes an entry from its queue and releases its frame
+- (void)discardEntry:(GPUImageFrameSyncEntry *)entry fromInput:(NSUInteger)index;
+
+@end
+
+/** Renders on every primary frame with the most recent frame of each other input, reusing it as long as nothing newer has arrived
+ */
+@interface GPUImageLatestFrameSyncPolicy : GPUImageFrameSyncPolicy
+
+@end
+
+/** Renders primary frames together with the frame of each other input whose timestamp is closest, if it lies within the tolerance
+
+ Primary frames without a match on some input are dropped once that input has moved past them. Frames with a non-numeric timestamp, such as still images, match anything.
+ */
+@interface GPUImageTimestampMatchedFrameSyncPolicy : GPUImageFrameSyncPolicy
+
+/// The largest timestamp difference that still counts as a match, 1/120 s by default
+@property (nonatomic, assign) CMTime tolerance;
+
+- (id)initWithTolerance:(CMTime)tolerance;
+
+@end
+
+/** Delays the output by a fixed number of primary frames, so that late frames on the other inputs still make it into the render for their timestamp
+
+ Each primary frame is rendered with the newest frame of each other input that is not later than it.
+ */
+@interface GPUImageFixedLatencyFrameSyncPolicy : GPUImageFrameSyncPolicy
+
+/// Primary frames held back before rendering, 2 by default
+@property (nonatomic, assign) NSUInteger latency;
+
+- (id)initWithLatency:(NSUInteger)latency;
+
+@end
@@ -0,0 +1,320 @@
+#import "GPUImageFrameSyncPolicy.h"
+
+static BOOL frameSyncTimeIsLater(CMTime time, CMTime referenceTime) {
+  return CMTIME_IS_NUMERIC(time) && CMTIME_IS_NUMERIC(referenceTime) && CMTimeCompare(time, referenceTime) > 0;
+}
+
+// Non-numeric timestamps, e.g. from still images, are at no distance from anything
+static CMTime frameSyncTimeDistance(CMTime time, CMTime referenceTime) {
+  if (!CMTIME_IS_NUMERIC(time) || !CMTIME_IS_NUMERIC(referenceTime)) {
+    return kCMTimeZero;
+  }
+  return CMTimeAbsoluteValue(CMTimeSubtract(time, referenceTime));
+}
+
+@implementation GPUImageFrameSyncEntry
+
+- (id)initWithFrame:(id)frame frameTime:(CMTime)frameTime {
+  if ((self = [super init])) {
+    _frame = frame;
+    _frameTime = frameTime;
+    _renderCount = 0;
+  }
+  return self;
+}
+
+@end
+
+@interface GPUImageFrameSyncPolicy()
+
+@property (nonatomic, strong) NSMutableArray *queues;
+@property (nonatomic, strong) NSArray *pendingFrameSet;
+
+@end
+
+@implementation GPUImageFrameSyncPolicy
+
+#pragma mark - Initialization and teardown
+
+- (id)init {
+  if ((self = [super init])) {
+    _primaryInput = 0;
+    _maximumQueueLength = 8;
+    self.queues = [NSMutableArray array];
+  }
+  return self;
+}
+
+- (void)dealloc {
+  [self removeAllFrames];
+}
+
+- (void)resetWithNumberOfInputs:(NSUInteger)numberOfInputs {
+  [self removeAllFrames];
+  _numberOfInputs = numberOfInputs;
+  for (NSUInteger input = 0; input < numberOfInputs; input++) {
+    [self.queues addObject:[NSMutableArray array]];
+  }
+  [self resetCounters];
+}
+
+- (void)resetCounters {
+  _renderedFrameCount = 0;
+  _droppedFrameCount = 0;
+  _reusedFrameCount = 0;
+}
+
+- (void)removeAllFrames {
+  self.pendingFrameSet = nil;
+  for (NSUInteger input = 0; input < [self.queues count]; input++) {
+    NSMutableArray *queue = self.queues[input];
+    while ([queue count] > 0) {
+      [self discardEntry:[queue firstObject] fromInput:input];
+    }
+  }
+  [self.queues removeAllObjects];
+}
+
+#pragma mark - Frames
+
+- (NSMutableArray *)queueForInput:(NSUInteger)index {
+  NSAssert(index < self.numberOfInputs, @"Invalid input index");
+  return self.queues[index];
+}
+
+- (void)discardEntry:(GPUImageFrameSyncEntry *)entry fromInput:(NSUInteger)index {
+  if (entry.renderCount == 0) {
+    _droppedFrameCount++;
+  }
+  [[self queueForInput:index] removeObjectIdenticalTo:entry];
+  if (self.frameReleaseBlock != NULL) {
+    self.frameReleaseBlock(entry.frame);
+  }
+}
+
+- (void)receiveFrame:(id)frame atTime:(CMTime)frameTime index:(NSUInteger)index {
+  NSAssert(self.primaryInput < self.numberOfInputs, @"Primary input out of range, reset the policy with the filter's number of inputs");
+  NSMutableArray *queue = [self queueForInput:index];
+  [queue addObject:[[GPUImageFrameSyncEntry alloc] initWithFrame:frame frameTime:frameTime]];
+
+  // Entries of the pending set are still being rendered
+  while ([queue count] > MAX(self.maximumQueueLength, 1) && ![self.pendingFrameSet containsObject:[queue firstObject]]) {
+    [self discardEntry:[queue firstObject] fromInput:index];
+  }
+}
+
+- (NSArray *)selectFrameSetWithTime:(CMTime *)frameTime {
+  NSAssert(NO, @"Must inherit");
+  return nil;
+}
+
+- (NSArray *)frameSetToRenderWithTime:(CMTime *)frameTime {
+  NSAssert(self.pendingFrameSet == nil, @"Finish the previous frame set with -didRenderFrameSet first");
+  NSArray *entries = [self selectFrameSetWithTime:frameTime];
+  if (entries == nil) {
+    return nil;
+  }
+
+  self.pendingFrameSet = entries;
+  return [entries valueForKey:@"frame"];
+}
+
+- (void)didRenderFrameSet {
+  [self retirePendingFrameSetRendered:YES];
+}
+
+- (void)didSkipFrameSet {
+  [self retirePendingFrameSetRendered:NO];
+}
+
+- (void)retirePendingFrameSetRendered:(BOOL)rendered {
+  NSArray *entries = self.pendingFrameSet;
+  self.pendingFrameSet = nil;
+  if (entries == nil) {
+    return;
+  }
+
+  if (rendered) {
+    _renderedFrameCount++;
+  }
+  for (NSUInteger input = 0; input < self.numberOfInputs; input++) {
+    GPUImageFrameSyncEntry *entry = entries[input];
+    if (rendered) {
+      if (entry.renderCount > 0) {
+        _reusedFrameCount++;
+      }
+      entry.renderCount++;
+    }
+
+    // Later renders only ever pick newer frames, and never the same primary frame twice
+    NSMutableArray *queue = [self queueForInput:input];
+    NSUInteger entryIndex = [queue indexOfObjectIdenticalTo:entry];
+    if (entryIndex == NSNotFound) {
+      continue;
+    }
+    NSUInteger retiredCount = (input == self.primaryInput) ? entryIndex + 1 : entryIndex;
+    for (NSUInteger retired = 0; retired < retiredCount; retired++) {
+      [self discardEntry:[queue firstObject] fromInput:input];
+    }
+  }
+}
+
+@end
+
+@implementation GPUImageLatestFrameSyncPolicy
+
+- (void)receiveFrame:(id)frame atTime:(CMTime)frameTime index:(NSUInteger)index {
+  [super receiveFrame:frame atTime:frameTime index:index];
+
+  // Only the newest frame of each input is ever rendered
+  NSMutableArray *queue = [self queueForInput:index];
+  while ([queue count] > 1) {
+    [self discardEntry:[queue firstObject] fromInput:index];
+  }
+}
+
+- (NSArray *)selectFrameSetWithTime:(CMTime *)frameTime {
+  GPUImageFrameSyncEntry *primaryEntry = [[self queueForInput:self.primaryInput] lastObject];
+  if (primaryEntry == nil) {
+    return nil;
+  }
+
+  NSMutableArray *entries = [NSMutableArray arrayWithCapacity:self.numberOfInputs];
+  for (NSUInteger input = 0; input < self.numberOfInputs; input++) {
+    GPUImageFrameSyncEntry *entry = (input == self.primaryInput) ? primaryEntry : [[self queueForInput:input] lastObject];
+    if (entry == nil) {
+      return nil;
+    }
+    [entries addObject:entry];
+  }
+
+  *frameTime = primaryEntry.frameTime;
+  return entries;
+}
+
+@end
+
+@implementation GPUImageTimestampMatchedFrameSyncPolicy
+
+- (id)init {
+  return [self initWithTolerance:CMTimeMake(1, 120)];
+}
+
+- (id)initWithTolerance:(CMTime)tolerance {
+  if ((self = [super init])) {
+    _tolerance = tolerance;
+  }
+  return self;
+}
+
+- (NSArray *)selectFrameSetWithTime:(CMTime *)frameTime {
+  NSMutableArray *primaryQueue = [self queueForInput:self.primaryInput];
+
+  while ([primaryQueue count] > 0) {
+    GPUImageFrameSyncEntry *primaryEntry = [primaryQueue firstObject];
+    NSMutableArray *entries = [NSMutableArray arrayWithCapacity:self.numberOfInputs];
+    BOOL waiting = NO;
+    BOOL unmatchable = NO;
+
+    for (NSUInteger input = 0; input < self.numberOfInputs; input++) {
+      if (input == self.primaryInput) {
+        [entries addObject:primaryEntry];
+        continue;
+      }
+
+      // Primary timestamps only increase, so frames too old for this one are too old for all that follow
+      NSMutableArray *queue = [self queueForInput:input];
+      while ([queue count] > 0 && frameSyncTimeIsLater(primaryEntry.frameTime, CMTimeAdd([[queue firstObject] frameTime], self.tolerance))) {
+        [self discardEntry:[queue firstObject] fromInput:input];
+      }
+
+      GPUImageFrameSyncEntry *closestEntry = nil;
+      for (GPUImageFrameSyncEntry *entry in queue) {
+        CMTime distance = frameSyncTimeDistance(entry.frameTime, primaryEntry.frameTime);
+        if (CMTimeCompare(distance, self.tolerance) <= 0 && (closestEntry == nil || CMTimeCompare(distance, frameSyncTimeDistance(closestEntry.frameTime, primaryEntry.frameTime)) < 0)) {
+          closestEntry = entry;
+        }
+      }
+
+      if (closestEntry != nil) {
+        [entries addObject:closestEntry];
+      } else if ([queue count] > 0) {
+        // Every remaining frame is past the tolerance, this input will never deliver a match
+        unmatchable = YES;
+        break;
+      } else {
+        waiting = YES;
+        break;
+      }
+    }
+
+    if (unmatchable) {
+      [self discardEntry:primaryEntry fromInput:self.primaryInput];
+      continue;
+    }
+    if (waiting) {
+      return nil;
+    }
+
+    *frameTime = primaryEntry.frameTime;
+    return entries;
+  }
+
+  return nil;
+}
+
+@end
+
+@implementation GPUImageFixedLatencyFrameSyncPolicy
+
+- (id)init {
+  return [self initWithLatency:2];
+}
+
+- (id)initWithLatency:(NSUInteger)latency {
+  if ((self = [super init])) {
+    self.latency = latency;
+  }
+  return self;
+}
+
+- (void)setLatency:(NSUInteger)latency {
+  _latency = latency;
+  self.maximumQueueLength = MAX(self.maximumQueueLength, latency + 1);
+}
+
+- (NSArray *)selectFrameSetWithTime:(CMTime *)frameTime {
+  NSMutableArray *primaryQueue = [self queueForInput:self.primaryInput];
+  if ([primaryQueue count] <= self.latency) {
+    return nil;
+  }
+
+  GPUImageFrameSyncEntry *primaryEntry = [primaryQueue firstObject];
+  NSMutableArray *entries = [NSMutableArray arrayWithCapacity:self.numberOfInputs];
+  for (NSUInteger input = 0; input < self.numberOfInputs; input++) {
+    if (input == self.primaryInput) {
+      [entries addObject:primaryEntry];
+      continue;
+    }
+
+    NSMutableArray *queue = [self queueForInput:input];
+    if ([queue count] == 0) {
+      return nil;
+    }
+
+    // The newest frame not later than the primary one, or the oldest frame when all of them are later
+    GPUImageFrameSyncEntry *chosenEntry = [queue firstObject];
+    for (GPUImageFrameSyncEntry *entry in queue) {
+      if (frameSyncTimeIsLater(entry.frameTime, primaryEntry.frameTime)) {
+        break;
+      }
+      chosenEntry = entry;
+    }
+    [entries addObject:chosenEntry];
+  }
+
+  *frameTime = primaryEntry.frameTime;
+  return entries;
+}
+
+@end
@@ -1,12 +1,19 @@
 #import "GPUImageFramebuffer.h"
 #import "GPUImageOutput.h"
+#import <stdatomic.h>
 
 @interface GPUImageFramebuffer()
+{
+  // Branches rendering on contexts of their own may lock and unlock a framebuffer they both read from different queues
+  atomic_ulong framebufferReferenceCount;
+}
+
+// The context the framebuffer object exists in, and whose cache it goes back to
+@property (nonatomic, weak) GPUImageContext *context;
 
 @property (nonatomic, assign) CVPixelBufferRef renderTarget;
 @property (nonatomic, assign) CVOpenGLESTextureRef renderTexture;
 @property (nonatomic, assign) NSUInteger readLockCount;
-@property (nonatomic, assign) NSUInteger framebufferReferenceCount;
 @property (nonatomic, assign) BOOL referenceCountingDisabled;
 
 @property(nonatomic, readwrite, assign) CGSize size;
@@ -28,15 +35,16 @@ void dataProviderUnlockCallback (void *info, const void *data, size_t size);
 
 - (id)initWithSize:(CGSize)framebufferSize textureOptions:(GPUTextureOptions)fboTextureOptions onlyTexture:(BOOL)onlyGenerateTexture {
   if ((self = [super init])) {
+    self.context = [GPUImageContext currentContext];
     self.textureOptions = fboTextureOptions;
     self.size = framebufferSize;
-    self.framebufferReferenceCount = 0;
+    atomic_init(&framebufferReferenceCount, 0);
     self.referenceCountingDisabled = NO;
     self.missingFramebuffer = onlyGenerateTexture;
 
     if (self.missingFramebuffer) {
-      runSynchronouslyOnVideoProcessingQueue(^{
-        [GPUImageContext useImageProcessingContext];
+      runSynchronouslyOnContextQueue([self owningContext], ^{
+        [[self owningContext] useAsCurrentContext];
         [self generateTexture];
         self.framebuffer = 0;
       });
@@ -58,9 +66,10 @@ void dataProviderUnlockCallback (void *info, const void *data, size_t size);
       .format = GL_BGRA,
       .type = GL_UNSIGNED_BYTE
     };
+    self.context = [GPUImageContext currentContext];
     self.textureOptions = defaultTextureOptions;
     self.size = framebufferSize;
-    self.framebufferReferenceCount = 0;
+    atomic_init(&framebufferReferenceCount, 0);
     self.referenceCountingDisabled = YES;
     self.texture = inputTexture;
   }
@@ -87,6 +96,10 @@ void dataProviderUnlockCallback (void *info, const void *data, size_t size);
 #pragma mark -
 #pragma mark Internal
 
+- (GPUImageContext *)owningContext {
+  return self.context ?: [GPUImageContext sharedImageProcessingContext];
+}
+
 - (void)generateTexture {
   glActiveTexture(GL_TEXTURE1);
   glGenTextures(1, &_texture);
@@ -100,15 +113,15 @@ void dataProviderUnlockCallback (void *info, const void *data, size_t size);
 }
 
 - (void)generateFramebuffer {
-  runSynchronouslyOnVideoProcessingQueue(^{
-    [GPUImageContext useImageProcessingContext];
+  runSynchronouslyOnContextQueue([self owningContext], ^{
+    [[self owningContext] useAsCurrentContext];
 
     glGenFramebuffers(1, &_framebuffer);
     glBindFramebuffer(GL_FRAMEBUFFER, self.framebuffer);
 
     // By default, all framebuffers on iOS 5.0+ devices are backed by texture caches, using one shared cache
-    if ([GPUImageContext supportsFastTextureUpload]) {
-      CVOpenGLESTextureCacheRef coreVideoTextureCache = [[GPUImageContext sharedImageProcessingContext] coreVideoTextureCache];
+    if ([self isBackedByTextureCache]) {
+      CVOpenGLESTextureCacheRef coreVideoTextureCache = [[self owningContext] coreVideoTextureCache];
       // Code originally sourced from http://allmybrain.com/2011/12/08/rendering-to-a-texture-with-ios-5-texture-cache-api/
 
       CFDictionaryRef empty = CFDictionaryCreate(kCFAllocatorDefault, NULL, NULL, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks); // our empty IOSurface properties dictionary
@@ -158,14 +171,15 @@ void dataProviderUnlockCallback (void *info, const void *data, size_t size);
   });
 }
 
+// A framebuffer object outliving its context went away with it, its texture lives on in the sharegroup of the shared context
 - (void)destroyFramebuffer {
-  runSynchronouslyOnVideoProcessingQueue(^{
-    [GPUImageContext useImageProcessingContext];
-    if (self.framebuffer) {
+  runSynchronouslyOnContextQueue([self owningContext], ^{
+    [[self owningContext] useAsCurrentContext];
+    if (self.framebuffer && self.context) {
       glDeleteFramebuffers(1, &_framebuffer);
       self.framebuffer = 0;
     }
-    if ([GPUImageContext supportsFastTextureUpload] && (!_missingFramebuffer)) {
+    if ([self isBackedByTextureCache] && (!_missingFramebuffer)) {
       if (self.renderTarget) {
         CFRelease(self.renderTarget);
         self.renderTarget = NULL;
@@ -180,6 +194,11 @@ void dataProviderUnlockCallback (void *info, const void *data, size_t size);
   });
 }
 
+// Texture caches only hand out 32BGRA render targets, so floating point framebuffers fall back to plain textures
+- (BOOL)isBackedByTextureCache {
+  return [GPUImageContext supportsFastTextureUpload] && (self.textureOptions.type == GL_UNSIGNED_BYTE);
+}
+
 #pragma mark -
 #pragma mark Usage
 
@@ -192,22 +211,22 @@ void dataProviderUnlockCallback (void *info, const void *data, size_t size);
 
 - (void)lock {
   if (!self.referenceCountingDisabled) {
-    self.framebufferReferenceCount++;
+    atomic_fetch_add(&framebufferReferenceCount, 1);
   }
 }
 
 - (void)unlock {
   if (!self.referenceCountingDisabled) {
-    NSAssert(self.framebufferReferenceCount > 0, @"Tried to overrelease a framebuffer, did you forget to call -useNextFrameForImageCapture before using -imageFromCurrentFramebuffer?");
-    self.framebufferReferenceCount--;
-    if (self.framebufferReferenceCount < 1) {
-      [[GPUImageContext sharedFramebufferCache] returnFramebufferToCache:self];
+    unsigned long previousReferenceCount = atomic_fetch_sub(&framebufferReferenceCount, 1);
+    NSAssert(previousReferenceCount > 0, @"Tried to overrelease a framebuffer, did you forget to call -useNextFrameForImageCapture before using -imageFromCurrentFramebuffer?");
+    if (previousReferenceCount == 1) {
+      [[[self owningContext] framebufferCache] returnFramebufferToCache:self];
     }
   }
 }
 
 - (void)clearAllLocks {
-  self.framebufferReferenceCount = 0;
+  atomic_store(&framebufferReferenceCount, 0);
 }
 
 - (void)disableReferenceCounting {
@@ -229,7 +248,7 @@ void dataProviderUnlockCallback (void *info, const void *data, size_t size) {
   GPUImageFramebuffer *framebuffer = (__bridge_transfer GPUImageFramebuffer*)info;
   [framebuffer restoreRenderTarget];
   [framebuffer unlock];
-  [[GPUImageContext sharedFramebufferCache] removeFramebufferFromActiveImageCaptureList:framebuffer];
+  [[[framebuffer owningContext] framebufferCache] removeFramebufferFromActiveImageCaptureList:framebuffer];
 }
 
 - (CGImageRef)newCGImageFromFramebufferContents {
@@ -239,8 +258,8 @@ void dataProviderUnlockCallback (void *info, const void *data, size_t size) {
 
   __block CGImageRef cgImageFromBytes;
 
-  runSynchronouslyOnVideoProcessingQueue(^{
-    [GPUImageContext useImageProcessingContext];
+  runSynchronouslyOnContextQueue([self owningContext], ^{
+    [[self owningContext] useAsCurrentContext];
 
     NSUInteger totalBytesForImage =  self.size.width *  self.size.height * 4;
     // It appears that the width of a texture must be padded out to be a multiple of 8 (32 bytes) if reading from it using a texture cache
@@ -257,7 +276,7 @@ void dataProviderUnlockCallback (void *info, const void *data, size_t size) {
       [self lockForReading];
       rawImagePixels = (GLubyte *)CVPixelBufferGetBaseAddress(self.renderTarget);
       dataProvider = CGDataProviderCreateWithData((__bridge_retained void*)self, rawImagePixels, paddedBytesForImage, dataProviderUnlockCallback);
-      [[GPUImageContext sharedFramebufferCache] addFramebufferToActiveImageCaptureList:self]; // In case the framebuffer is swapped out on the filter, need to have a strong reference to it somewhere for it to hang on while the image is in existence
+      [[[self owningContext] framebufferCache] addFramebufferToActiveImageCaptureList:self]; // In case the framebuffer is swapped out on the filter, need to have a strong reference to it somewhere for it to hang on while the image is in existence
     } else {
       [self activateFramebuffer];
       rawImagePixels = (GLubyte *)malloc(totalBytesForImage);
@@ -2,8 +2,15 @@
 #import <QuartzCore/QuartzCore.h>
 #import "GPUImageFramebuffer.h"
 
+@class GPUImageContext;
+
 @interface GPUImageFramebufferCache : NSObject
 
+/// The context the framebuffers are created in and whose queue the cache is managed on, the shared context if nil
+@property (nonatomic, weak, readonly) GPUImageContext *context;
+
+- (id)initWithContext:(GPUImageContext *)context;
+
 // Framebuffer management
 - (GPUImageFramebuffer *)fetchFramebufferForSize:(CGSize)framebufferSize textureOptions:(GPUTextureOptions)textureOptions onlyTexture:(BOOL)onlyTexture;
 - (GPUImageFramebuffer *)fetchFramebufferForSize:(CGSize)framebufferSize onlyTexture:(BOOL)onlyTexture;
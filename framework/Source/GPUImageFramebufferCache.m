@@ -9,6 +9,7 @@
 
 @interface GPUImageFramebufferCache()
 
+@property (nonatomic, weak, readwrite) GPUImageContext *context;
 @property (nonatomic, strong) id memoryWarningObserver;
 
 @property (nonatomic, strong) NSMutableDictionary *framebufferCache;
@@ -24,7 +25,12 @@
 #pragma mark Initialization and teardown
 
 - (id)init {
+  return [self initWithContext:nil];
+}
+
+- (id)initWithContext:(GPUImageContext *)context {
   if ((self = [super init])) {
+    self.context = context;
     self.memoryWarningObserver = [[NSNotificationCenter defaultCenter] addObserverForName:UIApplicationDidReceiveMemoryWarningNotification object:nil queue:nil usingBlock:^(NSNotification *note) {
 
       [self purgeAllUnassignedFramebuffers];
@@ -46,6 +52,10 @@
   self.memoryWarningObserver = nil;
 }
 
+- (GPUImageContext *)owningContext {
+  return self.context ?: [GPUImageContext sharedImageProcessingContext];
+}
+
 #pragma mark -
 #pragma mark Framebuffer management
 
@@ -60,7 +70,7 @@
 - (GPUImageFramebuffer *)fetchFramebufferForSize:(CGSize)framebufferSize textureOptions:(GPUTextureOptions)textureOptions onlyTexture:(BOOL)onlyTexture {
     __block GPUImageFramebuffer *framebufferFromCache = nil;
 
-    runSynchronouslyOnVideoProcessingQueue(^{
+    runSynchronouslyOnContextQueue([self owningContext], ^{
         NSString *lookupHash = [self hashForSize:framebufferSize textureOptions:textureOptions onlyTexture:onlyTexture];
         NSNumber *numberOfMatchingTexturesInCache = [self.framebufferTypeCounts objectForKey:lookupHash];
 
@@ -104,7 +114,7 @@
 - (void)returnFramebufferToCache:(GPUImageFramebuffer *)framebuffer {
   [framebuffer clearAllLocks];
   __weak typeof(self) weakSelf = self;
-  runAsynchronouslyOnVideoProcessingQueue(^{
+  runAsynchronouslyOnContextQueue([self owningContext], ^{
     __strong typeof(weakSelf) self = weakSelf;
     if (self) {
       CGSize framebufferSize = framebuffer.size;
@@ -122,14 +132,15 @@
 - (void)purgeAllUnassignedFramebuffers {
     [self.framebufferCache removeAllObjects];
     [self.framebufferTypeCounts removeAllObjects];
-    runAsynchronouslyOnVideoProcessingQueue(^{
-        CVOpenGLESTextureCacheFlush([[GPUImageContext sharedImageProcessingContext] coreVideoTextureCache], 0);
+    GPUImageContext *context = [self owningContext];
+    runAsynchronouslyOnContextQueue(context, ^{
+        CVOpenGLESTextureCacheFlush([context coreVideoTextureCache], 0);
     });
 }
 
 - (void)addFramebufferToActiveImageCaptureList:(GPUImageFramebuffer *)framebuffer {
   __weak typeof(self) weakSelf = self;
-  runAsynchronouslyOnVideoProcessingQueue(^{
+  runAsynchronouslyOnContextQueue([self owningContext], ^{
     __strong typeof(weakSelf) self = weakSelf;
     if (self) {
       [self.activeImageCaptureList addObject:framebuffer];
@@ -139,7 +150,7 @@
 
 - (void)removeFramebufferFromActiveImageCaptureList:(GPUImageFramebuffer *)framebuffer {
   __weak typeof(self) weakSelf = self;
-  runAsynchronouslyOnVideoProcessingQueue(^{
+  runAsynchronouslyOnContextQueue([self owningContext], ^{
     __strong typeof(weakSelf) self = weakSelf;
     if (self) {
       [self.activeImageCaptureList removeObject:framebuffer];
@@ -45,6 +45,8 @@ NSString *const kGPUImageGammaFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     gammaUniform = [self.filterProgram uniformIndex:@"gamma"];
     self.gamma = 1.0;
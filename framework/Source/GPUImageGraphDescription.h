@@ -0,0 +1,58 @@
+#import "GPUImageOutput.h"
+
+/// Name the nodes of a graph use in their inputs for the source the graph is attached to
+extern NSString *const kGPUImageGraphInputIdentifier;
+
+/// The newest format version the loader reads
+extern const NSUInteger kGPUImageGraphDescriptionVersion;
+
+/** A filter graph loaded from JSON, validated once and kept ready to build filters from
+
+ The format is a dictionary with a version, the nodes of the graph and the node giving its output:
+
+    {
+      "version": 1,
+      "nodes": [
+        {"id": "blur", "class": "GPUImageGaussianBlurFilter", "inputs": ["input"], "parameters": {"blurRadiusInPixels": {"float": 4}}},
+        {"id": "blend", "class": "GPUImageOverlayBlendFilter", "inputs": ["input", "blur"]}
+      ],
+      "output": "blend"
+    }
+
+ Inputs name other nodes, or kGPUImageGraphInputIdentifier for the source, in the order of the node's texture indices. Parameters set properties of the node's filter, each as a one key dictionary naming its type: float, int, bool, point ([x, y]), size ([width, height]), vec3, vec4, string, or points ([[x, y], ...], e.g. tone curve control points).
+
+ Everything that can be checked without creating filters is checked while loading: the version, that node identifiers are unique and inputs exist, that classes are filters, that parameters name writable properties of their type, that the graph has no cycle and that every node feeds the output. Errors are NSFileReadCorruptFileError in NSCocoaErrorDomain, the failure reason naming the offending node.
+ */
+@interface GPUImageGraphDescription : NSObject
+
+@property (nonatomic, assign, readonly) NSUInteger version;
+
+/// Every node, upstream before downstream, so the output comes last
+@property (nonatomic, copy, readonly) NSArray *nodeIdentifiers;
+
+@property (nonatomic, copy, readonly) NSString *outputIdentifier;
+
+/** Load a JSON graph, or return the one already loaded from the file if it hasn't changed since
+ */
++ (instancetype)graphDescriptionWithContentsOfURL:(NSURL *)url error:(NSError **)error;
+
+- (id)initWithJSONData:(NSData *)data error:(NSError **)error;
+
+/// The same format, already deserialized, e.g. from a property list
+- (id)initWithDictionary:(NSDictionary *)dictionary error:(NSError **)error;
+
+/// The graph in the format it was loaded from, nodes in sorted order
+- (NSDictionary *)dictionaryRepresentation;
+- (NSData *)JSONRepresentation;
+
+- (Class)filterClassOfNode:(NSString *)identifier;
+
+/// Node identifiers or kGPUImageGraphInputIdentifier, by texture index
+- (NSArray *)inputIdentifiersOfNode:(NSString *)identifier;
+
+/** Create the filter of a node with -init and set its parameters, without linking it
+ @param error Set when the filter doesn't take as many inputs as the node lists
+ */
+- (GPUImageOutput<GPUImageInput> *)newFilterForNode:(NSString *)identifier error:(NSError **)error;
+
+@end
@@ -0,0 +1,438 @@
+#import "GPUImageGraphDescription.h"
+#import "GPUImageFilter.h"
+#import <objc/runtime.h>
+
+NSString *const kGPUImageGraphInputIdentifier = @"input";
+const NSUInteger kGPUImageGraphDescriptionVersion = 1;
+
+static NSError *graphDescriptionError(NSString *identifier, NSString *reason) {
+  NSString *failureReason = (identifier != nil) ? [NSString stringWithFormat:@"Node \"%@\": %@", identifier, reason] : reason;
+  return [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadCorruptFileError userInfo:@{NSLocalizedFailureReasonErrorKey: failureReason}];
+}
+
+static BOOL failValidation(NSError **error, NSString *identifier, NSString *reason) {
+  if (error != NULL) {
+    *error = graphDescriptionError(identifier, reason);
+  }
+  return NO;
+}
+
+#pragma mark - Parameter types
+
+static BOOL readComponents(id value, NSUInteger count, CGFloat *components) {
+  if (![value isKindOfClass:[NSArray class]] || [value count] != count) {
+    return NO;
+  }
+  for (NSUInteger index = 0; index < count; index++) {
+    id component = value[index];
+    if (![component isKindOfClass:[NSNumber class]]) {
+      return NO;
+    }
+    components[index] = [component doubleValue];
+  }
+  return YES;
+}
+
+static BOOL isScalarType(const char *propertyType, const char *allowedTypes) {
+  return (strlen(propertyType) == 1) && (strchr(allowedTypes, propertyType[0]) != NULL);
+}
+
+static BOOL isObjectType(const char *propertyType, const char *className) {
+  NSString *expectedType = [NSString stringWithFormat:@"@\"%s\"", className];
+  return (strcmp(propertyType, "@") == 0) || (strcmp(propertyType, [expectedType UTF8String]) == 0);
+}
+
+// Converts a parameter once at load time into what KVC sets the property from, or returns nil with the reason
+static id boxedParameter(NSString *typeName, id value, const char *propertyType, NSString **reason) {
+  CGFloat components[4];
+  BOOL typeMatches = YES;
+  id boxedValue = nil;
+
+  if ([typeName isEqualToString:@"float"]) {
+    typeMatches = isScalarType(propertyType, "fd");
+    if ([value isKindOfClass:[NSNumber class]]) {
+      boxedValue = @([value doubleValue]);
+    }
+  } else if ([typeName isEqualToString:@"int"]) {
+    typeMatches = isScalarType(propertyType, "csilqCSILQ");
+    if ([value isKindOfClass:[NSNumber class]] && [value doubleValue] == floor([value doubleValue])) {
+      boxedValue = @([value longLongValue]);
+    }
+  } else if ([typeName isEqualToString:@"bool"]) {
+    typeMatches = isScalarType(propertyType, "cB");
+    if ([value isKindOfClass:[NSNumber class]]) {
+      boxedValue = @([value boolValue]);
+    }
+  } else if ([typeName isEqualToString:@"point"]) {
+    typeMatches = (strcmp(propertyType, @encode(CGPoint)) == 0);
+    if (readComponents(value, 2, components)) {
+      boxedValue = [NSValue valueWithCGPoint:CGPointMake(components[0], components[1])];
+    }
+  } else if ([typeName isEqualToString:@"size"]) {
+    typeMatches = (strcmp(propertyType, @encode(CGSize)) == 0);
+    if (readComponents(value, 2, components)) {
+      boxedValue = [NSValue valueWithCGSize:CGSizeMake(components[0], components[1])];
+    }
+  } else if ([typeName isEqualToString:@"vec3"]) {
+    typeMatches = (strcmp(propertyType, @encode(GPUVector3)) == 0);
+    if (readComponents(value, 3, components)) {
+      GPUVector3 vector = {components[0], components[1], components[2]};
+      boxedValue = [NSValue valueWithBytes:&vector objCType:@encode(GPUVector3)];
+    }
+  } else if ([typeName isEqualToString:@"vec4"]) {
+    typeMatches = (strcmp(propertyType, @encode(GPUVector4)) == 0);
+    if (readComponents(value, 4, components)) {
+      GPUVector4 vector = {components[0], components[1], components[2], components[3]};
+      boxedValue = [NSValue valueWithBytes:&vector objCType:@encode(GPUVector4)];
+    }
+  } else if ([typeName isEqualToString:@"string"]) {
+    typeMatches = isObjectType(propertyType, "NSString");
+    if ([value isKindOfClass:[NSString class]]) {
+      boxedValue = [value copy];
+    }
+  } else if ([typeName isEqualToString:@"points"]) {
+    typeMatches = isObjectType(propertyType, "NSArray");
+    if ([value isKindOfClass:[NSArray class]]) {
+      NSMutableArray *points = [NSMutableArray arrayWithCapacity:[value count]];
+      for (id pointValue in value) {
+        if (!readComponents(pointValue, 2, components)) {
+          points = nil;
+          break;
+        }
+        [points addObject:[NSValue valueWithCGPoint:CGPointMake(components[0], components[1])]];
+      }
+      boxedValue = points;
+    }
+  } else {
+    *reason = [NSString stringWithFormat:@"unknown parameter type \"%@\"", typeName];
+    return nil;
+  }
+
+  if (!typeMatches) {
+    *reason = [NSString stringWithFormat:@"the property isn't of type %@", typeName];
+    return nil;
+  }
+  if (boxedValue == nil) {
+    *reason = [NSString stringWithFormat:@"malformed %@ value", typeName];
+  }
+  return boxedValue;
+}
+
+#pragma mark - Nodes
+
+@interface GPUImageGraphNodeDescription : NSObject
+
+@property (nonatomic, copy) NSString *identifier;
+@property (nonatomic, assign) Class filterClass;
+@property (nonatomic, copy) NSArray *inputs;
+
+/// Boxed values by property name, ready for -setValue:forKey:
+@property (nonatomic, copy) NSDictionary *parameters;
+
+/// The parameters as loaded, for -dictionaryRepresentation
+@property (nonatomic, copy) NSDictionary *parameterDescriptions;
+
+@end
+
+@implementation GPUImageGraphNodeDescription
+@end
+
+@interface GPUImageGraphDescription()
+
+@property (nonatomic, copy) NSDictionary *nodes;
+
+@end
+
+@implementation GPUImageGraphDescription
+
+#pragma mark - Initialization and teardown
+
++ (instancetype)graphDescriptionWithContentsOfURL:(NSURL *)url error:(NSError **)error {
+  static dispatch_once_t pred;
+  static NSCache *graphDescriptionCache = nil;
+  dispatch_once(&pred, ^{
+    graphDescriptionCache = [[NSCache alloc] init];
+  });
+
+  NSDate *modificationDate = nil;
+  if (![url getResourceValue:&modificationDate forKey:NSURLContentModificationDateKey error:error]) {
+    return nil;
+  }
+  NSString *key = [NSString stringWithFormat:@"%@:%f", [url path], [modificationDate timeIntervalSinceReferenceDate]];
+  GPUImageGraphDescription *cachedDescription = [graphDescriptionCache objectForKey:key];
+  if (cachedDescription != nil) {
+    return cachedDescription;
+  }
+
+  NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedIfSafe error:error];
+  if (data == nil) {
+    return nil;
+  }
+  GPUImageGraphDescription *graphDescription = [[self alloc] initWithJSONData:data error:error];
+  if (graphDescription != nil) {
+    [graphDescriptionCache setObject:graphDescription forKey:key cost:[graphDescription.nodeIdentifiers count]];
+  }
+  return graphDescription;
+}
+
+- (id)initWithJSONData:(NSData *)data error:(NSError **)error {
+  id dictionary = [NSJSONSerialization JSONObjectWithData:data options:0 error:error];
+  if (dictionary == nil) {
+    return nil;
+  }
+  return [self initWithDictionary:dictionary error:error];
+}
+
+- (id)initWithDictionary:(NSDictionary *)dictionary error:(NSError **)error {
+  if (!(self = [super init])) {
+    return nil;
+  }
+
+  if (![self loadDictionary:dictionary error:error]) {
+    return nil;
+  }
+
+  return self;
+}
+
+#pragma mark - Loading
+
+- (BOOL)loadDictionary:(NSDictionary *)dictionary error:(NSError **)error {
+  if (![dictionary isKindOfClass:[NSDictionary class]]) {
+    return failValidation(error, nil, @"The graph isn't a dictionary");
+  }
+
+  id version = dictionary[@"version"];
+  if (![version isKindOfClass:[NSNumber class]] || [version integerValue] < 1) {
+    return failValidation(error, nil, @"Missing or invalid version");
+  }
+  if ([version unsignedIntegerValue] > kGPUImageGraphDescriptionVersion) {
+    return failValidation(error, nil, [NSString stringWithFormat:@"Version %lu is newer than the supported %lu", (unsigned long)[version unsignedIntegerValue], (unsigned long)kGPUImageGraphDescriptionVersion]);
+  }
+  _version = [version unsignedIntegerValue];
+
+  id nodeList = dictionary[@"nodes"];
+  if (![nodeList isKindOfClass:[NSArray class]] || [nodeList count] == 0) {
+    return failValidation(error, nil, @"Missing or empty list of nodes");
+  }
+
+  NSMutableDictionary *nodes = [NSMutableDictionary dictionaryWithCapacity:[nodeList count]];
+  NSMutableArray *declaredIdentifiers = [NSMutableArray arrayWithCapacity:[nodeList count]];
+  for (id nodeDictionary in nodeList) {
+    GPUImageGraphNodeDescription *node = [self nodeWithDictionary:nodeDictionary error:error];
+    if (node == nil) {
+      return NO;
+    }
+    if (nodes[node.identifier] != nil) {
+      return failValidation(error, node.identifier, @"duplicate identifier");
+    }
+    nodes[node.identifier] = node;
+    [declaredIdentifiers addObject:node.identifier];
+  }
+
+  for (NSString *identifier in declaredIdentifiers) {
+    for (NSString *input in [nodes[identifier] inputs]) {
+      if (![input isEqualToString:kGPUImageGraphInputIdentifier] && nodes[input] == nil) {
+        return failValidation(error, identifier, [NSString stringWithFormat:@"unknown input \"%@\"", input]);
+      }
+    }
+  }
+
+  id output = dictionary[@"output"];
+  if (![output isKindOfClass:[NSString class]] || nodes[output] == nil) {
+    return failValidation(error, nil, @"Missing or unknown output node");
+  }
+
+  // Kahn's algorithm, ties kept in declaration order
+  NSMutableDictionary *pendingInputCounts = [NSMutableDictionary dictionaryWithCapacity:[nodes count]];
+  NSMutableDictionary *consumers = [NSMutableDictionary dictionaryWithCapacity:[nodes count]];
+  for (NSString *identifier in declaredIdentifiers) {
+    NSUInteger pendingInputs = 0;
+    for (NSString *input in [nodes[identifier] inputs]) {
+      if (nodes[input] != nil) {
+        pendingInputs++;
+        if (consumers[input] == nil) {
+          consumers[input] = [NSMutableArray array];
+        }
+        [consumers[input] addObject:identifier];
+      }
+    }
+    pendingInputCounts[identifier] = @(pendingInputs);
+  }
+
+  NSMutableArray *sortedIdentifiers = [NSMutableArray arrayWithCapacity:[nodes count]];
+  for (NSString *identifier in declaredIdentifiers) {
+    if ([pendingInputCounts[identifier] unsignedIntegerValue] == 0) {
+      [sortedIdentifiers addObject:identifier];
+    }
+  }
+  for (NSUInteger sortedIndex = 0; sortedIndex < [sortedIdentifiers count]; sortedIndex++) {
+    for (NSString *consumer in consumers[sortedIdentifiers[sortedIndex]]) {
+      NSUInteger pendingInputs = [pendingInputCounts[consumer] unsignedIntegerValue] - 1;
+      pendingInputCounts[consumer] = @(pendingInputs);
+      if (pendingInputs == 0) {
+        [sortedIdentifiers addObject:consumer];
+      }
+    }
+  }
+  if ([sortedIdentifiers count] < [nodes count]) {
+    for (NSString *identifier in declaredIdentifiers) {
+      if ([pendingInputCounts[identifier] unsignedIntegerValue] > 0) {
+        return failValidation(error, identifier, @"part of a cycle");
+      }
+    }
+  }
+
+  // With every node feeding the output, the output is the only sink and sorts last
+  NSMutableSet *feedingOutput = [NSMutableSet setWithObject:output];
+  for (NSString *identifier in [sortedIdentifiers reverseObjectEnumerator]) {
+    if ([feedingOutput containsObject:identifier]) {
+      [feedingOutput addObjectsFromArray:[nodes[identifier] inputs]];
+    }
+  }
+  for (NSString *identifier in declaredIdentifiers) {
+    if (![feedingOutput containsObject:identifier]) {
+      return failValidation(error, identifier, @"doesn't feed the output");
+    }
+  }
+
+  self.nodes = nodes;
+  _nodeIdentifiers = [sortedIdentifiers copy];
+  _outputIdentifier = [output copy];
+  return YES;
+}
+
+- (GPUImageGraphNodeDescription *)nodeWithDictionary:(id)dictionary error:(NSError **)error {
+  if (![dictionary isKindOfClass:[NSDictionary class]]) {
+    failValidation(error, nil, @"A node isn't a dictionary");
+    return nil;
+  }
+
+  id identifier = dictionary[@"id"];
+  if (![identifier isKindOfClass:[NSString class]] || [identifier length] == 0 || [identifier isEqualToString:kGPUImageGraphInputIdentifier]) {
+    failValidation(error, nil, [NSString stringWithFormat:@"Missing or reserved node identifier %@", identifier]);
+    return nil;
+  }
+
+  id className = dictionary[@"class"];
+  Class filterClass = [className isKindOfClass:[NSString class]] ? NSClassFromString(className) : Nil;
+  if (filterClass == Nil || ![filterClass isSubclassOfClass:[GPUImageOutput class]] || ![filterClass conformsToProtocol:@protocol(GPUImageInput)]) {
+    failValidation(error, identifier, [NSString stringWithFormat:@"%@ isn't a filter class", className]);
+    return nil;
+  }
+
+  id inputs = dictionary[@"inputs"];
+  if (![inputs isKindOfClass:[NSArray class]] || [inputs count] == 0) {
+    failValidation(error, identifier, @"missing or empty inputs");
+    return nil;
+  }
+  for (id input in inputs) {
+    if (![input isKindOfClass:[NSString class]]) {
+      failValidation(error, identifier, @"inputs must be node identifiers");
+      return nil;
+    }
+  }
+  // An output only targets a filter once, so it can't fill two of its inputs
+  if ([[NSSet setWithArray:inputs] count] != [inputs count]) {
+    failValidation(error, identifier, @"an input is listed twice");
+    return nil;
+  }
+
+  id parameterDescriptions = dictionary[@"parameters"];
+  if (parameterDescriptions == nil) {
+    parameterDescriptions = @{};
+  }
+  if (![parameterDescriptions isKindOfClass:[NSDictionary class]]) {
+    failValidation(error, identifier, @"parameters aren't a dictionary");
+    return nil;
+  }
+
+  NSMutableDictionary *parameters = [NSMutableDictionary dictionaryWithCapacity:[parameterDescriptions count]];
+  for (id key in parameterDescriptions) {
+    id typedValue = parameterDescriptions[key];
+    if (![key isKindOfClass:[NSString class]] || ![typedValue isKindOfClass:[NSDictionary class]] || [typedValue count] != 1 || ![[[typedValue allKeys] firstObject] isKindOfClass:[NSString class]]) {
+      failValidation(error, identifier, [NSString stringWithFormat:@"parameter %@ must be a dictionary holding one typed value", key]);
+      return nil;
+    }
+
+    objc_property_t property = class_getProperty(filterClass, [key UTF8String]);
+    if (property == NULL) {
+      failValidation(error, identifier, [NSString stringWithFormat:@"%@ has no property %@", className, key]);
+      return nil;
+    }
+    char *readonlyAttribute = property_copyAttributeValue(property, "R");
+    BOOL isReadonly = (readonlyAttribute != NULL);
+    free(readonlyAttribute);
+    if (isReadonly) {
+      failValidation(error, identifier, [NSString stringWithFormat:@"property %@ is readonly", key]);
+      return nil;
+    }
+
+    NSString *typeName = [[typedValue allKeys] firstObject];
+    NSString *reason = nil;
+    char *propertyType = property_copyAttributeValue(property, "T");
+    id boxedValue = boxedParameter(typeName, typedValue[typeName], (propertyType != NULL) ? propertyType : "", &reason);
+    free(propertyType);
+    if (boxedValue == nil) {
+      failValidation(error, identifier, [NSString stringWithFormat:@"parameter %@: %@", key, reason]);
+      return nil;
+    }
+    parameters[key] = boxedValue;
+  }
+
+  GPUImageGraphNodeDescription *node = [[GPUImageGraphNodeDescription alloc] init];
+  node.identifier = identifier;
+  node.filterClass = filterClass;
+  node.inputs = inputs;
+  node.parameters = parameters;
+  node.parameterDescriptions = parameterDescriptions;
+  return node;
+}
+
+#pragma mark - Serialization
+
+- (NSDictionary *)dictionaryRepresentation {
+  NSMutableArray *nodeList = [NSMutableArray arrayWithCapacity:[self.nodeIdentifiers count]];
+  for (NSString *identifier in self.nodeIdentifiers) {
+    GPUImageGraphNodeDescription *node = self.nodes[identifier];
+    NSMutableDictionary *nodeDictionary = [@{@"id": identifier, @"class": NSStringFromClass(node.filterClass), @"inputs": node.inputs} mutableCopy];
+    if ([node.parameterDescriptions count] > 0) {
+      nodeDictionary[@"parameters"] = node.parameterDescriptions;
+    }
+    [nodeList addObject:nodeDictionary];
+  }
+  return @{@"version": @(self.version), @"nodes": nodeList, @"output": self.outputIdentifier};
+}
+
+- (NSData *)JSONRepresentation {
+  return [NSJSONSerialization dataWithJSONObject:[self dictionaryRepresentation] options:0 error:NULL];
+}
+
+#pragma mark - Nodes
+
+- (Class)filterClassOfNode:(NSString *)identifier {
+  return [self.nodes[identifier] filterClass];
+}
+
+- (NSArray *)inputIdentifiersOfNode:(NSString *)identifier {
+  return [self.nodes[identifier] inputs];
+}
+
+- (GPUImageOutput<GPUImageInput> *)newFilterForNode:(NSString *)identifier error:(NSError **)error {
+  GPUImageGraphNodeDescription *node = self.nodes[identifier];
+  NSParameterAssert(node != nil);
+
+  GPUImageOutput<GPUImageInput> *filter = [[node.filterClass alloc] init];
+  NSUInteger numberOfInputs = [filter isKindOfClass:[GPUImageFilter class]] ? [(GPUImageFilter *)filter numberOfInputs] : 1;
+  if ([node.inputs count] != numberOfInputs) {
+    failValidation(error, identifier, [NSString stringWithFormat:@"%@ takes %lu inputs, %lu given", NSStringFromClass(node.filterClass), (unsigned long)numberOfInputs, (unsigned long)[node.inputs count]]);
+    return nil;
+  }
+
+  [node.parameters enumerateKeysAndObjectsUsingBlock:^(NSString *key, id value, BOOL *stop) {
+    [filter setValue:value forKey:key];
+  }];
+  return filter;
+}
+
+@end
@@ -0,0 +1,59 @@
+#import "GPUImageOutput.h"
+
+/** Schedules the frames of a filter graph from a work list, instead of each output pushing into its targets recursively
+
+ Without an executor, an output renders and then calls every target in turn, each of which renders and recurses into its own targets on the same stack. Branches run depth first in the order targets were added, so a slow branch holds back its siblings whatever they feed.
+
+ The executor walks the graph from its sources and sorts the nodes topologically. Outputs of the graph then hand their frames to the executor, which delivers them one at a time: highest priority first, upstream before downstream, in the order they were scheduled otherwise. The priority of a node covers everything upstream of it, so a branch feeding a display can be set to run ahead of the encoder.
+
+ Deliveries to nodes without live consumers are skipped: paused nodes, and outputs whose targets are all skipped. An output without targets, capturing an image or with a frameProcessingCompletionBlock stays live, since it may report its results some other way.
+
+ A filter group is a single node, rendered as before within it. Sources that push to their targets without -informTargetsAboutNewFrameAtTime:, such as GPUImagePicture, start one executor frame per target. Call -rebuildGraph after changing targets.
+ */
+@interface GPUImageGraphExecutor : NSObject
+
+/// The nodes frames enter the graph through, typically a camera or a movie. Kept alive by the executor
+@property (nonatomic, copy, readonly) NSArray *sources;
+
+/// Every node reachable from the sources, upstream before downstream
+@property (nonatomic, strong, readonly) NSArray *sortedNodes;
+
+/// Whether some nodes feed back into themselves, in which case they come last in sortedNodes in the order they were found
+@property (nonatomic, assign, readonly) BOOL containsCycle;
+
+/// The nodes frames were delivered to during the last frame, in delivery order
+@property (nonatomic, strong, readonly) NSArray *lastFrameDeliveryOrder;
+
+/// Deliveries dropped in the last frame, because their node had no live consumer or the frame was cancelled
+@property (nonatomic, assign, readonly) NSUInteger lastFrameSkippedDeliveryCount;
+
+@property (nonatomic, assign, readonly) NSUInteger cancelledFrameCount;
+
+- (id)initWithSources:(NSArray *)sources;
+
+/// Walk the graph again from the sources, after targets were added or removed
+- (void)rebuildGraph;
+
+/** Run a node and everything upstream of it ahead of lower priorities
+ @param priority 0 by default, higher runs first
+ */
+- (void)setPriority:(NSInteger)priority forNode:(id<GPUImageInput>)node;
+- (NSInteger)priorityForNode:(id<GPUImageInput>)node;
+
+/// A paused node gets no frames, nor does whatever only feeds paused nodes, e.g. while a preview is off screen
+- (void)setNode:(id<GPUImageInput>)node paused:(BOOL)paused;
+- (BOOL)isNodePaused:(id<GPUImageInput>)node;
+
+/** Drop the deliveries the frame in flight hasn't made yet. Can be called from any thread, and has no effect between frames
+
+ Filters that got some of their inputs for the frame forget them, so that the next frame doesn't render against a partial set.
+ */
+- (void)cancelCurrentFrame;
+
+/// Called by -[GPUImageOutput informTargetsAboutNewFrameAtTime:] with the output's framebuffer still locked, takes a lock on it for every delivery
+- (void)scheduleTargetsOfOutput:(GPUImageOutput *)output atTime:(CMTime)frameTime;
+
+/// Called by -[GPUImageOutput informTargetsAboutNewFrameAtTime:] after scheduling. Delivers the frame unless the executor is already delivering one, which then takes over the new deliveries
+- (void)executeScheduledDeliveries;
+
+@end
@@ -0,0 +1,338 @@
+#import "GPUImageGraphExecutor.h"
+#import "GPUImageFilter.h"
+#import "GPUImageFilterGroup.h"
+
+// A frame on its way from an output to one of its targets, holding a lock on the framebuffer until delivered or dropped
+@interface GPUImageGraphDelivery : NSObject
+
+@property (nonatomic, strong) id<GPUImageInput> target;
+@property (nonatomic, assign) NSUInteger textureIndex;
+@property (nonatomic, strong) GPUImageFramebuffer *framebuffer;
+@property (nonatomic, assign) CGSize frameSize;
+@property (nonatomic, assign) CMTime frameTime;
+@property (nonatomic, assign) NSUInteger rank;
+@property (nonatomic, assign) NSUInteger sequence;
+
+@end
+
+@implementation GPUImageGraphDelivery
+
+@end
+
+// The output a node sends its frames from. Groups send them from their terminal filter, and plain consumers don't send any
+static GPUImageOutput *emittingOutputOfNode(id node) {
+  if ([node isKindOfClass:[GPUImageFilterGroup class]]) {
+    return [(GPUImageFilterGroup *)node terminalFilter];
+  }
+  if ([node isKindOfClass:[GPUImageOutput class]]) {
+    return node;
+  }
+  return nil;
+}
+
+// Nodes are told apart by identity, not -isEqual:
+static NSMapTable *nodeMapTable(void) {
+  return [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory];
+}
+
+static NSHashTable *nodeHashTable(void) {
+  return [NSHashTable hashTableWithOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality];
+}
+
+@interface GPUImageGraphExecutor()
+
+@property (nonatomic, copy, readwrite) NSArray *sources;
+@property (nonatomic, strong, readwrite) NSArray *sortedNodes;
+@property (nonatomic, assign, readwrite) BOOL containsCycle;
+@property (nonatomic, strong, readwrite) NSArray *lastFrameDeliveryOrder;
+@property (nonatomic, assign, readwrite) NSUInteger lastFrameSkippedDeliveryCount;
+
+// Node to the array of nodes it sends frames to, and node to its position in sortedNodes
+@property (nonatomic, strong) NSMapTable *successors;
+@property (nonatomic, strong) NSMapTable *ranks;
+
+@property (nonatomic, strong) NSMapTable *priorities;
+@property (nonatomic, strong) NSHashTable *pausedNodes;
+
+// Worked out at the start of each frame, from the priorities, the paused nodes and the state of the outputs
+@property (nonatomic, strong) NSMapTable *effectivePriorities;
+@property (nonatomic, strong) NSHashTable *liveNodes;
+
+@property (nonatomic, strong) NSMutableArray *workList;
+@property (nonatomic, assign) NSUInteger deliverySequence;
+@property (nonatomic, assign) BOOL isExecuting;
+@property (nonatomic, strong) NSMutableArray *frameDeliveryOrder;
+@property (nonatomic, assign) NSUInteger frameSkippedDeliveryCount;
+
+@property (atomic, assign) BOOL cancellationRequested;
+
+@end
+
+@implementation GPUImageGraphExecutor
+
+#pragma mark - Initialization and teardown
+
+- (id)initWithSources:(NSArray *)sources {
+  NSParameterAssert([sources count] > 0);
+  if (!(self = [super init])) {
+    return nil;
+  }
+
+  self.sources = sources;
+  self.priorities = nodeMapTable();
+  self.pausedNodes = nodeHashTable();
+  self.workList = [NSMutableArray array];
+  self.frameDeliveryOrder = [NSMutableArray array];
+  [self rebuildGraph];
+
+  return self;
+}
+
+#pragma mark - Graph
+
+- (void)rebuildGraph {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    for (id node in self.sortedNodes) {
+      GPUImageOutput *output = emittingOutputOfNode(node);
+      if (output.graphExecutor == self) {
+        output.graphExecutor = nil;
+      }
+    }
+
+    // Breadth first from the sources, counting the edges into each node
+    NSMutableArray *discoveredNodes = [NSMutableArray array];
+    NSHashTable *discovered = nodeHashTable();
+    NSMapTable *successors = nodeMapTable();
+    NSMapTable *incomingEdgeCounts = nodeMapTable();
+    for (id source in self.sources) {
+      if (![discovered containsObject:source]) {
+        [discovered addObject:source];
+        [discoveredNodes addObject:source];
+      }
+    }
+    for (NSUInteger nodeIndex = 0; nodeIndex < [discoveredNodes count]; nodeIndex++) {
+      id node = discoveredNodes[nodeIndex];
+      NSMutableArray *nodeSuccessors = [NSMutableArray array];
+      [emittingOutputOfNode(node) loopTargetsWithTargetAndTextureIndex:^(id<GPUImageInput> target, NSUInteger textureIndex) {
+        [nodeSuccessors addObject:target];
+        [incomingEdgeCounts setObject:@([[incomingEdgeCounts objectForKey:target] unsignedIntegerValue] + 1) forKey:target];
+        if (![discovered containsObject:target]) {
+          [discovered addObject:target];
+          [discoveredNodes addObject:target];
+        }
+      }];
+      [successors setObject:nodeSuccessors forKey:node];
+    }
+
+    // Kahn's algorithm, ready nodes taken in the order they were found
+    NSMutableArray *sortedNodes = [NSMutableArray arrayWithCapacity:[discoveredNodes count]];
+    NSHashTable *sorted = nodeHashTable();
+    NSMutableArray *readyNodes = [NSMutableArray array];
+    for (id node in discoveredNodes) {
+      if ([[incomingEdgeCounts objectForKey:node] unsignedIntegerValue] == 0) {
+        [readyNodes addObject:node];
+      }
+    }
+    for (NSUInteger readyIndex = 0; readyIndex < [readyNodes count]; readyIndex++) {
+      id node = readyNodes[readyIndex];
+      [sortedNodes addObject:node];
+      [sorted addObject:node];
+      for (id successor in [successors objectForKey:node]) {
+        NSUInteger remainingEdges = [[incomingEdgeCounts objectForKey:successor] unsignedIntegerValue] - 1;
+        [incomingEdgeCounts setObject:@(remainingEdges) forKey:successor];
+        if (remainingEdges == 0) {
+          [readyNodes addObject:successor];
+        }
+      }
+    }
+
+    self.containsCycle = [sortedNodes count] < [discoveredNodes count];
+    for (id node in discoveredNodes) {
+      if (![sorted containsObject:node]) {
+        [sortedNodes addObject:node];
+      }
+    }
+
+    NSMapTable *ranks = nodeMapTable();
+    [sortedNodes enumerateObjectsUsingBlock:^(id node, NSUInteger rank, BOOL *stop) {
+      [ranks setObject:@(rank) forKey:node];
+      emittingOutputOfNode(node).graphExecutor = self;
+    }];
+
+    self.sortedNodes = sortedNodes;
+    self.successors = successors;
+    self.ranks = ranks;
+  });
+}
+
+#pragma mark - Priorities and pausing
+
+- (void)setPriority:(NSInteger)priority forNode:(id<GPUImageInput>)node {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [self.priorities setObject:@(priority) forKey:node];
+  });
+}
+
+- (NSInteger)priorityForNode:(id<GPUImageInput>)node {
+  __block NSInteger priority;
+  runSynchronouslyOnVideoProcessingQueue(^{
+    priority = [[self.priorities objectForKey:node] integerValue];
+  });
+  return priority;
+}
+
+- (void)setNode:(id<GPUImageInput>)node paused:(BOOL)paused {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    if (paused) {
+      [self.pausedNodes addObject:node];
+    } else {
+      [self.pausedNodes removeObject:node];
+    }
+  });
+}
+
+- (BOOL)isNodePaused:(id<GPUImageInput>)node {
+  __block BOOL paused;
+  runSynchronouslyOnVideoProcessingQueue(^{
+    paused = [self.pausedNodes containsObject:node];
+  });
+  return paused;
+}
+
+// Downstream first, so that every node sees its successors settled, except around cycles where unsettled successors count as live
+- (void)updateFrameState {
+  NSMapTable *effectivePriorities = nodeMapTable();
+  NSHashTable *liveNodes = nodeHashTable();
+  NSHashTable *settledNodes = nodeHashTable();
+
+  for (id node in [self.sortedNodes reverseObjectEnumerator]) {
+    NSInteger priority = [[self.priorities objectForKey:node] integerValue];
+    BOOL live = NO;
+    if (![self.pausedNodes containsObject:node]) {
+      GPUImageOutput *output = emittingOutputOfNode(node);
+      NSArray *nodeSuccessors = [self.successors objectForKey:node];
+      live = (output == nil || [nodeSuccessors count] == 0 || output.usingNextFrameForImageCapture || output.frameProcessingCompletionBlock != NULL);
+      for (id successor in nodeSuccessors) {
+        if (![settledNodes containsObject:successor] || [liveNodes containsObject:successor]) {
+          live = YES;
+          priority = MAX(priority, [[effectivePriorities objectForKey:successor] integerValue]);
+        }
+      }
+    }
+
+    [settledNodes addObject:node];
+    if (live) {
+      [liveNodes addObject:node];
+    }
+    [effectivePriorities setObject:@(priority) forKey:node];
+  }
+
+  self.effectivePriorities = effectivePriorities;
+  self.liveNodes = liveNodes;
+}
+
+#pragma mark - Execution
+
+- (void)scheduleTargetsOfOutput:(GPUImageOutput *)output atTime:(CMTime)frameTime {
+  GPUImageFramebuffer *framebuffer = output.outputFramebuffer;
+  CGSize frameSize = [output outputFrameSize];
+
+  [output loopTargetsWithTargetAndTextureIndex:^(id<GPUImageInput> target, NSUInteger textureIndex) {
+    GPUImageGraphDelivery *delivery = [[GPUImageGraphDelivery alloc] init];
+    delivery.target = target;
+    delivery.textureIndex = textureIndex;
+    delivery.framebuffer = framebuffer;
+    delivery.frameSize = frameSize;
+    delivery.frameTime = frameTime;
+    // Nodes added since the last rebuild come after the known ones
+    NSNumber *rank = [self.ranks objectForKey:target];
+    delivery.rank = (rank != nil) ? [rank unsignedIntegerValue] : NSUIntegerMax;
+    delivery.sequence = self.deliverySequence++;
+    [framebuffer lock];
+    [self.workList addObject:delivery];
+  }];
+}
+
+// Highest priority first, then upstream first, then in scheduling order
+- (GPUImageGraphDelivery *)takeNextDelivery {
+  GPUImageGraphDelivery *nextDelivery = nil;
+  NSInteger nextPriority = 0;
+  NSUInteger nextIndex = 0;
+  for (NSUInteger deliveryIndex = 0; deliveryIndex < [self.workList count]; deliveryIndex++) {
+    GPUImageGraphDelivery *delivery = self.workList[deliveryIndex];
+    NSNumber *effectivePriority = [self.effectivePriorities objectForKey:delivery.target];
+    NSInteger priority = (effectivePriority != nil) ? [effectivePriority integerValue] : [[self.priorities objectForKey:delivery.target] integerValue];
+    if (nextDelivery == nil || priority > nextPriority || (priority == nextPriority && (delivery.rank < nextDelivery.rank || (delivery.rank == nextDelivery.rank && delivery.sequence < nextDelivery.sequence)))) {
+      nextDelivery = delivery;
+      nextPriority = priority;
+      nextIndex = deliveryIndex;
+    }
+  }
+  [self.workList removeObjectAtIndex:nextIndex];
+  return nextDelivery;
+}
+
+- (void)dropDelivery:(GPUImageGraphDelivery *)delivery {
+  [delivery.framebuffer unlock];
+  self.frameSkippedDeliveryCount++;
+}
+
+- (void)dropRemainingDeliveries {
+  NSHashTable *deliveredNodes = nodeHashTable();
+  for (id node in self.frameDeliveryOrder) {
+    [deliveredNodes addObject:node];
+  }
+
+  for (GPUImageGraphDelivery *delivery in self.workList) {
+    if ([deliveredNodes containsObject:delivery.target] && [delivery.target isKindOfClass:[GPUImageFilter class]]) {
+      [(GPUImageFilter *)delivery.target dropFrames];
+    }
+    [self dropDelivery:delivery];
+  }
+  [self.workList removeAllObjects];
+  _cancelledFrameCount++;
+}
+
+- (void)executeScheduledDeliveries {
+  if (self.isExecuting) {
+    return;
+  }
+  self.isExecuting = YES;
+  self.cancellationRequested = NO;
+  [self.frameDeliveryOrder removeAllObjects];
+  self.frameSkippedDeliveryCount = 0;
+  [self updateFrameState];
+
+  while ([self.workList count] > 0) {
+    if (self.cancellationRequested) {
+      [self dropRemainingDeliveries];
+      break;
+    }
+
+    GPUImageGraphDelivery *delivery = [self takeNextDelivery];
+    id<GPUImageInput> target = delivery.target;
+    BOOL known = ([self.ranks objectForKey:target] != nil);
+    if (known && ![self.liveNodes containsObject:target]) {
+      [self dropDelivery:delivery];
+      continue;
+    }
+
+    if (delivery.framebuffer != nil) {
+      [target setInputFramebuffer:delivery.framebuffer index:delivery.textureIndex];
+    }
+    [target setInputSize:delivery.frameSize index:delivery.textureIndex];
+    [delivery.framebuffer unlock];
+    [self.frameDeliveryOrder addObject:target];
+    [target newFrameReadyAtTime:delivery.frameTime atIndex:delivery.textureIndex];
+  }
+
+  self.lastFrameDeliveryOrder = [self.frameDeliveryOrder copy];
+  self.lastFrameSkippedDeliveryCount = self.frameSkippedDeliveryCount;
+  self.isExecuting = NO;
+}
+
+- (void)cancelCurrentFrame {
+  self.cancellationRequested = YES;
+}
+
+@end
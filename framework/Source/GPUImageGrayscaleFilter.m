@@ -122,6 +122,9 @@ NSString *const kGPUImageLuminanceFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
+    self.wantsMonochromeInput = YES;
     
     return self;
 }
@@ -66,6 +66,8 @@ NSString *const kGPUImageHazeFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     distanceUniform = [self.filterProgram uniformIndex:@"hazeDistance"];
 	slopeUniform = [self.filterProgram uniformIndex:@"slope"];
@@ -62,6 +62,8 @@ NSString *const kGPUImageHighlightShadowFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     shadowsUniform = [self.filterProgram uniformIndex:@"shadows"];
 	highlightsUniform = [self.filterProgram uniformIndex:@"highlights"];
@@ -106,6 +106,8 @@ NSString *const kGPUImageHueFragmentShaderString = SHADER_STRING
     {
         return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     hueAdjustUniform = [self.filterProgram uniformIndex:@"hueAdjust"];
     self.hue = 90;
@@ -0,0 +1,9 @@
+#import "GPUImageSummedAreaTableWindowFilter.h"
+
+/** A box blur read off a summed-area table, so its cost doesn't grow with the radius
+
+ Unlike GPUImageBoxBlurFilter, pixels near the edges average only the part of the window that lies inside the image. Requires float render targets, see +[GPUImageSummedAreaTableFilter isSupported].
+ */
+@interface GPUImageIntegralBoxBlurFilter : GPUImageSummedAreaTableWindowFilter
+
+@end
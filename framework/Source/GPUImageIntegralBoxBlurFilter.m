@@ -0,0 +1,29 @@
+#import "GPUImageIntegralBoxBlurFilter.h"
+
+NSString *const kGPUImageIntegralBoxBlurFragmentShaderString = SHADER_STRING
+(
+ varying vec2 textureCoordinate;
+ varying vec2 textureCoordinate2;
+
+ uniform sampler2D inputImageTexture;
+ uniform float radius;
+
+ void main()
+ {
+     vec2 pixel = floor(textureCoordinate2 * summedAreaTableSize);
+     vec4 moments = summedAreaTableMoments(pixel - radius, pixel + radius);
+
+     gl_FragColor = vec4(moments.rgb, texture2D(inputImageTexture, textureCoordinate).a);
+ }
+);
+
+@implementation GPUImageIntegralBoxBlurFilter
+
+#pragma mark - Initialization and teardown
+
+- (id)init {
+  self = [super initWithFragmentShaderFromString:kGPUImageIntegralBoxBlurFragmentShaderString];
+  return self;
+}
+
+@end
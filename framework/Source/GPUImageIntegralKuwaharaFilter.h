@@ -0,0 +1,10 @@
+#import "GPUImageSummedAreaTableWindowFilter.h"
+
+/** Kuwahara image abstraction with the sector statistics read off a summed-area table
+
+ Produces the same oil-painting-like effect as GPUImageKuwaharaFilter, picking the mean of whichever of the four (radius + 1)^2 quadrants around a pixel has the lowest variance, but the cost of a pixel no longer depends on the radius. Large radii are usable on live video.
+ Requires float render targets, see +[GPUImageSummedAreaTableFilter isSupported].
+ */
+@interface GPUImageIntegralKuwaharaFilter : GPUImageSummedAreaTableWindowFilter
+
+@end
@@ -0,0 +1,46 @@
+#import "GPUImageIntegralKuwaharaFilter.h"
+
+NSString *const kGPUImageIntegralKuwaharaFragmentShaderString = SHADER_STRING
+(
+ varying vec2 textureCoordinate;
+ varying vec2 textureCoordinate2;
+
+ uniform sampler2D inputImageTexture;
+ uniform float radius;
+
+ void main()
+ {
+     vec2 pixel = floor(textureCoordinate2 * summedAreaTableSize);
+
+     vec4 m0 = summedAreaTableMoments(pixel - radius, pixel);
+     vec4 m1 = summedAreaTableMoments(vec2(pixel.x, pixel.y - radius), vec2(pixel.x + radius, pixel.y));
+     vec4 m2 = summedAreaTableMoments(pixel, pixel + radius);
+     vec4 m3 = summedAreaTableMoments(vec2(pixel.x - radius, pixel.y), vec2(pixel.x, pixel.y + radius));
+
+     vec4 result = m0;
+     if (m1.a < result.a) {
+         result = m1;
+     }
+     if (m2.a < result.a) {
+         result = m2;
+     }
+     if (m3.a < result.a) {
+         result = m3;
+     }
+
+     gl_FragColor = vec4(result.rgb, texture2D(inputImageTexture, textureCoordinate).a);
+ }
+);
+
+@implementation GPUImageIntegralKuwaharaFilter
+
+#pragma mark - Initialization and teardown
+
+- (id)init {
+  if ((self = [super initWithFragmentShaderFromString:kGPUImageIntegralKuwaharaFragmentShaderString])) {
+    self.radius = 3;
+  }
+  return self;
+}
+
+@end
@@ -1,5 +1,6 @@
 #import "GPUImageFilter.h"
 
+// The diagram only depends on the seed points of the input, so when they don't move set hasStaticContent to render it once, calling -invalidateStaticContent after drawing new points
 @interface GPUImageJFAVoronoiFilter : GPUImageFilter
 {
     GLuint secondFilterOutputTexture;
@@ -1,6 +1,10 @@
-#import "GPUImageTwoPassTextureSamplingFilter.h"
+#import "GPUImageResamplingFilter.h"
 
-@interface GPUImageLanczosResamplingFilter : GPUImageTwoPassTextureSamplingFilter
+/** Lanczos downsampling to the size given to -forceProcessingAtSize:
+
+ A GPUImageResamplingFilter fixed to kGPUImageResamplingBoxPrefilteredLanczos, so large reductions are box filtered first instead of aliasing.
+ */
+@interface GPUImageLanczosResamplingFilter : GPUImageResamplingFilter
 
 @property(readwrite, nonatomic) CGSize originalImageSize;
 
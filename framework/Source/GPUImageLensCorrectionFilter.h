@@ -0,0 +1,21 @@
+#import "GPUImageMeshWarpFilter.h"
+
+/** Removes radial lens distortion, barrel or pincushion, using the polynomial model r' = r * (1 + k1 * r^2 + k2 * r^4)
+
+ The radius is measured from the center, in units of the distance from the center of the image to a corner, with pixels kept square. The model is evaluated per mesh vertex, so changing the coefficients costs one mesh update and nothing per frame.
+ */
+@interface GPUImageLensCorrectionFilter : GPUImageMeshWarpFilter
+
+/// k1, negative for pincushion and positive for barrel distortion of the input. Default of 0.0
+@property (nonatomic, assign) CGFloat radialCoefficient1;
+
+/// k2, the fourth-order term. Default of 0.0
+@property (nonatomic, assign) CGFloat radialCoefficient2;
+
+/// The optical center in normalized coordinates, with 0.0, 0.0 being the upper left corner of the image. Default of 0.5, 0.5
+@property (nonatomic, assign) CGPoint center;
+
+/// Magnification applied after the correction, above 1.0 to crop away the edges pulled in from outside the input. Default of 1.0
+@property (nonatomic, assign) CGFloat zoom;
+
+@end
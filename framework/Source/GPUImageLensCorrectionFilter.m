@@ -0,0 +1,80 @@
+#import "GPUImageLensCorrectionFilter.h"
+
+@interface GPUImageLensCorrectionFilter()
+
+@property (nonatomic, assign) CGFloat aspectRatio;
+
+@end
+
+@implementation GPUImageLensCorrectionFilter
+
+#pragma mark - Initialization and teardown
+
+- (id)initWithMeshColumns:(NSUInteger)meshColumns rows:(NSUInteger)meshRows {
+  if (!(self = [super initWithMeshColumns:meshColumns rows:meshRows])) {
+    return nil;
+  }
+
+  _radialCoefficient1 = 0.0;
+  _radialCoefficient2 = 0.0;
+  _center = CGPointMake(0.5, 0.5);
+  _zoom = 1.0;
+  _aspectRatio = 1.0;
+
+  return self;
+}
+
+- (void)setupFilterForSize:(CGSize)filterFrameSize {
+  if (filterFrameSize.width * filterFrameSize.height > 0.0) {
+    CGFloat aspectRatio = filterFrameSize.width / filterFrameSize.height;
+    if (aspectRatio != self.aspectRatio) {
+      self.aspectRatio = aspectRatio;
+      [self invalidateMesh];
+    }
+  }
+}
+
+#pragma mark - Mesh
+
+- (void)mapTextureCoordinatesFromX:(const GLfloat *)x y:(const GLfloat *)y toU:(GLfloat *)u v:(GLfloat *)v count:(NSUInteger)count {
+  // Square pixels, scaled so that the corners of a centered image are at radius 1. The size isn't known yet while initializing
+  CGFloat aspectRatio = (self.aspectRatio > 0.0) ? self.aspectRatio : 1.0;
+  GLfloat scaleX = 2.0 * aspectRatio / sqrt(aspectRatio * aspectRatio + 1.0);
+  GLfloat scaleY = 2.0 / sqrt(aspectRatio * aspectRatio + 1.0);
+  GLfloat centerX = self.center.x, centerY = self.center.y;
+  GLfloat k1 = self.radialCoefficient1, k2 = self.radialCoefficient2;
+  GLfloat inverseZoom = 1.0 / MAX(self.zoom, 0.01);
+
+  for (NSUInteger vertex = 0; vertex < count; vertex++) {
+    GLfloat dx = (x[vertex] - centerX) * scaleX * inverseZoom;
+    GLfloat dy = (y[vertex] - centerY) * scaleY * inverseZoom;
+    GLfloat radiusSquared = dx * dx + dy * dy;
+    GLfloat distortion = 1.0 + radiusSquared * (k1 + k2 * radiusSquared);
+    u[vertex] = centerX + dx * distortion / scaleX;
+    v[vertex] = centerY + dy * distortion / scaleY;
+  }
+}
+
+#pragma mark - Accessors
+
+- (void)setRadialCoefficient1:(CGFloat)newValue {
+  _radialCoefficient1 = newValue;
+  [self invalidateMesh];
+}
+
+- (void)setRadialCoefficient2:(CGFloat)newValue {
+  _radialCoefficient2 = newValue;
+  [self invalidateMesh];
+}
+
+- (void)setCenter:(CGPoint)newValue {
+  _center = newValue;
+  [self invalidateMesh];
+}
+
+- (void)setZoom:(CGFloat)newValue {
+  _zoom = newValue;
+  [self invalidateMesh];
+}
+
+@end
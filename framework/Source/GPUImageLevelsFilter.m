@@ -68,6 +68,8 @@ NSString *const kGPUImageLevelsFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     minUniform = [self.filterProgram uniformIndex:@"levelMinimum"];
     midUniform = [self.filterProgram uniformIndex:@"levelMiddle"];
@@ -4,6 +4,7 @@
 {
     GLint lineWidthUniform, lineColorUniform;
     GLfloat *lineCoordinates;
+    NSData *lastLineSlopeAndIntercepts;
 }
 
 // The width of the displayed lines, in pixels. The default is 1.
@@ -12,7 +13,7 @@
 // The color of the lines is specified using individual red, green, and blue components (normalized to 1.0). The default is green: (0.0, 1.0, 0.0).
 - (void)setLineColorRed:(GLfloat)redComponent green:(GLfloat)greenComponent blue:(GLfloat)blueComponent;
 
-// Rendering
+// Rendering. With hasStaticContent, set by default, the same lines as last time are passed on without rendering them again
 - (void)renderLinesFromArray:(GLfloat *)lineSlopeAndIntercepts count:(NSUInteger)numberOfLines frameTime:(CMTime)frameTime;
 
 @end
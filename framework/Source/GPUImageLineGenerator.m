@@ -56,6 +56,7 @@ NSString *const kGPUImageLineGeneratorFragmentShaderString = SHADER_STRING
         lineWidthUniform = [self.filterProgram uniformIndex:@"lineWidth"];
         lineColorUniform = [self.filterProgram uniformIndex:@"lineColor"];
         
+        self.hasStaticContent = YES;
         self.lineWidth = 1.0f;
         [self setLineColorRed:0.0f green:1.0f blue:0.0f];
     });
@@ -81,6 +82,7 @@ NSString *const kGPUImageLineGeneratorFragmentShaderString = SHADER_STRING
 
 - (void)renderLinesFromArray:(GLfloat *)lineSlopeAndIntercepts count:(NSUInteger)numberOfLines frameTime:(CMTime)frameTime {
     if (!self.preventRendering) {
+        NSData *slopeAndIntercepts = [NSData dataWithBytes:lineSlopeAndIntercepts length:numberOfLines * 2 * sizeof(GLfloat)];
         if (lineCoordinates == NULL) {
             [self generateLineCoordinates];
         }
@@ -107,6 +109,15 @@ NSString *const kGPUImageLineGeneratorFragmentShaderString = SHADER_STRING
         }
 
         runSynchronouslyOnVideoProcessingQueue(^{
+            if (![slopeAndIntercepts isEqualToData:lastLineSlopeAndIntercepts]) {
+                [self invalidateStaticContent];
+                lastLineSlopeAndIntercepts = slopeAndIntercepts;
+            }
+            if ([self reuseStaticContent]) {
+                [self informTargetsAboutNewFrameAtTime:frameTime];
+                return;
+            }
+
             [GPUImageContext setActiveShaderProgram:self.filterProgram];
 
             self.outputFramebuffer = [[GPUImageContext sharedFramebufferCache] fetchFramebufferForSize:[self sizeOfFBO] textureOptions:self.outputTextureOptions onlyTexture:NO];
@@ -124,6 +135,7 @@ NSString *const kGPUImageLineGeneratorFragmentShaderString = SHADER_STRING
             
             glDisable(GL_BLEND);
             
+            [self keepStaticContent];
             [self informTargetsAboutNewFrameAtTime:frameTime];
         });
     }
@@ -142,6 +154,7 @@ NSString *const kGPUImageLineGeneratorFragmentShaderString = SHADER_STRING
     _lineWidth = newValue;
     [GPUImageContext setActiveShaderProgram:self.filterProgram];
     glLineWidth(newValue);
+    [self invalidateStaticContent];
 }
 
 - (void)setLineColorRed:(GLfloat)redComponent green:(GLfloat)greenComponent blue:(GLfloat)blueComponent;
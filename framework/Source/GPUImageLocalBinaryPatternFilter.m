@@ -34,17 +34,20 @@ NSString *const kGPUImageLocalBinaryPatternFragmentShaderString = SHADER_STRING
  
  uniform sampler2D inputImageTexture;
  
+ // Compares luminance, which is what the camera's Y plane holds, rather than the red channel of RGB input
+ const highp vec3 W = vec3(0.2125, 0.7154, 0.0721);
+ 
  void main()
  {
-     lowp float centerIntensity = texture2D(inputImageTexture, textureCoordinate).r;
-     lowp float bottomLeftIntensity = texture2D(inputImageTexture, bottomLeftTextureCoordinate).r;
-     lowp float topRightIntensity = texture2D(inputImageTexture, topRightTextureCoordinate).r;
-     lowp float topLeftIntensity = texture2D(inputImageTexture, topLeftTextureCoordinate).r;
-     lowp float bottomRightIntensity = texture2D(inputImageTexture, bottomRightTextureCoordinate).r;
-     lowp float leftIntensity = texture2D(inputImageTexture, leftTextureCoordinate).r;
-     lowp float rightIntensity = texture2D(inputImageTexture, rightTextureCoordinate).r;
-     lowp float bottomIntensity = texture2D(inputImageTexture, bottomTextureCoordinate).r;
-     lowp float topIntensity = texture2D(inputImageTexture, topTextureCoordinate).r;
+     lowp float centerIntensity = dot(texture2D(inputImageTexture, textureCoordinate).rgb, W);
+     lowp float bottomLeftIntensity = dot(texture2D(inputImageTexture, bottomLeftTextureCoordinate).rgb, W);
+     lowp float topRightIntensity = dot(texture2D(inputImageTexture, topRightTextureCoordinate).rgb, W);
+     lowp float topLeftIntensity = dot(texture2D(inputImageTexture, topLeftTextureCoordinate).rgb, W);
+     lowp float bottomRightIntensity = dot(texture2D(inputImageTexture, bottomRightTextureCoordinate).rgb, W);
+     lowp float leftIntensity = dot(texture2D(inputImageTexture, leftTextureCoordinate).rgb, W);
+     lowp float rightIntensity = dot(texture2D(inputImageTexture, rightTextureCoordinate).rgb, W);
+     lowp float bottomIntensity = dot(texture2D(inputImageTexture, bottomTextureCoordinate).rgb, W);
+     lowp float topIntensity = dot(texture2D(inputImageTexture, topTextureCoordinate).rgb, W);
 
      lowp float byteTally = 1.0 / 255.0 * step(centerIntensity, topRightIntensity);
      byteTally += 2.0 / 255.0 * step(centerIntensity, topIntensity);
@@ -78,17 +81,20 @@ NSString *const kGPUImageLocalBinaryPatternFragmentShaderString = SHADER_STRING
  
  uniform sampler2D inputImageTexture;
  
+ // Compares luminance, which is what the camera's Y plane holds, rather than the red channel of RGB input
+ const vec3 W = vec3(0.2125, 0.7154, 0.0721);
+ 
  void main()
  {
-     float centerIntensity = texture2D(inputImageTexture, textureCoordinate).r;
-     float bottomLeftIntensity = texture2D(inputImageTexture, bottomLeftTextureCoordinate).r;
-     float topRightIntensity = texture2D(inputImageTexture, topRightTextureCoordinate).r;
-     float topLeftIntensity = texture2D(inputImageTexture, topLeftTextureCoordinate).r;
-     float bottomRightIntensity = texture2D(inputImageTexture, bottomRightTextureCoordinate).r;
-     float leftIntensity = texture2D(inputImageTexture, leftTextureCoordinate).r;
-     float rightIntensity = texture2D(inputImageTexture, rightTextureCoordinate).r;
-     float bottomIntensity = texture2D(inputImageTexture, bottomTextureCoordinate).r;
-     float topIntensity = texture2D(inputImageTexture, topTextureCoordinate).r;
+     float centerIntensity = dot(texture2D(inputImageTexture, textureCoordinate).rgb, W);
+     float bottomLeftIntensity = dot(texture2D(inputImageTexture, bottomLeftTextureCoordinate).rgb, W);
+     float topRightIntensity = dot(texture2D(inputImageTexture, topRightTextureCoordinate).rgb, W);
+     float topLeftIntensity = dot(texture2D(inputImageTexture, topLeftTextureCoordinate).rgb, W);
+     float bottomRightIntensity = dot(texture2D(inputImageTexture, bottomRightTextureCoordinate).rgb, W);
+     float leftIntensity = dot(texture2D(inputImageTexture, leftTextureCoordinate).rgb, W);
+     float rightIntensity = dot(texture2D(inputImageTexture, rightTextureCoordinate).rgb, W);
+     float bottomIntensity = dot(texture2D(inputImageTexture, bottomTextureCoordinate).rgb, W);
+     float topIntensity = dot(texture2D(inputImageTexture, topTextureCoordinate).rgb, W);
      
      float byteTally = 1.0 / 255.0 * step(centerIntensity, topRightIntensity);
      byteTally += 2.0 / 255.0 * step(centerIntensity, topIntensity);
@@ -117,6 +123,8 @@ NSString *const kGPUImageLocalBinaryPatternFragmentShaderString = SHADER_STRING
 		return nil;
     }
     
+    self.wantsMonochromeInput = YES;
+
     return self;
 }
 
@@ -0,0 +1,9 @@
+#import "GPUImageSummedAreaTableWindowFilter.h"
+
+/** Outputs the standard deviation of the colors in a square window around each pixel, as a grayscale image with the input's alpha
+
+ The value is the square root of the local variance averaged over the red, green and blue channels, so a flat area is black and a window split evenly between black and white is 0.5. Computed from a summed-area table at the same cost for any radius, requires float render targets, see +[GPUImageSummedAreaTableFilter isSupported].
+ */
+@interface GPUImageLocalStandardDeviationFilter : GPUImageSummedAreaTableWindowFilter
+
+@end
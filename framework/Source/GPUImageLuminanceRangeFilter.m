@@ -55,6 +55,8 @@ NSString *const kGPUImageLuminanceRangeFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     rangeReductionUniform = [self.filterProgram uniformIndex:@"rangeReduction"];
     self.rangeReductionFactor = 0.6;
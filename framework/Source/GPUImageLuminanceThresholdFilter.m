@@ -53,6 +53,9 @@ NSString *const kGPUImageLuminanceThresholdFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
+    self.wantsMonochromeInput = YES;
     
     thresholdUniform = [self.filterProgram uniformIndex:@"threshold"];
     self.threshold = 0.5;
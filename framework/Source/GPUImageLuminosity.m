@@ -118,6 +118,7 @@ NSString *const kGPUImageLuminosityFragmentShaderString = SHADER_STRING
     
     texelWidthUniform = [self.filterProgram uniformIndex:@"texelWidth"];
     texelHeightUniform = [self.filterProgram uniformIndex:@"texelHeight"];
+    self.wantsMonochromeInput = YES;
         
     __unsafe_unretained GPUImageLuminosity *weakSelf = self;
     [self setFrameProcessingCompletionBlock:^(GPUImageOutput *filter, CMTime frameTime) {
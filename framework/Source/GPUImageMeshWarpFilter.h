@@ -0,0 +1,33 @@
+#import "GPUImageFilter.h"
+#import "GPUImageWarpMesh.h"
+
+/** Warps its input by drawing a tessellated grid whose vertices carry their own texture coordinates
+
+ The warp is evaluated once per mesh vertex on the CPU and kept until -invalidateMesh, and the GPU interpolates linearly in between. Compared to evaluating the same math per pixel in a fragment shader this costs a few thousand evaluations per parameter change instead of millions per frame, at the price of the mesh resolution bounding the accuracy of strongly curved warps.
+ Coordinates mapped outside the input are clamped to its edge.
+
+ Either set a mapping block, or subclass and override -mapTextureCoordinatesFromX:y:toU:v:count: for warps with parameters of their own.
+ */
+@interface GPUImageMeshWarpFilter : GPUImageFilter
+
+/// Grid cells along each axis, 32 by default and limited to what 16-bit indices can address, see GPUImageWarpMesh
+@property (nonatomic, assign) NSUInteger meshColumns;
+@property (nonatomic, assign) NSUInteger meshRows;
+
+/// Whether mapped horizontal coordinates wrap around the input, as longitudes of equirectangular images do. Default of NO
+@property (nonatomic, assign) BOOL wrapsTextureHorizontally;
+
+/// Maps output positions to input texture coordinates, nil for the identity. Called on the video processing queue
+@property (nonatomic, copy) GPUImageWarpMeshMappingBlock mapping;
+
+@property (nonatomic, strong, readonly) GPUImageWarpMesh *mesh;
+
+- (id)initWithMeshColumns:(NSUInteger)meshColumns rows:(NSUInteger)meshRows;
+
+/// Recompute the mesh after the parameters of the warp have changed
+- (void)invalidateMesh;
+
+/// Runs the mapping block, override in subclasses. See GPUImageWarpMeshMappingBlock for the arguments
+- (void)mapTextureCoordinatesFromX:(const GLfloat *)x y:(const GLfloat *)y toU:(GLfloat *)u v:(GLfloat *)v count:(NSUInteger)count;
+
+@end
@@ -0,0 +1,202 @@
+#import "GPUImageMeshWarpFilter.h"
+
+// Passthrough that wraps the texture coordinate around along wrapAxis, for meshes whose coordinates were unwrapped across a seam
+#if TARGET_IPHONE_SIMULATOR || TARGET_OS_IPHONE
+NSString *const kGPUImageMeshWarpFragmentShaderString = SHADER_STRING
+(
+ varying highp vec2 textureCoordinate;
+
+ uniform sampler2D inputImageTexture;
+ uniform highp vec2 wrapAxis;
+
+ void main()
+ {
+     gl_FragColor = texture2D(inputImageTexture, mix(textureCoordinate, fract(textureCoordinate), wrapAxis));
+ }
+);
+#else
+NSString *const kGPUImageMeshWarpFragmentShaderString = SHADER_STRING
+(
+ varying vec2 textureCoordinate;
+
+ uniform sampler2D inputImageTexture;
+ uniform vec2 wrapAxis;
+
+ void main()
+ {
+     gl_FragColor = texture2D(inputImageTexture, mix(textureCoordinate, fract(textureCoordinate), wrapAxis));
+ }
+);
+#endif
+
+@interface GPUImageMeshWarpFilter()
+{
+    // Set before GPUImageFilter's initializer, which already builds the vertex buffers
+    NSUInteger requestedMeshColumns, requestedMeshRows;
+}
+
+@property (nonatomic, strong, readwrite) GPUImageWarpMesh *mesh;
+
+@end
+
+@implementation GPUImageMeshWarpFilter
+
+#pragma mark - Initialization and teardown
+
+- (id)init {
+  return [self initWithMeshColumns:32 rows:32];
+}
+
+- (id)initWithMeshColumns:(NSUInteger)meshColumns rows:(NSUInteger)meshRows {
+  requestedMeshColumns = meshColumns;
+  requestedMeshRows = meshRows;
+  if (!(self = [super initWithFragmentShaderFromString:kGPUImageMeshWarpFragmentShaderString])) {
+    return nil;
+  }
+  return self;
+}
+
+#pragma mark - Mesh
+
+- (void)mapTextureCoordinatesFromX:(const GLfloat *)x y:(const GLfloat *)y toU:(GLfloat *)u v:(GLfloat *)v count:(NSUInteger)count {
+  if (self.mapping != NULL) {
+    self.mapping(x, y, u, v, count);
+  } else {
+    memcpy(u, x, count * sizeof(GLfloat));
+    memcpy(v, y, count * sizeof(GLfloat));
+  }
+}
+
+- (void)invalidateMesh {
+  [self setupVerticesAndTextureCoordinates];
+}
+
+- (void)setupVerticesAndTextureCoordinates {
+  if ([self.inputs count] != self.numberOfInputs) {
+    return;
+  }
+
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [GPUImageContext useImageProcessingContext];
+
+    NSUInteger cellLimit = self.wrapsTextureHorizontally ? [GPUImageWarpMesh maximumNumberOfCellsPerAxisWrappingHorizontally] : [GPUImageWarpMesh maximumNumberOfCellsPerAxis];
+    NSUInteger columns = MIN(MAX(requestedMeshColumns, 1), cellLimit);
+    NSUInteger rows = MIN(MAX(requestedMeshRows, 1), cellLimit);
+    BOOL topologyChanged = (self.mesh == nil || self.mesh.columns != columns || self.mesh.rows != rows || self.mesh.wrapsHorizontally != self.wrapsTextureHorizontally);
+    if (topologyChanged) {
+      self.mesh = [[GPUImageWarpMesh alloc] initWithColumns:columns rows:rows wrapsHorizontally:self.wrapsTextureHorizontally];
+    }
+    GPUImageRotationMode rotation = [self getInputRotation:0];
+    [self.mesh updateTextureCoordinatesWithMapping:^(const GLfloat *x, const GLfloat *y, GLfloat *u, GLfloat *v, NSUInteger count) {
+      [self mapTextureCoordinatesFromX:x y:y toU:u v:v count:count];
+    } rotation:rotation];
+
+    // The unwrapped axis of the input turns with it
+    CGPoint wrapAxis = CGPointZero;
+    if (self.wrapsTextureHorizontally) {
+      wrapAxis = GPUImageRotationSwapsWidthAndHeight(rotation) ? CGPointMake(0.0, 1.0) : CGPointMake(1.0, 0.0);
+    }
+    [self setPoint:wrapAxis forUniformName:@"wrapAxis"];
+
+    // Views that move every frame only replace the vertex data
+    if (!topologyChanged && [self getInputVertexBuffer:0] != 0 && [self getInputIndexBuffer:0] != 0) {
+      glBindBuffer(GL_ARRAY_BUFFER, [self getInputVertexBuffer:0]);
+      glBufferSubData(GL_ARRAY_BUFFER, 0, self.mesh.vertexCount * sizeof(Vertex3D), self.mesh.vertices);
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+      return;
+    }
+
+    [self clearVerticesAndTextureCoordinates];
+
+    GLuint vertexBuffer, indexBuffer;
+    glGenBuffers(1, &vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, self.mesh.vertexCount * sizeof(Vertex3D), self.mesh.vertices, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glGenBuffers(1, &indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, self.mesh.indexCount * sizeof(GLushort), self.mesh.indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    [self setInputVertexBuffer:vertexBuffer index:0];
+    [self setInputIndexBuffer:indexBuffer index:0];
+  });
+}
+
+#pragma mark - Rendering
+
+- (void)bindVerticesAndIndices {
+  glBindBuffer(GL_ARRAY_BUFFER, [self getInputVertexBuffer:0]);
+  glVertexAttribPointer(self.filterPositionAttribute, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex3D), 0);
+  glVertexAttribPointer([self getInputTextureCoordinateAttribute:0], 2, GL_FLOAT, GL_FALSE, sizeof(Vertex3D), (GLvoid*)(sizeof(GLfloat) * 3));
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, [self getInputIndexBuffer:0]);
+}
+
+- (void)render {
+  glActiveTexture(GL_TEXTURE2);
+  glBindTexture(GL_TEXTURE_2D, [[self getInputFramebuffer:0] texture]);
+  glDrawElements(GL_TRIANGLES, (GLsizei)self.mesh.indexCount, GL_UNSIGNED_SHORT, 0);
+}
+
+#pragma mark - Region of interest
+
+- (CGRect)inputRegionForOutputRegion:(CGRect)outputRegion index:(NSUInteger)index {
+  if (self.mesh == nil) {
+    return kGPUImageFullRegionOfInterest;
+  }
+  CGRect bounds = [self.mesh textureCoordinateBoundsForRegion:outputRegion];
+  if (CGRectIsNull(bounds)) {
+    return kGPUImageFullRegionOfInterest;
+  }
+
+  // Coordinates past the edge of a wrapping mesh come back in on the other side
+  if (self.wrapsTextureHorizontally && !CGRectContainsRect(kGPUImageFullRegionOfInterest, bounds)) {
+    CGPoint wrapAxis = GPUImageRotationSwapsWidthAndHeight([self getInputRotation:0]) ? CGPointMake(0.0, 1.0) : CGPointMake(1.0, 0.0);
+    if (wrapAxis.x > 0.0 && (CGRectGetMinX(bounds) < 0.0 || CGRectGetMaxX(bounds) > 1.0)) {
+      bounds = CGRectMake(0.0, CGRectGetMinY(bounds), 1.0, CGRectGetHeight(bounds));
+    }
+    if (wrapAxis.y > 0.0 && (CGRectGetMinY(bounds) < 0.0 || CGRectGetMaxY(bounds) > 1.0)) {
+      bounds = CGRectMake(CGRectGetMinX(bounds), 0.0, CGRectGetWidth(bounds), 1.0);
+    }
+  }
+
+  // Vertices are interpolated linearly, so a cell reads its input between its corners, plus a pixel for filtering
+  CGSize inputSize = [self getInputSize:0];
+  if (inputSize.width * inputSize.height <= 0.0) {
+    return outsetRegionOfInterest(bounds, 0.0, 0.0);
+  }
+  return outsetRegionOfInterest(bounds, 1.0 / inputSize.width, 1.0 / inputSize.height);
+}
+
+#pragma mark - Accessors
+
+- (NSUInteger)meshColumns {
+  return requestedMeshColumns;
+}
+
+- (NSUInteger)meshRows {
+  return requestedMeshRows;
+}
+
+- (void)setMeshColumns:(NSUInteger)newValue {
+  requestedMeshColumns = newValue;
+  [self invalidateMesh];
+}
+
+- (void)setMeshRows:(NSUInteger)newValue {
+  requestedMeshRows = newValue;
+  [self invalidateMesh];
+}
+
+- (void)setWrapsTextureHorizontally:(BOOL)newValue {
+  _wrapsTextureHorizontally = newValue;
+  [self invalidateMesh];
+}
+
+- (void)setMapping:(GPUImageWarpMeshMappingBlock)newValue {
+  _mapping = [newValue copy];
+  [self invalidateMesh];
+}
+
+@end
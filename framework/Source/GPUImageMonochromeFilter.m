@@ -77,6 +77,8 @@ NSString *const kGPUMonochromeFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     intensityUniform = [self.filterProgram uniformIndex:@"intensity"];
     filterColorUniform = [self.filterProgram uniformIndex:@"filterColor"];
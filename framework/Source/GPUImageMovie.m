@@ -502,10 +502,12 @@
             glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-//            if (!allTargetsWantMonochromeData)
-//            {
+            // The conversion pass draws the frame unrotated, so the Y plane can stand in for it as is
+            if (isFullYUVRange && [self allTargetsWantMonochromeInput]) {
+                self.outputFramebuffer = [[GPUImageFramebuffer alloc] initWithSize:CGSizeMake(imageBufferWidth, imageBufferHeight) overriddenTexture:luminanceTexture];
+            } else {
                 [self convertYUVToRGBOutput];
-//            }
+            }
 
             [self loopTargetsWithTargetAndTextureIndex:^(id<GPUImageInput> target, NSUInteger textureIndex) {
                 [target setInputSize:CGSizeMake(bufferWidth, bufferHeight) index:textureIndex];
@@ -0,0 +1,24 @@
+#import "GPUImageFilter.h"
+
+/** A filter that renders any number of inputs in a single pass
+
+ Input i is sampled in the fragment shader as inputImageTexture<i+1> at textureCoordinate<i+1>, with the suffix left off for the first input, exactly like GPUImageTwoInputFilter and GPUImageThreeInputFilter.
+ Attach sources with -addTarget:atTextureLocation:. A frame is rendered once every input has delivered one, at the size of the first input.
+ */
+@interface GPUImageMultiInputFilter : GPUImageFilter
+
+/** The largest number of inputs this device can sample in one pass, bounded by its texture units, vertex attributes and varyings
+ */
++ (NSUInteger)maximumNumberOfInputs;
+
+/** The vertex shader passing every input's texture coordinate through
+ */
++ (NSString *)vertexShaderForNumberOfInputs:(NSUInteger)numberOfInputs;
+
+/** Initialize with a fragment shader reading numberOfInputs textures
+ @param numberOfInputs Number of inputs, from 1 to +maximumNumberOfInputs
+ @param fragmentShaderString Source code of the fragment shader
+ */
+- (id)initWithNumberOfInputs:(NSUInteger)numberOfInputs fragmentShaderFromString:(NSString *)fragmentShaderString;
+
+@end
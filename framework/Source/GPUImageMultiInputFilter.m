@@ -0,0 +1,66 @@
+#import "GPUImageMultiInputFilter.h"
+
+@interface GPUImageMultiInputFilter()
+{
+    // Has to be known before GPUImageFilter sets up its inputs and program
+    NSUInteger requestedNumberOfInputs;
+}
+@end
+
+@implementation GPUImageMultiInputFilter
+
+#pragma mark - Limits
+
++ (NSUInteger)maximumNumberOfInputs {
+  static dispatch_once_t pred;
+  static NSUInteger maximumNumberOfInputs = 0;
+
+  dispatch_once(&pred, ^{
+    runSynchronouslyOnVideoProcessingQueue(^{
+      [GPUImageContext useImageProcessingContext];
+      GLint textureUnits = 0, vertexAttributes = 0, varyingVectors = 0;
+      glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &textureUnits);
+      glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &vertexAttributes);
+#if TARGET_IPHONE_SIMULATOR || TARGET_OS_IPHONE
+      glGetIntegerv(GL_MAX_VARYING_VECTORS, &varyingVectors);
+#else
+      glGetIntegerv(GL_MAX_VARYING_FLOATS, &varyingVectors);
+      varyingVectors /= 4;
+#endif
+      // Units 0 and 1 are left to the outputs, position takes one attribute and every vec2 varying is counted as a full vector
+      maximumNumberOfInputs = (NSUInteger)MAX(MIN(MIN(textureUnits - 2, vertexAttributes - 1), varyingVectors), 1);
+    });
+  });
+
+  return maximumNumberOfInputs;
+}
+
++ (NSString *)vertexShaderForNumberOfInputs:(NSUInteger)numberOfInputs {
+  NSMutableString *shaderString = [NSMutableString stringWithString:@"attribute vec4 position;\n"];
+  for (NSUInteger input = 0; input < numberOfInputs; input++) {
+    [shaderString appendFormat:@"attribute vec4 %@;\nvarying vec2 %@;\n", inputVariableName(@"inputTextureCoordinate", input), inputVariableName(@"textureCoordinate", input)];
+  }
+
+  [shaderString appendString:@"\nvoid main()\n{\n    gl_Position = position;\n"];
+  for (NSUInteger input = 0; input < numberOfInputs; input++) {
+    [shaderString appendFormat:@"    %@ = %@.xy;\n", inputVariableName(@"textureCoordinate", input), inputVariableName(@"inputTextureCoordinate", input)];
+  }
+  [shaderString appendString:@"}\n"];
+
+  return shaderString;
+}
+
+#pragma mark - Initialization and teardown
+
+- (id)initWithNumberOfInputs:(NSUInteger)numberOfInputs fragmentShaderFromString:(NSString *)fragmentShaderString {
+  NSAssert(numberOfInputs >= 1 && numberOfInputs <= [[self class] maximumNumberOfInputs], @"Unsupported number of inputs");
+  requestedNumberOfInputs = numberOfInputs;
+  self = [super initWithVertexShaderFromString:[[self class] vertexShaderForNumberOfInputs:numberOfInputs] fragmentShaderFromString:fragmentShaderString];
+  return self;
+}
+
+- (void)initNumberOfInputs {
+  self.numberOfInputs = (GLuint)requestedNumberOfInputs;
+}
+
+@end
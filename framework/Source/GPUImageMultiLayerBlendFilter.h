@@ -0,0 +1,35 @@
+#import "GPUImageMultiInputFilter.h"
+
+typedef NS_ENUM(NSUInteger, GPUImageLayerBlendMode) {
+    /// Source over, like GPUImageNormalBlendFilter
+    kGPUImageLayerBlendNormal,
+    kGPUImageLayerBlendMultiply,
+    kGPUImageLayerBlendScreen,
+    kGPUImageLayerBlendAdd
+};
+
+/** Composites a stack of layers in a single pass, instead of a cascade of two-input blends that each render a full-size framebuffer
+
+ Input 0 is the bottom layer and every following input is blended on top of the result so far. Attach layers with -addTarget:atTextureLocation:.
+ The number of layers is limited by +[GPUImageMultiInputFilter maximumNumberOfInputs], split larger stacks over several blend filters.
+ */
+@interface GPUImageMultiLayerBlendFilter : GPUImageMultiInputFilter
+
+@property (nonatomic, readonly) NSUInteger numberOfLayers;
+
+/** Initialize with normal blending and full opacity for every layer
+ @param numberOfLayers Number of layers, including the bottom one
+ */
+- (id)initWithNumberOfLayers:(NSUInteger)numberOfLayers;
+
+/** The opacity multiplied into a layer's alpha, from 0.0 to 1.0. Default of 1.0
+ */
+- (void)setOpacity:(CGFloat)opacity forLayer:(NSUInteger)layer;
+- (CGFloat)opacityForLayer:(NSUInteger)layer;
+
+/** How a layer combines with the layers below it. Ignored for the bottom layer, default of kGPUImageLayerBlendNormal
+ */
+- (void)setBlendMode:(GPUImageLayerBlendMode)blendMode forLayer:(NSUInteger)layer;
+- (GPUImageLayerBlendMode)blendModeForLayer:(NSUInteger)layer;
+
+@end
@@ -0,0 +1,142 @@
+#import "GPUImageMultiLayerBlendFilter.h"
+
+#if TARGET_IPHONE_SIMULATOR || TARGET_OS_IPHONE
+NSString *const kGPUImageMultiLayerBlendShaderPrecision = @"precision mediump float;\n";
+#else
+NSString *const kGPUImageMultiLayerBlendShaderPrecision = @"";
+#endif
+
+// Layers are not premultiplied. Every mode mixes its result over the base by the layer's alpha and composites the alphas source-over
+NSString *const kGPUImageMultiLayerBlendFunctionsString = SHADER_STRING
+(
+ vec4 compositeLayer(vec4 base, vec4 layer, vec3 blendedColor)
+ {
+     float alpha = layer.a + base.a * (1.0 - layer.a);
+     vec3 color = (blendedColor * layer.a + base.rgb * base.a * (1.0 - layer.a)) / (alpha + step(alpha, 0.0));
+     return vec4(color, alpha);
+ }
+
+ vec4 blendNormal(vec4 base, vec4 layer)
+ {
+     return compositeLayer(base, layer, layer.rgb);
+ }
+
+ vec4 blendMultiply(vec4 base, vec4 layer)
+ {
+     return compositeLayer(base, layer, mix(layer.rgb, layer.rgb * base.rgb, base.a));
+ }
+
+ vec4 blendScreen(vec4 base, vec4 layer)
+ {
+     return compositeLayer(base, layer, mix(layer.rgb, 1.0 - (1.0 - layer.rgb) * (1.0 - base.rgb), base.a));
+ }
+
+ vec4 blendAdd(vec4 base, vec4 layer)
+ {
+     return compositeLayer(base, layer, mix(layer.rgb, min(layer.rgb + base.rgb, 1.0), base.a));
+ }
+);
+
+static NSString *multiLayerBlendFunctionName(GPUImageLayerBlendMode blendMode) {
+  switch (blendMode) {
+    case kGPUImageLayerBlendNormal: return @"blendNormal";
+    case kGPUImageLayerBlendMultiply: return @"blendMultiply";
+    case kGPUImageLayerBlendScreen: return @"blendScreen";
+    case kGPUImageLayerBlendAdd: return @"blendAdd";
+  }
+}
+
+static NSString *multiLayerBlendFragmentShader(NSArray *blendModes) {
+  NSUInteger numberOfLayers = [blendModes count];
+  NSMutableString *shaderString = [NSMutableString stringWithString:kGPUImageMultiLayerBlendShaderPrecision];
+  for (NSUInteger layer = 0; layer < numberOfLayers; layer++) {
+    [shaderString appendFormat:@"varying vec2 %@;\nuniform sampler2D %@;\n", inputVariableName(@"textureCoordinate", layer), inputVariableName(@"inputImageTexture", layer)];
+  }
+  [shaderString appendFormat:@"uniform float layerOpacity[%lu];\n", (unsigned long)numberOfLayers];
+  [shaderString appendString:kGPUImageMultiLayerBlendFunctionsString];
+
+  [shaderString appendString:@"\nvoid main()\n{\n"];
+  [shaderString appendString:@"    vec4 result = texture2D(inputImageTexture, textureCoordinate);\n    result.a *= layerOpacity[0];\n    vec4 layer;\n"];
+  for (NSUInteger layer = 1; layer < numberOfLayers; layer++) {
+    [shaderString appendFormat:@"    layer = texture2D(%@, %@);\n", inputVariableName(@"inputImageTexture", layer), inputVariableName(@"textureCoordinate", layer)];
+    [shaderString appendFormat:@"    layer.a *= layerOpacity[%lu];\n", (unsigned long)layer];
+    [shaderString appendFormat:@"    result = %@(result, layer);\n", multiLayerBlendFunctionName([blendModes[layer] unsignedIntegerValue])];
+  }
+  [shaderString appendString:@"    gl_FragColor = result;\n}\n"];
+
+  return shaderString;
+}
+
+@interface GPUImageMultiLayerBlendFilter()
+{
+    GLfloat *layerOpacities;
+}
+
+@property (nonatomic, strong) NSMutableArray *blendModes;
+
+@end
+
+@implementation GPUImageMultiLayerBlendFilter
+
+#pragma mark - Initialization and teardown
+
+- (id)initWithNumberOfLayers:(NSUInteger)numberOfLayers {
+  NSMutableArray *blendModes = [NSMutableArray arrayWithCapacity:numberOfLayers];
+  for (NSUInteger layer = 0; layer < numberOfLayers; layer++) {
+    [blendModes addObject:@(kGPUImageLayerBlendNormal)];
+  }
+
+  if (!(self = [super initWithNumberOfInputs:numberOfLayers fragmentShaderFromString:multiLayerBlendFragmentShader(blendModes)])) {
+    return nil;
+  }
+
+  _numberOfLayers = numberOfLayers;
+  self.blendModes = blendModes;
+  self.samplingFootprint = CGSizeZero;
+
+  layerOpacities = calloc(numberOfLayers, sizeof(GLfloat));
+  for (NSUInteger layer = 0; layer < numberOfLayers; layer++) {
+    layerOpacities[layer] = 1.0;
+  }
+  [self updateOpacities];
+
+  return self;
+}
+
+- (void)dealloc {
+  free(layerOpacities);
+}
+
+#pragma mark - Accessors
+
+- (void)updateOpacities {
+  [self setFloatArray:layerOpacities length:(GLsizei)self.numberOfLayers forUniform:@"layerOpacity"];
+}
+
+- (void)setOpacity:(CGFloat)opacity forLayer:(NSUInteger)layer {
+  NSAssert(layer < self.numberOfLayers, @"Invalid layer");
+  layerOpacities[layer] = MIN(MAX(opacity, 0.0), 1.0);
+  [self updateOpacities];
+}
+
+- (CGFloat)opacityForLayer:(NSUInteger)layer {
+  NSAssert(layer < self.numberOfLayers, @"Invalid layer");
+  return layerOpacities[layer];
+}
+
+- (void)setBlendMode:(GPUImageLayerBlendMode)blendMode forLayer:(NSUInteger)layer {
+  NSAssert(layer < self.numberOfLayers, @"Invalid layer");
+  if ([self.blendModes[layer] unsignedIntegerValue] == blendMode) {
+    return;
+  }
+  self.blendModes[layer] = @(blendMode);
+  [self switchToVertexShader:[[self class] vertexShaderForNumberOfInputs:self.numberOfLayers] fragmentShader:multiLayerBlendFragmentShader(self.blendModes)];
+  [self updateOpacities];
+}
+
+- (GPUImageLayerBlendMode)blendModeForLayer:(NSUInteger)layer {
+  NSAssert(layer < self.numberOfLayers, @"Invalid layer");
+  return [self.blendModes[layer] unsignedIntegerValue];
+}
+
+@end
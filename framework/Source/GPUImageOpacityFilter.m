@@ -45,6 +45,8 @@ NSString *const kGPUImageOpacityFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     opacityUniform = [self.filterProgram uniformIndex:@"opacity"];
     self.opacity = 1.0;
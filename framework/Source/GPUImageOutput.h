@@ -6,6 +6,8 @@
 void reportAvailableMemoryForGPUImage(NSString *tag);
 
 @class GPUImageMovieWriter;
+@class GPUImageGraphExecutor;
+@class GPUImageTimeline;
 
 /** GPUImage's base source object
  
@@ -29,10 +31,34 @@ void reportAvailableMemoryForGPUImage(NSString *tag);
 @property (nonatomic, assign) BOOL shouldIgnoreUpdatesToThisTarget;
 @property (nonatomic, assign) BOOL usingNextFrameForImageCapture;
 
+/// Set by the executor of the graph the output is part of, which then schedules the deliveries to the targets
+@property (nonatomic, weak) GPUImageGraphExecutor *graphExecutor;
+
+/// Set when properties of the output are bound to the timeline. Filters advance it to the time of each frame before rendering it, other outputs leave that to a bound filter, see GPUImageTimeline
+@property (nonatomic, weak) GPUImageTimeline *timeline;
+
 #pragma mark - Looping targets
 
 - (void)loopTargetsWithTargetAndTextureIndex:(void (^)(id<GPUImageInput> target, NSUInteger textureIndex))block;
 
+#pragma mark - Region of interest
+
+/** The union of the regions the targets read from the output, normalized. The full frame while capturing an image, or when any target doesn't declare its region
+ */
+- (CGRect)regionOfInterestOfOutput;
+
+#pragma mark - Monochrome input
+
+/** Whether there are targets and all of them only read luminance, so a YUV source can skip its RGB conversion. NO while capturing an image
+ */
+- (BOOL)allTargetsWantMonochromeInput;
+
+#pragma mark - Frame demand
+
+/** Whether any target wants the frame at frameTime, see -wantsFrameAtTime: of GPUImageInput. YES while capturing an image, with a frameProcessingCompletionBlock, or without targets, since the output may then be read some other way
+ */
+- (BOOL)targetsWantFrameAtTime:(CMTime)frameTime;
+
 #pragma mark - Managing targets
 
 - (void)setInputFramebufferForTarget:(id<GPUImageInput>)target atIndex:(NSUInteger)inputTextureIndex;
@@ -76,9 +102,14 @@ void reportAvailableMemoryForGPUImage(NSString *tag);
 
 - (void)informTargetsAboutNewFrameAtTime:(CMTime)frameTime;
 
+/// Render at a fixed size rather than the input size. CGSizeZero goes back to the input size
 - (void)forceProcessingAtSize:(CGSize)frameSize;
 - (void)forceProcessingAtSizeRespectingAspectRatio:(CGSize)frameSize;
 
+/// The size given to the last of the two above, CGSizeZero when processing at the input size
+- (CGSize)forcedProcessingSize;
+- (BOOL)forcedProcessingRespectsAspectRatio;
+
 /// @name Still image processing
 
 - (void)useNextFrameForImageCapture;
@@ -1,4 +1,5 @@
 #import "GPUImageOutput.h"
+#import "GPUImageGraphExecutor.h"
 #import "GPUImageMovieWriter.h"
 #import "GPUImagePicture.h"
 #import <mach/mach.h>
@@ -68,6 +69,65 @@ void reportAvailableMemoryForGPUImage(NSString *tag) {
     }
 }
 
+#pragma mark - Region of interest
+
+- (CGRect)regionOfInterestOfOutput {
+    if (self.usingNextFrameForImageCapture) {
+        return kGPUImageFullRegionOfInterest;
+    }
+
+    __block CGRect region = CGRectNull;
+    [self loopTargetsWithTargetAndTextureIndex:^(id<GPUImageInput> target, NSUInteger textureIndex) {
+        CGRect targetRegion = kGPUImageFullRegionOfInterest;
+        if ([target respondsToSelector:@selector(regionOfInterestForInputAtIndex:)]) {
+            targetRegion = [target regionOfInterestForInputAtIndex:textureIndex];
+        }
+        region = CGRectUnion(region, targetRegion);
+    }];
+
+    // Nothing consumes the output, so whatever reads it later expects all of it
+    if (CGRectIsNull(region)) {
+        return kGPUImageFullRegionOfInterest;
+    }
+    return outsetRegionOfInterest(region, 0.0, 0.0);
+}
+
+#pragma mark - Monochrome input
+
+- (BOOL)allTargetsWantMonochromeInput {
+    if (self.usingNextFrameForImageCapture || [self.targets count] == 0) {
+        return NO;
+    }
+
+    __block BOOL wantsMonochromeInput = YES;
+    [self loopTargetsWithTargetAndTextureIndex:^(id<GPUImageInput> target, NSUInteger textureIndex) {
+        if (![target respondsToSelector:@selector(wantsMonochromeInput)] || ![target wantsMonochromeInput]) {
+            wantsMonochromeInput = NO;
+        }
+    }];
+    return wantsMonochromeInput;
+}
+
+#pragma mark - Frame demand
+
+- (BOOL)targetsWantFrameAtTime:(CMTime)frameTime {
+    if (self.usingNextFrameForImageCapture || self.frameProcessingCompletionBlock != nil || [self.targets count] == 0) {
+        return YES;
+    }
+
+    __block BOOL wantsFrame = NO;
+    [self loopTargetsWithTargetAndTextureIndex:^(id<GPUImageInput> target, NSUInteger textureIndex) {
+        if ([target shouldIgnoreUpdatesToThisTarget]) {
+            return;
+        }
+        // Every target is asked, so that the samplers further down count the frame whoever else wants it
+        if (![target respondsToSelector:@selector(wantsFrameAtTime:)] || [target wantsFrameAtTime:frameTime]) {
+            wantsFrame = YES;
+        }
+    }];
+    return wantsFrame;
+}
+
 #pragma mark - Managing the display FBOs
 
 - (CGSize)outputFrameSize {
@@ -80,11 +140,16 @@ void reportAvailableMemoryForGPUImage(NSString *tag) {
         self.frameProcessingCompletionBlock(self, frameTime);
     }
 
-    // Get all targets the framebuffer so they can grab a lock on it
-    [self loopTargetsWithTargetAndTextureIndex:^(id<GPUImageInput> target, NSUInteger textureIndex) {
-        [self setInputFramebufferForTarget:target atIndex:textureIndex];
-        [target setInputSize:[self outputFrameSize] index:textureIndex];
-    }];
+    // Get all targets the framebuffer so they can grab a lock on it, or let the executor hold it for them until it delivers the frame
+    GPUImageGraphExecutor *graphExecutor = self.graphExecutor;
+    if (graphExecutor != nil) {
+        [graphExecutor scheduleTargetsOfOutput:self atTime:frameTime];
+    } else {
+        [self loopTargetsWithTargetAndTextureIndex:^(id<GPUImageInput> target, NSUInteger textureIndex) {
+            [self setInputFramebufferForTarget:target atIndex:textureIndex];
+            [target setInputSize:[self outputFrameSize] index:textureIndex];
+        }];
+    }
 
     // Release our hold so it can return to the cache immediately upon processing
     [self.outputFramebuffer unlock];
@@ -93,6 +158,11 @@ void reportAvailableMemoryForGPUImage(NSString *tag) {
         self.outputFramebuffer = nil;
     }
 
+    if (graphExecutor != nil) {
+        [graphExecutor executeScheduledDeliveries];
+        return;
+    }
+
     // Trigger processing last, so that our unlock comes first in serial execution, avoiding the need for a callback
     [self loopTargetsWithTargetAndTextureIndex:^(id<GPUImageInput> target, NSUInteger textureIndex) {
         [target newFrameReadyAtTime:frameTime atIndex:textureIndex];
@@ -175,6 +245,14 @@ void reportAvailableMemoryForGPUImage(NSString *tag) {
 - (void)forceProcessingAtSizeRespectingAspectRatio:(CGSize)frameSize {
 }
 
+- (CGSize)forcedProcessingSize {
+    return CGSizeZero;
+}
+
+- (BOOL)forcedProcessingRespectsAspectRatio {
+    return NO;
+}
+
 #pragma mark - Still image processing
 
 - (void)useNextFrameForImageCapture {
@@ -1,8 +1,10 @@
 #import "GPUImageFilter.h"
 
+// Renders once and passes the same noise on while its parameters stay put, see hasStaticContent
 @interface GPUImagePerlinNoiseFilter : GPUImageFilter 
 {
-    GLint scaleUniform, colorStartUniform, colorFinishUniform;
+    GLint scaleUniform, colorStartUniform, colorFinishUniform, noiseOffsetUniform, periodUniform;
+    GLint noiseAtlasTextureUniform, atlasScaleUniform, atlasOffsetUniform;
 }
 
 @property (readwrite, nonatomic) GPUVector4 colorStart;
@@ -10,4 +12,16 @@
 
 @property (readwrite, nonatomic) float scale;
 
+// Shifts the noise, in widths and heights of the output. The default is (0.0, 0.0)
+@property (readwrite, nonatomic) CGPoint noiseOffset;
+
+// Moves the noise by this much of the output per second of frame time, on top of noiseOffset. The default of (0.0, 0.0) keeps it still
+@property (readwrite, nonatomic) CGPoint noiseVelocity;
+
+// Renders the noise once into a tile that wraps around and moves that tile across the output, instead of computing the noise for every pixel of every frame. Use it for moving noise. The tile holds a whole number of cells, the scale rounded. The default is NO
+@property (readwrite, nonatomic) BOOL usesNoiseAtlas;
+
+// Width and height of the tile in pixels, rounded up to a power of two. The default is 512
+@property (readwrite, nonatomic) NSUInteger noiseAtlasSize;
+
 @end
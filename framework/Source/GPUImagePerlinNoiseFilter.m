@@ -9,6 +9,8 @@ NSString *const kGPUImagePerlinNoiseFragmentShaderString = SHADER_STRING
  
  uniform vec4 colorStart;
  uniform vec4 colorFinish;
+ uniform vec2 noiseOffset;
+ uniform vec2 period;
  
  //
  // Description : Array and textureless GLSL 2D/3D/4D simplex
@@ -45,6 +47,7 @@ NSString *const kGPUImagePerlinNoiseFragmentShaderString = SHADER_STRING
 {
     vec4 Pi = floor(P.xyxy) + vec4(0.0, 0.0, 1.0, 1.0);
     vec4 Pf = fract(P.xyxy) - vec4(0.0, 0.0, 1.0, 1.0);
+    Pi = mod(Pi, period.xyxy); // To create noise with explicit period
     Pi = mod289(Pi); // To avoid truncation effects in permutation
     vec4 ix = Pi.xzxz;
     vec4 iy = Pi.yyww;
@@ -84,7 +87,7 @@ NSString *const kGPUImagePerlinNoiseFragmentShaderString = SHADER_STRING
  void main()
  {
      
-     float n1 = (cnoise(textureCoordinate * scale) + 1.0) / 2.0;
+     float n1 = (cnoise((textureCoordinate + noiseOffset) * scale) + 1.0) / 2.0;
      
      vec4 colorDiff = colorFinish - colorStart;
      vec4 color = colorStart + colorDiff * n1;
@@ -100,6 +103,8 @@ NSString *const kGPUImagePerlinNoiseFragmentShaderString = SHADER_STRING
  
  uniform vec4 colorStart;
  uniform vec4 colorFinish;
+ uniform vec2 noiseOffset;
+ uniform vec2 period;
  
  //
  // Description : Array and textureless GLSL 2D/3D/4D simplex
@@ -136,6 +141,7 @@ NSString *const kGPUImagePerlinNoiseFragmentShaderString = SHADER_STRING
 {
     vec4 Pi = floor(P.xyxy) + vec4(0.0, 0.0, 1.0, 1.0);
     vec4 Pf = fract(P.xyxy) - vec4(0.0, 0.0, 1.0, 1.0);
+    Pi = mod(Pi, period.xyxy); // To create noise with explicit period
     Pi = mod289(Pi); // To avoid truncation effects in permutation
     vec4 ix = Pi.xzxz;
     vec4 iy = Pi.yyww;
@@ -174,7 +180,7 @@ NSString *const kGPUImagePerlinNoiseFragmentShaderString = SHADER_STRING
  void main()
  {
      
-     float n1 = (cnoise(textureCoordinate * scale) + 1.0) / 2.0;
+     float n1 = (cnoise((textureCoordinate + noiseOffset) * scale) + 1.0) / 2.0;
      
      vec4 colorDiff = colorFinish - colorStart;
      vec4 color = colorStart + colorDiff * n1;
@@ -184,10 +190,59 @@ NSString *const kGPUImagePerlinNoiseFragmentShaderString = SHADER_STRING
 );
 #endif
 
+#if TARGET_IPHONE_SIMULATOR || TARGET_OS_IPHONE
+NSString *const kGPUImageNoiseAtlasFragmentShaderString = SHADER_STRING
+(
+ varying highp vec2 textureCoordinate;
+ 
+ uniform sampler2D noiseAtlasTexture;
+ uniform highp float atlasScale;
+ uniform highp vec2 atlasOffset;
+ 
+ void main()
+ {
+     gl_FragColor = texture2D(noiseAtlasTexture, textureCoordinate * atlasScale + atlasOffset);
+ }
+);
+#else
+NSString *const kGPUImageNoiseAtlasFragmentShaderString = SHADER_STRING
+(
+ varying vec2 textureCoordinate;
+ 
+ uniform sampler2D noiseAtlasTexture;
+ uniform float atlasScale;
+ uniform vec2 atlasOffset;
+ 
+ void main()
+ {
+     gl_FragColor = texture2D(noiseAtlasTexture, textureCoordinate * atlasScale + atlasOffset);
+ }
+);
+#endif
+
+// Rendered straight through the permutation wrap, which leaves the noise as it always was
+static const GLfloat kGPUImagePerlinNoiseUnboundedPeriod = 289.0f;
+
+@interface GPUImagePerlinNoiseFilter()
+{
+    GLProgram *noiseAtlasProgram;
+    GPUImageFramebuffer *noiseAtlasFramebuffer;
+    CMTime currentFrameTime;
+}
+
+- (void)locateUniforms;
+- (void)renderNoiseAtlas;
+- (void)invalidateNoiseAtlas;
+- (BOOL)isNoiseMoving;
+- (CGPoint)noiseOffsetAtTime:(CMTime)frameTime;
+
+@end
 
 @implementation GPUImagePerlinNoiseFilter
 
 @synthesize scale = _scale, colorStart = _colorStart, colorFinish = _colorFinish;
+@synthesize noiseOffset = _noiseOffset, noiseVelocity = _noiseVelocity;
+@synthesize usesNoiseAtlas = _usesNoiseAtlas, noiseAtlasSize = _noiseAtlasSize;
 
 #pragma mark -
 #pragma mark Initialization and teardown
@@ -199,10 +254,11 @@ NSString *const kGPUImagePerlinNoiseFragmentShaderString = SHADER_STRING
 		return nil;
     }
     
-    scaleUniform = [self.filterProgram uniformIndex:@"scale"];
+    [self locateUniforms];
     
-    colorStartUniform = [self.filterProgram uniformIndex:@"colorStart"];
-    colorFinishUniform = [self.filterProgram uniformIndex:@"colorFinish"];
+    self.hasStaticContent = YES;
+    _noiseAtlasSize = 512;
+    currentFrameTime = kCMTimeIndefinite;
     
     [self setScale:8.0];
     
@@ -212,6 +268,154 @@ NSString *const kGPUImagePerlinNoiseFragmentShaderString = SHADER_STRING
     return self;
 }
 
+- (void)locateUniforms;
+{
+    runSynchronouslyOnVideoProcessingQueue(^{
+        scaleUniform = [self.filterProgram uniformIndex:@"scale"];
+        
+        colorStartUniform = [self.filterProgram uniformIndex:@"colorStart"];
+        colorFinishUniform = [self.filterProgram uniformIndex:@"colorFinish"];
+        noiseOffsetUniform = [self.filterProgram uniformIndex:@"noiseOffset"];
+        periodUniform = [self.filterProgram uniformIndex:@"period"];
+        
+        noiseAtlasTextureUniform = [self.filterProgram uniformIndex:@"noiseAtlasTexture"];
+        atlasScaleUniform = [self.filterProgram uniformIndex:@"atlasScale"];
+        atlasOffsetUniform = [self.filterProgram uniformIndex:@"atlasOffset"];
+    });
+}
+
+- (void)dealloc;
+{
+    [noiseAtlasFramebuffer unlock];
+}
+
+#pragma mark -
+#pragma mark Rendering
+
+- (void)newFrameReadyAtTime:(CMTime)frameTime atIndex:(NSInteger)textureIndex;
+{
+    currentFrameTime = frameTime;
+    [super newFrameReadyAtTime:frameTime atIndex:textureIndex];
+}
+
+- (BOOL)isNoiseMoving;
+{
+    return !CGPointEqualToPoint(_noiseVelocity, CGPointZero);
+}
+
+- (CGPoint)noiseOffsetAtTime:(CMTime)frameTime;
+{
+    if (![self isNoiseMoving] || !CMTIME_IS_NUMERIC(frameTime))
+    {
+        return _noiseOffset;
+    }
+    
+    Float64 seconds = CMTimeGetSeconds(frameTime);
+    return CGPointMake(_noiseOffset.x + _noiseVelocity.x * seconds, _noiseOffset.y + _noiseVelocity.y * seconds);
+}
+
+- (BOOL)reuseStaticContent;
+{
+    // Moving noise is different on every frame
+    return ![self isNoiseMoving] && [super reuseStaticContent];
+}
+
+- (void)keepStaticContent;
+{
+    if (![self isNoiseMoving])
+    {
+        [super keepStaticContent];
+    }
+}
+
+- (BOOL)preRender;
+{
+    if (_usesNoiseAtlas && !self.preventRendering && noiseAtlasFramebuffer == nil)
+    {
+        [self renderNoiseAtlas];
+    }
+    
+    return [super preRender];
+}
+
+- (void)renderNoiseAtlas;
+{
+    if (noiseAtlasProgram == nil)
+    {
+        noiseAtlasProgram = [[GPUImageContext currentContext] programForVertexShaderString:kGPUImageVertexShaderString fragmentShaderString:kGPUImagePerlinNoiseFragmentShaderString];
+        if (!noiseAtlasProgram.initialized)
+        {
+            [noiseAtlasProgram addAttribute:@"position"];
+            [noiseAtlasProgram addAttribute:@"inputTextureCoordinate"];
+            [noiseAtlasProgram link];
+        }
+    }
+    
+    // Wrapping needs a power of two texture in OpenGL ES 2.0
+    GPUTextureOptions atlasTextureOptions = self.outputTextureOptions;
+    atlasTextureOptions.wrapS = GL_REPEAT;
+    atlasTextureOptions.wrapT = GL_REPEAT;
+    noiseAtlasFramebuffer = [[GPUImageContext sharedFramebufferCache] fetchFramebufferForSize:CGSizeMake(_noiseAtlasSize, _noiseAtlasSize) textureOptions:atlasTextureOptions onlyTexture:NO];
+    
+    [GPUImageContext setActiveShaderProgram:noiseAtlasProgram];
+    [noiseAtlasFramebuffer activateFramebuffer];
+    
+    // Whole cells only, so that the tile joins up with itself
+    GLfloat cellsPerTile = MAX(roundf(_scale), 1.0f);
+    glUniform1f([noiseAtlasProgram uniformIndex:@"scale"], cellsPerTile);
+    glUniform2f([noiseAtlasProgram uniformIndex:@"period"], cellsPerTile, cellsPerTile);
+    glUniform2f([noiseAtlasProgram uniformIndex:@"noiseOffset"], 0.0f, 0.0f);
+    glUniform4fv([noiseAtlasProgram uniformIndex:@"colorStart"], 1, (GLfloat *)&_colorStart);
+    glUniform4fv([noiseAtlasProgram uniformIndex:@"colorFinish"], 1, (GLfloat *)&_colorFinish);
+    
+    static const GLfloat atlasVertices[] = {
+        -1.0f, -1.0f,
+        1.0f, -1.0f,
+        -1.0f,  1.0f,
+        1.0f,  1.0f,
+    };
+    static const GLfloat atlasTextureCoordinates[] = {
+        0.0f, 0.0f,
+        1.0f, 0.0f,
+        0.0f, 1.0f,
+        1.0f, 1.0f,
+    };
+    
+    GLuint positionAttribute = [noiseAtlasProgram attributeIndex:@"position"];
+    GLuint textureCoordinateAttribute = [noiseAtlasProgram attributeIndex:@"inputTextureCoordinate"];
+    glEnableVertexAttribArray(positionAttribute);
+    glEnableVertexAttribArray(textureCoordinateAttribute);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, 0, 0, atlasVertices);
+    glVertexAttribPointer(textureCoordinateAttribute, 2, GL_FLOAT, 0, 0, atlasTextureCoordinates);
+    
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+
+- (void)render;
+{
+    CGPoint offset = [self noiseOffsetAtTime:currentFrameTime];
+    
+    if (_usesNoiseAtlas)
+    {
+        // In tiles, wrapped on this side so that the offset keeps its precision however far the noise moves
+        GLfloat atlasScale = _scale / MAX(roundf(_scale), 1.0f);
+        GLfloat atlasOffsetX = offset.x * atlasScale, atlasOffsetY = offset.y * atlasScale;
+        glUniform1f(atlasScaleUniform, atlasScale);
+        glUniform2f(atlasOffsetUniform, atlasOffsetX - floorf(atlasOffsetX), atlasOffsetY - floorf(atlasOffsetY));
+        
+        glActiveTexture(GL_TEXTURE2 + self.numberOfInputs);
+        glBindTexture(GL_TEXTURE_2D, noiseAtlasFramebuffer.texture);
+        glUniform1i(noiseAtlasTextureUniform, (GLint)(2 + self.numberOfInputs));
+    }
+    else
+    {
+        glUniform2f(noiseOffsetUniform, offset.x, offset.y);
+    }
+    
+    [super render];
+}
+
 #pragma mark -
 #pragma mark Accessors
 
@@ -220,6 +424,8 @@ NSString *const kGPUImagePerlinNoiseFragmentShaderString = SHADER_STRING
     _scale = scale;
     
     [self setFloat:_scale forUniform:scaleUniform program:self.filterProgram];
+    [self setPoint:CGPointMake(kGPUImagePerlinNoiseUnboundedPeriod, kGPUImagePerlinNoiseUnboundedPeriod) forUniform:periodUniform program:self.filterProgram];
+    [self invalidateNoiseAtlas];
 }
 
 - (void)setColorStart:(GPUVector4)colorStart 
@@ -227,6 +433,7 @@ NSString *const kGPUImagePerlinNoiseFragmentShaderString = SHADER_STRING
     _colorStart = colorStart;
     
     [self setVec4:_colorStart forUniform:colorStartUniform program:self.filterProgram];
+    [self invalidateNoiseAtlas];
 }
 
 - (void)setColorFinish:(GPUVector4)colorFinish 
@@ -234,6 +441,55 @@ NSString *const kGPUImagePerlinNoiseFragmentShaderString = SHADER_STRING
     _colorFinish = colorFinish;
 
     [self setVec4:_colorFinish forUniform:colorFinishUniform program:self.filterProgram];
+    [self invalidateNoiseAtlas];
+}
+
+- (void)setNoiseOffset:(CGPoint)noiseOffset;
+{
+    _noiseOffset = noiseOffset;
+    [self invalidateStaticContent];
+}
+
+- (void)setNoiseVelocity:(CGPoint)noiseVelocity;
+{
+    _noiseVelocity = noiseVelocity;
+    [self invalidateStaticContent];
+}
+
+- (void)setUsesNoiseAtlas:(BOOL)usesNoiseAtlas;
+{
+    if (usesNoiseAtlas == _usesNoiseAtlas)
+    {
+        return;
+    }
+    _usesNoiseAtlas = usesNoiseAtlas;
+    
+    [self switchToVertexShader:kGPUImageVertexShaderString fragmentShader:(usesNoiseAtlas ? kGPUImageNoiseAtlasFragmentShaderString : kGPUImagePerlinNoiseFragmentShaderString)];
+    [self locateUniforms];
+    
+    [self setScale:_scale];
+    [self setColorStart:_colorStart];
+    [self setColorFinish:_colorFinish];
+}
+
+- (void)setNoiseAtlasSize:(NSUInteger)noiseAtlasSize;
+{
+    NSUInteger powerOfTwo = 1;
+    while (powerOfTwo < noiseAtlasSize)
+    {
+        powerOfTwo <<= 1;
+    }
+    _noiseAtlasSize = powerOfTwo;
+    [self invalidateNoiseAtlas];
+}
+
+- (void)invalidateNoiseAtlas;
+{
+    runSynchronouslyOnVideoProcessingQueue(^{
+        [noiseAtlasFramebuffer unlock];
+        noiseAtlasFramebuffer = nil;
+    });
+    [self invalidateStaticContent];
 }
 
 @end
@@ -45,6 +45,8 @@ NSString *const kGPUImagePosterizeFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     colorLevelsUniform = [self.filterProgram uniformIndex:@"colorLevels"];
     self.colorLevels = 10;
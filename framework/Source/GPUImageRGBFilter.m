@@ -49,6 +49,8 @@ NSString *const kGPUImageRGBFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     redUniform = [self.filterProgram uniformIndex:@"redAdjustment"];
     self.red = 1.0;
@@ -1,5 +1,6 @@
 #import <Foundation/Foundation.h>
 #import "GPUImageContext.h"
+#import "GPUImageFrameSampler.h"
 
 struct GPUByteColorVector {
     GLubyte red;
@@ -28,6 +29,9 @@ typedef struct GPUByteColorVector GPUByteColorVector;
 @property(readonly) GLubyte *rawBytesForImage;
 @property(nonatomic, copy) void(^newFrameAvailableBlock)(void);
 
+// Which frames the output wants, e.g. one in ten for an analysis that doesn't need every frame. Frames it turns down aren't rendered upstream for it
+@property(nonatomic, strong, readonly) GPUImageFrameSampler *frameSampler;
+
 // Initialization and teardown
 - (id)initWithImageSize:(CGSize)newImageSize resultsInBGRAFormat:(BOOL)resultsInBGRAFormat;
 
@@ -46,6 +46,7 @@
     hasReadFromTheCurrentFrame = NO;
     _rawBytesForImage = NULL;
     inputRotation = kGPUImageNoRotation;
+    _frameSampler = [[GPUImageFrameSampler alloc] init];
 
     [GPUImageContext useImageProcessingContext];
     if ( (outputBGRA && ![GPUImageContext supportsFastTextureUpload]) || (!outputBGRA && [GPUImageContext supportsFastTextureUpload]) )
@@ -210,6 +211,11 @@
     return NO;
 }
 
+- (BOOL)wantsFrameAtTime:(CMTime)frameTime;
+{
+    return [_frameSampler wantsFrameAtTime:frameTime];
+}
+
 #pragma mark - Accessors
 
 - (GLubyte *)rawBytesForImage;
@@ -0,0 +1,58 @@
+#import "GPUImageFilter.h"
+
+typedef NS_ENUM(NSUInteger, GPUImageResamplingMode) {
+    /// Lanczos for ratios up to 2, area averaging for whole-number ratios and a box prefilter followed by Lanczos otherwise
+    kGPUImageResamplingAutomatic,
+    /// Area average down to at most twice the output size, then a 3-lobe Lanczos filter. Sharpest, with some ringing at hard edges
+    kGPUImageResamplingBoxPrefilteredLanczos,
+    /// Repeated 2:1 reductions followed by one area-averaged step. Cheapest, slightly soft
+    kGPUImageResamplingRepeatedHalving,
+    /// Every output pixel is the coverage-weighted average of the input pixels under it. No ringing, softer than Lanczos
+    kGPUImageResamplingAreaAverage
+};
+
+typedef NS_ENUM(NSUInteger, GPUImageResamplingKernel) {
+    /// Coverage of each input pixel by the output pixel's footprint
+    kGPUImageResamplingAreaKernel,
+    /// 3-lobe Lanczos, stretched by the ratio when reducing
+    kGPUImageResamplingLanczosKernel
+};
+
+/// Half the width of the kernel in input pixels, when reducing by ratio input pixels per output pixel
+CGFloat GPUImageResamplingKernelSupport(GPUImageResamplingKernel kernel, CGFloat ratio);
+
+/// The number of input pixels one pass of the kernel reads per output pixel, at most 32
+NSUInteger GPUImageResamplingTapCount(GPUImageResamplingKernel kernel, CGFloat ratio);
+
+/** The normalized weights the filter tabulates for one sub-pixel position of the output pixel center
+ @param subpixelOffset Where the output pixel center minus the support falls between two input pixels, 0.0 up to 1.0. Tap i sits i + 1 - subpixelOffset - support input pixels from the center
+ @param weights Filled with GPUImageResamplingTapCount() weights summing to 1.0
+ */
+void GPUImageResamplingKernelWeights(GPUImageResamplingKernel kernel, CGFloat ratio, CGFloat subpixelOffset, CGFloat *weights);
+
+/** Resizes its input to the size given to -forceProcessingAtSize: or -forceProcessingAtSizeRespectingAspectRatio:, with proper prefiltering for large reductions
+
+ Resampling is separable and polyphase: each pass filters along one axis with a kernel sampled at 16 sub-pixel phases. The weight tables are computed once per kernel and ratio and shared between filters, so changing sizes back and forth costs nothing after the first time.
+ Large ratios, e.g. 8K frames to 1080p or thumbnails, are split into several passes so that no pass reads more than 32 input pixels per output pixel.
+ */
+@interface GPUImageResamplingFilter : GPUImageFilter
+{
+    GLint passAxisUniform;
+    GLint tapStepUniform;
+    GLint ratioUniform;
+    GLint supportUniform;
+    GLint tapCountUniform;
+    GLint weightTableUniform;
+    GLuint passVertexBuffer;
+}
+
+/// How the reduction is split into passes, kGPUImageResamplingAutomatic by default
+@property (nonatomic, assign) GPUImageResamplingMode resamplingMode;
+
+/// The size of the incoming image, in the orientation of the output
+@property (nonatomic, readonly) CGSize sourceSize;
+
+/// The number of render passes the current source and output sizes take
+@property (nonatomic, readonly) NSUInteger numberOfPasses;
+
+@end
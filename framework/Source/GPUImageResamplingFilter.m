@@ -0,0 +1,414 @@
+#import "GPUImageResamplingFilter.h"
+
+// Sub-pixel positions the kernels are tabulated at
+static const NSUInteger kGPUImageResamplingPhases = 16;
+// Upper bound on the input pixels read per output pixel in one pass
+static const NSUInteger kGPUImageResamplingMaximumTaps = 32;
+// Area passes read ratio + 1 pixels, larger reductions are chained
+static const CGFloat kGPUImageResamplingMaximumAreaRatio = 16.0;
+static const CGFloat kGPUImageResamplingLanczosLobes = 3.0;
+
+#if TARGET_IPHONE_SIMULATOR || TARGET_OS_IPHONE
+NSString *const kGPUImageResamplingShaderPrecision = @"precision highp float;\n";
+#else
+NSString *const kGPUImageResamplingShaderPrecision = @"";
+#endif
+
+// Filters along one output axis. weightTable holds one row of 16-bit fixed point weights per phase, encoded in the red and green channels
+NSString *const kGPUImageResamplingFragmentShaderString = SHADER_STRING
+(
+ varying vec2 textureCoordinate;
+
+ uniform sampler2D inputImageTexture;
+ uniform sampler2D weightTable;
+ uniform vec2 passAxis;
+ uniform vec2 tapStep;
+ uniform float ratio;
+ uniform float support;
+ uniform float tapCount;
+
+ void main()
+ {
+     // textureCoordinate sits on this input position, in pixels along the pass axis
+     float center = dot(gl_FragCoord.xy, passAxis) * ratio - 0.5;
+     float start = floor((center - support) * float(phases) + 0.5) / float(phases);
+     float phase = fract(start);
+     float firstTap = start - phase + 1.0;
+
+     vec2 firstTapCoordinate = textureCoordinate + (firstTap - center) * tapStep;
+     float weightRow = (phase * float(phases) + 0.5) / float(phases);
+
+     vec4 sum = vec4(0.0);
+     for (int tap = 0; tap < maximumTaps; tap++)
+     {
+         if (float(tap) >= tapCount)
+         {
+             break;
+         }
+         vec2 encodedWeight = texture2D(weightTable, vec2((float(tap) + 0.5) / tapCount, weightRow)).rg;
+         float weight = dot(encodedWeight, vec2(65280.0, 255.0)) / 65535.0 * 2.5 - 1.0;
+         sum += texture2D(inputImageTexture, firstTapCoordinate + float(tap) * tapStep) * weight;
+     }
+
+     gl_FragColor = sum;
+ }
+);
+
+#pragma mark - Kernels
+
+CGFloat GPUImageResamplingKernelSupport(GPUImageResamplingKernel kernel, CGFloat ratio) {
+  switch (kernel) {
+    case kGPUImageResamplingAreaKernel:
+      return ratio / 2.0 + 0.5;
+    case kGPUImageResamplingLanczosKernel:
+      return kGPUImageResamplingLanczosLobes * MAX(ratio, 1.0);
+  }
+}
+
+NSUInteger GPUImageResamplingTapCount(GPUImageResamplingKernel kernel, CGFloat ratio) {
+  return MIN(MAX((NSUInteger)ceil(2.0 * GPUImageResamplingKernelSupport(kernel, ratio)), 1), kGPUImageResamplingMaximumTaps);
+}
+
+// distance is measured in input pixels from the output pixel center
+static CGFloat resamplingKernelWeight(GPUImageResamplingKernel kernel, CGFloat distance, CGFloat ratio) {
+  switch (kernel) {
+    case kGPUImageResamplingAreaKernel:
+      // Overlap of the input pixel with the output pixel footprint
+      return MAX(MIN(distance + 0.5, ratio / 2.0) - MAX(distance - 0.5, -ratio / 2.0), 0.0);
+    case kGPUImageResamplingLanczosKernel: {
+      CGFloat x = distance / MAX(ratio, 1.0);
+      if (fabs(x) < 1e-6) {
+        return 1.0;
+      }
+      if (fabs(x) >= kGPUImageResamplingLanczosLobes) {
+        return 0.0;
+      }
+      return kGPUImageResamplingLanczosLobes * sin(M_PI * x) * sin(M_PI * x / kGPUImageResamplingLanczosLobes) / (M_PI * M_PI * x * x);
+    }
+  }
+}
+
+void GPUImageResamplingKernelWeights(GPUImageResamplingKernel kernel, CGFloat ratio, CGFloat subpixelOffset, CGFloat *weights) {
+  CGFloat support = GPUImageResamplingKernelSupport(kernel, ratio);
+  NSUInteger tapCount = GPUImageResamplingTapCount(kernel, ratio);
+  CGFloat weightSum = 0.0;
+  for (NSUInteger tap = 0; tap < tapCount; tap++) {
+    weights[tap] = resamplingKernelWeight(kernel, tap + 1.0 - subpixelOffset - support, ratio);
+    weightSum += weights[tap];
+  }
+  for (NSUInteger tap = 0; tap < tapCount; tap++) {
+    weights[tap] = (weightSum != 0.0) ? weights[tap] / weightSum : 0.0;
+  }
+}
+
+// RGBA texels, tapCount wide and one row per phase. Shared by every filter using the same kernel and ratio
+static NSData *resamplingWeightTable(GPUImageResamplingKernel kernel, CGFloat ratio) {
+  static dispatch_once_t pred;
+  static NSCache *weightTableCache = nil;
+  dispatch_once(&pred, ^{
+    weightTableCache = [[NSCache alloc] init];
+  });
+
+  NSString *key = [NSString stringWithFormat:@"%lu:%.5f", (unsigned long)kernel, ratio];
+  NSData *cachedTable = [weightTableCache objectForKey:key];
+  if (cachedTable != nil) {
+    return cachedTable;
+  }
+
+  NSUInteger tapCount = GPUImageResamplingTapCount(kernel, ratio);
+  NSMutableData *table = [NSMutableData dataWithLength:tapCount * kGPUImageResamplingPhases * 4];
+  GLubyte *texel = [table mutableBytes];
+
+  CGFloat weights[kGPUImageResamplingMaximumTaps];
+  for (NSUInteger phase = 0; phase < kGPUImageResamplingPhases; phase++) {
+    GPUImageResamplingKernelWeights(kernel, ratio, (CGFloat)phase / kGPUImageResamplingPhases, weights);
+    for (NSUInteger tap = 0; tap < tapCount; tap++) {
+      NSUInteger encodedWeight = (NSUInteger)round(MIN(MAX((weights[tap] + 1.0) / 2.5, 0.0), 1.0) * 65535.0);
+      texel[0] = (GLubyte)(encodedWeight >> 8);
+      texel[1] = (GLubyte)(encodedWeight & 0xFF);
+      texel[2] = 0;
+      texel[3] = 255;
+      texel += 4;
+    }
+  }
+
+  [weightTableCache setObject:table forKey:key];
+  return table;
+}
+
+#pragma mark - Pass planning
+
+@interface GPUImageResamplingPass : NSObject
+
+@property (nonatomic, assign) BOOL vertical;
+@property (nonatomic, assign) GPUImageResamplingKernel kernel;
+@property (nonatomic, assign) CGFloat inputLength;
+@property (nonatomic, assign) CGFloat outputLength;
+@property (nonatomic, assign) CGSize outputSize;
+@property (nonatomic, assign) GLuint weightTexture;
+
+@end
+
+@implementation GPUImageResamplingPass
+
+- (CGFloat)ratio {
+  return self.inputLength / self.outputLength;
+}
+
+@end
+
+static void resamplingAddPass(NSMutableArray *passes, GPUImageResamplingKernel kernel, CGFloat *length, CGFloat outputLength) {
+  GPUImageResamplingPass *pass = [[GPUImageResamplingPass alloc] init];
+  pass.kernel = kernel;
+  pass.inputLength = *length;
+  pass.outputLength = outputLength;
+  [passes addObject:pass];
+  *length = outputLength;
+}
+
+static void resamplingAddAreaPasses(NSMutableArray *passes, CGFloat *length, CGFloat outputLength) {
+  CGFloat ratio = *length / outputLength;
+  NSUInteger steps = MAX((NSUInteger)ceil(log(ratio) / log(kGPUImageResamplingMaximumAreaRatio)), 1);
+  CGFloat inputLength = *length;
+  for (NSUInteger step = 1; step <= steps; step++) {
+    CGFloat stepLength = (step == steps) ? outputLength : round(inputLength / pow(ratio, (CGFloat)step / steps));
+    resamplingAddPass(passes, kGPUImageResamplingAreaKernel, length, stepLength);
+  }
+}
+
+static void resamplingAddPrefilteredLanczosPasses(NSMutableArray *passes, CGFloat *length, CGFloat outputLength) {
+  CGFloat ratio = *length / outputLength;
+  if (ratio > 2.0) {
+    // Box down to no more than twice the output size, where 3 Lanczos lobes still fit in the tap budget
+    CGFloat prefilteredLength = round(*length / ceil(ratio / 2.0));
+    if (prefilteredLength > outputLength) {
+      resamplingAddAreaPasses(passes, length, prefilteredLength);
+    }
+  }
+  resamplingAddPass(passes, kGPUImageResamplingLanczosKernel, length, outputLength);
+}
+
+static NSArray *resamplingPassesForAxis(GPUImageResamplingMode mode, CGFloat inputLength, CGFloat outputLength) {
+  NSMutableArray *passes = [NSMutableArray array];
+  CGFloat length = inputLength;
+  CGFloat ratio = inputLength / outputLength;
+
+  if (inputLength == outputLength) {
+    return passes;
+  }
+  if (ratio < 1.0) {
+    resamplingAddPass(passes, kGPUImageResamplingLanczosKernel, &length, outputLength);
+    return passes;
+  }
+
+  switch (mode) {
+    case kGPUImageResamplingAutomatic:
+      if (ratio <= 2.0) {
+        resamplingAddPass(passes, kGPUImageResamplingLanczosKernel, &length, outputLength);
+      } else if (fabs(ratio - round(ratio)) < 0.01) {
+        resamplingAddAreaPasses(passes, &length, outputLength);
+      } else {
+        resamplingAddPrefilteredLanczosPasses(passes, &length, outputLength);
+      }
+      break;
+    case kGPUImageResamplingBoxPrefilteredLanczos:
+      resamplingAddPrefilteredLanczosPasses(passes, &length, outputLength);
+      break;
+    case kGPUImageResamplingRepeatedHalving:
+      while (round(length / 2.0) >= outputLength) {
+        resamplingAddPass(passes, kGPUImageResamplingAreaKernel, &length, round(length / 2.0));
+      }
+      if (length != outputLength) {
+        resamplingAddPass(passes, kGPUImageResamplingAreaKernel, &length, outputLength);
+      }
+      break;
+    case kGPUImageResamplingAreaAverage:
+      resamplingAddAreaPasses(passes, &length, outputLength);
+      break;
+  }
+  return passes;
+}
+
+#pragma mark - Filter
+
+@interface GPUImageResamplingFilter()
+
+@property (nonatomic, strong) NSArray *passes;
+@property (nonatomic, assign) CGSize plannedSourceSize;
+@property (nonatomic, assign) CGSize plannedOutputSize;
+@property (nonatomic, assign) GPUImageResamplingMode plannedMode;
+
+@end
+
+@implementation GPUImageResamplingFilter
+
+#pragma mark - Initialization and teardown
+
+- (id)init {
+  NSString *fragmentShader = [NSString stringWithFormat:@"%@const int phases = %lu;\nconst int maximumTaps = %lu;\n%@", kGPUImageResamplingShaderPrecision, (unsigned long)kGPUImageResamplingPhases, (unsigned long)kGPUImageResamplingMaximumTaps, kGPUImageResamplingFragmentShaderString];
+  if (!(self = [super initWithFragmentShaderFromString:fragmentShader])) {
+    return nil;
+  }
+
+  passAxisUniform = [self.filterProgram uniformIndex:@"passAxis"];
+  tapStepUniform = [self.filterProgram uniformIndex:@"tapStep"];
+  ratioUniform = [self.filterProgram uniformIndex:@"ratio"];
+  supportUniform = [self.filterProgram uniformIndex:@"support"];
+  tapCountUniform = [self.filterProgram uniformIndex:@"tapCount"];
+  weightTableUniform = [self.filterProgram uniformIndex:@"weightTable"];
+  [self setInteger:3 forUniform:weightTableUniform program:self.filterProgram];
+
+  _resamplingMode = kGPUImageResamplingAutomatic;
+  self.passes = @[];
+
+  // Passes after the first read intermediate images that are already upright, whatever the input rotation
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [GPUImageContext useImageProcessingContext];
+    glGenBuffers(1, &passVertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, passVertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, 4 * sizeof(Vertex2D), verticesAndTextureCoordinatesForRotation(kGPUImageNoRotation), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  });
+
+  return self;
+}
+
+- (void)dealloc {
+  GLuint vertexBuffer = passVertexBuffer;
+  NSArray *passes = self.passes;
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [GPUImageContext useImageProcessingContext];
+    GLuint buffer = vertexBuffer;
+    glDeleteBuffers(1, &buffer);
+    for (GPUImageResamplingPass *pass in passes) {
+      GLuint weightTexture = pass.weightTexture;
+      glDeleteTextures(1, &weightTexture);
+    }
+  });
+}
+
+#pragma mark - Sizing
+
+- (void)setInputSize:(CGSize)value index:(NSUInteger)index {
+  if (index == 0) {
+    _sourceSize = GPUImageRotationSwapsWidthAndHeight([self getInputRotation:0]) ? CGSizeMake(value.height, value.width) : value;
+  }
+  [super setInputSize:value index:index];
+}
+
+- (void)setupFilterForSize:(CGSize)filterFrameSize {
+  [self updatePassesForSourceSize:self.sourceSize outputSize:filterFrameSize];
+}
+
+- (void)updatePassesForSourceSize:(CGSize)sourceSize outputSize:(CGSize)outputSize {
+  if ((sourceSize.width * sourceSize.height <= 0.0) || (outputSize.width * outputSize.height <= 0.0)) {
+    return;
+  }
+  if (CGSizeEqualToSize(sourceSize, self.plannedSourceSize) && CGSizeEqualToSize(outputSize, self.plannedOutputSize) && (self.resamplingMode == self.plannedMode)) {
+    return;
+  }
+  self.plannedSourceSize = sourceSize;
+  self.plannedOutputSize = outputSize;
+  self.plannedMode = self.resamplingMode;
+
+  NSMutableArray *passes = [NSMutableArray array];
+  for (GPUImageResamplingPass *pass in resamplingPassesForAxis(self.resamplingMode, sourceSize.width, outputSize.width)) {
+    pass.outputSize = CGSizeMake(pass.outputLength, sourceSize.height);
+    [passes addObject:pass];
+  }
+  for (GPUImageResamplingPass *pass in resamplingPassesForAxis(self.resamplingMode, sourceSize.height, outputSize.height)) {
+    pass.vertical = YES;
+    pass.outputSize = CGSizeMake(outputSize.width, pass.outputLength);
+    [passes addObject:pass];
+  }
+  if ([passes count] == 0) {
+    // Same size in and out, a single-tap area pass copies the input
+    CGFloat length = sourceSize.width;
+    resamplingAddPass(passes, kGPUImageResamplingAreaKernel, &length, outputSize.width);
+    [[passes lastObject] setOutputSize:outputSize];
+  }
+
+  NSArray *previousPasses = self.passes;
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [GPUImageContext useImageProcessingContext];
+    for (GPUImageResamplingPass *pass in previousPasses) {
+      GLuint weightTexture = pass.weightTexture;
+      glDeleteTextures(1, &weightTexture);
+    }
+
+    for (GPUImageResamplingPass *pass in passes) {
+      NSData *weightTable = resamplingWeightTable(pass.kernel, [pass ratio]);
+      GLuint weightTexture;
+      glGenTextures(1, &weightTexture);
+      glBindTexture(GL_TEXTURE_2D, weightTexture);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, (GLsizei)GPUImageResamplingTapCount(pass.kernel, [pass ratio]), (GLsizei)kGPUImageResamplingPhases, 0, GL_RGBA, GL_UNSIGNED_BYTE, [weightTable bytes]);
+      glBindTexture(GL_TEXTURE_2D, 0);
+      pass.weightTexture = weightTexture;
+    }
+  });
+  self.passes = passes;
+}
+
+- (NSUInteger)numberOfPasses {
+  return [self.passes count];
+}
+
+#pragma mark - Rendering
+
+- (void)render {
+  NSArray *passes = self.passes;
+  GPUImageFramebuffer *sourceFramebuffer = [self getInputFramebuffer:0];
+  GPUImageFramebuffer *intermediateFramebuffer = nil;
+  CGSize inputSize = self.sourceSize;
+
+  for (NSUInteger passIndex = 0; passIndex < [passes count]; passIndex++) {
+    GPUImageResamplingPass *pass = passes[passIndex];
+    GPUImageFramebuffer *targetFramebuffer = self.outputFramebuffer;
+    if (passIndex < [passes count] - 1) {
+      targetFramebuffer = [[GPUImageContext sharedFramebufferCache] fetchFramebufferForSize:pass.outputSize textureOptions:self.outputTextureOptions onlyTexture:NO];
+    }
+    [self activatePassFramebuffer:targetFramebuffer];
+
+    if (passIndex == 0) {
+      // The first pass samples the input through its rotation, so step along whichever texture axis the output axis maps to
+      Vertex2D *corners = verticesAndTextureCoordinatesForRotation([self getInputRotation:0]);
+      Vertex2D end = pass.vertical ? corners[2] : corners[1];
+      glUniform2f(tapStepUniform, (end.u - corners[0].u) / pass.inputLength, (end.v - corners[0].v) / pass.inputLength);
+    } else {
+      if (passIndex == 1) {
+        glBindBuffer(GL_ARRAY_BUFFER, passVertexBuffer);
+        glVertexAttribPointer(self.filterPositionAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), 0);
+        glVertexAttribPointer([self getInputTextureCoordinateAttribute:0], 2, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), (GLvoid*)(sizeof(GLfloat) * 2));
+      }
+      glUniform2f(tapStepUniform, pass.vertical ? 0.0 : 1.0 / inputSize.width, pass.vertical ? 1.0 / inputSize.height : 0.0);
+    }
+    glUniform2f(passAxisUniform, pass.vertical ? 0.0 : 1.0, pass.vertical ? 1.0 : 0.0);
+    glUniform1f(ratioUniform, [pass ratio]);
+    glUniform1f(supportUniform, GPUImageResamplingKernelSupport(pass.kernel, [pass ratio]));
+    glUniform1f(tapCountUniform, GPUImageResamplingTapCount(pass.kernel, [pass ratio]));
+
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_2D, pass.weightTexture);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, (passIndex == 0) ? [sourceFramebuffer texture] : [intermediateFramebuffer texture]);
+
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    [intermediateFramebuffer unlock];
+    intermediateFramebuffer = (targetFramebuffer == self.outputFramebuffer) ? nil : targetFramebuffer;
+    inputSize = pass.outputSize;
+  }
+}
+
+#pragma mark - Accessors
+
+- (void)setResamplingMode:(GPUImageResamplingMode)newValue {
+  _resamplingMode = newValue;
+  [self updatePassesForSourceSize:self.sourceSize outputSize:[self sizeOfFBO]];
+}
+
+@end
@@ -57,6 +57,8 @@ NSString *const kGPUImageSaturationFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     saturationUniform = [self.filterProgram uniformIndex:@"saturation"];
     self.saturation = 1.0;
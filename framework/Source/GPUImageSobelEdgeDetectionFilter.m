@@ -108,6 +108,7 @@ NSString *const kGPUImageSobelEdgeDetectionFragmentShaderString = SHADER_STRING
     }
     
     hasOverriddenImageSizeFactor = NO;
+    self.wantsMonochromeInput = YES;
     
     texelWidthUniform = [secondFilterProgram uniformIndex:@"texelWidth"];
     texelHeightUniform = [secondFilterProgram uniformIndex:@"texelHeight"];
@@ -47,6 +47,7 @@ NSString *const kGPUSolidColorFragmentShaderString = SHADER_STRING
     useExistingAlphaUniform = [self.filterProgram uniformIndex:@"useExistingAlpha"];
     
 	_color = (GPUVector4){0.0f, 0.0f, 0.5f, 1.0f};
+    [self setVec4:_color forUniform:colorUniform program:self.filterProgram];
     self.useExistingAlpha = NO;
     
     return self;
@@ -104,7 +105,7 @@ NSString *const kGPUSolidColorFragmentShaderString = SHADER_STRING
   _color.three = (GLfloat)blueComponent;
   _color.four = (GLfloat)alphaComponent;
 
-  //    [self setVec4:_color forUniform:colorUniform program:filterProgram];
+  [self setVec4:_color forUniform:colorUniform program:self.filterProgram];
   __weak typeof(self) weakSelf = self;
   runAsynchronouslyOnVideoProcessingQueue(^{
     __strong typeof(weakSelf) self = weakSelf;
@@ -117,6 +118,8 @@ NSString *const kGPUSolidColorFragmentShaderString = SHADER_STRING
 - (void)setUseExistingAlpha:(BOOL)useExistingAlpha;
 {
     _useExistingAlpha = useExistingAlpha;
+    // The alpha then comes from the input, which may change from frame to frame
+    self.hasStaticContent = !useExistingAlpha;
 
     [self setInteger:(useExistingAlpha ? 1 : 0) forUniform:useExistingAlphaUniform program:self.filterProgram];
 }
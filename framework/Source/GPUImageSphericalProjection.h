@@ -0,0 +1,35 @@
+#import "GPUImageSupport.h"
+
+/** Conversions between directions on the unit sphere and the image layouts of 360 degree content, shared by the reprojection filters
+
+ Directions use the OpenGL cube map convention for a viewer inside the sphere: +x to the right, +y up and +z straight ahead.
+ Equirectangular points are texture coordinates, 0.0 to 1.0 with 0.0, 0.0 in the upper left corner. x runs from longitude -180 to 180 degrees, so that straight ahead is in the middle, and y from latitude 90 degrees at the top to -90 degrees at the bottom.
+ Angles are in radians. None of these touch OpenGL, so mappings can be checked on the CPU at known angles.
+ */
+
+typedef NS_ENUM(NSUInteger, GPUImageCubeFace) {
+    kGPUImageCubeFacePositiveX,
+    kGPUImageCubeFaceNegativeX,
+    kGPUImageCubeFacePositiveY,
+    kGPUImageCubeFaceNegativeY,
+    kGPUImageCubeFacePositiveZ,
+    kGPUImageCubeFaceNegativeZ
+};
+
+// Faces of a cube atlas are laid out three across and two down, in GPUImageCubeFace order
+extern const NSUInteger kGPUImageCubeAtlasColumns;
+extern const NSUInteger kGPUImageCubeAtlasRows;
+
+GPUVector3 GPUImageSphericalDirectionForEquirectangularPoint(CGPoint point);
+CGPoint GPUImageEquirectangularPointForSphericalDirection(GPUVector3 direction);
+
+// Face points follow the OpenGL cube map orientation, texture coordinates within the face
+GPUVector3 GPUImageSphericalDirectionForCubeFacePoint(GPUImageCubeFace face, CGPoint point);
+CGPoint GPUImageCubeFacePointForSphericalDirection(GPUVector3 direction, GPUImageCubeFace *face);
+
+// The region of a face in a cube atlas, in texture coordinates
+CGRect GPUImageCubeAtlasRectForFace(GPUImageCubeFace face);
+
+// Turns the view right by yaw, then up by pitch, then clockwise by roll
+GPUMatrix3x3 GPUImageSphericalRotation(CGFloat yaw, CGFloat pitch, CGFloat roll);
+GPUVector3 GPUImageRotateSphericalDirection(GPUMatrix3x3 rotation, GPUVector3 direction);
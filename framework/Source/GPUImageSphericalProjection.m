@@ -0,0 +1,96 @@
+#import "GPUImageSphericalProjection.h"
+
+const NSUInteger kGPUImageCubeAtlasColumns = 3;
+const NSUInteger kGPUImageCubeAtlasRows = 2;
+
+GPUVector3 GPUImageSphericalDirectionForEquirectangularPoint(CGPoint point) {
+    CGFloat longitude = (point.x - 0.5) * 2.0 * M_PI;
+    CGFloat latitude = (0.5 - point.y) * M_PI;
+
+    GPUVector3 direction;
+    direction.one = cos(latitude) * sin(longitude);
+    direction.two = sin(latitude);
+    direction.three = cos(latitude) * cos(longitude);
+    return direction;
+}
+
+CGPoint GPUImageEquirectangularPointForSphericalDirection(GPUVector3 direction) {
+    CGFloat horizontalLength = sqrt(direction.one * direction.one + direction.three * direction.three);
+    CGFloat longitude = atan2(direction.one, direction.three);
+    CGFloat latitude = atan2(direction.two, horizontalLength);
+
+    return CGPointMake(longitude / (2.0 * M_PI) + 0.5, 0.5 - latitude / M_PI);
+}
+
+GPUVector3 GPUImageSphericalDirectionForCubeFacePoint(GPUImageCubeFace face, CGPoint point) {
+    GLfloat s = 2.0 * point.x - 1.0;
+    GLfloat t = 2.0 * point.y - 1.0;
+
+    GPUVector3 direction;
+    switch (face) {
+        case kGPUImageCubeFacePositiveX: direction = (GPUVector3){ 1.0, -t, -s}; break;
+        case kGPUImageCubeFaceNegativeX: direction = (GPUVector3){-1.0, -t,  s}; break;
+        case kGPUImageCubeFacePositiveY: direction = (GPUVector3){ s,  1.0,  t}; break;
+        case kGPUImageCubeFaceNegativeY: direction = (GPUVector3){ s, -1.0, -t}; break;
+        case kGPUImageCubeFacePositiveZ: direction = (GPUVector3){ s, -t,  1.0}; break;
+        case kGPUImageCubeFaceNegativeZ: direction = (GPUVector3){-s, -t, -1.0}; break;
+    }
+
+    GLfloat length = sqrt(direction.one * direction.one + direction.two * direction.two + direction.three * direction.three);
+    direction.one /= length;
+    direction.two /= length;
+    direction.three /= length;
+    return direction;
+}
+
+CGPoint GPUImageCubeFacePointForSphericalDirection(GPUVector3 direction, GPUImageCubeFace *face) {
+    GLfloat absoluteX = fabs(direction.one), absoluteY = fabs(direction.two), absoluteZ = fabs(direction.three);
+    GLfloat s, t, majorAxis;
+
+    // Major axis selection from the OpenGL cube map specification
+    if (absoluteX >= absoluteY && absoluteX >= absoluteZ) {
+        majorAxis = absoluteX;
+        *face = (direction.one >= 0.0) ? kGPUImageCubeFacePositiveX : kGPUImageCubeFaceNegativeX;
+        s = (direction.one >= 0.0) ? -direction.three : direction.three;
+        t = -direction.two;
+    } else if (absoluteY >= absoluteZ) {
+        majorAxis = absoluteY;
+        *face = (direction.two >= 0.0) ? kGPUImageCubeFacePositiveY : kGPUImageCubeFaceNegativeY;
+        s = direction.one;
+        t = (direction.two >= 0.0) ? direction.three : -direction.three;
+    } else {
+        majorAxis = absoluteZ;
+        *face = (direction.three >= 0.0) ? kGPUImageCubeFacePositiveZ : kGPUImageCubeFaceNegativeZ;
+        s = (direction.three >= 0.0) ? direction.one : -direction.one;
+        t = -direction.two;
+    }
+
+    return CGPointMake((s / majorAxis + 1.0) * 0.5, (t / majorAxis + 1.0) * 0.5);
+}
+
+CGRect GPUImageCubeAtlasRectForFace(GPUImageCubeFace face) {
+    CGFloat width = 1.0 / kGPUImageCubeAtlasColumns;
+    CGFloat height = 1.0 / kGPUImageCubeAtlasRows;
+    return CGRectMake((face % kGPUImageCubeAtlasColumns) * width, (face / kGPUImageCubeAtlasColumns) * height, width, height);
+}
+
+GPUMatrix3x3 GPUImageSphericalRotation(CGFloat yaw, CGFloat pitch, CGFloat roll) {
+    GLfloat cy = cos(yaw), sy = sin(yaw);
+    GLfloat cp = cos(pitch), sp = sin(pitch);
+    GLfloat cr = cos(roll), sr = sin(roll);
+
+    // Yaw about y, pitch about x, roll about z, applied to view directions roll first
+    GPUMatrix3x3 rotation;
+    rotation.one = (GPUVector3){cy * cr + sy * sp * sr, cy * sr - sy * sp * cr, sy * cp};
+    rotation.two = (GPUVector3){-cp * sr, cp * cr, sp};
+    rotation.three = (GPUVector3){-sy * cr + cy * sp * sr, -sy * sr - cy * sp * cr, cy * cp};
+    return rotation;
+}
+
+GPUVector3 GPUImageRotateSphericalDirection(GPUMatrix3x3 rotation, GPUVector3 direction) {
+    GPUVector3 rotated;
+    rotated.one = rotation.one.one * direction.one + rotation.one.two * direction.two + rotation.one.three * direction.three;
+    rotated.two = rotation.two.one * direction.one + rotation.two.two * direction.two + rotation.two.three * direction.three;
+    rotated.three = rotation.three.one * direction.one + rotation.three.two * direction.two + rotation.three.three * direction.three;
+    return rotated;
+}
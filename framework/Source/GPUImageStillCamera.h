@@ -1,6 +1,5 @@
 #import "GPUImageVideoCamera.h"
 
-void stillImageDataReleaseCallback(void *releaseRefCon, const void *baseAddress);
 void GPUImageCreateResizedSampleBuffer(CVPixelBufferRef cameraFrame, CGSize finalSize, CMSampleBufferRef *sampleBuffer);
 
 @interface GPUImageStillCamera : GPUImageVideoCamera
@@ -9,6 +8,14 @@ void GPUImageCreateResizedSampleBuffer(CVPixelBufferRef cameraFrame, CGSize fina
  */
 @property GLfloat jpegCompressionQuality;
 
+/** Time the last photo too large for a texture took to be resized on the CPU before upload, in seconds. 0 for photos that fit
+ */
+@property (readonly) CFTimeInterval lastPhotoResizeDuration;
+
+/** Time from requesting the last JPEG capture until its data was encoded, in seconds, set before the completion handler is called
+ */
+@property (readonly) CFTimeInterval lastCaptureToJPEGDuration;
+
 // Only reliably set inside the context of the completion handler of one of the capture methods
 @property (readonly) NSDictionary *currentCaptureMetadata;
 
@@ -1,35 +1,102 @@
 // 2448x3264 pixel image = 31,961,088 bytes for uncompressed RGBA
 
 #import "GPUImageStillCamera.h"
+#import <QuartzCore/QuartzCore.h>
 
-void stillImageDataReleaseCallback(void *releaseRefCon, const void *baseAddress)
+// Area average of every source pixel under each destination pixel, for downscaling only. Bands of destination rows are resampled in parallel, and each band first sums its source rows into one row of column totals in a plain loop the compiler vectorizes
+static void GPUImageDownsamplePlane(const GLubyte *sourceBytes, size_t sourceWidth, size_t sourceHeight, size_t sourceBytesPerRow, GLubyte *destinationBytes, size_t destinationWidth, size_t destinationHeight, size_t destinationBytesPerRow, size_t bytesPerPixel)
 {
-    free((void *)baseAddress);
+    size_t bandCount = MIN(destinationHeight, (size_t)32);
+    size_t sourceBytesPerLine = sourceWidth * bytesPerPixel;
+
+    dispatch_apply(bandCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^(size_t band) {
+        size_t firstRow = band * destinationHeight / bandCount;
+        size_t lastRow = (band + 1) * destinationHeight / bandCount;
+        uint32_t *columnTotals = (uint32_t *)malloc(sourceBytesPerLine * sizeof(uint32_t));
+
+        for (size_t destinationRow = firstRow; destinationRow < lastRow; destinationRow++)
+        {
+            size_t sourceRowStart = destinationRow * sourceHeight / destinationHeight;
+            size_t sourceRowEnd = MAX((destinationRow + 1) * sourceHeight / destinationHeight, sourceRowStart + 1);
+
+            memset(columnTotals, 0, sourceBytesPerLine * sizeof(uint32_t));
+            for (size_t sourceRow = sourceRowStart; sourceRow < sourceRowEnd; sourceRow++)
+            {
+                const GLubyte *sourceLine = sourceBytes + sourceRow * sourceBytesPerRow;
+                for (size_t byteIndex = 0; byteIndex < sourceBytesPerLine; byteIndex++)
+                {
+                    columnTotals[byteIndex] += sourceLine[byteIndex];
+                }
+            }
+
+            GLubyte *destinationPixel = destinationBytes + destinationRow * destinationBytesPerRow;
+            for (size_t destinationColumn = 0; destinationColumn < destinationWidth; destinationColumn++)
+            {
+                size_t sourceColumnStart = destinationColumn * sourceWidth / destinationWidth;
+                size_t sourceColumnEnd = MAX((destinationColumn + 1) * sourceWidth / destinationWidth, sourceColumnStart + 1);
+                uint32_t sampleCount = (uint32_t)((sourceColumnEnd - sourceColumnStart) * (sourceRowEnd - sourceRowStart));
+
+                for (size_t channel = 0; channel < bytesPerPixel; channel++)
+                {
+                    uint32_t total = 0;
+                    for (size_t sourceColumn = sourceColumnStart; sourceColumn < sourceColumnEnd; sourceColumn++)
+                    {
+                        total += columnTotals[sourceColumn * bytesPerPixel + channel];
+                    }
+                    destinationPixel[channel] = (GLubyte)((total + sampleCount / 2) / sampleCount);
+                }
+                destinationPixel += bytesPerPixel;
+            }
+        }
+
+        free(columnTotals);
+    });
 }
 
 void GPUImageCreateResizedSampleBuffer(CVPixelBufferRef cameraFrame, CGSize finalSize, CMSampleBufferRef *sampleBuffer)
 {
-    // CVPixelBufferCreateWithPlanarBytes for YUV input
-    
-    CGSize originalSize = CGSizeMake(CVPixelBufferGetWidth(cameraFrame), CVPixelBufferGetHeight(cameraFrame));
+    // Resample straight into a buffer of the camera's own pixel format, plane by plane, so YUV photos never go through BGRA. The result is IOSurface backed, so the camera uploads it through the texture cache without another copy
+    OSType pixelFormat = CVPixelBufferGetPixelFormatType(cameraFrame);
+    BOOL isBiPlanarYUV = (pixelFormat == kCVPixelFormatType_420YpCbCr8BiPlanarFullRange) || (pixelFormat == kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange);
+    NSCAssert(isBiPlanarYUV || (pixelFormat == kCVPixelFormatType_32BGRA), @"Error: photos can only be resized from BGRA or bi-planar 4:2:0 YUV");
+
+    size_t finalWidth = (size_t)finalSize.width;
+    size_t finalHeight = (size_t)finalSize.height;
+    if (isBiPlanarYUV)
+    {
+        // Keep the chroma plane exactly half the size of the luminance plane, as the camera's chrominance upload assumes
+        finalWidth &= ~(size_t)1;
+        finalHeight &= ~(size_t)1;
+    }
 
-    CVPixelBufferLockBaseAddress(cameraFrame, 0);
-    GLubyte *sourceImageBytes =  CVPixelBufferGetBaseAddress(cameraFrame);
-    CGDataProviderRef dataProvider = CGDataProviderCreateWithData(NULL, sourceImageBytes, CVPixelBufferGetBytesPerRow(cameraFrame) * originalSize.height, NULL);
-    CGColorSpaceRef genericRGBColorspace = CGColorSpaceCreateDeviceRGB();
-    CGImageRef cgImageFromBytes = CGImageCreate((int)originalSize.width, (int)originalSize.height, 8, 32, CVPixelBufferGetBytesPerRow(cameraFrame), genericRGBColorspace, kCGBitmapByteOrder32Little | kCGImageAlphaPremultipliedFirst, dataProvider, NULL, NO, kCGRenderingIntentDefault);
-    
-    GLubyte *imageData = (GLubyte *) calloc(1, (int)finalSize.width * (int)finalSize.height * 4);
-    
-    CGContextRef imageContext = CGBitmapContextCreate(imageData, (int)finalSize.width, (int)finalSize.height, 8, (int)finalSize.width * 4, genericRGBColorspace,  kCGBitmapByteOrder32Little | kCGImageAlphaPremultipliedFirst);
-    CGContextDrawImage(imageContext, CGRectMake(0.0, 0.0, finalSize.width, finalSize.height), cgImageFromBytes);
-    CGImageRelease(cgImageFromBytes);
-    CGContextRelease(imageContext);
-    CGColorSpaceRelease(genericRGBColorspace);
-    CGDataProviderRelease(dataProvider);
-    
+    NSDictionary *pixelBufferAttributes = [NSDictionary dictionaryWithObject:[NSDictionary dictionary] forKey:(id)kCVPixelBufferIOSurfacePropertiesKey];
     CVPixelBufferRef pixel_buffer = NULL;
-    CVPixelBufferCreateWithBytes(kCFAllocatorDefault, finalSize.width, finalSize.height, kCVPixelFormatType_32BGRA, imageData, finalSize.width * 4, stillImageDataReleaseCallback, NULL, NULL, &pixel_buffer);
+    CVReturn err = CVPixelBufferCreate(kCFAllocatorDefault, finalWidth, finalHeight, pixelFormat, (__bridge CFDictionaryRef)pixelBufferAttributes, &pixel_buffer);
+    if (err != kCVReturnSuccess)
+    {
+        NSLog(@"Error at CVPixelBufferCreate %d", err);
+        *sampleBuffer = NULL;
+        return;
+    }
+    // Carries over the YCbCr matrix the camera picks its color conversion by
+    CVBufferPropagateAttachments(cameraFrame, pixel_buffer);
+
+    CVPixelBufferLockBaseAddress(cameraFrame, kCVPixelBufferLock_ReadOnly);
+    CVPixelBufferLockBaseAddress(pixel_buffer, 0);
+    if (isBiPlanarYUV)
+    {
+        for (size_t plane = 0; plane < 2; plane++)
+        {
+            GPUImageDownsamplePlane(CVPixelBufferGetBaseAddressOfPlane(cameraFrame, plane), CVPixelBufferGetWidthOfPlane(cameraFrame, plane), CVPixelBufferGetHeightOfPlane(cameraFrame, plane), CVPixelBufferGetBytesPerRowOfPlane(cameraFrame, plane), CVPixelBufferGetBaseAddressOfPlane(pixel_buffer, plane), CVPixelBufferGetWidthOfPlane(pixel_buffer, plane), CVPixelBufferGetHeightOfPlane(pixel_buffer, plane), CVPixelBufferGetBytesPerRowOfPlane(pixel_buffer, plane), (plane == 0) ? 1 : 2);
+        }
+    }
+    else
+    {
+        GPUImageDownsamplePlane(CVPixelBufferGetBaseAddress(cameraFrame), CVPixelBufferGetWidth(cameraFrame), CVPixelBufferGetHeight(cameraFrame), CVPixelBufferGetBytesPerRow(cameraFrame), CVPixelBufferGetBaseAddress(pixel_buffer), finalWidth, finalHeight, CVPixelBufferGetBytesPerRow(pixel_buffer), 4);
+    }
+    CVPixelBufferUnlockBaseAddress(pixel_buffer, 0);
+    CVPixelBufferUnlockBaseAddress(cameraFrame, kCVPixelBufferLock_ReadOnly);
+
     CMVideoFormatDescriptionRef videoInfo = NULL;
     CMVideoFormatDescriptionCreateForImageBuffer(NULL, pixel_buffer, &videoInfo);
     
@@ -37,7 +104,6 @@ void GPUImageCreateResizedSampleBuffer(CVPixelBufferRef cameraFrame, CGSize fina
     CMSampleTimingInfo timing = {frameTime, frameTime, kCMTimeInvalid};
     
     CMSampleBufferCreateForImageBuffer(kCFAllocatorDefault, pixel_buffer, YES, NULL, NULL, videoInfo, &timing, sampleBuffer);
-    CVPixelBufferUnlockBaseAddress(cameraFrame, 0);
     CFRelease(videoInfo);
     CVPixelBufferRelease(pixel_buffer);
 }
@@ -54,10 +120,13 @@ void GPUImageCreateResizedSampleBuffer(CVPixelBufferRef cameraFrame, CGSize fina
 
 @implementation GPUImageStillCamera {
     BOOL requiresFrontCameraTextureCacheCorruptionWorkaround;
+    CFTimeInterval captureRequestTime;
 }
 
 @synthesize currentCaptureMetadata = _currentCaptureMetadata;
 @synthesize jpegCompressionQuality = _jpegCompressionQuality;
+@synthesize lastPhotoResizeDuration = _lastPhotoResizeDuration;
+@synthesize lastCaptureToJPEGDuration = _lastCaptureToJPEGDuration;
 
 #pragma mark -
 #pragma mark Initialization and teardown
@@ -194,6 +263,7 @@ void GPUImageCreateResizedSampleBuffer(CVPixelBufferRef cameraFrame, CGSize fina
 
                 dataForJPEGFile = UIImageJPEGRepresentation(filteredPhoto,self.jpegCompressionQuality);
 //                reportAvailableMemoryForGPUImage(@"After JPEG generation");
+                _lastCaptureToJPEGDuration = CACurrentMediaTime() - captureRequestTime;
             }
 
 //            reportAvailableMemoryForGPUImage(@"After autorelease pool");
@@ -215,6 +285,7 @@ void GPUImageCreateResizedSampleBuffer(CVPixelBufferRef cameraFrame, CGSize fina
                 dispatch_semaphore_signal(self.frameRenderingSemaphore);
                 
                 dataForJPEGFile = UIImageJPEGRepresentation(filteredPhoto, self.jpegCompressionQuality);
+                _lastCaptureToJPEGDuration = CACurrentMediaTime() - captureRequestTime;
             }
         } else {
             dispatch_semaphore_signal(self.frameRenderingSemaphore);
@@ -278,6 +349,7 @@ void GPUImageCreateResizedSampleBuffer(CVPixelBufferRef cameraFrame, CGSize fina
         return;
     }
 
+    captureRequestTime = CACurrentMediaTime();
     [photoOutput captureStillImageAsynchronouslyFromConnection:[[photoOutput connections] objectAtIndex:0] completionHandler:^(CMSampleBufferRef imageSampleBuffer, NSError *error) {
         if (imageSampleBuffer == NULL) {
             block(error);
@@ -292,10 +364,12 @@ void GPUImageCreateResizedSampleBuffer(CVPixelBufferRef cameraFrame, CGSize fina
         if (!CGSizeEqualToSize(sizeOfPhoto, scaledImageSizeToFitOnGPU)) {
             CMSampleBufferRef sampleBuffer = NULL;
             
-            if (CVPixelBufferGetPlaneCount(cameraFrame) > 0) {
-                NSAssert(NO, @"Error: no downsampling for YUV input in the framework yet");
-            } else {
-                GPUImageCreateResizedSampleBuffer(cameraFrame, scaledImageSizeToFitOnGPU, &sampleBuffer);
+            CFTimeInterval resizeStartTime = CACurrentMediaTime();
+            GPUImageCreateResizedSampleBuffer(cameraFrame, scaledImageSizeToFitOnGPU, &sampleBuffer);
+            _lastPhotoResizeDuration = CACurrentMediaTime() - resizeStartTime;
+            if (sampleBuffer == NULL) {
+                block([NSError errorWithDomain:AVFoundationErrorDomain code:AVErrorOutOfMemory userInfo:nil]);
+                return;
             }
 
             dispatch_semaphore_signal(self.frameRenderingSemaphore);
@@ -305,6 +379,8 @@ void GPUImageCreateResizedSampleBuffer(CVPixelBufferRef cameraFrame, CGSize fina
             if (sampleBuffer != NULL)
                 CFRelease(sampleBuffer);
         } else {
+            _lastPhotoResizeDuration = 0.0;
+
             // This is a workaround for the corrupt images that are sometimes returned when taking a photo with the front camera and using the iOS 5.0 texture caches
             AVCaptureDevicePosition currentCameraPosition = [[self.videoInput device] position];
             if ( (currentCameraPosition != AVCaptureDevicePositionFront) || (![GPUImageContext supportsFastTextureUpload]) || !requiresFrontCameraTextureCacheCorruptionWorkaround) {
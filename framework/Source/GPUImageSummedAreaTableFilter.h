@@ -0,0 +1,28 @@
+#import "GPUImageFilter.h"
+
+/** GLSL helpers for reading a summed-area table bound to inputImageTexture2, prepend them to a fragment shader of a GPUImageTwoInputFilter.
+ They declare inputImageTexture2 and the summedAreaTableSize uniform (the table size in pixels), and provide:
+
+ vec4 summedAreaTableSum(vec2 lowerPixel, vec2 upperPixel): the table contents summed over the inclusive pixel rectangle, clamped to the image
+ float summedAreaTableCount(vec2 lowerPixel, vec2 upperPixel): the number of image pixels in that rectangle
+ vec4 summedAreaTableMoments(vec2 lowerPixel, vec2 upperPixel): the mean color in rgb and the summed per-channel variance in a
+ */
+extern NSString *const kGPUImageSummedAreaTableFunctionsString;
+
+/** Computes the summed-area table (integral image) of its input
+
+ Each output texel holds the sum of every input pixel above and to the left of it, inclusive, so that the sum over any rectangle can be read back with four texture fetches regardless of its size.
+ The rgb channels accumulate the color offset by -0.5 and the alpha channel accumulates the squared length of that offset, which is enough for box means and variances. Centering the values keeps the running sums small and preserves precision.
+
+ The table is built with a parallel prefix scan, log4(width) horizontal and log4(height) vertical passes of four taps each, rendered into 32-bit float framebuffers. Float render targets are required, check +isSupported before relying on the output.
+ */
+@interface GPUImageSummedAreaTableFilter : GPUImageFilter
+{
+    GLint scanStepUniform;
+    GLuint scanVertexBuffer;
+}
+
+/// Whether the current device can render the table at the precision it needs
++ (BOOL)isSupported;
+
+@end
@@ -0,0 +1,182 @@
+#import "GPUImageSummedAreaTableFilter.h"
+
+// Taps per scan pass, each pass widens the summed span by this factor
+static const NSUInteger kGPUImageSummedAreaTableScanRadix = 4;
+
+#if TARGET_IPHONE_SIMULATOR || TARGET_OS_IPHONE
+#define GPUImageSummedAreaTablePrecision @"precision highp float;\n"
+#else
+#define GPUImageSummedAreaTablePrecision @""
+#endif
+
+NSString *const kGPUImageSummedAreaTableFunctionsString = GPUImageSummedAreaTablePrecision SHADER_STRING
+(
+ uniform sampler2D inputImageTexture2;
+ uniform vec2 summedAreaTableSize;
+
+ vec4 summedAreaTableFetch(vec2 pixel)
+ {
+     // Texels before the first row or column hold an empty sum
+     vec2 inside = step(vec2(0.0), pixel);
+     return texture2D(inputImageTexture2, (pixel + 0.5) / summedAreaTableSize) * inside.x * inside.y;
+ }
+
+ vec4 summedAreaTableSum(vec2 lowerPixel, vec2 upperPixel)
+ {
+     vec2 lower = clamp(lowerPixel, vec2(0.0), summedAreaTableSize - 1.0) - 1.0;
+     vec2 upper = clamp(upperPixel, vec2(0.0), summedAreaTableSize - 1.0);
+     return summedAreaTableFetch(upper) - summedAreaTableFetch(vec2(lower.x, upper.y)) - summedAreaTableFetch(vec2(upper.x, lower.y)) + summedAreaTableFetch(lower);
+ }
+
+ float summedAreaTableCount(vec2 lowerPixel, vec2 upperPixel)
+ {
+     vec2 extent = clamp(upperPixel, vec2(0.0), summedAreaTableSize - 1.0) - clamp(lowerPixel, vec2(0.0), summedAreaTableSize - 1.0) + 1.0;
+     return extent.x * extent.y;
+ }
+
+ vec4 summedAreaTableMoments(vec2 lowerPixel, vec2 upperPixel)
+ {
+     vec4 average = summedAreaTableSum(lowerPixel, upperPixel) / summedAreaTableCount(lowerPixel, upperPixel);
+     return vec4(average.rgb + 0.5, max(average.a - dot(average.rgb, average.rgb), 0.0));
+ }
+);
+
+// A zero scanStep converts the input into centered moments, any other value adds the scanRadix - 1 texels preceding the current one, scanStep pixels apart
+NSString *const kGPUImageSummedAreaTableScanFragmentShaderString = SHADER_STRING
+(
+ varying vec2 textureCoordinate;
+
+ uniform sampler2D inputImageTexture;
+ uniform vec2 scanStep;
+ uniform vec2 tableSize;
+
+ void main()
+ {
+     if (scanStep.x + scanStep.y == 0.0)
+     {
+         vec3 centeredColor = texture2D(inputImageTexture, textureCoordinate).rgb - 0.5;
+         gl_FragColor = vec4(centeredColor, dot(centeredColor, centeredColor));
+     }
+     else
+     {
+         vec2 pixel = floor(textureCoordinate * tableSize);
+         vec4 sum = texture2D(inputImageTexture, textureCoordinate);
+         for (int tap = 1; tap < scanRadix; tap++)
+         {
+             vec2 tapPixel = pixel - float(tap) * scanStep;
+             // Taps before the start of the row or column contribute nothing
+             vec2 inside = step(vec2(0.0), tapPixel);
+             sum += texture2D(inputImageTexture, (tapPixel + 0.5) / tableSize) * inside.x * inside.y;
+         }
+         gl_FragColor = sum;
+     }
+ }
+);
+
+static NSUInteger summedAreaTableScanPasses(CGFloat length) {
+  NSUInteger passes = 0;
+  for (CGFloat span = 1.0; span < length; span *= kGPUImageSummedAreaTableScanRadix) {
+    passes++;
+  }
+  return passes;
+}
+
+@implementation GPUImageSummedAreaTableFilter
+
+#pragma mark - Initialization and teardown
+
++ (BOOL)isSupported {
+  return [GPUImageContext deviceSupportsFloatRenderTargets];
+}
+
+- (id)init {
+  NSString *fragmentShader = [NSString stringWithFormat:@"%@const int scanRadix = %lu;\n%@", GPUImageSummedAreaTablePrecision, (unsigned long)kGPUImageSummedAreaTableScanRadix, kGPUImageSummedAreaTableScanFragmentShaderString];
+  if (!(self = [super initWithFragmentShaderFromString:fragmentShader])) {
+    return nil;
+  }
+
+  scanStepUniform = [self.filterProgram uniformIndex:@"scanStep"];
+
+  // Running sums need the full float range, and float textures aren't filterable everywhere
+  GPUTextureOptions tableTextureOptions = self.outputTextureOptions;
+  tableTextureOptions.minFilter = GL_NEAREST;
+  tableTextureOptions.magFilter = GL_NEAREST;
+  tableTextureOptions.internalFormat = GL_RGBA;
+  tableTextureOptions.format = GL_RGBA;
+  tableTextureOptions.type = GL_FLOAT;
+  self.outputTextureOptions = tableTextureOptions;
+
+  // The scan passes read intermediate tables that are already upright, whatever the input rotation
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [GPUImageContext useImageProcessingContext];
+    glGenBuffers(1, &scanVertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, scanVertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, 4 * sizeof(Vertex2D), verticesAndTextureCoordinatesForRotation(kGPUImageNoRotation), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  });
+
+  return self;
+}
+
+- (void)dealloc {
+  GLuint vertexBuffer = scanVertexBuffer;
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [GPUImageContext useImageProcessingContext];
+    GLuint buffer = vertexBuffer;
+    glDeleteBuffers(1, &buffer);
+  });
+}
+
+- (void)setupFilterForSize:(CGSize)filterFrameSize {
+  [self setSize:filterFrameSize forUniformName:@"tableSize"];
+}
+
+#pragma mark - Rendering
+
+- (void)render {
+  CGSize tableSize = [self sizeOfFBO];
+  NSUInteger horizontalPasses = summedAreaTableScanPasses(tableSize.width);
+  NSUInteger verticalPasses = summedAreaTableScanPasses(tableSize.height);
+  NSUInteger passes = 1 + horizontalPasses + verticalPasses;
+
+  GPUImageFramebuffer *sourceFramebuffer = [self getInputFramebuffer:0];
+  GPUImageFramebuffer *intermediateFramebuffer = nil;
+  GLfloat scanStep = 1.0;
+
+  for (NSUInteger pass = 0; pass < passes; pass++) {
+    GPUImageFramebuffer *targetFramebuffer = self.outputFramebuffer;
+    if (pass < passes - 1) {
+      targetFramebuffer = [[GPUImageContext sharedFramebufferCache] fetchFramebufferForSize:tableSize textureOptions:self.outputTextureOptions onlyTexture:NO];
+    }
+    [self activatePassFramebuffer:targetFramebuffer];
+
+    glActiveTexture(GL_TEXTURE2);
+    if (pass == 0) {
+      // Moments pass, drawn with the rotated input vertices bound by preRender
+      glUniform2f(scanStepUniform, 0.0, 0.0);
+      glBindTexture(GL_TEXTURE_2D, [sourceFramebuffer texture]);
+    } else {
+      if (pass == 1) {
+        glBindBuffer(GL_ARRAY_BUFFER, scanVertexBuffer);
+        glVertexAttribPointer(self.filterPositionAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), 0);
+        glVertexAttribPointer([self getInputTextureCoordinateAttribute:0], 2, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), (GLvoid*)(sizeof(GLfloat) * 2));
+      }
+      if (pass == horizontalPasses + 1) {
+        scanStep = 1.0;
+      }
+      if (pass <= horizontalPasses) {
+        glUniform2f(scanStepUniform, scanStep, 0.0);
+      } else {
+        glUniform2f(scanStepUniform, 0.0, scanStep);
+      }
+      scanStep *= kGPUImageSummedAreaTableScanRadix;
+      glBindTexture(GL_TEXTURE_2D, [intermediateFramebuffer texture]);
+    }
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    [intermediateFramebuffer unlock];
+    intermediateFramebuffer = (targetFramebuffer == self.outputFramebuffer) ? nil : targetFramebuffer;
+  }
+}
+
+@end
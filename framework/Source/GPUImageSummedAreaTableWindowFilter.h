@@ -0,0 +1,19 @@
+#import "GPUImageFilterGroup.h"
+
+/** Base class for filters that gather statistics over square windows through a summed-area table, at the same cost for any radius
+
+ The input is turned into a GPUImageSummedAreaTableFilter table and then handed, together with the original image, to a two-input fragment shader.
+ The shader is given the kGPUImageSummedAreaTableFunctionsString helpers, the original image as inputImageTexture at textureCoordinate, the table's coordinate as textureCoordinate2 and the window radius in pixels as the float uniform radius.
+ */
+@interface GPUImageSummedAreaTableWindowFilter : GPUImageFilterGroup
+
+/** The window radius in pixels, the window covers (2 * radius + 1)^2 pixels. Default of 4
+ */
+@property (nonatomic, assign) NSUInteger radius;
+
+/** Initialize with the fragment shader that reads the table
+ @param fragmentShaderString Source code of the fragment shader, without the summed-area table helpers
+ */
+- (id)initWithFragmentShaderFromString:(NSString *)fragmentShaderString;
+
+@end
@@ -0,0 +1,53 @@
+#import "GPUImageSummedAreaTableWindowFilter.h"
+#import "GPUImageSummedAreaTableFilter.h"
+#import "GPUImageTwoInputFilter.h"
+
+@interface GPUImageSummedAreaTableLookupFilter : GPUImageTwoInputFilter
+
+@end
+
+@implementation GPUImageSummedAreaTableLookupFilter
+
+- (void)setupFilterForSize:(CGSize)filterFrameSize {
+  [self setSize:filterFrameSize forUniformName:@"summedAreaTableSize"];
+}
+
+@end
+
+@interface GPUImageSummedAreaTableWindowFilter()
+
+@property (nonatomic, strong) GPUImageSummedAreaTableFilter *summedAreaTableFilter;
+@property (nonatomic, strong) GPUImageSummedAreaTableLookupFilter *lookupFilter;
+
+@end
+
+@implementation GPUImageSummedAreaTableWindowFilter
+
+#pragma mark - Initialization and teardown
+
+- (id)initWithFragmentShaderFromString:(NSString *)fragmentShaderString {
+  if ((self = [super init])) {
+    self.summedAreaTableFilter = [[GPUImageSummedAreaTableFilter alloc] init];
+    self.lookupFilter = [[GPUImageSummedAreaTableLookupFilter alloc] initWithFragmentShaderFromString:[kGPUImageSummedAreaTableFunctionsString stringByAppendingString:fragmentShaderString]];
+
+    [self addFilter:self.summedAreaTableFilter];
+    [self addFilter:self.lookupFilter];
+
+    [self.summedAreaTableFilter addTarget:self.lookupFilter atTextureLocation:1];
+
+    self.initialFilters = @[self.summedAreaTableFilter, self.lookupFilter];
+    self.terminalFilter = self.lookupFilter;
+
+    self.radius = 4;
+  }
+  return self;
+}
+
+#pragma mark - Accessors
+
+- (void)setRadius:(NSUInteger)newValue {
+  _radius = newValue;
+  [self.lookupFilter setFloat:(GLfloat)_radius forUniformName:@"radius"];
+}
+
+@end
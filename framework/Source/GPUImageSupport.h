@@ -73,3 +73,14 @@ void bufferVerticesAndTextureCoordinatesForMultipleRotations(NSArray *rotations)
 
 CGSize rotatedSize(CGSize sizeToRotate, GPUImageRotationMode rotation);
 CGPoint rotatedPoint(CGPoint pointToRotate, GPUImageRotationMode rotation);
+// Bounding box of the rotated corners
+CGRect rotatedRect(CGRect rectToRotate, GPUImageRotationMode rotation);
+
+// Regions of interest are normalized to the texture they refer to, see -regionOfInterestForInputAtIndex: of GPUImageInput
+#define kGPUImageFullRegionOfInterest CGRectMake(0.0, 0.0, 1.0, 1.0)
+
+// Grows a region by the given amount on every side and clips it to the texture, an infinite outset gives the full texture
+CGRect outsetRegionOfInterest(CGRect region, CGFloat horizontalOutset, CGFloat verticalOutset);
+
+// Shader variable name for a filter input, the first input has no suffix: inputImageTexture, inputImageTexture2, inputImageTexture3...
+NSString *inputVariableName(NSString *baseName, NSUInteger inputIndex);
@@ -200,3 +200,27 @@ CGPoint rotatedPoint(CGPoint pointToRotate, GPUImageRotationMode rotation) {
 
     return rotatedPoint;
 }
+
+CGRect rotatedRect(CGRect rectToRotate, GPUImageRotationMode rotation) {
+    CGPoint firstCorner = rotatedPoint(rectToRotate.origin, rotation);
+    CGPoint secondCorner = rotatedPoint(CGPointMake(CGRectGetMaxX(rectToRotate), CGRectGetMaxY(rectToRotate)), rotation);
+
+    return CGRectMake(MIN(firstCorner.x, secondCorner.x), MIN(firstCorner.y, secondCorner.y), fabs(secondCorner.x - firstCorner.x), fabs(secondCorner.y - firstCorner.y));
+}
+
+CGRect outsetRegionOfInterest(CGRect region, CGFloat horizontalOutset, CGFloat verticalOutset) {
+    // Written out instead of CGRectInset, which doesn't cope with infinite outsets
+    CGFloat minX = MAX(CGRectGetMinX(region) - horizontalOutset, 0.0);
+    CGFloat minY = MAX(CGRectGetMinY(region) - verticalOutset, 0.0);
+    CGFloat maxX = MIN(CGRectGetMaxX(region) + horizontalOutset, 1.0);
+    CGFloat maxY = MIN(CGRectGetMaxY(region) + verticalOutset, 1.0);
+
+    return CGRectMake(minX, minY, MAX(maxX - minX, 0.0), MAX(maxY - minY, 0.0));
+}
+
+NSString *inputVariableName(NSString *baseName, NSUInteger inputIndex) {
+    if (inputIndex == 0) {
+        return baseName;
+    }
+    return [NSString stringWithFormat:@"%@%lu", baseName, (unsigned long)inputIndex + 1];
+}
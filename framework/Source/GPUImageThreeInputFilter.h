@@ -3,19 +3,5 @@
 extern NSString *const kGPUImageThreeInputTextureVertexShaderString;
 
 @interface GPUImageThreeInputFilter : GPUImageTwoInputFilter
-{
-    GPUImageFramebuffer *thirdInputFramebuffer;
-
-    GLint filterThirdTextureCoordinateAttribute;
-    GLint filterInputTextureUniform3;
-    GPUImageRotationMode inputRotation3;
-    GLuint filterSourceTexture3;
-    CMTime thirdFrameTime;
-    
-    BOOL hasSetSecondTexture, hasReceivedThirdFrame, thirdFrameWasVideo;
-    BOOL thirdFrameCheckDisabled;
-}
-
-- (void)disableThirdFrameCheck;
 
 @end
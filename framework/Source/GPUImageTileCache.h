@@ -0,0 +1,31 @@
+#import "GPUImageTileStore.h"
+
+/** A fixed number of tiles, dropping the least recently used one to make room for a new one
+
+ The cache only does the bookkeeping, the tiles are whatever the owner stores, e.g. texture names. It is not thread safe.
+ */
+@interface GPUImageTileCache : NSObject
+
+@property (nonatomic, assign, readonly) NSUInteger capacity;
+@property (nonatomic, assign, readonly) NSUInteger count;
+
+/// Called with every tile leaving the cache, to free what it holds
+@property (nonatomic, copy) void (^evictionBlock)(GPUImageTileKey key, id tile);
+
+/// Tiles dropped to make room since the cache was created
+@property (nonatomic, assign, readonly) NSUInteger evictionCount;
+
+- (id)initWithCapacity:(NSUInteger)capacity;
+
+/// Returns the tile and marks it as the most recently used one
+- (id)tileForKey:(GPUImageTileKey)key;
+
+/// Checks for a tile without changing the order of use
+- (BOOL)containsTileForKey:(GPUImageTileKey)key;
+
+/// Stores a tile as the most recently used one, evicting the least recently used one when full
+- (void)setTile:(id)tile forKey:(GPUImageTileKey)key;
+
+- (void)removeAllTiles;
+
+@end
@@ -0,0 +1,120 @@
+#import "GPUImageTileCache.h"
+
+GPUImageTileKey GPUImageTileKeyMake(NSUInteger level, NSUInteger column, NSUInteger row) {
+  NSCAssert(level < (1 << 8) && column < (1 << 28) && row < (1 << 28), @"Tile key out of range");
+  return ((GPUImageTileKey)level << 56) | ((GPUImageTileKey)column << 28) | (GPUImageTileKey)row;
+}
+
+NSUInteger GPUImageTileKeyLevel(GPUImageTileKey key) {
+  return (NSUInteger)(key >> 56);
+}
+
+NSUInteger GPUImageTileKeyColumn(GPUImageTileKey key) {
+  return (NSUInteger)((key >> 28) & ((1 << 28) - 1));
+}
+
+NSUInteger GPUImageTileKeyRow(GPUImageTileKey key) {
+  return (NSUInteger)(key & ((1 << 28) - 1));
+}
+
+CGSize GPUImageTileLevelSize(CGSize imageSize, NSUInteger level) {
+  CGFloat scale = (CGFloat)(1 << level);
+  return CGSizeMake(MAX(ceil(imageSize.width / scale), 1.0), MAX(ceil(imageSize.height / scale), 1.0));
+}
+
+@interface GPUImageTileCache()
+
+@property (nonatomic, strong) NSMutableDictionary *tiles;
+
+// Keys from the least to the most recently used
+@property (nonatomic, strong) NSMutableOrderedSet *usageOrder;
+
+@end
+
+@implementation GPUImageTileCache
+
+#pragma mark - Initialization and teardown
+
+- (id)init {
+  return [self initWithCapacity:64];
+}
+
+- (id)initWithCapacity:(NSUInteger)capacity {
+  NSAssert(capacity > 0, @"A tile cache needs room for at least one tile");
+  if (!(self = [super init])) {
+    return nil;
+  }
+
+  _capacity = capacity;
+  self.tiles = [NSMutableDictionary dictionaryWithCapacity:capacity];
+  self.usageOrder = [NSMutableOrderedSet orderedSetWithCapacity:capacity];
+
+  return self;
+}
+
+- (void)dealloc {
+  [self removeAllTiles];
+}
+
+#pragma mark - Tiles
+
+- (NSUInteger)count {
+  return [self.tiles count];
+}
+
+- (id)tileForKey:(GPUImageTileKey)key {
+  NSNumber *boxedKey = @(key);
+  id tile = self.tiles[boxedKey];
+  if (tile != nil) {
+    [self.usageOrder removeObject:boxedKey];
+    [self.usageOrder addObject:boxedKey];
+  }
+  return tile;
+}
+
+- (BOOL)containsTileForKey:(GPUImageTileKey)key {
+  return self.tiles[@(key)] != nil;
+}
+
+- (void)setTile:(id)tile forKey:(GPUImageTileKey)key {
+  NSParameterAssert(tile != nil);
+  NSNumber *boxedKey = @(key);
+
+  id replacedTile = self.tiles[boxedKey];
+  if (replacedTile != nil) {
+    [self.usageOrder removeObject:boxedKey];
+    [self.tiles removeObjectForKey:boxedKey];
+    if (replacedTile != tile) {
+      [self releaseTile:replacedTile forKey:boxedKey];
+    }
+  }
+
+  while ([self.tiles count] >= self.capacity) {
+    NSNumber *leastRecentlyUsedKey = [self.usageOrder firstObject];
+    id evictedTile = self.tiles[leastRecentlyUsedKey];
+    [self.usageOrder removeObjectAtIndex:0];
+    [self.tiles removeObjectForKey:leastRecentlyUsedKey];
+    _evictionCount++;
+    [self releaseTile:evictedTile forKey:leastRecentlyUsedKey];
+  }
+
+  self.tiles[boxedKey] = tile;
+  [self.usageOrder addObject:boxedKey];
+}
+
+- (void)removeAllTiles {
+  NSDictionary *removedTiles = [self.tiles copy];
+  [self.tiles removeAllObjects];
+  [self.usageOrder removeAllObjects];
+  [removedTiles enumerateKeysAndObjectsUsingBlock:^(NSNumber *boxedKey, id tile, BOOL *stop) {
+    [self releaseTile:tile forKey:boxedKey];
+  }];
+}
+
+- (void)releaseTile:(id)tile forKey:(NSNumber *)boxedKey {
+  if (self.evictionBlock != NULL) {
+    self.evictionBlock([boxedKey unsignedLongLongValue], tile);
+  }
+}
+
+@end
@@ -0,0 +1,58 @@
+#import "GPUImageTileCache.h"
+
+/** Decides which tiles of a GPUImageTileStore to show for a view of the image, and streams in the missing ones
+
+ The scheduler picks the pyramid level that matches the zoom, keeps the tiles in a GPUImageTileCache and loads missing tiles on background queues, closest to the center of the view first. While a tile is loading its nearest resident ancestor is drawn instead, and the coarsest level is always requested first so that there is something to show anywhere.
+ It holds no OpenGL state itself, the owner turns tile data into whatever the cache should keep with tileUploadBlock. All methods and blocks run on the callback queue.
+ */
+@interface GPUImageTileScheduler : NSObject
+
+@property (nonatomic, strong, readonly) id<GPUImageTileStore> store;
+@property (nonatomic, strong, readonly) GPUImageTileCache *cache;
+
+/// Tiles read from the store at once, 4 by default
+@property (nonatomic, assign) NSUInteger maximumConcurrentLoads;
+
+/// Turns the data of a loaded tile into what the cache keeps, e.g. a texture. Returning nil drops the tile
+@property (nonatomic, copy) id (^tileUploadBlock)(GPUImageTileKey key, NSData *data);
+
+/// Called once tiles are in the cache, e.g. to render again
+@property (nonatomic, copy) void (^tilesDidLoadBlock)(void);
+
+/// Tiles requested or being read
+@property (nonatomic, assign, readonly) NSUInteger pendingLoadCount;
+
+/// Tiles put in the cache since the scheduler was created
+@property (nonatomic, assign, readonly) NSUInteger loadedTileCount;
+
+- (id)initWithStore:(id<GPUImageTileStore>)store cache:(GPUImageTileCache *)cache callbackQueue:(dispatch_queue_t)callbackQueue;
+
+#pragma mark - Geometry
+
+/** The finest level with no more pixels than needed to show a region at a size
+ @param region Part of the image, normalized
+ @param outputSize Pixel size the region is shown at
+ */
+- (NSUInteger)levelForRegion:(CGRect)region outputSize:(CGSize)outputSize;
+
+/// Boxed GPUImageTileKeys of the tiles of a level overlapping a normalized region, row by row
+- (NSArray *)keysOfTilesAtLevel:(NSUInteger)level inRegion:(CGRect)region;
+
+/// Part of the image covered by a tile, normalized
+- (CGRect)regionOfTile:(GPUImageTileKey)key;
+
+/// Part of a tile's texture inside the image, normalized, less than the full tile on the right and bottom edges
+- (CGRect)textureRegionOfTile:(GPUImageTileKey)key;
+
+#pragma mark - Scheduling
+
+/** Boxed GPUImageTileKeys of the resident tiles to draw for a view, coarsest first so that finer tiles are drawn over them
+
+ Missing tiles are requested, replacing requests from earlier views that haven't started loading yet.
+ */
+- (NSArray *)tilesToDrawForRegion:(CGRect)region outputSize:(CGSize)outputSize;
+
+/// Drops every request that hasn't started loading
+- (void)cancelPendingLoads;
+
+@end
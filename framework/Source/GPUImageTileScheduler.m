@@ -0,0 +1,203 @@
+#import "GPUImageTileScheduler.h"
+
+@interface GPUImageTileScheduler()
+
+@property (nonatomic, strong) dispatch_queue_t callbackQueue;
+
+// Boxed keys waiting to be read, most important first
+@property (nonatomic, strong) NSMutableArray *requestedKeys;
+@property (nonatomic, strong) NSMutableSet *loadingKeys;
+
+// Tiles the store couldn't deliver, which aren't asked for again
+@property (nonatomic, strong) NSMutableSet *failedKeys;
+
+@end
+
+@implementation GPUImageTileScheduler
+
+#pragma mark - Initialization and teardown
+
+- (id)initWithStore:(id<GPUImageTileStore>)store cache:(GPUImageTileCache *)cache callbackQueue:(dispatch_queue_t)callbackQueue {
+  NSParameterAssert(store != nil && cache != nil && callbackQueue != NULL);
+  NSAssert([store numberOfLevels] > 0 && [store tileSize] > 0, @"Invalid tile store");
+
+  if (!(self = [super init])) {
+    return nil;
+  }
+
+  _store = store;
+  _cache = cache;
+  _maximumConcurrentLoads = 4;
+  self.callbackQueue = callbackQueue;
+  self.requestedKeys = [NSMutableArray array];
+  self.loadingKeys = [NSMutableSet set];
+  self.failedKeys = [NSMutableSet set];
+
+  return self;
+}
+
+#pragma mark - Geometry
+
+- (NSUInteger)levelForRegion:(CGRect)region outputSize:(CGSize)outputSize {
+  CGSize imageSize = [self.store imageSize];
+  if (outputSize.width * outputSize.height <= 0.0 || region.size.width * region.size.height <= 0.0) {
+    return 0;
+  }
+
+  // Image pixels per output pixel along the axis that needs the most detail
+  CGFloat scale = MIN(region.size.width * imageSize.width / outputSize.width, region.size.height * imageSize.height / outputSize.height);
+  if (scale <= 1.0) {
+    return 0;
+  }
+  return MIN((NSUInteger)floor(log2(scale)), [self.store numberOfLevels] - 1);
+}
+
+- (NSArray *)keysOfTilesAtLevel:(NSUInteger)level inRegion:(CGRect)region {
+  CGSize levelSize = GPUImageTileLevelSize([self.store imageSize], level);
+  CGFloat tileSize = [self.store tileSize];
+  NSInteger columns = (NSInteger)ceil(levelSize.width / tileSize);
+  NSInteger rows = (NSInteger)ceil(levelSize.height / tileSize);
+
+  NSInteger firstColumn = MAX((NSInteger)floor(CGRectGetMinX(region) * levelSize.width / tileSize), 0);
+  NSInteger lastColumn = MIN((NSInteger)ceil(CGRectGetMaxX(region) * levelSize.width / tileSize) - 1, columns - 1);
+  NSInteger firstRow = MAX((NSInteger)floor(CGRectGetMinY(region) * levelSize.height / tileSize), 0);
+  NSInteger lastRow = MIN((NSInteger)ceil(CGRectGetMaxY(region) * levelSize.height / tileSize) - 1, rows - 1);
+
+  NSMutableArray *keys = [NSMutableArray array];
+  for (NSInteger row = firstRow; row <= lastRow; row++) {
+    for (NSInteger column = firstColumn; column <= lastColumn; column++) {
+      [keys addObject:@(GPUImageTileKeyMake(level, column, row))];
+    }
+  }
+  return keys;
+}
+
+- (CGRect)regionOfTile:(GPUImageTileKey)key {
+  CGSize levelSize = GPUImageTileLevelSize([self.store imageSize], GPUImageTileKeyLevel(key));
+  CGFloat tileSize = [self.store tileSize];
+  CGFloat minX = GPUImageTileKeyColumn(key) * tileSize, minY = GPUImageTileKeyRow(key) * tileSize;
+  CGFloat maxX = MIN(minX + tileSize, levelSize.width), maxY = MIN(minY + tileSize, levelSize.height);
+  return CGRectMake(minX / levelSize.width, minY / levelSize.height, (maxX - minX) / levelSize.width, (maxY - minY) / levelSize.height);
+}
+
+- (CGRect)textureRegionOfTile:(GPUImageTileKey)key {
+  CGSize levelSize = GPUImageTileLevelSize([self.store imageSize], GPUImageTileKeyLevel(key));
+  CGFloat tileSize = [self.store tileSize];
+  CGFloat width = MIN(tileSize, levelSize.width - GPUImageTileKeyColumn(key) * tileSize);
+  CGFloat height = MIN(tileSize, levelSize.height - GPUImageTileKeyRow(key) * tileSize);
+  return CGRectMake(0.0, 0.0, width / tileSize, height / tileSize);
+}
+
+#pragma mark - Scheduling
+
+- (NSArray *)tilesToDrawForRegion:(CGRect)region outputSize:(CGSize)outputSize {
+  NSUInteger level = [self levelForRegion:region outputSize:outputSize];
+  NSUInteger coarsestLevel = [self.store numberOfLevels] - 1;
+
+  NSMutableOrderedSet *drawnKeys = [NSMutableOrderedSet orderedSet];
+  NSMutableArray *missingKeys = [NSMutableArray array];
+  for (NSNumber *boxedKey in [self keysOfTilesAtLevel:level inRegion:region]) {
+    GPUImageTileKey key = [boxedKey unsignedLongLongValue];
+    if ([self.cache tileForKey:key] != nil) {
+      [drawnKeys addObject:boxedKey];
+      continue;
+    }
+
+    [missingKeys addObject:boxedKey];
+    for (NSUInteger ancestorLevel = level + 1; ancestorLevel <= coarsestLevel; ancestorLevel++) {
+      NSUInteger shift = ancestorLevel - level;
+      GPUImageTileKey ancestorKey = GPUImageTileKeyMake(ancestorLevel, GPUImageTileKeyColumn(key) >> shift, GPUImageTileKeyRow(key) >> shift);
+      if ([self.cache tileForKey:ancestorKey] != nil) {
+        [drawnKeys addObject:@(ancestorKey)];
+        break;
+      }
+    }
+  }
+
+  // Closest to the center of the view first
+  CGPoint center = CGPointMake(CGRectGetMidX(region), CGRectGetMidY(region));
+  [missingKeys sortUsingComparator:^NSComparisonResult(NSNumber *firstKey, NSNumber *secondKey) {
+    CGRect firstRegion = [self regionOfTile:[firstKey unsignedLongLongValue]];
+    CGRect secondRegion = [self regionOfTile:[secondKey unsignedLongLongValue]];
+    CGFloat firstDistance = hypot(CGRectGetMidX(firstRegion) - center.x, CGRectGetMidY(firstRegion) - center.y);
+    CGFloat secondDistance = hypot(CGRectGetMidX(secondRegion) - center.x, CGRectGetMidY(secondRegion) - center.y);
+    return (firstDistance < secondDistance) ? NSOrderedAscending : ((firstDistance > secondDistance) ? NSOrderedDescending : NSOrderedSame);
+  }];
+
+  NSMutableArray *requestedKeys = [NSMutableArray array];
+  if (level != coarsestLevel) {
+    for (NSNumber *boxedKey in [self keysOfTilesAtLevel:coarsestLevel inRegion:region]) {
+      if (![self.cache containsTileForKey:[boxedKey unsignedLongLongValue]]) {
+        [requestedKeys addObject:boxedKey];
+      }
+    }
+  }
+  [requestedKeys addObjectsFromArray:missingKeys];
+  [self requestTiles:requestedKeys];
+
+  return [[drawnKeys array] sortedArrayUsingComparator:^NSComparisonResult(NSNumber *firstKey, NSNumber *secondKey) {
+    NSUInteger firstLevel = GPUImageTileKeyLevel([firstKey unsignedLongLongValue]);
+    NSUInteger secondLevel = GPUImageTileKeyLevel([secondKey unsignedLongLongValue]);
+    return (firstLevel > secondLevel) ? NSOrderedAscending : ((firstLevel < secondLevel) ? NSOrderedDescending : NSOrderedSame);
+  }];
+}
+
+- (NSUInteger)pendingLoadCount {
+  return [self.requestedKeys count] + [self.loadingKeys count];
+}
+
+- (void)requestTiles:(NSArray *)keys {
+  [self.requestedKeys removeAllObjects];
+  for (NSNumber *boxedKey in keys) {
+    if (![self.loadingKeys containsObject:boxedKey] && ![self.failedKeys containsObject:boxedKey]) {
+      [self.requestedKeys addObject:boxedKey];
+    }
+  }
+  [self startLoads];
+}
+
+- (void)cancelPendingLoads {
+  [self.requestedKeys removeAllObjects];
+}
+
+- (void)startLoads {
+  while ([self.loadingKeys count] < MAX(self.maximumConcurrentLoads, 1) && [self.requestedKeys count] > 0) {
+    NSNumber *boxedKey = [self.requestedKeys firstObject];
+    [self.requestedKeys removeObjectAtIndex:0];
+    [self.loadingKeys addObject:boxedKey];
+
+    id<GPUImageTileStore> store = self.store;
+    dispatch_queue_t callbackQueue = self.callbackQueue;
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+      NSData *data = [store tileDataForKey:[boxedKey unsignedLongLongValue]];
+      dispatch_async(callbackQueue, ^{
+        [weakSelf finishLoadingTile:boxedKey data:data];
+      });
+    });
+  }
+}
+
+- (void)finishLoadingTile:(NSNumber *)boxedKey data:(NSData *)data {
+  [self.loadingKeys removeObject:boxedKey];
+  GPUImageTileKey key = [boxedKey unsignedLongLongValue];
+  NSUInteger tileSize = [self.store tileSize];
+
+  id tile = nil;
+  if ([data length] >= tileSize * tileSize * 4 && self.tileUploadBlock != NULL) {
+    tile = self.tileUploadBlock(key, data);
+  }
+  if (tile != nil) {
+    [self.cache setTile:tile forKey:key];
+    _loadedTileCount++;
+  } else {
+    [self.failedKeys addObject:boxedKey];
+  }
+
+  [self startLoads];
+  if (tile != nil && self.tilesDidLoadBlock != NULL) {
+    self.tilesDidLoadBlock();
+  }
+}
+
+@end
@@ -0,0 +1,38 @@
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+
+/** Identifies a tile of an image pyramid by level, column and row, packed into 64 bits so it can be boxed in an NSNumber
+
+ Level 0 is the full resolution image, every further level halves it. Column 0, row 0 is the top left tile of its level.
+ */
+typedef uint64_t GPUImageTileKey;
+
+GPUImageTileKey GPUImageTileKeyMake(NSUInteger level, NSUInteger column, NSUInteger row);
+NSUInteger GPUImageTileKeyLevel(GPUImageTileKey key);
+NSUInteger GPUImageTileKeyColumn(GPUImageTileKey key);
+NSUInteger GPUImageTileKeyRow(GPUImageTileKey key);
+
+/// Pixel size of a pyramid level, rounding odd sizes up
+CGSize GPUImageTileLevelSize(CGSize imageSize, NSUInteger level);
+
+/** Tiled multi-resolution image data, read by GPUImageTileScheduler
+
+ Tiles are square, tightly packed BGRA with 8 bits per channel and the top row first. Tiles on the right and bottom edges of a level are stored at full size, the pixels past the edge of the level are ignored.
+ */
+@protocol GPUImageTileStore <NSObject>
+
+/// Size of level 0 in pixels
+@property (nonatomic, assign, readonly) CGSize imageSize;
+
+/// Width and height of every tile in pixels
+@property (nonatomic, assign, readonly) NSUInteger tileSize;
+
+@property (nonatomic, assign, readonly) NSUInteger numberOfLevels;
+
+/** The pixels of a tile, tileSize * tileSize * 4 bytes, or nil if it can't be read
+
+ Called on background queues, possibly for several tiles at once.
+ */
+- (NSData *)tileDataForKey:(GPUImageTileKey)key;
+
+@end
@@ -0,0 +1,58 @@
+#import "GPUImageTileStore.h"
+
+/** Layout of a tiled image file, as written by GPUImageTiledImageWriter
+
+ The file starts with this header, followed by one GPUImageTiledImageIndexEntry per tile at indexOffset and the tile data at dataOffset. Tiles are ordered level by level, each level row by row from the top left, and every tile starts on a kGPUImageTiledImageAlignment boundary so that it lies on whole pages when the file is mapped.
+ All fields are little endian.
+ */
+typedef struct GPUImageTiledImageHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t tileSize;
+  uint32_t numberOfLevels;
+  uint32_t pixelFormat;
+  uint32_t tileCount;
+  uint64_t indexOffset;
+  uint64_t dataOffset;
+} GPUImageTiledImageHeader;
+
+/// Where a tile is stored in the file. A length of 0 marks a tile that was never written
+typedef struct GPUImageTiledImageIndexEntry {
+  uint64_t offset;
+  uint64_t length;
+} GPUImageTiledImageIndexEntry;
+
+#define kGPUImageTiledImageMagic "GPTI"
+#define kGPUImageTiledImageVersion 1
+
+/// Uncompressed BGRA, 8 bits per channel, the only pixel format so far
+#define kGPUImageTiledImagePixelFormatBGRA8 0
+
+/// Covers both 4 kB and 16 kB pages
+#define kGPUImageTiledImageAlignment 16384
+
+/// Levels of a pyramid whose coarsest level fits in a single tile
+NSUInteger GPUImageTiledImageNumberOfLevels(CGSize imageSize, NSUInteger tileSize);
+
+/** A tiled image file mapped into memory, serving its tiles to a GPUImageTiledPicture
+
+ Opening a file only reads its header and index, so reopening a processed panorama takes no decoding at all. Tiles are returned as NSData pointing straight into the mapped pages, and the pages are faulted in on the background queue that reads the tile, so the texture upload copies the pixels once, from the page cache to the GPU.
+ */
+@interface GPUImageTiledImageFile : NSObject <GPUImageTileStore>
+
+@property (nonatomic, copy, readonly) NSString *path;
+@property (nonatomic, assign, readonly) CGSize imageSize;
+@property (nonatomic, assign, readonly) NSUInteger tileSize;
+@property (nonatomic, assign, readonly) NSUInteger numberOfLevels;
+
+/** Map a file written by GPUImageTiledImageWriter
+ @param error Set to an error in NSPOSIXErrorDomain when the file can't be read or isn't a valid tiled image
+ */
+- (id)initWithPath:(NSString *)path error:(NSError **)error;
+
+/// The pixels of a tile without copying them, valid for as long as the data object lives
+- (NSData *)tileDataForKey:(GPUImageTileKey)key;
+
+@end
@@ -0,0 +1,163 @@
+#import "GPUImageTiledImageFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+NSUInteger GPUImageTiledImageNumberOfLevels(CGSize imageSize, NSUInteger tileSize) {
+  NSUInteger numberOfLevels = 1;
+  CGSize levelSize = imageSize;
+  while (levelSize.width > tileSize || levelSize.height > tileSize) {
+    levelSize = GPUImageTileLevelSize(imageSize, numberOfLevels);
+    numberOfLevels++;
+  }
+  return numberOfLevels;
+}
+
+static NSError *tiledImageFileError(int code, NSString *path) {
+  return [NSError errorWithDomain:NSPOSIXErrorDomain code:code userInfo:@{NSFilePathErrorKey: path}];
+}
+
+@interface GPUImageTiledImageFile()
+{
+  const uint8_t *mappedBytes;
+  size_t mappedLength;
+  const GPUImageTiledImageIndexEntry *tileIndex;
+  NSUInteger tileCount;
+
+  // Index of the first tile and tiles per row of every level
+  NSUInteger *levelFirstTiles;
+  NSUInteger *levelColumns;
+}
+@end
+
+@implementation GPUImageTiledImageFile
+
+#pragma mark - Initialization and teardown
+
+- (id)initWithPath:(NSString *)path error:(NSError **)error {
+  if (!(self = [super init])) {
+    return nil;
+  }
+
+  _path = [path copy];
+
+  int fileDescriptor = open([path fileSystemRepresentation], O_RDONLY);
+  if (fileDescriptor < 0) {
+    if (error != NULL) {
+      *error = tiledImageFileError(errno, path);
+    }
+    return nil;
+  }
+
+  struct stat fileStatus;
+  int statusResult = fstat(fileDescriptor, &fileStatus);
+  if (statusResult != 0 || fileStatus.st_size < (off_t)sizeof(GPUImageTiledImageHeader)) {
+    int code = (statusResult != 0) ? errno : EINVAL;
+    close(fileDescriptor);
+    if (error != NULL) {
+      *error = tiledImageFileError(code, path);
+    }
+    return nil;
+  }
+
+  // The mapping stays valid after the descriptor is closed
+  mappedLength = (size_t)fileStatus.st_size;
+  void *mapping = mmap(NULL, mappedLength, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+  close(fileDescriptor);
+  if (mapping == MAP_FAILED) {
+    mappedBytes = NULL;
+    if (error != NULL) {
+      *error = tiledImageFileError(errno, path);
+    }
+    return nil;
+  }
+  mappedBytes = mapping;
+
+  if (![self readHeader]) {
+    if (error != NULL) {
+      *error = tiledImageFileError(EINVAL, path);
+    }
+    return nil;
+  }
+
+  return self;
+}
+
+- (void)dealloc {
+  if (mappedBytes != NULL) {
+    munmap((void *)mappedBytes, mappedLength);
+  }
+  free(levelFirstTiles);
+  free(levelColumns);
+}
+
+- (BOOL)readHeader {
+  const GPUImageTiledImageHeader *header = (const GPUImageTiledImageHeader *)mappedBytes;
+  if (memcmp(header->magic, kGPUImageTiledImageMagic, 4) != 0 || header->version != kGPUImageTiledImageVersion || header->pixelFormat != kGPUImageTiledImagePixelFormatBGRA8) {
+    return NO;
+  }
+  if (header->width == 0 || header->height == 0 || header->tileSize == 0 || header->numberOfLevels == 0) {
+    return NO;
+  }
+
+  _imageSize = CGSizeMake(header->width, header->height);
+  _tileSize = header->tileSize;
+  _numberOfLevels = header->numberOfLevels;
+  if (_numberOfLevels != GPUImageTiledImageNumberOfLevels(_imageSize, _tileSize)) {
+    return NO;
+  }
+
+  levelFirstTiles = calloc(_numberOfLevels, sizeof(NSUInteger));
+  levelColumns = calloc(_numberOfLevels, sizeof(NSUInteger));
+  tileCount = 0;
+  for (NSUInteger level = 0; level < _numberOfLevels; level++) {
+    CGSize levelSize = GPUImageTileLevelSize(_imageSize, level);
+    levelFirstTiles[level] = tileCount;
+    levelColumns[level] = (NSUInteger)ceil(levelSize.width / _tileSize);
+    tileCount += levelColumns[level] * (NSUInteger)ceil(levelSize.height / _tileSize);
+  }
+
+  if (header->tileCount != tileCount || header->indexOffset > mappedLength || (mappedLength - header->indexOffset) / sizeof(GPUImageTiledImageIndexEntry) < tileCount) {
+    return NO;
+  }
+  tileIndex = (const GPUImageTiledImageIndexEntry *)(mappedBytes + header->indexOffset);
+
+  return YES;
+}
+
+#pragma mark - Tiles
+
+- (NSData *)tileDataForKey:(GPUImageTileKey)key {
+  NSUInteger level = GPUImageTileKeyLevel(key);
+  if (level >= self.numberOfLevels) {
+    return nil;
+  }
+  CGSize levelSize = GPUImageTileLevelSize(self.imageSize, level);
+  NSUInteger column = GPUImageTileKeyColumn(key), row = GPUImageTileKeyRow(key);
+  if (column >= levelColumns[level] || row >= (NSUInteger)ceil(levelSize.height / self.tileSize)) {
+    return nil;
+  }
+
+  GPUImageTiledImageIndexEntry entry = tileIndex[levelFirstTiles[level] + row * levelColumns[level] + column];
+  uint64_t tileLength = (uint64_t)self.tileSize * self.tileSize * 4;
+  if (entry.length != tileLength || entry.offset > mappedLength || mappedLength - entry.offset < tileLength) {
+    return nil;
+  }
+
+  // Touch every page now, on the loading queue, rather than during the upload on the GL queue
+  const uint8_t *tileBytes = mappedBytes + entry.offset;
+  size_t pageSize = (size_t)getpagesize();
+  volatile uint8_t pageSum = 0;
+  for (size_t pageOffset = 0; pageOffset < tileLength; pageOffset += pageSize) {
+    pageSum += tileBytes[pageOffset];
+  }
+
+  // The deallocator keeps the file mapped for as long as the data is in use
+  GPUImageTiledImageFile *mappedFile = self;
+  return [[NSData alloc] initWithBytesNoCopy:(void *)tileBytes length:(NSUInteger)tileLength deallocator:^(void *bytes, NSUInteger length) {
+    (void)mappedFile;
+  }];
+}
+
+@end
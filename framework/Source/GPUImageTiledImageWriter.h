@@ -0,0 +1,39 @@
+#import "GPUImageTiledImageFile.h"
+#import "GPUImageRawDataOutput.h"
+#import "GPUImageFramebuffer.h"
+
+/** Writes an image and its pyramid of downscaled levels to a tiled image file, for GPUImageTiledImageFile to map
+
+ The file is laid out in full up front and mapped, so the full resolution tiles are copied straight from the source bytes into the mapped pages and every coarser level is box filtered from the finer one tile by tile, without holding a second copy of the image. It is written under a temporary name and moved into place by -finishWritingWithError:, so readers never see a partial file.
+ */
+@interface GPUImageTiledImageWriter : NSObject
+
+@property (nonatomic, copy, readonly) NSString *path;
+@property (nonatomic, assign, readonly) CGSize imageSize;
+@property (nonatomic, assign, readonly) NSUInteger tileSize;
+@property (nonatomic, assign, readonly) NSUInteger numberOfLevels;
+
+/** Create the file
+ @param imageSize Size of the full resolution image in pixels
+ @param tileSize Width and height of the tiles, a power of two of at least 64
+ */
+- (id)initWithPath:(NSString *)path imageSize:(CGSize)imageSize tileSize:(NSUInteger)tileSize error:(NSError **)error;
+
+/** Store the full resolution image
+ @param bytes BGRA pixels with the top row first, imageSize in size
+ */
+- (void)writeImageBytes:(const GLubyte *)bytes bytesPerRow:(NSUInteger)bytesPerRow;
+
+/// Store the current frame of a raw data output created with resultsInBGRAFormat:YES and the image size
+- (void)writeImageFromRawDataOutput:(GPUImageRawDataOutput *)rawDataOutput;
+
+/// Store the contents of a framebuffer backed by a texture cache, as on iOS with fast texture upload. Call on the video processing queue
+- (void)writeImageFromFramebuffer:(GPUImageFramebuffer *)framebuffer;
+
+/// Build the coarser levels, flush and move the file into place
+- (BOOL)finishWritingWithError:(NSError **)error;
+
+/// Remove the partial file without finishing it
+- (void)cancelWriting;
+
+@end
@@ -0,0 +1,274 @@
+#import "GPUImageTiledImageWriter.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static NSError *tiledImageWriterError(int code, NSString *path) {
+  return [NSError errorWithDomain:NSPOSIXErrorDomain code:code userInfo:@{NSFilePathErrorKey: path}];
+}
+
+static uint64_t tiledImageAlignedLength(uint64_t length) {
+  return (length + kGPUImageTiledImageAlignment - 1) / kGPUImageTiledImageAlignment * kGPUImageTiledImageAlignment;
+}
+
+@interface GPUImageTiledImageWriter()
+{
+  uint8_t *mappedBytes;
+  size_t mappedLength;
+  uint64_t dataOffset;
+  uint64_t tileStride;
+
+  // Index of the first tile, tiles per row and per column of every level
+  NSUInteger *levelFirstTiles;
+  NSUInteger *levelColumns;
+  NSUInteger *levelRows;
+}
+
+@property (nonatomic, copy) NSString *partialPath;
+
+@end
+
+@implementation GPUImageTiledImageWriter
+
+#pragma mark - Initialization and teardown
+
+- (id)initWithPath:(NSString *)path imageSize:(CGSize)imageSize tileSize:(NSUInteger)tileSize error:(NSError **)error {
+  NSAssert(tileSize >= 64 && (tileSize & (tileSize - 1)) == 0, @"Tiles have to be a power of two of at least 64 pixels");
+  NSAssert(imageSize.width >= 1.0 && imageSize.height >= 1.0, @"Invalid image size");
+  if (!(self = [super init])) {
+    return nil;
+  }
+
+  _path = [path copy];
+  _imageSize = CGSizeMake(floor(imageSize.width), floor(imageSize.height));
+  _tileSize = tileSize;
+  _numberOfLevels = GPUImageTiledImageNumberOfLevels(_imageSize, tileSize);
+  self.partialPath = [path stringByAppendingString:@".partial"];
+
+  levelFirstTiles = calloc(_numberOfLevels, sizeof(NSUInteger));
+  levelColumns = calloc(_numberOfLevels, sizeof(NSUInteger));
+  levelRows = calloc(_numberOfLevels, sizeof(NSUInteger));
+  NSUInteger tileCount = 0;
+  for (NSUInteger level = 0; level < _numberOfLevels; level++) {
+    CGSize levelSize = GPUImageTileLevelSize(_imageSize, level);
+    levelFirstTiles[level] = tileCount;
+    levelColumns[level] = (NSUInteger)ceil(levelSize.width / tileSize);
+    levelRows[level] = (NSUInteger)ceil(levelSize.height / tileSize);
+    tileCount += levelColumns[level] * levelRows[level];
+  }
+
+  uint64_t tileLength = (uint64_t)tileSize * tileSize * 4;
+  tileStride = tiledImageAlignedLength(tileLength);
+  dataOffset = tiledImageAlignedLength(sizeof(GPUImageTiledImageHeader) + tileCount * sizeof(GPUImageTiledImageIndexEntry));
+  mappedLength = (size_t)(dataOffset + tileCount * tileStride);
+
+  // Extending the file leaves it sparse, pages are only allocated as tiles are written
+  int fileDescriptor = open([self.partialPath fileSystemRepresentation], O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fileDescriptor < 0) {
+    if (error != NULL) {
+      *error = tiledImageWriterError(errno, path);
+    }
+    return nil;
+  }
+  if (ftruncate(fileDescriptor, (off_t)mappedLength) != 0) {
+    int code = errno;
+    close(fileDescriptor);
+    [self cancelWriting];
+    if (error != NULL) {
+      *error = tiledImageWriterError(code, path);
+    }
+    return nil;
+  }
+  void *mapping = mmap(NULL, mappedLength, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+  close(fileDescriptor);
+  if (mapping == MAP_FAILED) {
+    int code = errno;
+    [self cancelWriting];
+    if (error != NULL) {
+      *error = tiledImageWriterError(code, path);
+    }
+    return nil;
+  }
+  mappedBytes = mapping;
+
+  GPUImageTiledImageHeader *header = (GPUImageTiledImageHeader *)mappedBytes;
+  memcpy(header->magic, kGPUImageTiledImageMagic, 4);
+  header->version = kGPUImageTiledImageVersion;
+  header->width = (uint32_t)_imageSize.width;
+  header->height = (uint32_t)_imageSize.height;
+  header->tileSize = (uint32_t)tileSize;
+  header->numberOfLevels = (uint32_t)_numberOfLevels;
+  header->pixelFormat = kGPUImageTiledImagePixelFormatBGRA8;
+  header->tileCount = (uint32_t)tileCount;
+  header->indexOffset = sizeof(GPUImageTiledImageHeader);
+  header->dataOffset = dataOffset;
+
+  GPUImageTiledImageIndexEntry *tileIndex = (GPUImageTiledImageIndexEntry *)(mappedBytes + header->indexOffset);
+  for (NSUInteger tile = 0; tile < tileCount; tile++) {
+    tileIndex[tile].offset = dataOffset + tile * tileStride;
+    tileIndex[tile].length = tileLength;
+  }
+
+  return self;
+}
+
+- (void)dealloc {
+  [self cancelWriting];
+  free(levelFirstTiles);
+  free(levelColumns);
+  free(levelRows);
+}
+
+#pragma mark - Tiles
+
+- (uint8_t *)tileBytesAtLevel:(NSUInteger)level column:(NSUInteger)column row:(NSUInteger)row {
+  NSUInteger tile = levelFirstTiles[level] + row * levelColumns[level] + column;
+  return mappedBytes + dataOffset + tile * tileStride;
+}
+
+// Rows and columns past the edge of the image repeat the last ones, so that linear filtering at the edges of tiles doesn't pick up black
+- (void)writeImageBytes:(const GLubyte *)bytes bytesPerRow:(NSUInteger)bytesPerRow swapsRedAndBlue:(BOOL)swapsRedAndBlue {
+  NSAssert(mappedBytes != NULL, @"The writer was already finished or cancelled");
+  NSUInteger tileSize = self.tileSize;
+  NSUInteger width = (NSUInteger)self.imageSize.width, height = (NSUInteger)self.imageSize.height;
+
+  for (NSUInteger row = 0; row < levelRows[0]; row++) {
+    for (NSUInteger column = 0; column < levelColumns[0]; column++) {
+      uint8_t *tileBytes = [self tileBytesAtLevel:0 column:column row:row];
+      NSUInteger firstX = column * tileSize;
+      NSUInteger copiedWidth = MIN(tileSize, width - firstX);
+
+      for (NSUInteger y = 0; y < tileSize; y++) {
+        const GLubyte *sourceRow = bytes + MIN(row * tileSize + y, height - 1) * bytesPerRow + firstX * 4;
+        uint8_t *destinationRow = tileBytes + y * tileSize * 4;
+        if (swapsRedAndBlue) {
+          for (NSUInteger x = 0; x < copiedWidth; x++) {
+            destinationRow[4 * x] = sourceRow[4 * x + 2];
+            destinationRow[4 * x + 1] = sourceRow[4 * x + 1];
+            destinationRow[4 * x + 2] = sourceRow[4 * x];
+            destinationRow[4 * x + 3] = sourceRow[4 * x + 3];
+          }
+        } else {
+          memcpy(destinationRow, sourceRow, copiedWidth * 4);
+        }
+        for (NSUInteger x = copiedWidth; x < tileSize; x++) {
+          memcpy(destinationRow + 4 * x, destinationRow + 4 * (copiedWidth - 1), 4);
+        }
+      }
+    }
+  }
+}
+
+- (void)writeImageBytes:(const GLubyte *)bytes bytesPerRow:(NSUInteger)bytesPerRow {
+  [self writeImageBytes:bytes bytesPerRow:bytesPerRow swapsRedAndBlue:NO];
+}
+
+- (void)writeImageFromRawDataOutput:(GPUImageRawDataOutput *)rawDataOutput {
+  [rawDataOutput lockFramebufferForReading];
+  [self writeImageBytes:rawDataOutput.rawBytesForImage bytesPerRow:[rawDataOutput bytesPerRowInOutput]];
+  [rawDataOutput unlockFramebufferAfterReading];
+}
+
+- (void)writeImageFromFramebuffer:(GPUImageFramebuffer *)framebuffer {
+  NSAssert(CGSizeEqualToSize(framebuffer.size, self.imageSize), @"The framebuffer has to be the size of the image");
+  if ([GPUImageContext supportsFastTextureUpload]) {
+    [framebuffer lockForReading];
+    [self writeImageBytes:[framebuffer byteBuffer] bytesPerRow:[framebuffer bytesPerRow]];
+    [framebuffer unlockAfterReading];
+  } else {
+    NSUInteger bytesPerRow = (NSUInteger)self.imageSize.width * 4;
+    GLubyte *framebufferBytes = malloc(bytesPerRow * (NSUInteger)self.imageSize.height);
+    [framebuffer activateFramebuffer];
+    glReadPixels(0, 0, (GLsizei)self.imageSize.width, (GLsizei)self.imageSize.height, GL_RGBA, GL_UNSIGNED_BYTE, framebufferBytes);
+    [self writeImageBytes:framebufferBytes bytesPerRow:bytesPerRow swapsRedAndBlue:YES];
+    free(framebufferBytes);
+  }
+}
+
+#pragma mark - Pyramid
+
+// Each pixel is the rounded average of a 2x2 block of the finer level, with blocks clamped at its edges
+- (void)downsampleLevel:(NSUInteger)level {
+  NSUInteger tileSize = self.tileSize;
+  NSUInteger tileShift = 0;
+  while (((NSUInteger)1 << tileShift) < tileSize) {
+    tileShift++;
+  }
+  CGSize sourceSize = GPUImageTileLevelSize(self.imageSize, level);
+  CGSize destinationSize = GPUImageTileLevelSize(self.imageSize, level + 1);
+  NSUInteger sourceWidth = (NSUInteger)sourceSize.width, sourceHeight = (NSUInteger)sourceSize.height;
+  NSUInteger destinationWidth = (NSUInteger)destinationSize.width, destinationHeight = (NSUInteger)destinationSize.height;
+
+  for (NSUInteger row = 0; row < levelRows[level + 1]; row++) {
+    for (NSUInteger column = 0; column < levelColumns[level + 1]; column++) {
+      uint8_t *destinationTile = [self tileBytesAtLevel:level + 1 column:column row:row];
+
+      for (NSUInteger y = 0; y < tileSize; y++) {
+        NSUInteger destinationY = MIN(row * tileSize + y, destinationHeight - 1);
+        NSUInteger sourceY0 = 2 * destinationY, sourceY1 = MIN(2 * destinationY + 1, sourceHeight - 1);
+        uint8_t *destinationRow = destinationTile + y * tileSize * 4;
+
+        // Both rows and both columns of a block lie in the same source tile, as blocks start on even pixels
+        NSUInteger cachedSourceColumn = NSNotFound;
+        const uint8_t *sourceRow0 = NULL, *sourceRow1 = NULL;
+        for (NSUInteger x = 0; x < tileSize; x++) {
+          NSUInteger destinationX = MIN(column * tileSize + x, destinationWidth - 1);
+          NSUInteger sourceX0 = 2 * destinationX, sourceX1 = MIN(2 * destinationX + 1, sourceWidth - 1);
+          NSUInteger sourceColumn = sourceX0 >> tileShift;
+          if (sourceColumn != cachedSourceColumn) {
+            const uint8_t *sourceTile = [self tileBytesAtLevel:level column:sourceColumn row:sourceY0 >> tileShift];
+            sourceRow0 = sourceTile + (sourceY0 & (tileSize - 1)) * tileSize * 4;
+            sourceRow1 = sourceTile + (sourceY1 & (tileSize - 1)) * tileSize * 4;
+            cachedSourceColumn = sourceColumn;
+          }
+
+          NSUInteger localX0 = 4 * (sourceX0 & (tileSize - 1)), localX1 = 4 * (sourceX1 & (tileSize - 1));
+          for (NSUInteger channel = 0; channel < 4; channel++) {
+            NSUInteger sum = sourceRow0[localX0 + channel] + sourceRow0[localX1 + channel] + sourceRow1[localX0 + channel] + sourceRow1[localX1 + channel];
+            destinationRow[4 * x + channel] = (uint8_t)((sum + 2) >> 2);
+          }
+        }
+      }
+    }
+  }
+}
+
+#pragma mark - Finishing
+
+- (BOOL)finishWritingWithError:(NSError **)error {
+  NSAssert(mappedBytes != NULL, @"The writer was already finished or cancelled");
+  for (NSUInteger level = 0; level + 1 < self.numberOfLevels; level++) {
+    [self downsampleLevel:level];
+  }
+
+  int result = msync(mappedBytes, mappedLength, MS_SYNC);
+  munmap(mappedBytes, mappedLength);
+  mappedBytes = NULL;
+  if (result == 0) {
+    result = rename([self.partialPath fileSystemRepresentation], [self.path fileSystemRepresentation]);
+  }
+  if (result != 0) {
+    int code = errno;
+    unlink([self.partialPath fileSystemRepresentation]);
+    if (error != NULL) {
+      *error = tiledImageWriterError(code, self.path);
+    }
+    return NO;
+  }
+
+  self.partialPath = nil;
+  return YES;
+}
+
+- (void)cancelWriting {
+  if (mappedBytes != NULL) {
+    munmap(mappedBytes, mappedLength);
+    mappedBytes = NULL;
+  }
+  if (self.partialPath != nil) {
+    unlink([self.partialPath fileSystemRepresentation]);
+    self.partialPath = nil;
+  }
+}
+
+@end
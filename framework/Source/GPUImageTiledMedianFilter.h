@@ -0,0 +1,19 @@
+#import "GPUImageFilterGroup.h"
+
+/** An approximate large-radius median filter whose per-pixel cost doesn't depend on the radius
+
+ Per-channel cumulative histograms of the (2 * radius + 1)^2 window are gathered once per tile on a coarse grid, one bin per atlas slice. Each output pixel then bilinearly interpolates the histograms of the four surrounding tiles and reads the median off the interpolated distribution.
+
+ This is not a per-pixel median: only pixels at tile centers get the median of their own window, to within a histogram bin. Everywhere else the result blends the windows of neighboring tiles, so sharp edges bleed by up to a tile. Raise the quality to shrink the tiles, or use GPUImageMedianFilter for an exact 3x3 median. On images too large for the histograms to fit within a texture, the tiles are spaced further apart.
+ */
+@interface GPUImageTiledMedianFilter : GPUImageFilterGroup
+
+/** The radius of the median window in pixels, from 1 up. Default of 5, a 11x11 window
+ */
+@property (nonatomic, assign) NSUInteger radius;
+
+/** Trades speed for accuracy, from 0.0 (16 histogram bins, tiles spaced a full window apart) to 1.0 (64 bins, tiles spaced half a window apart). Default of 0.5
+ */
+@property (nonatomic, assign) CGFloat quality;
+
+@end
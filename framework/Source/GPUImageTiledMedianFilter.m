@@ -0,0 +1,285 @@
+#import "GPUImageTiledMedianFilter.h"
+#import "GPUImageTwoInputFilter.h"
+
+// Window samples along each axis, larger windows are subsampled
+static const NSUInteger kGPUImageTiledMedianMaximumWindowSamples = 16;
+
+#if TARGET_IPHONE_SIMULATOR || TARGET_OS_IPHONE
+NSString *const kGPUImageTiledMedianShaderPrecision = @"precision highp float;\n";
+#else
+NSString *const kGPUImageTiledMedianShaderPrecision = @"";
+#endif
+
+// The histogram atlas holds histogramBins slices, each one tileGrid texels large, wrapped into rows of atlasSlices.x slices so that it fits within a texture.
+// Texel (tile, bin) stores the per-channel fraction of window pixels whose value is at or below the upper edge of that bin
+NSString *const kGPUImageTiledMedianCDFFragmentShaderString = SHADER_STRING
+(
+ varying vec2 textureCoordinate;
+
+ uniform sampler2D inputImageTexture;
+ uniform vec2 tileGrid;
+ uniform vec2 atlasSlices;
+ uniform vec2 texelSize;
+ uniform float tileStride;
+ uniform float sampleStep;
+
+ void main()
+ {
+     vec2 atlasPosition = textureCoordinate * tileGrid * atlasSlices;
+     vec2 slice = floor(atlasPosition / tileGrid);
+     float bin = slice.y * atlasSlices.x + slice.x;
+     vec2 tile = floor(atlasPosition - slice * tileGrid);
+     vec2 windowOrigin = ((tile + 0.5) * tileStride - float(windowSamples - 1) * 0.5 * sampleStep) * texelSize;
+     vec3 binUpperEdge = vec3((bin + 1.0) / float(histogramBins));
+
+     vec3 count = vec3(0.0);
+     for (int y = 0; y < windowSamples; y++)
+     {
+         for (int x = 0; x < windowSamples; x++)
+         {
+             vec3 color = texture2D(inputImageTexture, windowOrigin + vec2(float(x), float(y)) * sampleStep * texelSize).rgb;
+             count += step(color, binUpperEdge);
+         }
+     }
+
+     gl_FragColor = vec4(count / float(windowSamples * windowSamples), 1.0);
+ }
+);
+
+NSString *const kGPUImageTiledMedianFragmentShaderString = SHADER_STRING
+(
+ varying vec2 textureCoordinate;
+ varying vec2 textureCoordinate2;
+
+ uniform sampler2D inputImageTexture;
+ uniform sampler2D inputImageTexture2;
+ uniform vec2 tileGrid;
+ uniform vec2 atlasSlices;
+ uniform vec2 tileScale;
+
+ void main()
+ {
+     vec4 color = texture2D(inputImageTexture, textureCoordinate);
+     vec2 tile = clamp(textureCoordinate2 * tileScale, vec2(0.5), tileGrid - 0.5);
+
+     vec3 previousDistribution = vec3(0.0);
+     vec3 previousBelowMedian = vec3(1.0);
+     vec3 binsBelowMedian = vec3(0.0);
+     vec3 fractionOfMedianBin = vec3(0.0);
+     for (int bin = 0; bin < histogramBins; bin++)
+     {
+         float sliceRow = floor((float(bin) + 0.5) / atlasSlices.x);
+         vec2 slice = vec2(float(bin) - sliceRow * atlasSlices.x, sliceRow);
+         vec3 distribution = texture2D(inputImageTexture2, (slice * tileGrid + tile) / (tileGrid * atlasSlices)).rgb;
+         vec3 belowMedian = vec3(1.0) - step(vec3(0.5), distribution);
+
+         // Linear interpolation inside the bin where the distribution crosses one half
+         fractionOfMedianBin += (previousBelowMedian - belowMedian) * clamp((0.5 - previousDistribution) / max(distribution - previousDistribution, 0.0001), 0.0, 1.0);
+         binsBelowMedian += belowMedian;
+
+         previousBelowMedian = belowMedian;
+         previousDistribution = distribution;
+     }
+
+     gl_FragColor = vec4((binsBelowMedian + fractionOfMedianBin) / float(histogramBins), color.a);
+ }
+);
+
+static NSUInteger tiledMedianWindowSamples(NSUInteger radius) {
+  return MIN(2 * radius + 1, kGPUImageTiledMedianMaximumWindowSamples);
+}
+
+static NSString *tiledMedianShader(NSString *shaderBody, NSUInteger radius, NSUInteger histogramBins) {
+  return [NSString stringWithFormat:@"%@const int windowSamples = %lu;\nconst int histogramBins = %lu;\n%@", kGPUImageTiledMedianShaderPrecision, (unsigned long)tiledMedianWindowSamples(radius), (unsigned long)histogramBins, shaderBody];
+}
+
+typedef struct {
+  CGSize tileGrid;
+  GLfloat tileStride;
+  NSUInteger slicesPerRow;
+  NSUInteger sliceRows;
+} GPUImageTiledMedianAtlasLayout;
+
+// Wraps the slices into as many rows as needed, and only spaces the tiles further apart when even that doesn't fit within a texture
+static GPUImageTiledMedianAtlasLayout tiledMedianAtlasLayout(CGSize imageSize, GLfloat tileStride, NSUInteger histogramBins) {
+  CGFloat maximumTextureSize = (CGFloat)[GPUImageContext maximumTextureSizeForThisDevice];
+  GPUImageTiledMedianAtlasLayout layout;
+  layout.tileStride = tileStride;
+  while (YES) {
+    layout.tileGrid = CGSizeMake(ceil(imageSize.width / layout.tileStride), ceil(imageSize.height / layout.tileStride));
+    layout.slicesPerRow = MIN(histogramBins, (NSUInteger)floor(maximumTextureSize / layout.tileGrid.width));
+    if (layout.slicesPerRow > 0) {
+      layout.sliceRows = (histogramBins + layout.slicesPerRow - 1) / layout.slicesPerRow;
+      if (layout.sliceRows * layout.tileGrid.height <= maximumTextureSize) {
+        return layout;
+      }
+    }
+    layout.tileStride = ceil(layout.tileStride * 1.25);
+  }
+}
+
+#pragma mark - Median stages
+
+@interface GPUImageTiledMedianCDFFilter : GPUImageFilter
+
+@property (nonatomic, assign) NSUInteger radius;
+@property (nonatomic, assign) NSUInteger histogramBins;
+@property (nonatomic, assign) GLfloat tileStride;
+
+@end
+
+@implementation GPUImageTiledMedianCDFFilter
+
+- (id)initWithRadius:(NSUInteger)radius histogramBins:(NSUInteger)histogramBins tileStride:(GLfloat)tileStride {
+  if ((self = [super initWithFragmentShaderFromString:tiledMedianShader(kGPUImageTiledMedianCDFFragmentShaderString, radius, histogramBins)])) {
+    self.radius = radius;
+    self.histogramBins = histogramBins;
+    self.tileStride = tileStride;
+  }
+  return self;
+}
+
+- (void)setRadius:(NSUInteger)radius histogramBins:(NSUInteger)histogramBins tileStride:(GLfloat)tileStride {
+  BOOL programChanged = (radius != self.radius) || (histogramBins != self.histogramBins);
+  self.radius = radius;
+  self.histogramBins = histogramBins;
+  self.tileStride = tileStride;
+  if (programChanged) {
+    [self switchToVertexShader:kGPUImageVertexShaderString fragmentShader:tiledMedianShader(kGPUImageTiledMedianCDFFragmentShaderString, radius, histogramBins)];
+  } else {
+    [self setupFilterForSize:[self sizeOfFBO]];
+  }
+}
+
+- (CGSize)sizeOfFBO {
+  CGSize imageSize = [self getInputSize:0];
+  if (imageSize.width * imageSize.height <= 0.0) {
+    return imageSize;
+  }
+  GPUImageTiledMedianAtlasLayout layout = tiledMedianAtlasLayout(imageSize, self.tileStride, self.histogramBins);
+  return CGSizeMake(layout.tileGrid.width * layout.slicesPerRow, layout.tileGrid.height * layout.sliceRows);
+}
+
+- (void)setupFilterForSize:(CGSize)filterFrameSize {
+  CGSize imageSize = [self getInputSize:0];
+  if (imageSize.width * imageSize.height > 0.0) {
+    GPUImageTiledMedianAtlasLayout layout = tiledMedianAtlasLayout(imageSize, self.tileStride, self.histogramBins);
+    [self setSize:layout.tileGrid forUniformName:@"tileGrid"];
+    [self setSize:CGSizeMake(layout.slicesPerRow, layout.sliceRows) forUniformName:@"atlasSlices"];
+    [self setSize:CGSizeMake(1.0 / imageSize.width, 1.0 / imageSize.height) forUniformName:@"texelSize"];
+    [self setFloat:layout.tileStride forUniformName:@"tileStride"];
+    [self setFloat:(GLfloat)(2 * self.radius + 1) / tiledMedianWindowSamples(self.radius) forUniformName:@"sampleStep"];
+  }
+}
+
+@end
+
+@interface GPUImageTiledMedianSelectionFilter : GPUImageTwoInputFilter
+
+@property (nonatomic, assign) NSUInteger histogramBins;
+@property (nonatomic, assign) GLfloat tileStride;
+
+@end
+
+@implementation GPUImageTiledMedianSelectionFilter
+
+- (id)initWithHistogramBins:(NSUInteger)histogramBins tileStride:(GLfloat)tileStride {
+  if ((self = [super initWithFragmentShaderFromString:tiledMedianShader(kGPUImageTiledMedianFragmentShaderString, 0, histogramBins)])) {
+    self.histogramBins = histogramBins;
+    self.tileStride = tileStride;
+  }
+  return self;
+}
+
+- (void)setHistogramBins:(NSUInteger)histogramBins tileStride:(GLfloat)tileStride {
+  BOOL programChanged = (histogramBins != self.histogramBins);
+  self.histogramBins = histogramBins;
+  self.tileStride = tileStride;
+  if (programChanged) {
+    [self switchToVertexShader:kGPUImageTwoInputTextureVertexShaderString fragmentShader:tiledMedianShader(kGPUImageTiledMedianFragmentShaderString, 0, histogramBins)];
+  } else {
+    [self setupFilterForSize:[self sizeOfFBO]];
+  }
+}
+
+- (void)setupFilterForSize:(CGSize)filterFrameSize {
+  if (filterFrameSize.width * filterFrameSize.height > 0.0) {
+    GPUImageTiledMedianAtlasLayout layout = tiledMedianAtlasLayout(filterFrameSize, self.tileStride, self.histogramBins);
+    [self setSize:layout.tileGrid forUniformName:@"tileGrid"];
+    [self setSize:CGSizeMake(layout.slicesPerRow, layout.sliceRows) forUniformName:@"atlasSlices"];
+    [self setSize:CGSizeMake(filterFrameSize.width / layout.tileStride, filterFrameSize.height / layout.tileStride) forUniformName:@"tileScale"];
+  }
+}
+
+@end
+
+#pragma mark - Filter group
+
+@interface GPUImageTiledMedianFilter()
+
+@property (nonatomic, strong) GPUImageTiledMedianCDFFilter *distributionFilter;
+@property (nonatomic, strong) GPUImageTiledMedianSelectionFilter *selectionFilter;
+
+@end
+
+@implementation GPUImageTiledMedianFilter
+
+#pragma mark - Initialization and teardown
+
+- (id)init {
+  if ((self = [super init])) {
+    _radius = 5;
+    _quality = 0.5;
+
+    self.distributionFilter = [[GPUImageTiledMedianCDFFilter alloc] initWithRadius:self.radius histogramBins:[self histogramBins] tileStride:[self tileStride]];
+    self.selectionFilter = [[GPUImageTiledMedianSelectionFilter alloc] initWithHistogramBins:[self histogramBins] tileStride:[self tileStride]];
+
+    // The selection pass samples the histograms bilinearly, which half float textures don't support everywhere
+    if ([GPUImageContext deviceSupportsHalfFloatRenderTargets] && [GPUImageContext deviceSupportsHalfFloatLinearFiltering]) {
+      GPUTextureOptions distributionTextureOptions = self.distributionFilter.outputTextureOptions;
+      distributionTextureOptions.internalFormat = GL_RGBA;
+      distributionTextureOptions.format = GL_RGBA;
+      distributionTextureOptions.type = GL_HALF_FLOAT_OES;
+      self.distributionFilter.outputTextureOptions = distributionTextureOptions;
+    }
+
+    [self addFilter:self.distributionFilter];
+    [self addFilter:self.selectionFilter];
+
+    [self.distributionFilter addTarget:self.selectionFilter atTextureLocation:1];
+
+    self.initialFilters = @[self.distributionFilter, self.selectionFilter];
+    self.terminalFilter = self.selectionFilter;
+  }
+  return self;
+}
+
+#pragma mark - Histogram sampling
+
+- (NSUInteger)histogramBins {
+  // Multiples of 8 keep the number of distinct programs small while dragging the quality slider
+  return 16 + 8 * (NSUInteger)round(self.quality * 6.0);
+}
+
+- (GLfloat)tileStride {
+  return MAX(1.0, round((2.0 * self.radius + 1.0) / (1.0 + self.quality)));
+}
+
+- (void)updateHistogram {
+  [self.distributionFilter setRadius:self.radius histogramBins:[self histogramBins] tileStride:[self tileStride]];
+  [self.selectionFilter setHistogramBins:[self histogramBins] tileStride:[self tileStride]];
+}
+
+#pragma mark - Accessors
+
+- (void)setRadius:(NSUInteger)newValue {
+  _radius = MAX(newValue, 1);
+  [self updateHistogram];
+}
+
+- (void)setQuality:(CGFloat)newValue {
+  _quality = MIN(MAX(newValue, 0.0), 1.0);
+  [self updateHistogram];
+}
+
+@end
@@ -0,0 +1,30 @@
+#import "GPUImageOutput.h"
+#import "GPUImageTileScheduler.h"
+
+/** A source showing part of an image too large for a texture, such as a gigapixel panorama, from a tile pyramid
+
+ Only the tiles needed for the visible region at the current zoom are on the GPU, in an LRU cache of a fixed number of tiles, so GPU memory stays bounded regardless of the image size. Missing tiles stream in from the store in the background, and the output is rendered again as they arrive.
+ Make the cache large enough for the tiles of a whole view plus their fallbacks, about (width / tileSize + 2) * (height / tileSize + 2) * 1.5 tiles for the output size.
+ */
+@interface GPUImageTiledPicture : GPUImageOutput
+
+@property (nonatomic, strong, readonly) GPUImageTileScheduler *scheduler;
+
+/// Part of the image shown, normalized with 0.0, 0.0 at the top left. The full image by default
+@property (nonatomic, assign) CGRect visibleRegion;
+
+/// Pixel size of the output
+@property (nonatomic, assign) CGSize outputSize;
+
+/// Whether arriving tiles render the output again, YES by default
+@property (nonatomic, assign) BOOL rendersWhenTilesLoad;
+
+/// Cache room for 64 tiles, 64 MB with 512 * 512 tiles
+- (id)initWithTileStore:(id<GPUImageTileStore>)store outputSize:(CGSize)outputSize;
+- (id)initWithTileStore:(id<GPUImageTileStore>)store outputSize:(CGSize)outputSize maximumNumberOfResidentTiles:(NSUInteger)maximumNumberOfResidentTiles;
+
+// Image rendering
+- (void)processImage;
+- (CGSize)outputImageSize;
+
+@end
@@ -0,0 +1,204 @@
+#import "GPUImageTiledPicture.h"
+#import "GPUImageFilter.h"
+
+@interface GPUImageTiledPicture()
+
+@property (nonatomic, strong, readwrite) GPUImageTileScheduler *scheduler;
+
+@property (nonatomic, strong) GLProgram *tileProgram;
+@property (nonatomic, assign) GLint tilePositionAttribute;
+@property (nonatomic, assign) GLint tileTextureCoordinateAttribute;
+@property (nonatomic, assign) GLint tileInputTextureUniform;
+@property (nonatomic, assign) GLuint tileVertexBuffer;
+
+// Renders requested while one is pending are merged into it
+@property (nonatomic, assign) BOOL isRenderScheduled;
+
+@end
+
+@implementation GPUImageTiledPicture
+
+#pragma mark - Initialization and teardown
+
+- (id)initWithTileStore:(id<GPUImageTileStore>)store outputSize:(CGSize)outputSize {
+  return [self initWithTileStore:store outputSize:outputSize maximumNumberOfResidentTiles:64];
+}
+
+- (id)initWithTileStore:(id<GPUImageTileStore>)store outputSize:(CGSize)outputSize maximumNumberOfResidentTiles:(NSUInteger)maximumNumberOfResidentTiles {
+  NSAssert(outputSize.width * outputSize.height > 0.0, @"Invalid output size");
+  if (!(self = [super init])) {
+    return nil;
+  }
+
+  _outputSize = outputSize;
+  _visibleRegion = CGRectMake(0.0, 0.0, 1.0, 1.0);
+  _rendersWhenTilesLoad = YES;
+
+  GPUImageTileCache *cache = [[GPUImageTileCache alloc] initWithCapacity:maximumNumberOfResidentTiles];
+  cache.evictionBlock = ^(GPUImageTileKey key, id tile) {
+    GLuint texture = [tile unsignedIntValue];
+    glDeleteTextures(1, &texture);
+  };
+
+  self.scheduler = [[GPUImageTileScheduler alloc] initWithStore:store cache:cache callbackQueue:[GPUImageContext sharedContextQueue]];
+  NSUInteger tileSize = [store tileSize];
+  self.scheduler.tileUploadBlock = ^id(GPUImageTileKey key, NSData *data) {
+    [GPUImageContext useImageProcessingContext];
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, (GLsizei)tileSize, (GLsizei)tileSize, 0, GL_BGRA, GL_UNSIGNED_BYTE, [data bytes]);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return @(texture);
+  };
+  __weak typeof(self) weakSelf = self;
+  self.scheduler.tilesDidLoadBlock = ^{
+    __strong typeof(weakSelf) self = weakSelf;
+    if (self.rendersWhenTilesLoad) {
+      [self setNeedsRender];
+    }
+  };
+
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [GPUImageContext useImageProcessingContext];
+    self.tileProgram = [[GLProgram alloc] initWithVertexShaderString:kGPUImageVertexShaderString fragmentShaderString:kGPUImagePassthroughFragmentShaderString];
+    if (!self.tileProgram.initialized) {
+      [self.tileProgram addAttribute:@"position"];
+      [self.tileProgram addAttribute:@"inputTextureCoordinate"];
+      [self.tileProgram link];
+    }
+
+    [GPUImageContext setActiveShaderProgram:self.tileProgram];
+    self.tilePositionAttribute = [self.tileProgram attributeIndex:@"position"];
+    self.tileTextureCoordinateAttribute = [self.tileProgram attributeIndex:@"inputTextureCoordinate"];
+    self.tileInputTextureUniform = [self.tileProgram uniformIndex:@"inputImageTexture"];
+    glEnableVertexAttribArray(self.tilePositionAttribute);
+    glEnableVertexAttribArray(self.tileTextureCoordinateAttribute);
+    glUniform1i(self.tileInputTextureUniform, 2);
+
+    GLuint vertexBuffer;
+    glGenBuffers(1, &vertexBuffer);
+    self.tileVertexBuffer = vertexBuffer;
+  });
+
+  return self;
+}
+
+- (void)dealloc {
+  GPUImageTileScheduler *scheduler = _scheduler;
+  GLuint vertexBuffer = _tileVertexBuffer;
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [GPUImageContext useImageProcessingContext];
+    [scheduler cancelPendingLoads];
+    [scheduler.cache removeAllTiles];
+    GLuint buffer = vertexBuffer;
+    glDeleteBuffers(1, &buffer);
+  });
+}
+
+#pragma mark - Image rendering
+
+- (void)processImage {
+  runAsynchronouslyOnVideoProcessingQueue(^{
+    [self setNeedsRender];
+  });
+}
+
+- (void)setNeedsRender {
+  if (self.isRenderScheduled) {
+    return;
+  }
+  self.isRenderScheduled = YES;
+
+  __weak typeof(self) weakSelf = self;
+  dispatch_async([GPUImageContext sharedContextQueue], ^{
+    __strong typeof(weakSelf) self = weakSelf;
+    if (self) {
+      self.isRenderScheduled = NO;
+      [self renderVisibleTiles];
+    }
+  });
+}
+
+- (void)renderVisibleTiles {
+  [GPUImageContext setActiveShaderProgram:self.tileProgram];
+
+  CGRect region = self.visibleRegion;
+  NSArray *tileKeys = [self.scheduler tilesToDrawForRegion:region outputSize:self.outputSize];
+
+  self.outputFramebuffer = [[GPUImageContext sharedFramebufferCache] fetchFramebufferForSize:self.outputSize textureOptions:self.outputTextureOptions onlyTexture:NO];
+  [self.outputFramebuffer activateFramebuffer];
+  if (self.usingNextFrameForImageCapture) {
+    [self.outputFramebuffer lock];
+  }
+
+  glClearColor(0.0, 0.0, 0.0, 0.0);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  // Two triangles per tile, placed by where the tile lies within the visible region
+  NSUInteger tileCount = [tileKeys count];
+  Vertex2D *vertices = calloc(MAX(tileCount, 1) * 6, sizeof(Vertex2D));
+  for (NSUInteger tile = 0; tile < tileCount; tile++) {
+    GPUImageTileKey key = [tileKeys[tile] unsignedLongLongValue];
+    CGRect tileRegion = [self.scheduler regionOfTile:key];
+    CGRect textureRegion = [self.scheduler textureRegionOfTile:key];
+
+    GLfloat minX = 2.0 * (CGRectGetMinX(tileRegion) - region.origin.x) / region.size.width - 1.0;
+    GLfloat maxX = 2.0 * (CGRectGetMaxX(tileRegion) - region.origin.x) / region.size.width - 1.0;
+    GLfloat minY = 2.0 * (CGRectGetMinY(tileRegion) - region.origin.y) / region.size.height - 1.0;
+    GLfloat maxY = 2.0 * (CGRectGetMaxY(tileRegion) - region.origin.y) / region.size.height - 1.0;
+    GLfloat maxU = CGRectGetMaxX(textureRegion), maxV = CGRectGetMaxY(textureRegion);
+
+    Vertex2D corners[6] = {
+      {minX, minY, 0.0, 0.0}, {maxX, minY, maxU, 0.0}, {minX, maxY, 0.0, maxV},
+      {minX, maxY, 0.0, maxV}, {maxX, minY, maxU, 0.0}, {maxX, maxY, maxU, maxV}
+    };
+    memcpy(vertices + 6 * tile, corners, sizeof(corners));
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, self.tileVertexBuffer);
+  glBufferData(GL_ARRAY_BUFFER, MAX(tileCount, 1) * 6 * sizeof(Vertex2D), vertices, GL_STREAM_DRAW);
+  free(vertices);
+  glVertexAttribPointer(self.tilePositionAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), 0);
+  glVertexAttribPointer(self.tileTextureCoordinateAttribute, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), (GLvoid*)(sizeof(GLfloat) * 2));
+
+  glActiveTexture(GL_TEXTURE2);
+  for (NSUInteger tile = 0; tile < tileCount; tile++) {
+    id texture = [self.scheduler.cache tileForKey:[tileKeys[tile] unsignedLongLongValue]];
+    glBindTexture(GL_TEXTURE_2D, [texture unsignedIntValue]);
+    glDrawArrays(GL_TRIANGLES, (GLint)(6 * tile), 6);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  [self informTargetsAboutNewFrameAtTime:kCMTimeIndefinite];
+}
+
+- (CGSize)outputImageSize {
+  return self.outputSize;
+}
+
+- (CGSize)outputFrameSize {
+  return self.outputSize;
+}
+
+#pragma mark - Accessors
+
+- (void)setVisibleRegion:(CGRect)newValue {
+  NSAssert(newValue.size.width > 0.0 && newValue.size.height > 0.0, @"Invalid visible region");
+  runAsynchronouslyOnVideoProcessingQueue(^{
+    _visibleRegion = newValue;
+  });
+}
+
+- (void)setOutputSize:(CGSize)newValue {
+  NSAssert(newValue.width * newValue.height > 0.0, @"Invalid output size");
+  runAsynchronouslyOnVideoProcessingQueue(^{
+    _outputSize = newValue;
+  });
+}
+
+@end
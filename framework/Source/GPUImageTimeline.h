@@ -0,0 +1,65 @@
+#import "GPUImageSupport.h"
+#import <CoreMedia/CoreMedia.h>
+
+typedef NS_ENUM(NSUInteger, GPUImageKeyframeInterpolation) {
+    /// Keeps the keyframe's value until the next keyframe
+    kGPUImageKeyframeInterpolationHold,
+    kGPUImageKeyframeInterpolationLinear,
+    /// Eases out of the keyframe and into the next one
+    kGPUImageKeyframeInterpolationSmooth
+};
+
+/** Values of one to four components changing over media time, e.g. a blur radius or a vignette centre
+
+ The interpolation of a keyframe applies up to the next one. Before the first keyframe the curve holds its value, and so it does after the last. Curves can be edited from any thread, also while a timeline evaluates them.
+ */
+@interface GPUImageKeyframeCurve : NSObject
+
+@property (nonatomic, assign, readonly) NSUInteger numberOfComponents;
+@property (nonatomic, assign, readonly) NSUInteger keyframeCount;
+
+/// @param numberOfComponents 1 for scalars, 2 for points and sizes, 3 or 4 for vectors
+- (id)initWithNumberOfComponents:(NSUInteger)numberOfComponents;
+
+/// Adds a keyframe, replacing the one already at that time. values holds numberOfComponents values
+- (void)addKeyframeAtTime:(CMTime)time values:(const GLfloat *)values interpolation:(GPUImageKeyframeInterpolation)interpolation;
+- (void)addKeyframeAtTime:(CMTime)time value:(GLfloat)value interpolation:(GPUImageKeyframeInterpolation)interpolation;
+- (void)addKeyframeAtTime:(CMTime)time point:(CGPoint)point interpolation:(GPUImageKeyframeInterpolation)interpolation;
+- (void)removeAllKeyframes;
+
+/// Writes numberOfComponents values. Sequential times are found in constant time, others by binary search
+- (void)evaluateAtTime:(CMTime)time values:(GLfloat *)values;
+
+@end
+
+/** Drives properties of filters from keyframe curves, all evaluated at once for the presentation time of the frame being rendered
+
+ Setting parameters from timers on the main thread updates them whenever the timer fires, so an exported movie doesn't match its preview. A filter bound to a timeline instead brings every binding of the timeline to the time of a frame before rendering it, on the video processing queue, once per frame time however many filters are bound. Offline renders through GPUImageMovie into GPUImageMovieWriter get the same values on every run.
+
+ Only GPUImageFilter and its subclasses advance the timeline, from their own renders. Bindings on other objects, such as filter groups, cameras, movies or objects outside the chain, are brought along whenever a filter bound to the same timeline renders a frame. A timeline without bound filters has to be advanced by its owner, e.g. from a frameProcessingCompletionBlock.
+
+ Only frames with numeric timestamps advance the timeline. For stills, or to drive the timeline with synthetic times, call -applyAtTime:.
+ */
+@interface GPUImageTimeline : NSObject
+
+/// The time the bindings were brought to last, invalid until then
+@property (nonatomic, assign, readonly) CMTime lastAppliedTime;
+
+/// Properties set so far. Values that didn't change since the previous frame aren't set again
+@property (nonatomic, assign, readonly) NSUInteger propertyUpdateCount;
+
+/** Drive a property from a curve
+
+ The property may be a float, double or integer for a curve of 1 component, a CGPoint or CGSize for 2, a GPUVector3 for 3 and a GPUVector4 for 4. A GPUImageFilter bound to the timeline advances it before rendering, see the timeline property of GPUImageOutput.
+ */
+- (void)bindCurve:(GPUImageKeyframeCurve *)curve toKey:(NSString *)key ofObject:(id)object;
+- (void)unbindKey:(NSString *)key ofObject:(id)object;
+- (void)removeAllBindings;
+
+/// Bring every binding to frameTime, unless it was already applied last
+- (void)advanceToTime:(CMTime)frameTime;
+
+/// Bring every binding to frameTime, even if it was applied last
+- (void)applyAtTime:(CMTime)frameTime;
+
+@end
@@ -0,0 +1,343 @@
+#import "GPUImageTimeline.h"
+#import "GPUImageOutput.h"
+#import <objc/runtime.h>
+
+typedef struct {
+  Float64 time;
+  GLfloat values[4];
+  GPUImageKeyframeInterpolation interpolation;
+} GPUImageKeyframe;
+
+@interface GPUImageKeyframeCurve()
+{
+  NSMutableData *keyframes;
+  // Segment found by the last evaluation, where playback most likely continues
+  NSUInteger segmentHint;
+}
+
+@end
+
+@implementation GPUImageKeyframeCurve
+
+#pragma mark - Initialization and teardown
+
+- (id)initWithNumberOfComponents:(NSUInteger)numberOfComponents {
+  NSParameterAssert(numberOfComponents >= 1 && numberOfComponents <= 4);
+  if (!(self = [super init])) {
+    return nil;
+  }
+
+  _numberOfComponents = numberOfComponents;
+  keyframes = [NSMutableData data];
+
+  return self;
+}
+
+#pragma mark - Keyframes
+
+- (NSUInteger)keyframeCount {
+  @synchronized(self) {
+    return [keyframes length] / sizeof(GPUImageKeyframe);
+  }
+}
+
+- (void)addKeyframeAtTime:(CMTime)time values:(const GLfloat *)values interpolation:(GPUImageKeyframeInterpolation)interpolation {
+  NSParameterAssert(CMTIME_IS_NUMERIC(time));
+  GPUImageKeyframe keyframe = {CMTimeGetSeconds(time), {0.0, 0.0, 0.0, 0.0}, interpolation};
+  memcpy(keyframe.values, values, self.numberOfComponents * sizeof(GLfloat));
+
+  @synchronized(self) {
+    NSUInteger count = [keyframes length] / sizeof(GPUImageKeyframe);
+    GPUImageKeyframe *frames = [keyframes mutableBytes];
+    NSUInteger lower = 0;
+    NSUInteger upper = count;
+    while (lower < upper) {
+      NSUInteger middle = (lower + upper) / 2;
+      if (frames[middle].time < keyframe.time) {
+        lower = middle + 1;
+      } else {
+        upper = middle;
+      }
+    }
+
+    if (lower < count && frames[lower].time == keyframe.time) {
+      frames[lower] = keyframe;
+    } else {
+      [keyframes replaceBytesInRange:NSMakeRange(lower * sizeof(GPUImageKeyframe), 0) withBytes:&keyframe length:sizeof(GPUImageKeyframe)];
+    }
+    segmentHint = 0;
+  }
+}
+
+- (void)addKeyframeAtTime:(CMTime)time value:(GLfloat)value interpolation:(GPUImageKeyframeInterpolation)interpolation {
+  NSAssert(self.numberOfComponents == 1, @"Scalar keyframe on a curve of %lu components", (unsigned long)self.numberOfComponents);
+  [self addKeyframeAtTime:time values:&value interpolation:interpolation];
+}
+
+- (void)addKeyframeAtTime:(CMTime)time point:(CGPoint)point interpolation:(GPUImageKeyframeInterpolation)interpolation {
+  NSAssert(self.numberOfComponents == 2, @"Point keyframe on a curve of %lu components", (unsigned long)self.numberOfComponents);
+  GLfloat values[2] = {point.x, point.y};
+  [self addKeyframeAtTime:time values:values interpolation:interpolation];
+}
+
+- (void)removeAllKeyframes {
+  @synchronized(self) {
+    [keyframes setLength:0];
+    segmentHint = 0;
+  }
+}
+
+#pragma mark - Evaluation
+
+- (void)evaluateAtTime:(CMTime)time values:(GLfloat *)values {
+  NSUInteger numberOfComponents = self.numberOfComponents;
+  Float64 seconds = CMTimeGetSeconds(time);
+
+  @synchronized(self) {
+    NSUInteger count = [keyframes length] / sizeof(GPUImageKeyframe);
+    const GPUImageKeyframe *frames = [keyframes bytes];
+    if (count == 0) {
+      memset(values, 0, numberOfComponents * sizeof(GLfloat));
+      return;
+    }
+    // Also catches times that aren't numeric
+    if (!(seconds > frames[0].time)) {
+      memcpy(values, frames[0].values, numberOfComponents * sizeof(GLfloat));
+      return;
+    }
+    if (seconds >= frames[count - 1].time) {
+      memcpy(values, frames[count - 1].values, numberOfComponents * sizeof(GLfloat));
+      return;
+    }
+
+    // The segment starting at the last keyframe not after the time
+    NSUInteger segment = segmentHint;
+    BOOL hintMatches = (segment + 1 < count) && (frames[segment].time <= seconds) && (seconds < frames[segment + 1].time);
+    if (!hintMatches) {
+      if ((segment + 2 < count) && (frames[segment + 1].time <= seconds) && (seconds < frames[segment + 2].time)) {
+        segment++;
+      } else {
+        NSUInteger lower = 0;
+        NSUInteger upper = count - 1;
+        while (upper - lower > 1) {
+          NSUInteger middle = (lower + upper) / 2;
+          if (frames[middle].time <= seconds) {
+            lower = middle;
+          } else {
+            upper = middle;
+          }
+        }
+        segment = lower;
+      }
+    }
+    segmentHint = segment;
+
+    const GPUImageKeyframe *start = &frames[segment];
+    const GPUImageKeyframe *end = &frames[segment + 1];
+    GLfloat fraction = (seconds - start->time) / (end->time - start->time);
+    switch (start->interpolation) {
+      case kGPUImageKeyframeInterpolationHold: fraction = 0.0; break;
+      case kGPUImageKeyframeInterpolationLinear: break;
+      case kGPUImageKeyframeInterpolationSmooth: fraction = fraction * fraction * (3.0 - 2.0 * fraction); break;
+    }
+    for (NSUInteger component = 0; component < numberOfComponents; component++) {
+      values[component] = start->values[component] + (end->values[component] - start->values[component]) * fraction;
+    }
+  }
+}
+
+@end
+
+#pragma mark - Bindings
+
+typedef NS_ENUM(NSUInteger, GPUImageTimelineValueType) {
+  kGPUImageTimelineValueNumber,
+  kGPUImageTimelineValuePoint,
+  kGPUImageTimelineValueSize,
+  kGPUImageTimelineValueVector3,
+  kGPUImageTimelineValueVector4
+};
+
+@interface GPUImageTimelineBinding : NSObject
+{
+@public
+  GLfloat lastValues[4];
+  BOOL hasLastValues;
+}
+
+@property (nonatomic, strong) id object;
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic, strong) GPUImageKeyframeCurve *curve;
+@property (nonatomic, assign) GPUImageTimelineValueType valueType;
+
+@end
+
+@implementation GPUImageTimelineBinding
+@end
+
+static BOOL timelineValueTypeOfProperty(id object, NSString *key, GPUImageTimelineValueType *valueType, NSUInteger *numberOfComponents) {
+  objc_property_t property = class_getProperty([object class], [key UTF8String]);
+  char *propertyType = (property != NULL) ? property_copyAttributeValue(property, "T") : NULL;
+  if (propertyType == NULL) {
+    return NO;
+  }
+
+  BOOL supported = YES;
+  if (strlen(propertyType) == 1 && strchr("fdcsilqCSILQB", propertyType[0]) != NULL) {
+    *valueType = kGPUImageTimelineValueNumber;
+    *numberOfComponents = 1;
+  } else if (strcmp(propertyType, @encode(CGPoint)) == 0) {
+    *valueType = kGPUImageTimelineValuePoint;
+    *numberOfComponents = 2;
+  } else if (strcmp(propertyType, @encode(CGSize)) == 0) {
+    *valueType = kGPUImageTimelineValueSize;
+    *numberOfComponents = 2;
+  } else if (strcmp(propertyType, @encode(GPUVector3)) == 0) {
+    *valueType = kGPUImageTimelineValueVector3;
+    *numberOfComponents = 3;
+  } else if (strcmp(propertyType, @encode(GPUVector4)) == 0) {
+    *valueType = kGPUImageTimelineValueVector4;
+    *numberOfComponents = 4;
+  } else {
+    supported = NO;
+  }
+  free(propertyType);
+  return supported;
+}
+
+static id boxedTimelineValue(GPUImageTimelineValueType valueType, const GLfloat *values) {
+  switch (valueType) {
+    case kGPUImageTimelineValueNumber: return @(values[0]);
+    case kGPUImageTimelineValuePoint: return [NSValue valueWithCGPoint:CGPointMake(values[0], values[1])];
+    case kGPUImageTimelineValueSize: return [NSValue valueWithCGSize:CGSizeMake(values[0], values[1])];
+    case kGPUImageTimelineValueVector3: {
+      GPUVector3 vector = {values[0], values[1], values[2]};
+      return [NSValue valueWithBytes:&vector objCType:@encode(GPUVector3)];
+    }
+    case kGPUImageTimelineValueVector4: {
+      GPUVector4 vector = {values[0], values[1], values[2], values[3]};
+      return [NSValue valueWithBytes:&vector objCType:@encode(GPUVector4)];
+    }
+  }
+  return nil;
+}
+
+@interface GPUImageTimeline()
+
+// Only touched on the video processing queue
+@property (nonatomic, strong) NSMutableArray *bindings;
+
+@end
+
+@implementation GPUImageTimeline
+
+#pragma mark - Initialization and teardown
+
+- (id)init {
+  if (!(self = [super init])) {
+    return nil;
+  }
+
+  _bindings = [NSMutableArray array];
+  _lastAppliedTime = kCMTimeInvalid;
+
+  return self;
+}
+
+#pragma mark - Bindings
+
+- (void)bindCurve:(GPUImageKeyframeCurve *)curve toKey:(NSString *)key ofObject:(id)object {
+  NSParameterAssert(curve != nil && key != nil && object != nil);
+  GPUImageTimelineValueType valueType = kGPUImageTimelineValueNumber;
+  NSUInteger numberOfComponents = 0;
+  BOOL supported = timelineValueTypeOfProperty(object, key, &valueType, &numberOfComponents);
+  NSAssert(supported, @"%@ has no property %@ of a type the timeline can drive", [object class], key);
+  NSAssert(numberOfComponents == curve.numberOfComponents, @"Curve of %lu components bound to %@ of %lu", (unsigned long)curve.numberOfComponents, key, (unsigned long)numberOfComponents);
+  if (!supported || numberOfComponents != curve.numberOfComponents) {
+    return;
+  }
+
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [self removeBindingOfKey:key ofObject:object];
+
+    GPUImageTimelineBinding *binding = [[GPUImageTimelineBinding alloc] init];
+    binding.object = object;
+    binding.key = key;
+    binding.curve = curve;
+    binding.valueType = valueType;
+    [self.bindings addObject:binding];
+
+    if ([object isKindOfClass:[GPUImageOutput class]]) {
+      [(GPUImageOutput *)object setTimeline:self];
+    }
+  });
+}
+
+- (void)unbindKey:(NSString *)key ofObject:(id)object {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [self removeBindingOfKey:key ofObject:object];
+
+    for (GPUImageTimelineBinding *binding in self.bindings) {
+      if (binding.object == object) {
+        return;
+      }
+    }
+    if ([object isKindOfClass:[GPUImageOutput class]] && [(GPUImageOutput *)object timeline] == self) {
+      [(GPUImageOutput *)object setTimeline:nil];
+    }
+  });
+}
+
+- (void)removeAllBindings {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    for (GPUImageTimelineBinding *binding in self.bindings) {
+      if ([binding.object isKindOfClass:[GPUImageOutput class]] && [(GPUImageOutput *)binding.object timeline] == self) {
+        [(GPUImageOutput *)binding.object setTimeline:nil];
+      }
+    }
+    [self.bindings removeAllObjects];
+  });
+}
+
+- (void)removeBindingOfKey:(NSString *)key ofObject:(id)object {
+  NSIndexSet *indexes = [self.bindings indexesOfObjectsPassingTest:^BOOL(GPUImageTimelineBinding *binding, NSUInteger index, BOOL *stop) {
+    return (binding.object == object) && [binding.key isEqualToString:key];
+  }];
+  [self.bindings removeObjectsAtIndexes:indexes];
+}
+
+#pragma mark - Applying
+
+- (void)advanceToTime:(CMTime)frameTime {
+  if (!CMTIME_IS_NUMERIC(frameTime)) {
+    return;
+  }
+  runSynchronouslyOnVideoProcessingQueue(^{
+    if (CMTIME_IS_VALID(self.lastAppliedTime) && CMTIME_COMPARE_INLINE(frameTime, ==, self.lastAppliedTime)) {
+      return;
+    }
+    [self applyAtTime:frameTime];
+  });
+}
+
+- (void)applyAtTime:(CMTime)frameTime {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    GLfloat values[4];
+    for (GPUImageTimelineBinding *binding in self.bindings) {
+      NSUInteger numberOfComponents = binding.curve.numberOfComponents;
+      [binding.curve evaluateAtTime:frameTime values:values];
+      if (binding->hasLastValues && memcmp(values, binding->lastValues, numberOfComponents * sizeof(GLfloat)) == 0) {
+        continue;
+      }
+      memcpy(binding->lastValues, values, numberOfComponents * sizeof(GLfloat));
+      binding->hasLastValues = YES;
+
+      // Setters called on the video processing queue update their uniforms right away
+      [binding.object setValue:boxedTimelineValue(binding.valueType, values) forKey:binding.key];
+      _propertyUpdateCount++;
+    }
+    _lastAppliedTime = frameTime;
+  });
+}
+
+@end
@@ -1,7 +1,14 @@
 #import "GPUImageFilter.h"
 
+/** Samples the natural cubic spline through a set of control points at the 256 input levels, the way GPUImageToneCurveFilter builds its curves
+ @param points Control points with both coordinates in 0...1, in any order. Points on an input level already taken are skipped, and fewer than two distinct points give the identity curve
+ @param curve Filled with the output level in 0...255 of each input level. Levels below the first point are 0, above the last one 255
+ */
+void GPUImageSolveToneCurve(const CGPoint *points, NSUInteger pointCount, GLfloat *curve);
+
 @interface GPUImageToneCurveFilter : GPUImageFilter
 
+// Setting the points of one channel only solves that channel again
 @property(readwrite, nonatomic, copy) NSArray *redControlPoints;
 @property(readwrite, nonatomic, copy) NSArray *greenControlPoints;
 @property(readwrite, nonatomic, copy) NSArray *blueControlPoints;
@@ -22,6 +29,7 @@
 - (void)setPointsWithACVURL:(NSURL*)curveFileURL;
 
 // Curve calculation
+// The filter solves its curves with GPUImageSolveToneCurve(), these boxed versions are kept for existing callers.
 - (NSMutableArray *)getPreparedSplineCurve:(NSArray *)points;
 - (NSMutableArray *)splineCurve:(NSArray *)points;
 - (NSMutableArray *)secondDerivative:(NSArray *)cgPoints;
@@ -133,14 +133,126 @@ NSString *const kGPUImageToneCurveFragmentShaderString = SHADER_STRING
  }
 );
 #endif
+#pragma mark -
+#pragma mark Curve solving
+
+void GPUImageSolveToneCurve(const CGPoint *points, NSUInteger pointCount, GLfloat *curve)
+{
+    // Sorted by input level in 0...255, dropping points on an input level already taken
+    GLfloat x[MAX(pointCount, 1)], y[MAX(pointCount, 1)];
+    NSUInteger count = 0;
+    for (NSUInteger pointIndex = 0; pointIndex < pointCount; pointIndex++)
+    {
+        GLfloat pointX = points[pointIndex].x * 255.0f, pointY = points[pointIndex].y * 255.0f;
+        NSUInteger insertion = count;
+        while (insertion > 0 && x[insertion - 1] > pointX)
+        {
+            insertion--;
+        }
+        if (insertion > 0 && x[insertion - 1] == pointX)
+        {
+            continue;
+        }
+        memmove(x + insertion + 1, x + insertion, (count - insertion) * sizeof(GLfloat));
+        memmove(y + insertion + 1, y + insertion, (count - insertion) * sizeof(GLfloat));
+        x[insertion] = pointX;
+        y[insertion] = pointY;
+        count++;
+    }
+
+    if (count < 2)
+    {
+        for (NSUInteger level = 0; level < 256; level++)
+        {
+            curve[level] = level;
+        }
+        return;
+    }
+
+    // Natural cubic spline: second derivatives from a tridiagonal system, zero at both ends, solved with the Thomas algorithm
+    GLfloat upperDiagonal[count], rightHandSide[count], secondDerivative[count];
+    upperDiagonal[0] = 0.0f;
+    rightHandSide[0] = 0.0f;
+    for (NSUInteger i = 1; i < count - 1; i++)
+    {
+        GLfloat lower = (x[i] - x[i - 1]) / 6.0f;
+        GLfloat diagonal = (x[i + 1] - x[i - 1]) / 3.0f;
+        GLfloat upper = (x[i + 1] - x[i]) / 6.0f;
+        GLfloat slopeChange = (y[i + 1] - y[i]) / (x[i + 1] - x[i]) - (y[i] - y[i - 1]) / (x[i] - x[i - 1]);
+        GLfloat pivot = diagonal - lower * upperDiagonal[i - 1];
+        upperDiagonal[i] = upper / pivot;
+        rightHandSide[i] = (slopeChange - lower * rightHandSide[i - 1]) / pivot;
+    }
+    secondDerivative[count - 1] = 0.0f;
+    for (NSInteger i = count - 2; i > 0; i--)
+    {
+        secondDerivative[i] = rightHandSide[i] - upperDiagonal[i] * secondDerivative[i + 1];
+    }
+    secondDerivative[0] = 0.0f;
+
+    // Levels below the first point are black and above the last one white, as getPreparedSplineCurve: has them
+    NSInteger firstLevel = MIN(MAX((NSInteger)x[0], 0), 256);
+    NSInteger lastLevel = MIN(MAX((NSInteger)x[count - 1], -1), 255);
+    for (NSInteger level = 0; level < firstLevel; level++)
+    {
+        curve[level] = 0.0f;
+    }
+
+    // Every level within a segment is independent of the others, which lets the compiler vectorize the inner loop
+    for (NSUInteger segment = 0; segment < count - 1; segment++)
+    {
+        GLfloat width = x[segment + 1] - x[segment];
+        GLfloat curvatureScale = width * width / 6.0f;
+        NSInteger start = MAX((NSInteger)x[segment], 0);
+        NSInteger end = MIN((NSInteger)x[segment + 1], 256);
+        for (NSInteger level = start; level < end; level++)
+        {
+            GLfloat b = (level - x[segment]) / width;
+            GLfloat a = 1.0f - b;
+            GLfloat value = a * y[segment] + b * y[segment + 1] + curvatureScale * ((a * a * a - a) * secondDerivative[segment] + (b * b * b - b) * secondDerivative[segment + 1]);
+            curve[level] = MIN(MAX(value, 0.0f), 255.0f);
+        }
+    }
+
+    if (lastLevel >= 0)
+    {
+        curve[lastLevel] = MIN(MAX(y[count - 1], 0.0f), 255.0f);
+    }
+    for (NSInteger level = lastLevel + 1; level < 256; level++)
+    {
+        curve[level] = 255.0f;
+    }
+}
+
+// Fills one byte of each BGRA texel: the colour curve, then the composite curve on top
+static void composeToneCurveTexture(const GLfloat *colorCurve, const GLfloat *compositeCurve, GLubyte *texelBytes)
+{
+    for (NSUInteger level = 0; level < 256; level++)
+    {
+        GLubyte colorLevel = (GLubyte)colorCurve[level];
+        texelBytes[level * 4] = (GLubyte)compositeCurve[colorLevel];
+    }
+}
+
+enum {
+    kGPUImageToneCurveComposite,
+    kGPUImageToneCurveRed,
+    kGPUImageToneCurveGreen,
+    kGPUImageToneCurveBlue,
+    kGPUImageToneCurveCount
+};
+
+// Byte of the BGRA texels each colour curve ends up in
+static const NSUInteger toneCurveTexelByte[kGPUImageToneCurveCount] = {0, 2, 1, 0};
 
 @interface GPUImageToneCurveFilter()
 {
     GLint toneCurveTextureUniform;
     GLuint toneCurveTexture;
     GLubyte *toneCurveByteArray;
-    
-    NSArray *_redCurve, *_greenCurve, *_blueCurve, *_rgbCompositeCurve;
+
+    // Output level in 0...255 for each input level, solved from the control points
+    GLfloat toneCurves[kGPUImageToneCurveCount][256];
 }
 
 @end
@@ -161,8 +273,11 @@ NSString *const kGPUImageToneCurveFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     toneCurveTextureUniform = [self.filterProgram uniformIndex:@"toneCurveTexture"];
+    [self setInteger:3 forUniform:toneCurveTextureUniform program:self.filterProgram];
 #if TARGET_IPHONE_SIMULATOR || TARGET_OS_IPHONE
     NSArray *defaultCurve = [NSArray arrayWithObjects:[NSValue valueWithCGPoint:CGPointMake(0.0, 0.0)], [NSValue valueWithCGPoint:CGPointMake(0.5, 0.5)], [NSValue valueWithCGPoint:CGPointMake(1.0, 1.0)], nil];
 #else
@@ -182,8 +297,11 @@ NSString *const kGPUImageToneCurveFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     toneCurveTextureUniform = [self.filterProgram uniformIndex:@"toneCurveTexture"];
+    [self setInteger:3 forUniform:toneCurveTextureUniform program:self.filterProgram];
     
     GPUImageACVFile *curve = [[GPUImageACVFile alloc] initWithACVFileData:data];
     
@@ -484,86 +602,80 @@ NSString *const kGPUImageToneCurveFragmentShaderString = SHADER_STRING
 }
 
 - (void)updateToneCurveTexture;
+{
+    [self updateToneCurveTextureForCurve:kGPUImageToneCurveComposite];
+}
+
+// Only rewrites the texels of the colour curve given, or of all three for the composite curve
+- (void)updateToneCurveTextureForCurve:(NSUInteger)curve
 {
     runSynchronouslyOnVideoProcessingQueue(^{
         [GPUImageContext useImageProcessingContext];
-        if (!toneCurveTexture)
+        BOOL isNewTexture = (toneCurveTexture == 0);
+        if (isNewTexture)
         {
-            glActiveTexture(GL_TEXTURE3);
             glGenTextures(1, &toneCurveTexture);
             glBindTexture(GL_TEXTURE_2D, toneCurveTexture);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            
             toneCurveByteArray = calloc(256 * 4, sizeof(GLubyte));
+            for (NSUInteger level = 0; level < 256; level++)
+            {
+                toneCurveByteArray[level * 4 + 3] = 255;
+            }
         }
         else
         {
-            glActiveTexture(GL_TEXTURE3);
             glBindTexture(GL_TEXTURE_2D, toneCurveTexture);
         }
-        
-        if ( ([_redCurve count] >= 256) && ([_greenCurve count] >= 256) && ([_blueCurve count] >= 256) && ([_rgbCompositeCurve count] >= 256))
+
+        for (NSUInteger colorCurve = kGPUImageToneCurveRed; colorCurve <= kGPUImageToneCurveBlue; colorCurve++)
         {
-            for (unsigned int currentCurveIndex = 0; currentCurveIndex < 256; currentCurveIndex++)
+            if (curve == kGPUImageToneCurveComposite || curve == colorCurve)
             {
-                // BGRA for upload to texture
-                GLubyte b = fmin(fmax(currentCurveIndex + [[_blueCurve objectAtIndex:currentCurveIndex] floatValue], 0), 255);
-                toneCurveByteArray[currentCurveIndex * 4] = fmin(fmax(b + [[_rgbCompositeCurve objectAtIndex:b] floatValue], 0), 255);
-                GLubyte g = fmin(fmax(currentCurveIndex + [[_greenCurve objectAtIndex:currentCurveIndex] floatValue], 0), 255);
-                toneCurveByteArray[currentCurveIndex * 4 + 1] = fmin(fmax(g + [[_rgbCompositeCurve objectAtIndex:g] floatValue], 0), 255);
-                GLubyte r = fmin(fmax(currentCurveIndex + [[_redCurve objectAtIndex:currentCurveIndex] floatValue], 0), 255);
-                toneCurveByteArray[currentCurveIndex * 4 + 2] = fmin(fmax(r + [[_rgbCompositeCurve objectAtIndex:r] floatValue], 0), 255);
-                toneCurveByteArray[currentCurveIndex * 4 + 3] = 255;
+                composeToneCurveTexture(toneCurves[colorCurve], toneCurves[kGPUImageToneCurveComposite], toneCurveByteArray + toneCurveTexelByte[colorCurve]);
             }
-            
+        }
+
+        if (isNewTexture)
+        {
             glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 256 /*width*/, 1 /*height*/, 0, GL_BGRA, GL_UNSIGNED_BYTE, toneCurveByteArray);
-        }        
+        }
+        else
+        {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 256, 1, GL_BGRA, GL_UNSIGNED_BYTE, toneCurveByteArray);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
     });
 }
 
+- (void)solveCurve:(NSUInteger)curve fromControlPoints:(NSArray *)controlPoints
+{
+    NSUInteger pointCount = [controlPoints count];
+    CGPoint points[MAX(pointCount, 1)];
+    for (NSUInteger pointIndex = 0; pointIndex < pointCount; pointIndex++)
+    {
+#if TARGET_IPHONE_SIMULATOR || TARGET_OS_IPHONE
+        points[pointIndex] = [[controlPoints objectAtIndex:pointIndex] CGPointValue];
+#else
+        points[pointIndex] = NSPointToCGPoint([[controlPoints objectAtIndex:pointIndex] pointValue]);
+#endif
+    }
+
+    GPUImageSolveToneCurve(points, pointCount, toneCurves[curve]);
+    [self updateToneCurveTextureForCurve:curve];
+}
+
 #pragma mark -
 #pragma mark Rendering
 
-- (void)renderToTextureWithVertices:(const GLfloat *)vertices textureCoordinates:(const GLfloat *)textureCoordinates;
+- (void)render
 {
-    NSAssert(NO, @"not implemented");
-//    if (self.preventRendering)
-//    {
-//        [self.firstInputFramebuffer unlock];
-//        return;
-//    }
-//    
-//    [GPUImageContext setActiveShaderProgram:self.filterProgram];
-//    self.outputFramebuffer = [[GPUImageContext sharedFramebufferCache] fetchFramebufferForSize:[self sizeOfFBO] textureOptions:self.outputTextureOptions onlyTexture:NO];
-//    [self.outputFramebuffer activateFramebuffer];
-//    if (self.usingNextFrameForImageCapture)
-//    {
-//        [self.outputFramebuffer lock];
-//    }
-//
-//    glClearColor(self.backgroundColorRed, self.backgroundColorGreen, self.backgroundColorBlue, self.backgroundColorAlpha);
-//    glClear(GL_COLOR_BUFFER_BIT);
-//    
-//  	glActiveTexture(GL_TEXTURE2);
-//  	glBindTexture(GL_TEXTURE_2D, [self.firstInputFramebuffer texture]);
-//  	glUniform1i(self.filterInputTextureUniform, 2);
-//    
-//    glActiveTexture(GL_TEXTURE3);
-//    glBindTexture(GL_TEXTURE_2D, toneCurveTexture);                
-//    glUniform1i(toneCurveTextureUniform, 3);	
-//    
-//    glVertexAttribPointer(self.filterPositionAttribute, 2, GL_FLOAT, 0, 0, vertices);
-//    glVertexAttribPointer(self.filterTextureCoordinateAttribute, 2, GL_FLOAT, 0, 0, textureCoordinates);
-//    
-//    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-//    [self.firstInputFramebuffer unlock];
-//    if (self.usingNextFrameForImageCapture)
-//    {
-//        dispatch_semaphore_signal(self.imageCaptureSemaphore);
-//    }
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_2D, toneCurveTexture);
+    [super render];
 }
 
 #pragma mark -
@@ -572,51 +684,41 @@ NSString *const kGPUImageToneCurveFragmentShaderString = SHADER_STRING
 - (void)setRGBControlPoints:(NSArray *)points
 {
     _redControlPoints = [points copy];
-    _redCurve = [self getPreparedSplineCurve:_redControlPoints];
+    [self solveCurve:kGPUImageToneCurveRed fromControlPoints:_redControlPoints];
 
     _greenControlPoints = [points copy];
-    _greenCurve = [self getPreparedSplineCurve:_greenControlPoints];
+    [self solveCurve:kGPUImageToneCurveGreen fromControlPoints:_greenControlPoints];
 
     _blueControlPoints = [points copy];
-    _blueCurve = [self getPreparedSplineCurve:_blueControlPoints];
-    
-    [self updateToneCurveTexture];
+    [self solveCurve:kGPUImageToneCurveBlue fromControlPoints:_blueControlPoints];
 }
 
 
 - (void)setRgbCompositeControlPoints:(NSArray *)newValue
 {
   _rgbCompositeControlPoints = [newValue copy];
-  _rgbCompositeCurve = [self getPreparedSplineCurve:_rgbCompositeControlPoints];
-  
-  [self updateToneCurveTexture];
+  [self solveCurve:kGPUImageToneCurveComposite fromControlPoints:_rgbCompositeControlPoints];
 }
 
 
 - (void)setRedControlPoints:(NSArray *)newValue;
 {  
     _redControlPoints = [newValue copy];
-    _redCurve = [self getPreparedSplineCurve:_redControlPoints];
-    
-    [self updateToneCurveTexture];
+    [self solveCurve:kGPUImageToneCurveRed fromControlPoints:_redControlPoints];
 }
 
 
 - (void)setGreenControlPoints:(NSArray *)newValue
 {
     _greenControlPoints = [newValue copy];
-    _greenCurve = [self getPreparedSplineCurve:_greenControlPoints];
-    
-    [self updateToneCurveTexture];
+    [self solveCurve:kGPUImageToneCurveGreen fromControlPoints:_greenControlPoints];
 }
 
 
 - (void)setBlueControlPoints:(NSArray *)newValue
 {
     _blueControlPoints = [newValue copy];
-    _blueCurve = [self getPreparedSplineCurve:_blueControlPoints];
-    
-    [self updateToneCurveTexture];
+    [self solveCurve:kGPUImageToneCurveBlue fromControlPoints:_blueControlPoints];
 }
 
 @end
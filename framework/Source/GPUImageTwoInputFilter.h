@@ -1,5 +1,7 @@
 #import "GPUImageFilter.h"
 
+extern NSString *const kGPUImageTwoInputTextureVertexShaderString;
+
 @interface GPUImageTwoInputFilter : GPUImageFilter
 
 @end
@@ -28,27 +28,9 @@ NSString *const kGPUImageTwoInputTextureVertexShaderString = SHADER_STRING
   return self;
 }
 
+// The second input's attribute, sampler and texture unit are set up by GPUImageFilter from numberOfInputs
 - (void)initNumberOfInputs {
   self.numberOfInputs = NUMBER_OF_INPUT_FRAME_BUFFERS;
 }
 
-- (void)initializeAttributes {
-  [super initializeAttributes];
-  [self.filterProgram addAttribute:@"inputTextureCoordinate2"];
-}
-
-#pragma mark - Setup
-
-- (void)configGL {
-  [super configGL];
-
-  GLuint textureCoordinateAttribute = [self.filterProgram attributeIndex:@"inputTextureCoordinate2"];
-  [self setInputTextureCoordinateAttribute:textureCoordinateAttribute index:1];
-  glEnableVertexAttribArray(textureCoordinateAttribute);
-
-  GLuint textureUniform = [self.filterProgram uniformIndex:@"inputImageTexture2"];
-  [self setInputTextureUniform:textureUniform index:1];
-  glUniform1i(textureUniform, 3);
-}
-
 @end
@@ -3,6 +3,7 @@
 #import <CoreMedia/CoreMedia.h>
 #import "GPUImageContext.h"
 #import "GPUImageOutput.h"
+#import "GPUImageFramePacingController.h"
 
 extern const GLfloat kColorConversion601[];
 extern const GLfloat kColorConversion601FullRange[];
@@ -42,6 +43,12 @@ extern NSString *const kGPUImageYUVVideoRangeConversionForLAFragmentShaderString
 
 @property (nonatomic, strong) dispatch_semaphore_t frameRenderingSemaphore;
 
+/** Decides which frames are rendered when the targets can't keep up, and keeps drop counts and a latency histogram
+
+ The camera applies the controller's resolution scale to its first target with -forceProcessingAtSizeRespectingAspectRatio:, and its target frame rate through frameRate, so set maximumFrameRate to the rate of the session preset before enabling frame rate adaptation.
+ */
+@property (nonatomic, strong, readonly) GPUImageFramePacingController *pacingController;
+
 @property (nonatomic, assign) BOOL captureAsYUV;
 @property (nonatomic, assign) GLuint luminanceTexture;
 @property (nonatomic, assign) GLuint chrominanceTexture;
@@ -122,6 +122,13 @@ NSString *const kGPUImageYUVVideoRangeConversionForLAFragmentShaderString = SHAD
 
 @property (nonatomic, assign) CGSize inputTextureSize;
 
+// The target scaled down by the pacing controller, and the size forced on it before, put back on recovery
+@property (nonatomic, weak) GPUImageOutput *resolutionScaledTarget;
+@property (nonatomic, assign) CGSize resolutionScaledTargetForcedSize;
+@property (nonatomic, assign) BOOL resolutionScaledTargetRespectedAspectRatio;
+
+@property (nonatomic, strong, readwrite) GPUImageFramePacingController *pacingController;
+
 @end
 
 @implementation GPUImageVideoCamera
@@ -144,6 +151,15 @@ NSString *const kGPUImageYUVVideoRangeConversionForLAFragmentShaderString = SHAD
 
         self.frameRenderingSemaphore = dispatch_semaphore_create(1);
 
+        self.pacingController = [[GPUImageFramePacingController alloc] init];
+        __weak typeof(self) weakSelf = self;
+        self.pacingController.resolutionScaleChangedBlock = ^(CGFloat resolutionScale) {
+            [weakSelf applyProcessingResolutionScale:resolutionScale];
+        };
+        self.pacingController.frameRateChangedBlock = ^(int32_t frameRate) {
+            weakSelf.frameRate = frameRate;
+        };
+
         self.frameRate = 0; // This will not set frame rate unless this value gets set to 1 or above
         self.runBenchmark = NO;
         self.capturePaused = NO;
@@ -362,6 +378,7 @@ NSString *const kGPUImageYUVVideoRangeConversionForLAFragmentShaderString = SHAD
     if ([self.captureSession isRunning]) {
         [self.captureSession stopRunning];
     }
+    [self.pacingController removeAllFrames];
 }
 
 - (void)pauseCameraCapture {
@@ -552,6 +569,11 @@ NSString *const kGPUImageYUVVideoRangeConversionForLAFragmentShaderString = SHAD
 
 	CMTime currentTime = CMSampleBufferGetPresentationTimeStamp(sampleBuffer);
 
+    // No target will use the frame, so it isn't even uploaded
+    if (![self targetsWantFrameAtTime:currentTime]) {
+        return;
+    }
+
     [GPUImageContext useImageProcessingContext];
 
     if ([GPUImageContext supportsFastTextureUpload] && self.captureAsYUV) {
@@ -583,8 +605,13 @@ NSString *const kGPUImageYUVVideoRangeConversionForLAFragmentShaderString = SHAD
             glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-            [self getColorConversionForFrame:cameraFrame];
-            [self convertYUVToRGBOutput];
+            // Luminance only chains read the Y plane directly, without the conversion pass and its RGBA framebuffer. Video range luminance would need rescaling and rotated output is laid out by the conversion, so those still go through it
+            if (self.isFullYUVRange && self.inputRotation == kGPUImageNoRotation && [self allTargetsWantMonochromeInput]) {
+                self.outputFramebuffer = [[GPUImageFramebuffer alloc] initWithSize:self.inputTextureSize overriddenTexture:self.luminanceTexture];
+            } else {
+                [self getColorConversionForFrame:cameraFrame];
+                [self convertYUVToRGBOutput];
+            }
 
             [self informTargetsAboutNewFrameAtTime:currentTime];
 
@@ -689,6 +716,10 @@ NSString *const kGPUImageYUVVideoRangeConversionForLAFragmentShaderString = SHAD
   if (self.captureSession.isRunning) {
     if (captureOutput == self.audioOutput) {
       [self processAudioSampleBuffer:sampleBuffer];
+    } else if (captureOutput == self.videoOutput) {
+      // The frame is retained by the controller for as long as it is queued
+      [self.pacingController receiveFrame:(__bridge id)sampleBuffer];
+      [self renderPacedFrames];
     } else {
       if (dispatch_semaphore_wait(self.frameRenderingSemaphore, DISPATCH_TIME_NOW) == 0) {
         CFRetain(sampleBuffer);
@@ -710,6 +741,81 @@ NSString *const kGPUImageYUVVideoRangeConversionForLAFragmentShaderString = SHAD
   }
 }
 
+#pragma mark - Frame pacing
+
+// Frames are queued before the semaphore is tried, and the queue is checked again after releasing it, so a frame arriving while a render finishes is never left behind
+- (void)renderPacedFrames {
+  while (dispatch_semaphore_wait(self.frameRenderingSemaphore, DISPATCH_TIME_NOW) == 0) {
+    id frame = [self.pacingController nextFrameToRender];
+    if (frame != nil) {
+      __weak typeof(self) weakSelf = self;
+      runAsynchronouslyOnVideoProcessingQueue(^{
+        __strong typeof(weakSelf) self = weakSelf;
+        if (self) {
+          CMSampleBufferRef sampleBuffer = (__bridge CMSampleBufferRef)frame;
+          //Feature Detection Hook.
+          if (self.delegate) {
+            [self.delegate willOutputSampleBuffer:sampleBuffer];
+          }
+          [self processVideoSampleBuffer:sampleBuffer];
+          [self.pacingController didFinishRenderingFrame];
+          dispatch_semaphore_signal(self.frameRenderingSemaphore);
+          [self renderPacedFrames];
+        }
+      });
+      return;
+    }
+
+    dispatch_semaphore_signal(self.frameRenderingSemaphore);
+    if (![self.pacingController hasQueuedFrames]) {
+      return;
+    }
+  }
+}
+
+- (void)applyProcessingResolutionScale:(CGFloat)resolutionScale {
+  runAsynchronouslyOnVideoProcessingQueue(^{
+    GPUImageOutput *scaledTarget = self.resolutionScaledTarget;
+    if (resolutionScale >= 1.0) {
+      if (scaledTarget == nil) {
+        return;
+      }
+      CGSize forcedSize = self.resolutionScaledTargetForcedSize;
+      if (self.resolutionScaledTargetRespectedAspectRatio || CGSizeEqualToSize(forcedSize, CGSizeZero)) {
+        [scaledTarget forceProcessingAtSizeRespectingAspectRatio:forcedSize];
+      } else {
+        [scaledTarget forceProcessingAtSize:forcedSize];
+      }
+      self.resolutionScaledTarget = nil;
+      return;
+    }
+
+    if (scaledTarget == nil) {
+      __block GPUImageOutput *firstTarget = nil;
+      [self loopTargetsWithTargetAndTextureIndex:^(id<GPUImageInput> target, NSUInteger textureIndex) {
+        if (firstTarget == nil && [(id)target isKindOfClass:[GPUImageOutput class]]) {
+          firstTarget = (GPUImageOutput *)target;
+        }
+      }];
+      scaledTarget = firstTarget;
+      if (scaledTarget == nil) {
+        return;
+      }
+      self.resolutionScaledTarget = scaledTarget;
+      self.resolutionScaledTargetForcedSize = [scaledTarget forcedProcessingSize];
+      self.resolutionScaledTargetRespectedAspectRatio = [scaledTarget forcedProcessingRespectsAspectRatio];
+    }
+
+    // Scaled from the size the target was forced to, if any
+    CGSize frameSize = self.resolutionScaledTargetForcedSize;
+    if (CGSizeEqualToSize(frameSize, CGSizeZero)) {
+      frameSize = [self outputFrameSize];
+    }
+    CGFloat side = round(MAX(frameSize.width, frameSize.height) * resolutionScale);
+    [scaledTarget forceProcessingAtSizeRespectingAspectRatio:CGSizeMake(side, side)];
+  });
+}
+
 #pragma mark - Accessors
 
 - (void)setAudioEncodingTarget:(GPUImageMovieWriter *)newValue {
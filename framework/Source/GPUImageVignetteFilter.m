@@ -56,6 +56,8 @@ NSString *const kGPUImageVignetteFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     vignetteCenterUniform = [self.filterProgram uniformIndex:@"vignetteCenter"];
     vignetteColorUniform = [self.filterProgram uniformIndex:@"vignetteColor"];
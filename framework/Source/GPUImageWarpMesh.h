@@ -0,0 +1,60 @@
+#import "GPUImageSupport.h"
+
+/** Computes source texture coordinates for a batch of mesh vertices
+
+ x and y are the positions of the vertices in the output, normalized from 0.0 to 1.0 in texture coordinate space. Write the texture coordinates to sample the input at into u and v.
+ All arrays hold count elements. Prefer plain loops without branches over the arrays, so that the compiler can vectorize them.
+ */
+typedef void (^GPUImageWarpMeshMappingBlock)(const GLfloat *x, const GLfloat *y, GLfloat *u, GLfloat *v, NSUInteger count);
+
+/** A regular grid of Vertex3D vertices covering the output, drawn as indexed triangles
+
+ The grid positions never change, only the texture coordinates are recomputed when the mapping does. The mesh doesn't touch OpenGL, so it can be generated and checked without a context.
+ */
+@interface GPUImageWarpMesh : NSObject
+
+/// Grid cells along each axis
+@property (nonatomic, assign, readonly) NSUInteger columns;
+@property (nonatomic, assign, readonly) NSUInteger rows;
+
+/// Whether texture coordinates wrap around horizontally, as longitudes of 360 degree content do
+@property (nonatomic, assign, readonly) BOOL wrapsHorizontally;
+
+/// (columns + 1) * (rows + 1) vertices in row-major order, or four per cell for wrapping meshes, positions in normalized device coordinates
+@property (nonatomic, assign, readonly) const Vertex3D *vertices;
+@property (nonatomic, assign, readonly) NSUInteger vertexCount;
+
+/// Two counter-clockwise triangles per cell, for GL_TRIANGLES with GL_UNSIGNED_SHORT indices
+@property (nonatomic, assign, readonly) const GLushort *indices;
+@property (nonatomic, assign, readonly) NSUInteger indexCount;
+
+/// The largest number of cells along one axis of a square mesh, given 16-bit indices
++ (NSUInteger)maximumNumberOfCellsPerAxis;
++ (NSUInteger)maximumNumberOfCellsPerAxisWrappingHorizontally;
+
+/** Initialize with texture coordinates that reproduce the input unchanged
+ @param columns Number of cells across, at least 1
+ @param rows Number of cells down, at least 1
+ */
+- (id)initWithColumns:(NSUInteger)columns rows:(NSUInteger)rows;
+
+/** Initialize a mesh whose texture coordinates may wrap around horizontally
+
+ Every cell gets vertices of its own, and their horizontal texture coordinates are unwrapped to lie within half a turn of each other, possibly outside 0.0 to 1.0. Draw it with a shader that takes the fractional part, so that cells across the seam interpolate the short way around.
+ Cells containing a pole of the mapping still interpolate across it.
+ */
+- (id)initWithColumns:(NSUInteger)columns rows:(NSUInteger)rows wrapsHorizontally:(BOOL)wrapsHorizontally;
+
+/** Recompute every texture coordinate
+ @param mapping Maps output positions to input texture coordinates, nil for the identity
+ @param rotation The rotation of the input, applied to the mapped coordinates
+ */
+- (void)updateTextureCoordinatesWithMapping:(GPUImageWarpMeshMappingBlock)mapping rotation:(GPUImageRotationMode)rotation;
+
+/** Bounding box of the texture coordinates of every cell overlapping a region of the output
+ @param region Normalized output region
+ @return Unclipped bounds, which may extend past 0.0 to 1.0 for wrapping meshes and mappings reaching outside the input
+ */
+- (CGRect)textureCoordinateBoundsForRegion:(CGRect)region;
+
+@end
@@ -0,0 +1,189 @@
+#import "GPUImageWarpMesh.h"
+
+@interface GPUImageWarpMesh()
+{
+    Vertex3D *meshVertices;
+    GLushort *meshIndices;
+
+    // Structure of arrays over the grid points for the mapping, so that it can run vectorized
+    NSUInteger gridPointCount;
+    GLfloat *gridX, *gridY;
+    GLfloat *mappedU, *mappedV;
+}
+@end
+
+@implementation GPUImageWarpMesh
+
+#pragma mark - Initialization and teardown
+
++ (NSUInteger)maximumNumberOfCellsPerAxis {
+  // (cells + 1)^2 vertices have to be addressable by GLushort indices
+  return 255;
+}
+
++ (NSUInteger)maximumNumberOfCellsPerAxisWrappingHorizontally {
+  // 4 * cells^2 vertices
+  return 128;
+}
+
+- (id)initWithColumns:(NSUInteger)columns rows:(NSUInteger)rows {
+  return [self initWithColumns:columns rows:rows wrapsHorizontally:NO];
+}
+
+- (id)initWithColumns:(NSUInteger)columns rows:(NSUInteger)rows wrapsHorizontally:(BOOL)wrapsHorizontally {
+  NSAssert(columns >= 1 && rows >= 1, @"A mesh needs at least one cell");
+
+  if (!(self = [super init])) {
+    return nil;
+  }
+
+  _columns = columns;
+  _rows = rows;
+  _wrapsHorizontally = wrapsHorizontally;
+  _vertexCount = wrapsHorizontally ? 4 * columns * rows : (columns + 1) * (rows + 1);
+  _indexCount = 6 * columns * rows;
+  NSAssert(_vertexCount <= 65536, @"Too many vertices for 16-bit indices");
+
+  gridPointCount = (columns + 1) * (rows + 1);
+  gridX = calloc(gridPointCount, sizeof(GLfloat));
+  gridY = calloc(gridPointCount, sizeof(GLfloat));
+  mappedU = calloc(gridPointCount, sizeof(GLfloat));
+  mappedV = calloc(gridPointCount, sizeof(GLfloat));
+  meshVertices = calloc(_vertexCount, sizeof(Vertex3D));
+  meshIndices = calloc(_indexCount, sizeof(GLushort));
+
+  NSUInteger point = 0;
+  for (NSUInteger row = 0; row <= rows; row++) {
+    for (NSUInteger column = 0; column <= columns; column++, point++) {
+      gridX[point] = (GLfloat)column / columns;
+      gridY[point] = (GLfloat)row / rows;
+    }
+  }
+
+  for (NSUInteger vertex = 0; vertex < _vertexCount; vertex++) {
+    NSUInteger gridPoint = [self gridPointForVertex:vertex];
+    meshVertices[vertex].x = 2.0 * gridX[gridPoint] - 1.0;
+    meshVertices[vertex].y = 2.0 * gridY[gridPoint] - 1.0;
+    meshVertices[vertex].z = 0.0;
+  }
+
+  NSUInteger index = 0;
+  for (NSUInteger row = 0; row < rows; row++) {
+    for (NSUInteger column = 0; column < columns; column++) {
+      GLushort lowerLeft, lowerRight, upperLeft, upperRight;
+      if (wrapsHorizontally) {
+        lowerLeft = (GLushort)(4 * (row * columns + column));
+        lowerRight = lowerLeft + 1;
+        upperLeft = lowerLeft + 2;
+        upperRight = lowerLeft + 3;
+      } else {
+        lowerLeft = (GLushort)(row * (columns + 1) + column);
+        lowerRight = lowerLeft + 1;
+        upperLeft = (GLushort)(lowerLeft + columns + 1);
+        upperRight = upperLeft + 1;
+      }
+
+      meshIndices[index++] = lowerLeft;
+      meshIndices[index++] = lowerRight;
+      meshIndices[index++] = upperLeft;
+      meshIndices[index++] = upperLeft;
+      meshIndices[index++] = lowerRight;
+      meshIndices[index++] = upperRight;
+    }
+  }
+
+  [self updateTextureCoordinatesWithMapping:nil rotation:kGPUImageNoRotation];
+
+  return self;
+}
+
+- (void)dealloc {
+  free(meshVertices);
+  free(meshIndices);
+  free(gridX);
+  free(gridY);
+  free(mappedU);
+  free(mappedV);
+}
+
+#pragma mark - Accessors
+
+- (const Vertex3D *)vertices {
+  return meshVertices;
+}
+
+- (const GLushort *)indices {
+  return meshIndices;
+}
+
+// Wrapping meshes store the corners of each cell in the order lower left, lower right, upper left, upper right
+- (NSUInteger)gridPointForVertex:(NSUInteger)vertex {
+  if (!self.wrapsHorizontally) {
+    return vertex;
+  }
+  NSUInteger cell = vertex / 4, corner = vertex % 4;
+  NSUInteger row = cell / self.columns + corner / 2;
+  NSUInteger column = cell % self.columns + corner % 2;
+  return row * (self.columns + 1) + column;
+}
+
+#pragma mark - Mapping
+
+- (void)updateTextureCoordinatesWithMapping:(GPUImageWarpMeshMappingBlock)mapping rotation:(GPUImageRotationMode)rotation {
+  if (mapping != NULL) {
+    mapping(gridX, gridY, mappedU, mappedV, gridPointCount);
+  } else {
+    memcpy(mappedU, gridX, gridPointCount * sizeof(GLfloat));
+    memcpy(mappedV, gridY, gridPointCount * sizeof(GLfloat));
+  }
+
+  GLfloat cellReferenceU = 0.0;
+  for (NSUInteger vertex = 0; vertex < self.vertexCount; vertex++) {
+    NSUInteger gridPoint = [self gridPointForVertex:vertex];
+    CGPoint textureCoordinate = CGPointMake(mappedU[gridPoint], mappedV[gridPoint]);
+    if (self.wrapsHorizontally) {
+      if (vertex % 4 == 0) {
+        cellReferenceU = textureCoordinate.x;
+      } else {
+        textureCoordinate.x -= round(textureCoordinate.x - cellReferenceU);
+      }
+    }
+    if (rotation != kGPUImageNoRotation) {
+      textureCoordinate = rotatedPoint(textureCoordinate, rotation);
+    }
+    meshVertices[vertex].u = textureCoordinate.x;
+    meshVertices[vertex].v = textureCoordinate.y;
+  }
+}
+
+- (CGRect)textureCoordinateBoundsForRegion:(CGRect)region {
+  NSInteger firstColumn = MAX((NSInteger)floor(CGRectGetMinX(region) * self.columns), 0);
+  NSInteger lastColumn = MIN((NSInteger)ceil(CGRectGetMaxX(region) * self.columns) - 1, (NSInteger)self.columns - 1);
+  NSInteger firstRow = MAX((NSInteger)floor(CGRectGetMinY(region) * self.rows), 0);
+  NSInteger lastRow = MIN((NSInteger)ceil(CGRectGetMaxY(region) * self.rows) - 1, (NSInteger)self.rows - 1);
+  if (firstColumn > lastColumn || firstRow > lastRow) {
+    return CGRectNull;
+  }
+
+  GLfloat minU = INFINITY, minV = INFINITY, maxU = -INFINITY, maxV = -INFINITY;
+  for (NSInteger row = firstRow; row <= lastRow; row++) {
+    for (NSInteger column = firstColumn; column <= lastColumn; column++) {
+      for (NSUInteger corner = 0; corner < 4; corner++) {
+        NSUInteger vertex;
+        if (self.wrapsHorizontally) {
+          vertex = 4 * (row * self.columns + column) + corner;
+        } else {
+          vertex = (row + corner / 2) * (self.columns + 1) + column + corner % 2;
+        }
+        minU = MIN(minU, meshVertices[vertex].u);
+        maxU = MAX(maxU, meshVertices[vertex].u);
+        minV = MIN(minV, meshVertices[vertex].v);
+        maxV = MAX(maxV, meshVertices[vertex].v);
+      }
+    }
+  }
+
+  return CGRectMake(minU, minV, maxU - minU, maxV - minV);
+}
+
+@end
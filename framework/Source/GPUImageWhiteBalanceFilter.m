@@ -76,6 +76,8 @@ NSString *const kGPUImageWhiteBalanceFragmentShaderString = SHADER_STRING
     {
 		return nil;
     }
+
+    self.samplingFootprint = CGSizeZero;
     
     temperatureUniform = [self.filterProgram uniformIndex:@"temperature"];
 	tintUniform = [self.filterProgram uniformIndex:@"tint"];
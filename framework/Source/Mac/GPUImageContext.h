@@ -7,6 +7,11 @@
 
 #define GPUImageRotationSwapsWidthAndHeight(rotation) (((rotation) == kGPUImageRotateLeft) || ((rotation) == kGPUImageRotateRight) || ((rotation) == kGPUImageRotateRightFlipVertical) )
 
+// The OpenGL ES name of the half float type, for code shared with iOS behind +deviceSupportsHalfFloatRenderTargets
+#ifndef GL_HALF_FLOAT_OES
+#define GL_HALF_FLOAT_OES 0x8D61
+#endif
+
 typedef enum { kGPUImageNoRotation, kGPUImageRotateLeft, kGPUImageRotateRight, kGPUImageFlipVertical, kGPUImageFlipHorizonal, kGPUImageRotateRightFlipVertical, kGPUImageRotateRightFlipHorizontal, kGPUImageRotate180 } GPUImageRotationMode;
 
 @interface GPUImageContext : NSObject
@@ -27,6 +32,9 @@ typedef enum { kGPUImageNoRotation, kGPUImageRotateLeft, kGPUImageRotateRight, k
 + (BOOL)deviceSupportsOpenGLESExtension:(NSString *)extension;
 + (BOOL)deviceSupportsRedTextures;
 + (BOOL)deviceSupportsFramebufferReads;
++ (BOOL)deviceSupportsHalfFloatRenderTargets;
++ (BOOL)deviceSupportsHalfFloatLinearFiltering;
++ (BOOL)deviceSupportsFloatRenderTargets;
 + (CGSize)sizeThatFitsWithinATextureForSize:(CGSize)inputSize;
 
 - (void)presentBufferForDisplay;
@@ -124,6 +124,23 @@ static void *openGLESContextQueueKey;
     return NO;
 }
 
+// GPUImageFramebuffer creates its textures with unsized internal formats, which desktop OpenGL stores as 8 bits per channel whatever the type, so float targets aren't offered here
+
++ (BOOL)deviceSupportsHalfFloatRenderTargets;
+{
+    return NO;
+}
+
++ (BOOL)deviceSupportsHalfFloatLinearFiltering;
+{
+    return NO;
+}
+
++ (BOOL)deviceSupportsFloatRenderTargets;
+{
+    return NO;
+}
+
 // http://www.khronos.org/registry/gles/extensions/EXT/EXT_texture_rg.txt
 
 + (BOOL)deviceSupportsRedTextures;
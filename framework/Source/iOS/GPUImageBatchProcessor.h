@@ -0,0 +1,58 @@
+#import <UIKit/UIKit.h>
+#import "GPUImageOutput.h"
+
+typedef NS_ENUM(NSUInteger, GPUImageBatchOutputFormat) {
+  kGPUImageBatchOutputFormatPNG,
+  kGPUImageBatchOutputFormatJPEG
+};
+
+/** Runs many still images through one filter graph, overlapping the work on consecutive images
+
+ A GPUImagePicture per image decodes, uploads, renders and reads back one image at a time, each stage waiting on the one before. The batch processor instead decodes images ahead on a queue of its own while the video processing queue uploads image N + 1, renders image N and reads back image N - 1. Each readback waits on a fence set after its render rather than on glFinish, so the GPU keeps working on the next image meanwhile. Results are encoded and handed out on a delivery queue, in the order of the input.
+
+ Input textures are kept by the processor and reused for later images of the same size, going back to the shared framebuffer cache when the batch ends. Decoded and read back pixels live in buffers recycled from pools, a read back buffer returning to its pool when the image made from it is released.
+
+ The graph runs from initialFilter to finalFilter. While a batch runs, the processor feeds initialFilter and is a target of finalFilter, so don't drive the graph from elsewhere meanwhile. Batches queue up behind each other.
+ */
+@interface GPUImageBatchProcessor : NSObject <GPUImageInput>
+
+@property (nonatomic, strong, readonly) GPUImageOutput<GPUImageInput> *initialFilter;
+@property (nonatomic, strong, readonly) GPUImageOutput *finalFilter;
+
+/// Images decoded but not yet handed out, which bounds the pooled memory. At least 3 so that the stages overlap, 5 by default
+@property (atomic, assign) NSUInteger maximumImagesInFlight;
+
+/// For kGPUImageBatchOutputFormatJPEG, 0.9 by default
+@property (atomic, assign) CGFloat compressionQuality;
+
+#pragma mark - Statistics
+
+/// Images of the current or last batch handed out so far, or written
+@property (atomic, assign, readonly) NSUInteger processedImageCount;
+
+/// Images of the current or last batch that couldn't be read, processed or written
+@property (atomic, assign, readonly) NSUInteger failedImageCount;
+
+/// Throughput of the current or last batch, from the start of decoding to the last image handed out
+@property (atomic, assign, readonly) double imagesPerSecond;
+
+/// A single filter or a filter group
+- (id)initWithFilter:(GPUImageOutput<GPUImageInput> *)filter;
+- (id)initWithInitialFilter:(GPUImageOutput<GPUImageInput> *)initialFilter finalFilter:(GPUImageOutput *)finalFilter;
+
+/** Filter a batch of images
+ @param images NSURLs of image files or UIImages
+ @param imageHandler Called on the delivery queue for every image in order, with the filtered image or why there isn't one
+ @param completion Called on the delivery queue once every image was handed out, finished being NO if the batch was cancelled
+ */
+- (void)processImages:(NSArray *)images imageHandler:(void (^)(NSUInteger index, UIImage *processedImage, NSError *error))imageHandler completion:(void (^)(BOOL finished))completion;
+
+/** Filter a batch of images into files named after the image files, or image-<index> for UIImages
+ @param completion Called on the delivery queue, with the first error if some image failed
+ */
+- (void)processImages:(NSArray *)images writingToDirectory:(NSURL *)directoryURL format:(GPUImageBatchOutputFormat)format completion:(void (^)(BOOL finished, NSError *error))completion;
+
+/// Stop decoding the batches queued and running. Images already decoded are still handed out
+- (void)cancelProcessing;
+
+@end
@@ -0,0 +1,654 @@
+#import "GPUImageBatchProcessor.h"
+#import <stdatomic.h>
+
+#pragma mark - Buffer pool
+
+@class GPUImageBatchBufferPool;
+
+@interface GPUImageBatchBuffer : NSObject
+
+@property (nonatomic, strong, readonly) NSMutableData *data;
+@property (nonatomic, weak) GPUImageBatchBufferPool *pool;
+
+@end
+
+@implementation GPUImageBatchBuffer
+
+- (id)initWithLength:(NSUInteger)length;
+{
+  if (!(self = [super init]))
+  {
+    return nil;
+  }
+
+  _data = [[NSMutableData alloc] initWithLength:length];
+
+  return self;
+}
+
+@end
+
+/// Pixel buffers kept for reuse, handed out by size and returned once their contents are no longer needed
+@interface GPUImageBatchBufferPool : NSObject
+{
+  NSMutableArray *freeBuffers;
+}
+
+@property (atomic, assign) NSUInteger maximumFreeBufferCount;
+
+- (GPUImageBatchBuffer *)bufferOfLength:(NSUInteger)length;
+- (void)recycleBuffer:(GPUImageBatchBuffer *)buffer;
+
+@end
+
+@implementation GPUImageBatchBufferPool
+
+- (id)init;
+{
+  if (!(self = [super init]))
+  {
+    return nil;
+  }
+
+  freeBuffers = [[NSMutableArray alloc] init];
+  _maximumFreeBufferCount = 4;
+
+  return self;
+}
+
+- (GPUImageBatchBuffer *)bufferOfLength:(NSUInteger)length;
+{
+  GPUImageBatchBuffer *buffer = nil;
+  @synchronized(self)
+  {
+    // Buffers are only reused for images of the same size or smaller, so that a batch of mixed sizes doesn't keep growing them
+    for (NSUInteger bufferIndex = 0; bufferIndex < [freeBuffers count]; bufferIndex++)
+    {
+      GPUImageBatchBuffer *freeBuffer = [freeBuffers objectAtIndex:bufferIndex];
+      if ([freeBuffer.data length] >= length)
+      {
+        buffer = freeBuffer;
+        [freeBuffers removeObjectAtIndex:bufferIndex];
+        break;
+      }
+    }
+  }
+
+  if (buffer == nil)
+  {
+    buffer = [[GPUImageBatchBuffer alloc] initWithLength:length];
+  }
+  buffer.pool = self;
+
+  return buffer;
+}
+
+- (void)recycleBuffer:(GPUImageBatchBuffer *)buffer;
+{
+  @synchronized(self)
+  {
+    if ([freeBuffers count] < self.maximumFreeBufferCount)
+    {
+      [freeBuffers addObject:buffer];
+    }
+  }
+}
+
+@end
+
+static void GPUImageBatchBufferReleaseCallback(void *info, const void *data, size_t size)
+{
+  GPUImageBatchBuffer *buffer = (__bridge_transfer GPUImageBatchBuffer *)info;
+  [buffer.pool recycleBuffer:buffer];
+}
+
+#pragma mark - Pipeline stages
+
+/// One image on its way through the pipeline
+@interface GPUImageBatchItem : NSObject
+
+@property (nonatomic, assign) NSUInteger index;
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, strong) NSError *error;
+@property (nonatomic, assign) CGSize size;
+
+// Decoded BGRA pixels, until uploaded
+@property (nonatomic, strong) GPUImageBatchBuffer *decodedBuffer;
+// The uploaded image, until read back, when the GPU is done reading it
+@property (nonatomic, strong) GPUImageFramebuffer *inputFramebuffer;
+// Output of the graph and the fence after its render, until read back
+@property (nonatomic, strong) GPUImageFramebuffer *outputFramebuffer;
+@property (nonatomic, assign) GLsync renderFence;
+// Read back pixels, until handed out
+@property (nonatomic, strong) GPUImageBatchBuffer *readbackBuffer;
+@property (nonatomic, assign) NSUInteger readbackBytesPerRow;
+@property (nonatomic, assign) CGBitmapInfo readbackBitmapInfo;
+
+@end
+
+@implementation GPUImageBatchItem
+@end
+
+/// Feeds uploaded images into the graph, as GPUImagePicture would
+@interface GPUImageBatchSource : GPUImageOutput
+
+- (void)processFramebuffer:(GPUImageFramebuffer *)framebuffer size:(CGSize)size;
+
+@end
+
+@implementation GPUImageBatchSource
+
+- (void)processFramebuffer:(GPUImageFramebuffer *)framebuffer size:(CGSize)size;
+{
+  self.outputFramebuffer = framebuffer;
+  [self loopTargetsWithTargetAndTextureIndex:^(id<GPUImageInput> target, NSUInteger textureIndex) {
+    [target setInputSize:size index:textureIndex];
+    [target setInputFramebuffer:framebuffer index:textureIndex];
+    [target newFrameReadyAtTime:kCMTimeIndefinite atIndex:textureIndex];
+  }];
+  self.outputFramebuffer = nil;
+}
+
+@end
+
+#pragma mark - Batch processor
+
+// Input textures kept between images, enough for the two images between upload and readback and one more
+enum { kGPUImageBatchMaximumFreeInputFramebuffers = 3 };
+
+@interface GPUImageBatchProcessor ()
+{
+  GPUImageBatchSource *batchSource;
+  dispatch_queue_t batchQueue, deliveryQueue;
+  GPUImageBatchBufferPool *decodedBufferPool, *readbackBufferPool;
+
+  // Only touched on the video processing queue
+  GPUImageBatchItem *uploadedItem, *renderedItem, *capturingItem;
+  GPUImageFramebuffer *incomingFramebuffer;
+  NSMutableArray *freeInputFramebuffers;
+  BOOL usesFences;
+
+  dispatch_semaphore_t inFlightSemaphore;
+  GLint maximumTextureSize;
+  CFAbsoluteTime batchStartTime;
+  atomic_int cancellationGeneration;
+}
+
+@property (atomic, assign, readwrite) NSUInteger processedImageCount;
+@property (atomic, assign, readwrite) NSUInteger failedImageCount;
+@property (atomic, assign, readwrite) double imagesPerSecond;
+
+- (void)runBatch:(NSArray *)images generation:(int)generation deliveryBlock:(void (^)(GPUImageBatchItem *item, UIImage *processedImage))deliveryBlock;
+- (GPUImageBatchItem *)decodeImage:(id)image atIndex:(NSUInteger)index;
+- (void)advancePipelineWithItem:(GPUImageBatchItem *)newItem deliveryBlock:(void (^)(GPUImageBatchItem *item, UIImage *processedImage))deliveryBlock;
+- (void)readBackItem:(GPUImageBatchItem *)item;
+- (GPUImageFramebuffer *)inputFramebufferForSize:(CGSize)size;
+- (void)recycleInputFramebuffer:(GPUImageFramebuffer *)framebuffer;
+- (void)releaseInputFramebuffers;
+- (void)deliverItem:(GPUImageBatchItem *)item deliveryBlock:(void (^)(GPUImageBatchItem *item, UIImage *processedImage))deliveryBlock;
+
+@end
+
+@implementation GPUImageBatchProcessor
+
+@synthesize initialFilter = _initialFilter;
+@synthesize finalFilter = _finalFilter;
+@synthesize maximumImagesInFlight = _maximumImagesInFlight;
+@synthesize compressionQuality = _compressionQuality;
+@synthesize processedImageCount = _processedImageCount;
+@synthesize failedImageCount = _failedImageCount;
+@synthesize imagesPerSecond = _imagesPerSecond;
+
+#pragma mark - Initialization and teardown
+
+- (id)initWithFilter:(GPUImageOutput<GPUImageInput> *)filter;
+{
+  return [self initWithInitialFilter:filter finalFilter:filter];
+}
+
+- (id)initWithInitialFilter:(GPUImageOutput<GPUImageInput> *)initialFilter finalFilter:(GPUImageOutput *)finalFilter;
+{
+  if (!(self = [super init]))
+  {
+    return nil;
+  }
+
+  _initialFilter = initialFilter;
+  _finalFilter = finalFilter;
+  _maximumImagesInFlight = 5;
+  _compressionQuality = 0.9;
+
+  batchSource = [[GPUImageBatchSource alloc] init];
+  batchQueue = dispatch_queue_create("com.sunsetlakesoftware.GPUImage.batchDecodingQueue", NULL);
+  deliveryQueue = dispatch_queue_create("com.sunsetlakesoftware.GPUImage.batchDeliveryQueue", NULL);
+  atomic_init(&cancellationGeneration, 0);
+  decodedBufferPool = [[GPUImageBatchBufferPool alloc] init];
+  readbackBufferPool = [[GPUImageBatchBufferPool alloc] init];
+  freeInputFramebuffers = [[NSMutableArray alloc] init];
+
+  return self;
+}
+
+#pragma mark - Batches
+
+- (void)processImages:(NSArray *)images imageHandler:(void (^)(NSUInteger index, UIImage *processedImage, NSError *error))imageHandler completion:(void (^)(BOOL finished))completion;
+{
+  NSArray *imagesToProcess = [images copy];
+  int generation = atomic_load(&cancellationGeneration);
+
+  dispatch_async(batchQueue, ^{
+    [self runBatch:imagesToProcess generation:generation deliveryBlock:^(GPUImageBatchItem *item, UIImage *processedImage) {
+      if (imageHandler)
+      {
+        imageHandler(item.index, processedImage, item.error);
+      }
+    }];
+
+    dispatch_sync(deliveryQueue, ^{
+      if (completion)
+      {
+        completion(generation == atomic_load(&cancellationGeneration));
+      }
+    });
+  });
+}
+
+- (void)processImages:(NSArray *)images writingToDirectory:(NSURL *)directoryURL format:(GPUImageBatchOutputFormat)format completion:(void (^)(BOOL finished, NSError *error))completion;
+{
+  NSArray *imagesToProcess = [images copy];
+  int generation = atomic_load(&cancellationGeneration);
+  NSString *pathExtension = (format == kGPUImageBatchOutputFormatJPEG) ? @"jpg" : @"png";
+  __block NSError *firstError = nil;
+
+  dispatch_async(batchQueue, ^{
+    [self runBatch:imagesToProcess generation:generation deliveryBlock:^(GPUImageBatchItem *item, UIImage *processedImage) {
+      NSError *error = item.error;
+      if (processedImage != nil)
+      {
+        NSData *encodedImage = (format == kGPUImageBatchOutputFormatJPEG) ? UIImageJPEGRepresentation(processedImage, self.compressionQuality) : UIImagePNGRepresentation(processedImage);
+        NSURL *fileURL = [directoryURL URLByAppendingPathComponent:[item.name stringByAppendingPathExtension:pathExtension]];
+        if (![encodedImage writeToURL:fileURL options:NSDataWritingAtomic error:&error])
+        {
+          self.processedImageCount--;
+          self.failedImageCount++;
+        }
+      }
+
+      if ((error != nil) && (firstError == nil))
+      {
+        firstError = error;
+      }
+    }];
+
+    dispatch_sync(deliveryQueue, ^{
+      if (completion)
+      {
+        completion(generation == atomic_load(&cancellationGeneration), firstError);
+      }
+    });
+  });
+}
+
+- (void)cancelProcessing;
+{
+  atomic_fetch_add(&cancellationGeneration, 1);
+}
+
+- (void)runBatch:(NSArray *)images generation:(int)generation deliveryBlock:(void (^)(GPUImageBatchItem *item, UIImage *processedImage))deliveryBlock;
+{
+  self.processedImageCount = 0;
+  self.failedImageCount = 0;
+  self.imagesPerSecond = 0.0;
+  batchStartTime = CFAbsoluteTimeGetCurrent();
+
+  // Three images in flight at least, or the upload of one would wait for the readback of another that waits for it
+  NSUInteger maximumImagesInFlight = MAX(self.maximumImagesInFlight, (NSUInteger)3);
+  inFlightSemaphore = dispatch_semaphore_create(maximumImagesInFlight);
+  decodedBufferPool.maximumFreeBufferCount = maximumImagesInFlight;
+  readbackBufferPool.maximumFreeBufferCount = maximumImagesInFlight;
+
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [GPUImageContext useImageProcessingContext];
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maximumTextureSize);
+    usesFences = [GPUImageContext deviceSupportsOpenGLESExtension:@"GL_APPLE_sync"];
+
+    [batchSource addTarget:_initialFilter];
+    [_finalFilter addTarget:self];
+  });
+
+  for (NSUInteger imageIndex = 0; imageIndex < [images count]; imageIndex++)
+  {
+    dispatch_semaphore_wait(inFlightSemaphore, DISPATCH_TIME_FOREVER);
+    if (generation != atomic_load(&cancellationGeneration))
+    {
+      dispatch_semaphore_signal(inFlightSemaphore);
+      break;
+    }
+
+    GPUImageBatchItem *item;
+    @autoreleasepool {
+      item = [self decodeImage:[images objectAtIndex:imageIndex] atIndex:imageIndex];
+    }
+
+    runAsynchronouslyOnVideoProcessingQueue(^{
+      [self advancePipelineWithItem:item deliveryBlock:deliveryBlock];
+    });
+  }
+
+  // Push the last two images out of the pipeline
+  runSynchronouslyOnVideoProcessingQueue(^{
+    while ((uploadedItem != nil) || (renderedItem != nil))
+    {
+      [self advancePipelineWithItem:nil deliveryBlock:deliveryBlock];
+    }
+
+    [_finalFilter removeTarget:self];
+    [batchSource removeTarget:_initialFilter];
+
+    // Adding the target handed it the filter's last framebuffer
+    [incomingFramebuffer unlock];
+    incomingFramebuffer = nil;
+
+    [self releaseInputFramebuffers];
+  });
+}
+
+#pragma mark - Decoding
+
+- (GPUImageBatchItem *)decodeImage:(id)image atIndex:(NSUInteger)index;
+{
+  GPUImageBatchItem *item = [[GPUImageBatchItem alloc] init];
+  item.index = index;
+
+  UIImage *sourceImage = nil;
+  if ([image isKindOfClass:[NSURL class]])
+  {
+    item.name = [[image lastPathComponent] stringByDeletingPathExtension];
+    sourceImage = [[UIImage alloc] initWithContentsOfFile:[image path]];
+  }
+  else if ([image isKindOfClass:[UIImage class]])
+  {
+    item.name = [NSString stringWithFormat:@"image-%lu", (unsigned long)index];
+    sourceImage = image;
+  }
+
+  CGImageRef cgImage = [sourceImage CGImage];
+  if ((cgImage == NULL) || (CGImageGetWidth(cgImage) == 0) || (CGImageGetHeight(cgImage) == 0))
+  {
+    NSString *reason = [NSString stringWithFormat:@"Image %lu (%@) couldn't be decoded.", (unsigned long)index, image];
+    item.error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadCorruptFileError userInfo:@{NSLocalizedFailureReasonErrorKey : reason}];
+    return item;
+  }
+
+  // Scale down whatever doesn't fit in a texture, keeping the aspect ratio
+  CGSize pixelSize = CGSizeMake(CGImageGetWidth(cgImage), CGImageGetHeight(cgImage));
+  if ((pixelSize.width > maximumTextureSize) || (pixelSize.height > maximumTextureSize))
+  {
+    CGFloat scale = (CGFloat)maximumTextureSize / MAX(pixelSize.width, pixelSize.height);
+    pixelSize = CGSizeMake(MAX(floor(pixelSize.width * scale), 1.0), MAX(floor(pixelSize.height * scale), 1.0));
+  }
+  item.size = pixelSize;
+
+  size_t width = (size_t)pixelSize.width, height = (size_t)pixelSize.height;
+  GPUImageBatchBuffer *decodedBuffer = [decodedBufferPool bufferOfLength:width * height * 4];
+
+  CGColorSpaceRef genericRGBColorspace = CGColorSpaceCreateDeviceRGB();
+  CGContextRef imageContext = CGBitmapContextCreate([decodedBuffer.data mutableBytes], width, height, 8, width * 4, genericRGBColorspace, kCGBitmapByteOrder32Little | kCGImageAlphaPremultipliedFirst);
+  // A recycled buffer still holds the previous image, which would show through transparent parts
+  CGContextClearRect(imageContext, CGRectMake(0.0, 0.0, pixelSize.width, pixelSize.height));
+  CGContextDrawImage(imageContext, CGRectMake(0.0, 0.0, pixelSize.width, pixelSize.height), cgImage);
+  CGContextRelease(imageContext);
+  CGColorSpaceRelease(genericRGBColorspace);
+
+  item.decodedBuffer = decodedBuffer;
+  return item;
+}
+
+#pragma mark - Uploading, rendering and reading back
+
+- (void)advancePipelineWithItem:(GPUImageBatchItem *)newItem deliveryBlock:(void (^)(GPUImageBatchItem *item, UIImage *processedImage))deliveryBlock;
+{
+  [GPUImageContext useImageProcessingContext];
+
+  // Render N, which was uploaded with the previous step
+  GPUImageBatchItem *itemToRender = uploadedItem;
+  if (itemToRender.inputFramebuffer != nil)
+  {
+    capturingItem = itemToRender;
+    [batchSource processFramebuffer:itemToRender.inputFramebuffer size:itemToRender.size];
+    capturingItem = nil;
+
+    if (itemToRender.outputFramebuffer == nil)
+    {
+      NSString *reason = [NSString stringWithFormat:@"The filter graph produced no output for image %lu.", (unsigned long)itemToRender.index];
+      itemToRender.error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadCorruptFileError userInfo:@{NSLocalizedFailureReasonErrorKey : reason}];
+    }
+    else if (usesFences)
+    {
+      itemToRender.renderFence = glFenceSyncAPPLE(GL_SYNC_GPU_COMMANDS_COMPLETE_APPLE, 0);
+    }
+  }
+
+  // Upload N + 1 behind it, so the copy overlaps the render
+  if (newItem.decodedBuffer != nil)
+  {
+    GPUImageFramebuffer *inputFramebuffer = [self inputFramebufferForSize:newItem.size];
+    glBindTexture(GL_TEXTURE_2D, [inputFramebuffer texture]);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, (int)newItem.size.width, (int)newItem.size.height, 0, GL_BGRA, GL_UNSIGNED_BYTE, [newItem.decodedBuffer.data bytes]);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    [decodedBufferPool recycleBuffer:newItem.decodedBuffer];
+    newItem.decodedBuffer = nil;
+    newItem.inputFramebuffer = inputFramebuffer;
+  }
+  glFlush();
+
+  // Read back N - 1, rendered with the previous step and most likely done by now
+  GPUImageBatchItem *itemToReadBack = renderedItem;
+  if (itemToReadBack != nil)
+  {
+    [self readBackItem:itemToReadBack];
+    [self recycleInputFramebuffer:itemToReadBack.inputFramebuffer];
+    itemToReadBack.inputFramebuffer = nil;
+    dispatch_async(deliveryQueue, ^{
+      [self deliverItem:itemToReadBack deliveryBlock:deliveryBlock];
+    });
+  }
+
+  renderedItem = itemToRender;
+  uploadedItem = newItem;
+}
+
+- (void)readBackItem:(GPUImageBatchItem *)item;
+{
+  GPUImageFramebuffer *framebuffer = item.outputFramebuffer;
+  if (framebuffer == nil)
+  {
+    return;
+  }
+
+  if (item.renderFence != NULL)
+  {
+    glClientWaitSyncAPPLE(item.renderFence, GL_SYNC_FLUSH_COMMANDS_BIT_APPLE, GL_TIMEOUT_IGNORED_APPLE);
+    glDeleteSyncAPPLE(item.renderFence);
+    item.renderFence = NULL;
+  }
+  else if ([GPUImageContext supportsFastTextureUpload])
+  {
+    glFinish();
+  }
+
+  CGSize size = framebuffer.size;
+  if ([GPUImageContext supportsFastTextureUpload])
+  {
+    // The framebuffer is backed by a pixel buffer, copied out row by row as its rows may be padded
+    [framebuffer lockForReading];
+    NSUInteger bytesPerRow = [framebuffer bytesPerRow];
+    GPUImageBatchBuffer *readbackBuffer = [readbackBufferPool bufferOfLength:bytesPerRow * (NSUInteger)size.height];
+    memcpy([readbackBuffer.data mutableBytes], [framebuffer byteBuffer], bytesPerRow * (NSUInteger)size.height);
+    [framebuffer unlockAfterReading];
+
+    item.readbackBuffer = readbackBuffer;
+    item.readbackBytesPerRow = bytesPerRow;
+    item.readbackBitmapInfo = kCGBitmapByteOrder32Little | kCGImageAlphaPremultipliedFirst;
+  }
+  else
+  {
+    NSUInteger bytesPerRow = (NSUInteger)size.width * 4;
+    GPUImageBatchBuffer *readbackBuffer = [readbackBufferPool bufferOfLength:bytesPerRow * (NSUInteger)size.height];
+    [framebuffer activateFramebuffer];
+    glReadPixels(0, 0, (int)size.width, (int)size.height, GL_RGBA, GL_UNSIGNED_BYTE, [readbackBuffer.data mutableBytes]);
+
+    item.readbackBuffer = readbackBuffer;
+    item.readbackBytesPerRow = bytesPerRow;
+    item.readbackBitmapInfo = kCGBitmapByteOrderDefault | kCGImageAlphaLast;
+  }
+
+  [framebuffer unlock];
+  item.outputFramebuffer = nil;
+}
+
+#pragma mark - Input textures
+
+- (GPUImageFramebuffer *)inputFramebufferForSize:(CGSize)size;
+{
+  for (NSUInteger framebufferIndex = 0; framebufferIndex < [freeInputFramebuffers count]; framebufferIndex++)
+  {
+    GPUImageFramebuffer *framebuffer = [freeInputFramebuffers objectAtIndex:framebufferIndex];
+    if (CGSizeEqualToSize(framebuffer.size, size))
+    {
+      [freeInputFramebuffers removeObjectAtIndex:framebufferIndex];
+      return framebuffer;
+    }
+  }
+
+  // Filters stop reference counting their inputs once rendered, so the processor holds the texture itself, as GPUImagePicture does
+  GPUImageFramebuffer *framebuffer = [[GPUImageContext sharedFramebufferCache] fetchFramebufferForSize:size onlyTexture:YES];
+  [framebuffer disableReferenceCounting];
+  return framebuffer;
+}
+
+- (void)recycleInputFramebuffer:(GPUImageFramebuffer *)framebuffer;
+{
+  if (framebuffer == nil)
+  {
+    return;
+  }
+
+  [freeInputFramebuffers addObject:framebuffer];
+  // The least recently used texture, likely of a size no longer coming in, goes back to the shared cache
+  if ([freeInputFramebuffers count] > kGPUImageBatchMaximumFreeInputFramebuffers)
+  {
+    GPUImageFramebuffer *oldestFramebuffer = [freeInputFramebuffers firstObject];
+    [freeInputFramebuffers removeObjectAtIndex:0];
+    [oldestFramebuffer enableReferenceCounting];
+    [oldestFramebuffer unlock];
+  }
+}
+
+- (void)releaseInputFramebuffers;
+{
+  for (GPUImageFramebuffer *framebuffer in freeInputFramebuffers)
+  {
+    [framebuffer enableReferenceCounting];
+    [framebuffer unlock];
+  }
+  [freeInputFramebuffers removeAllObjects];
+}
+
+#pragma mark - Delivery
+
+- (void)deliverItem:(GPUImageBatchItem *)item deliveryBlock:(void (^)(GPUImageBatchItem *item, UIImage *processedImage))deliveryBlock;
+{
+  @autoreleasepool {
+    UIImage *processedImage = nil;
+    GPUImageBatchBuffer *readbackBuffer = item.readbackBuffer;
+    if ((item.error == nil) && (readbackBuffer != nil))
+    {
+      CGSize size = item.size;
+      // The buffer goes back to its pool once the image is released
+      CGDataProviderRef dataProvider = CGDataProviderCreateWithData((__bridge_retained void *)readbackBuffer, [readbackBuffer.data bytes], item.readbackBytesPerRow * (size_t)size.height, GPUImageBatchBufferReleaseCallback);
+      CGColorSpaceRef defaultRGBColorSpace = CGColorSpaceCreateDeviceRGB();
+      CGImageRef cgImage = CGImageCreate((size_t)size.width, (size_t)size.height, 8, 32, item.readbackBytesPerRow, defaultRGBColorSpace, item.readbackBitmapInfo, dataProvider, NULL, NO, kCGRenderingIntentDefault);
+      processedImage = [UIImage imageWithCGImage:cgImage];
+      CGImageRelease(cgImage);
+      CGColorSpaceRelease(defaultRGBColorSpace);
+      CGDataProviderRelease(dataProvider);
+    }
+    else if (readbackBuffer != nil)
+    {
+      [readbackBufferPool recycleBuffer:readbackBuffer];
+    }
+    item.readbackBuffer = nil;
+
+    if (processedImage != nil)
+    {
+      self.processedImageCount++;
+    }
+    else
+    {
+      self.failedImageCount++;
+    }
+
+    deliveryBlock(item, processedImage);
+
+    CFAbsoluteTime elapsedTime = CFAbsoluteTimeGetCurrent() - batchStartTime;
+    if (elapsedTime > 0.0)
+    {
+      self.imagesPerSecond = (double)(self.processedImageCount + self.failedImageCount) / elapsedTime;
+    }
+  }
+
+  dispatch_semaphore_signal(inFlightSemaphore);
+}
+
+#pragma mark - GPUImageInput
+
+- (void)newFrameReadyAtTime:(CMTime)frameTime atIndex:(NSInteger)textureIndex;
+{
+  if ((capturingItem != nil) && (capturingItem.outputFramebuffer == nil))
+  {
+    capturingItem.outputFramebuffer = incomingFramebuffer;
+  }
+  else
+  {
+    [incomingFramebuffer unlock];
+  }
+  incomingFramebuffer = nil;
+}
+
+- (void)setInputFramebuffer:(GPUImageFramebuffer *)newInputFramebuffer index:(NSUInteger)index;
+{
+  [incomingFramebuffer unlock];
+  incomingFramebuffer = newInputFramebuffer;
+  [incomingFramebuffer lock];
+}
+
+- (NSInteger)nextAvailableTextureIndex;
+{
+  return 0;
+}
+
+- (void)setInputSize:(CGSize)newSize index:(NSUInteger)index;
+{
+}
+
+- (void)setInputRotation:(GPUImageRotationMode)newInputRotation index:(NSUInteger)index;
+{
+}
+
+- (void)endProcessing;
+{
+}
+
+- (BOOL)shouldIgnoreUpdatesToThisTarget;
+{
+  return NO;
+}
+
+- (BOOL)wantsFrameAtTime:(CMTime)frameTime;
+{
+  return (capturingItem != nil);
+}
+
+@end
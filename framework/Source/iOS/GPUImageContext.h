@@ -5,12 +5,20 @@
 @interface GPUImageContext : NSObject
 
 @property(nonatomic, readonly, strong) EAGLContext *context;
+@property(nonatomic, readonly) dispatch_queue_t contextQueue;
 
 @property(nonatomic, readonly) CVOpenGLESTextureCacheRef coreVideoTextureCache;
 @property(nonatomic, readonly) GPUImageFramebufferCache *framebufferCache;
 
 + (void *)contextKey;
 + (GPUImageContext *)sharedImageProcessingContext;
+/** A further context with a serial queue of its own, in the sharegroup of context
+ 
+ Textures, buffers and programs are shared with context, framebuffer objects aren't. Rendering on its queue runs in parallel with the video processing queue, e.g. for a branch of the graph that shouldn't hold up the rest. Whatever one context rendered has to be flushed before the other reads it.
+ */
++ (GPUImageContext *)contextSharingResourcesWithContext:(GPUImageContext *)context label:(NSString *)label;
+/// The context whose queue the caller runs on, the shared context everywhere else. The class methods below act on it
++ (GPUImageContext *)currentContext;
 + (void)clearContext;
 + (dispatch_queue_t)sharedContextQueue;
 + (GPUImageFramebufferCache *)sharedFramebufferCache;
@@ -20,12 +28,19 @@
 - (void)setContextShaderProgram:(GLProgram *)shaderProgram;
 + (GLProgram *)getActiveShaderProgram;
 - (GLProgram *)getContextShaderProgram;
++ (GLint)maximumTextureSizeForThisDevice;
 + (BOOL)deviceSupportsOpenGLESExtension:(NSString *)extension;
 + (BOOL)deviceSupportsRedTextures;
 + (BOOL)deviceSupportsFramebufferReads;
++ (BOOL)deviceSupportsHalfFloatRenderTargets;
+/// Whether half float textures can be sampled with GL_LINEAR, without it they only work with GL_NEAREST
++ (BOOL)deviceSupportsHalfFloatLinearFiltering;
++ (BOOL)deviceSupportsFloatRenderTargets;
 + (CGSize)sizeThatFitsWithinATextureForSize:(CGSize)inputSize;
 
 - (void)presentBufferForDisplay;
+/// A program for the shaders, shared by everyone asking this context for the same pair. Link it if it isn't initialized yet, and set its uniforms before each use
+- (GLProgram *)programForVertexShaderString:(NSString *)vertexShaderString fragmentShaderString:(NSString *)fragmentShaderString;
 
 - (void)useSharegroup:(EAGLSharegroup *)sharegroup;
 
@@ -48,7 +63,28 @@
 
 - (void)endProcessing;
 - (BOOL)shouldIgnoreUpdatesToThisTarget;
+
+@optional
+/** The part of the input at textureIndex this target reads, normalized to the incoming texture
+
+ Sources render only the union of what their targets need, so a sink showing a small part of a large frame keeps the whole chain above it from processing the rest. Targets that don't implement this need the full frame.
+ */
+- (CGRect)regionOfInterestForInputAtIndex:(NSInteger)textureIndex;
+
+/** Whether this target only ever looks at the luminance of its inputs
+
+ When every target of a YUV source says so, the source hands out its full range Y plane as is, read as (Y, Y, Y, 1), instead of converting each frame to RGBA first. Targets that don't implement this need RGB.
+ */
+- (BOOL)wantsMonochromeInput;
+
+/** Whether this target will use the frame at frameTime, asked before the frame is rendered for it
+
+ Sources and filters render and pass a frame on only while some target wants it, so a branch that is switched off or samples one frame in ten costs nothing the rest of the time. Asked on the video processing queue, possibly several times for the same frame. Targets that don't implement this want every frame, unless they ignore updates.
+ */
+- (BOOL)wantsFrameAtTime:(CMTime)frameTime;
 @end
 
 void runSynchronouslyOnVideoProcessingQueue(void (^block)(void));
 void runAsynchronouslyOnVideoProcessingQueue(void (^block)(void));
+void runSynchronouslyOnContextQueue(GPUImageContext *context, void (^block)(void));
+void runAsynchronouslyOnContextQueue(GPUImageContext *context, void (^block)(void));
@@ -18,14 +18,31 @@ void runAsynchronouslyOnVideoProcessingQueue(void (^block)(void)) {
 	}
 }
 
+void runSynchronouslyOnContextQueue(GPUImageContext *context, void (^block)(void)) {
+  if (dispatch_get_specific([GPUImageContext contextKey]) == (__bridge void *)context) {
+    block();
+  } else {
+    dispatch_sync(context.contextQueue, block);
+  }
+}
+
+void runAsynchronouslyOnContextQueue(GPUImageContext *context, void (^block)(void)) {
+  if (dispatch_get_specific([GPUImageContext contextKey]) == (__bridge void *)context) {
+    block();
+  } else {
+    dispatch_async(context.contextQueue, block);
+  }
+}
+
 @interface GPUImageContext()
 {
     EAGLSharegroup *_sharegroup;
+    NSMutableDictionary *_shaderProgramCache;
 }
 
 @property(nonatomic, readwrite, strong) EAGLContext *context;
 
-@property(nonatomic) dispatch_queue_t contextQueue;
+@property(nonatomic, readwrite) dispatch_queue_t contextQueue;
 
 @property(nonatomic, readwrite) CVOpenGLESTextureCacheRef coreVideoTextureCache;
 @property(nonatomic, readwrite, strong) GPUImageFramebufferCache *framebufferCache;
@@ -36,17 +53,28 @@ void runAsynchronouslyOnVideoProcessingQueue(void (^block)(void)) {
 
 @implementation GPUImageContext
 
-static void *openGLESContextQueueKey;
+static void *openGLESContextQueueKey = &openGLESContextQueueKey;
 
 -(instancetype) initUniqueInstance {
+    return [self initWithQueueLabel:@"com.sunsetlakesoftware.GPUImage.openGLESContextQueue"];
+}
+
+- (instancetype)initWithQueueLabel:(NSString *)label {
     if ((self = [super init])) {
-        openGLESContextQueueKey = &openGLESContextQueueKey;
-        self.contextQueue = dispatch_queue_create("com.sunsetlakesoftware.GPUImage.openGLESContextQueue", DISPATCH_QUEUE_SERIAL);
+        self.contextQueue = dispatch_queue_create(label.UTF8String, DISPATCH_QUEUE_SERIAL);
         dispatch_queue_set_specific(self.contextQueue, openGLESContextQueueKey, (__bridge void *)self, NULL);
+        _shaderProgramCache = [[NSMutableDictionary alloc] init];
     }
     return self;
 }
 
+// Only contexts made by +contextSharingResourcesWithContext:label: go away
+- (void)dealloc {
+    if (_coreVideoTextureCache) {
+        CFRelease(_coreVideoTextureCache);
+    }
+}
+
 + (void *)contextKey {
 	return openGLESContextQueueKey;
 }
@@ -62,6 +90,17 @@ static void *openGLESContextQueueKey;
     return sharedImageProcessingContext;
 }
 
++ (GPUImageContext *)contextSharingResourcesWithContext:(GPUImageContext *)context label:(NSString *)label {
+    GPUImageContext *sharingContext = [[super alloc] initWithQueueLabel:label];
+    [sharingContext useSharegroup:context.context.sharegroup];
+    return sharingContext;
+}
+
++ (GPUImageContext *)currentContext {
+    GPUImageContext *queueContext = (__bridge GPUImageContext *)dispatch_get_specific(openGLESContextQueueKey);
+    return queueContext ?: [self sharedImageProcessingContext];
+}
+
 + (void)clearContext {
     NSAssert(dispatch_get_specific([GPUImageContext contextKey]), @"loopTargetsWithTargetAndTextureIndex - not VideoProcessingQueue");
     GPUImageContext *singleton = [GPUImageContext sharedImageProcessingContext];
@@ -81,7 +120,7 @@ static void *openGLESContextQueueKey;
 }
 
 + (void)useImageProcessingContext {
-    [[GPUImageContext sharedImageProcessingContext] useAsCurrentContext];
+    [[GPUImageContext currentContext] useAsCurrentContext];
 }
 
 - (void)useAsCurrentContext {
@@ -92,8 +131,7 @@ static void *openGLESContextQueueKey;
 }
 
 + (void)setActiveShaderProgram:(GLProgram *)shaderProgram {
-    GPUImageContext *sharedContext = [GPUImageContext sharedImageProcessingContext];
-    [sharedContext setContextShaderProgram:shaderProgram];
+    [[GPUImageContext currentContext] setContextShaderProgram:shaderProgram];
 }
 
 - (void)setContextShaderProgram:(GLProgram *)shaderProgram {
@@ -109,13 +147,27 @@ static void *openGLESContextQueueKey;
 }
 
 + (GLProgram *)getActiveShaderProgram {
-    return [[GPUImageContext sharedImageProcessingContext] getContextShaderProgram];
+    return [[GPUImageContext currentContext] getContextShaderProgram];
 }
 
 - (GLProgram *)getContextShaderProgram {
     return self.currentShaderProgram;
 }
 
++ (GLint)maximumTextureSizeForThisDevice {
+    static dispatch_once_t pred;
+    static GLint maxTextureSize = 0;
+
+    dispatch_once(&pred, ^{
+        runSynchronouslyOnVideoProcessingQueue(^{
+            [self useImageProcessingContext];
+            glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+        });
+    });
+
+    return maxTextureSize;
+}
+
 + (BOOL)deviceSupportsOpenGLESExtension:(NSString *)extension {
     static dispatch_once_t pred;
     static NSArray *extensionNames = nil;
@@ -155,6 +207,45 @@ static void *openGLESContextQueueKey;
     return supportsFramebufferReads;
 }
 
+// http://www.khronos.org/registry/gles/extensions/EXT/EXT_color_buffer_half_float.txt
+
++ (BOOL)deviceSupportsHalfFloatRenderTargets {
+    static dispatch_once_t pred;
+    static BOOL supportsHalfFloatRenderTargets = NO;
+
+    dispatch_once(&pred, ^{
+        supportsHalfFloatRenderTargets = [GPUImageContext deviceSupportsOpenGLESExtension:@"GL_OES_texture_half_float"] && [GPUImageContext deviceSupportsOpenGLESExtension:@"GL_EXT_color_buffer_half_float"];
+    });
+
+    return supportsHalfFloatRenderTargets;
+}
+
+// http://www.khronos.org/registry/gles/extensions/OES/OES_texture_float_linear.txt
+
++ (BOOL)deviceSupportsHalfFloatLinearFiltering {
+    static dispatch_once_t pred;
+    static BOOL supportsHalfFloatLinearFiltering = NO;
+
+    dispatch_once(&pred, ^{
+        supportsHalfFloatLinearFiltering = [GPUImageContext deviceSupportsOpenGLESExtension:@"GL_OES_texture_half_float_linear"];
+    });
+
+    return supportsHalfFloatLinearFiltering;
+}
+
+// http://www.khronos.org/registry/gles/extensions/EXT/EXT_color_buffer_float.txt
+
++ (BOOL)deviceSupportsFloatRenderTargets {
+    static dispatch_once_t pred;
+    static BOOL supportsFloatRenderTargets = NO;
+
+    dispatch_once(&pred, ^{
+        supportsFloatRenderTargets = [GPUImageContext deviceSupportsOpenGLESExtension:@"GL_OES_texture_float"] && [GPUImageContext deviceSupportsOpenGLESExtension:@"GL_EXT_color_buffer_float"];
+    });
+
+    return supportsFloatRenderTargets;
+}
+
 + (CGSize)sizeThatFitsWithinATextureForSize:(CGSize)inputSize {
     [self useImageProcessingContext];
     __block GLint maxTextureSize = 0;
@@ -182,6 +273,16 @@ static void *openGLESContextQueueKey;
     [self.context presentRenderbuffer:GL_RENDERBUFFER];
 }
 
+- (GLProgram *)programForVertexShaderString:(NSString *)vertexShaderString fragmentShaderString:(NSString *)fragmentShaderString {
+    NSString *lookupKeyForShaderProgram = [NSString stringWithFormat:@"V: %@ - F: %@", vertexShaderString, fragmentShaderString];
+    GLProgram *programFromCache = [_shaderProgramCache objectForKey:lookupKeyForShaderProgram];
+    if (programFromCache == nil) {
+        programFromCache = [[GLProgram alloc] initWithVertexShaderString:vertexShaderString fragmentShaderString:fragmentShaderString];
+        [_shaderProgramCache setObject:programFromCache forKey:lookupKeyForShaderProgram];
+    }
+    return programFromCache;
+}
+
 - (void)useSharegroup:(EAGLSharegroup *)sharegroup {
     NSAssert(_context == nil, @"Unable to use a share group when the context has already been created. Call this method before you use the context for the first time.");
     _sharegroup = sharegroup;
@@ -229,13 +330,13 @@ static void *openGLESContextQueueKey;
 
 - (GPUImageFramebufferCache *)framebufferCache {
     if (_framebufferCache == nil) {
-        _framebufferCache = [[GPUImageFramebufferCache alloc] init];
+        _framebufferCache = [[GPUImageFramebufferCache alloc] initWithContext:self];
     }
     return _framebufferCache;
 }
 
 + (GPUImageFramebufferCache *)sharedFramebufferCache {
-    return [[self sharedImageProcessingContext] framebufferCache];
+    return [[self currentContext] framebufferCache];
 }
 
 @end
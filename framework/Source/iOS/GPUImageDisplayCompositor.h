@@ -0,0 +1,45 @@
+#import <Foundation/Foundation.h>
+#import <QuartzCore/QuartzCore.h>
+#import "GPUImageView.h"
+
+/** Draws and presents several GPUImageViews together, once per display refresh
+
+ On its own every GPUImageView draws and presents each frame as soon as it arrives, so an editor showing the original, the filtered and a split comparison pays for three separate draws and presents per frame, at whatever moment each chain finishes. Views added to a compositor only keep the newest frame they receive. On each display refresh the compositor draws every view with a new frame in one pass on the context queue, with the shared display program bound once, then presents them back to back so they reach the screen in the same refresh.
+ Each CAEAGLLayer still needs its own present, but no view waits on another's round trip through the context queue.
+ */
+@interface GPUImageDisplayCompositor : NSObject
+
+@property (nonatomic, strong, readonly) NSArray *views;
+
+/// Display refreshes per composition, 1 by default. 2 composes at 30 fps on a 60 Hz screen
+@property (nonatomic, assign) NSInteger frameInterval;
+
+/// Display refreshes that presented at least one view
+@property (nonatomic, assign, readonly) NSUInteger compositionCount;
+
+- (void)addView:(GPUImageView *)view;
+- (void)removeView:(GPUImageView *)view;
+
+/** Hand over the newest frame of a view, replacing one that hasn't been presented yet
+ @param framebuffer A framebuffer locked for the compositor, it is unlocked once drawn or replaced
+ */
+- (void)enqueueFramebuffer:(GPUImageFramebuffer *)framebuffer forView:(GPUImageView *)view;
+
+/// Draw and present every pending frame now instead of waiting for the next display refresh
+- (void)composeViews;
+
+#pragma mark - Statistics
+
+/// Frames of a view that reached the screen
+- (NSUInteger)presentedFrameCountForView:(GPUImageView *)view;
+
+/// Frames of a view replaced by a newer one before a display refresh came
+- (NSUInteger)skippedFrameCountForView:(GPUImageView *)view;
+
+/// Time from a frame arriving at a view to its present, in seconds
+- (CFTimeInterval)averageLatencyForView:(GPUImageView *)view;
+- (CFTimeInterval)maximumLatencyForView:(GPUImageView *)view;
+
+- (void)resetStatistics;
+
+@end
@@ -0,0 +1,285 @@
+#import "GPUImageDisplayCompositor.h"
+
+@interface GPUImageDisplayCompositorEntry : NSObject
+
+@property (nonatomic, weak) GPUImageView *view;
+
+// The newest frame not presented yet, locked for the compositor
+@property (nonatomic, strong) GPUImageFramebuffer *pendingFramebuffer;
+@property (nonatomic, assign) CFTimeInterval arrivalTime;
+
+@property (nonatomic, assign) NSUInteger presentedFrameCount;
+@property (nonatomic, assign) NSUInteger skippedFrameCount;
+@property (nonatomic, assign) CFTimeInterval totalLatency;
+@property (nonatomic, assign) CFTimeInterval maximumLatency;
+
+@end
+
+@implementation GPUImageDisplayCompositorEntry
+
+@end
+
+// CADisplayLink retains its target, so the compositor is only referenced weakly by it
+@interface GPUImageDisplayCompositorLinkTarget : NSObject
+
+@property (nonatomic, weak) GPUImageDisplayCompositor *compositor;
+
+@end
+
+@interface GPUImageDisplayCompositor()
+
+// Only touched on the video processing queue
+@property (nonatomic, strong) NSMutableArray *entries;
+
+@property (nonatomic, strong) CADisplayLink *displayLink;
+
+// Taken while a composition is scheduled, so that refreshes don't pile up behind a busy context queue
+@property (nonatomic, strong) dispatch_semaphore_t compositionSemaphore;
+
+- (void)displayLinkDidFire;
+
+@end
+
+@implementation GPUImageDisplayCompositorLinkTarget
+
+- (void)displayLinkDidFire:(CADisplayLink *)displayLink {
+  [self.compositor displayLinkDidFire];
+}
+
+@end
+
+@implementation GPUImageDisplayCompositor
+
+#pragma mark - Initialization and teardown
+
+- (id)init {
+  if (!(self = [super init])) {
+    return nil;
+  }
+
+  self.entries = [NSMutableArray array];
+  self.compositionSemaphore = dispatch_semaphore_create(1);
+  _frameInterval = 1;
+
+  return self;
+}
+
+- (void)dealloc {
+  [_displayLink invalidate];
+  NSArray *entries = _entries;
+  runSynchronouslyOnVideoProcessingQueue(^{
+    for (GPUImageDisplayCompositorEntry *entry in entries) {
+      [entry.pendingFramebuffer unlock];
+      entry.pendingFramebuffer = nil;
+    }
+  });
+}
+
+#pragma mark - Views
+
+- (NSArray *)views {
+  __block NSArray *views;
+  runSynchronouslyOnVideoProcessingQueue(^{
+    NSMutableArray *liveViews = [NSMutableArray arrayWithCapacity:[self.entries count]];
+    for (GPUImageDisplayCompositorEntry *entry in self.entries) {
+      if (entry.view != nil) {
+        [liveViews addObject:entry.view];
+      }
+    }
+    views = liveViews;
+  });
+  return views;
+}
+
+- (GPUImageDisplayCompositorEntry *)entryForView:(GPUImageView *)view {
+  for (GPUImageDisplayCompositorEntry *entry in self.entries) {
+    if (entry.view == view) {
+      return entry;
+    }
+  }
+  return nil;
+}
+
+- (void)addView:(GPUImageView *)view {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    if ([self entryForView:view] != nil) {
+      return;
+    }
+    [view.displayCompositor removeView:view];
+
+    GPUImageDisplayCompositorEntry *entry = [[GPUImageDisplayCompositorEntry alloc] init];
+    entry.view = view;
+    [self.entries addObject:entry];
+    view.displayCompositor = self;
+  });
+  [self updateDisplayLink];
+}
+
+- (void)removeView:(GPUImageView *)view {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    GPUImageDisplayCompositorEntry *entry = [self entryForView:view];
+    if (entry == nil) {
+      return;
+    }
+    [entry.pendingFramebuffer unlock];
+    entry.pendingFramebuffer = nil;
+    [self.entries removeObject:entry];
+    if (view.displayCompositor == self) {
+      view.displayCompositor = nil;
+    }
+  });
+  [self updateDisplayLink];
+}
+
+#pragma mark - Display refresh
+
+- (void)setFrameInterval:(NSInteger)frameInterval {
+  _frameInterval = MAX(frameInterval, 1);
+  dispatch_async(dispatch_get_main_queue(), ^{
+    self.displayLink.frameInterval = self.frameInterval;
+  });
+}
+
+// The display link only runs while there are views, and lives on the main run loop
+- (void)updateDisplayLink {
+  __block BOOL hasViews;
+  runSynchronouslyOnVideoProcessingQueue(^{
+    hasViews = [self.entries count] > 0;
+  });
+
+  dispatch_async(dispatch_get_main_queue(), ^{
+    if (hasViews && self.displayLink == nil) {
+      GPUImageDisplayCompositorLinkTarget *linkTarget = [[GPUImageDisplayCompositorLinkTarget alloc] init];
+      linkTarget.compositor = self;
+      self.displayLink = [CADisplayLink displayLinkWithTarget:linkTarget selector:@selector(displayLinkDidFire:)];
+      self.displayLink.frameInterval = self.frameInterval;
+      [self.displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+    } else if (!hasViews && self.displayLink != nil) {
+      [self.displayLink invalidate];
+      self.displayLink = nil;
+    }
+  });
+}
+
+- (void)displayLinkDidFire {
+  if (dispatch_semaphore_wait(self.compositionSemaphore, DISPATCH_TIME_NOW) != 0) {
+    return;
+  }
+
+  __weak typeof(self) weakSelf = self;
+  dispatch_semaphore_t compositionSemaphore = self.compositionSemaphore;
+  runAsynchronouslyOnVideoProcessingQueue(^{
+    [weakSelf composeViews];
+    dispatch_semaphore_signal(compositionSemaphore);
+  });
+}
+
+#pragma mark - Composition
+
+- (void)enqueueFramebuffer:(GPUImageFramebuffer *)framebuffer forView:(GPUImageView *)view {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    GPUImageDisplayCompositorEntry *entry = [self entryForView:view];
+    if (entry == nil) {
+      [framebuffer unlock];
+      return;
+    }
+
+    if (entry.pendingFramebuffer != nil) {
+      [entry.pendingFramebuffer unlock];
+      entry.skippedFrameCount++;
+    }
+    entry.pendingFramebuffer = framebuffer;
+    entry.arrivalTime = CACurrentMediaTime();
+  });
+}
+
+- (void)composeViews {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    [GPUImageContext useImageProcessingContext];
+
+    // Draw everything first, so that the presents go out back to back
+    NSMutableArray *drawnEntries = [NSMutableArray arrayWithCapacity:[self.entries count]];
+    for (GPUImageDisplayCompositorEntry *entry in [self.entries copy]) {
+      GPUImageView *view = entry.view;
+      if (view == nil) {
+        [entry.pendingFramebuffer unlock];
+        [self.entries removeObject:entry];
+        continue;
+      }
+      if (entry.pendingFramebuffer == nil) {
+        continue;
+      }
+
+      [view drawFramebufferForDisplay:entry.pendingFramebuffer];
+      [entry.pendingFramebuffer unlock];
+      entry.pendingFramebuffer = nil;
+      [drawnEntries addObject:entry];
+    }
+
+    if ([drawnEntries count] == 0) {
+      return;
+    }
+
+    for (GPUImageDisplayCompositorEntry *entry in drawnEntries) {
+      [entry.view presentFramebuffer];
+    }
+
+    CFTimeInterval presentTime = CACurrentMediaTime();
+    for (GPUImageDisplayCompositorEntry *entry in drawnEntries) {
+      CFTimeInterval latency = presentTime - entry.arrivalTime;
+      entry.presentedFrameCount++;
+      entry.totalLatency += latency;
+      entry.maximumLatency = MAX(entry.maximumLatency, latency);
+    }
+    _compositionCount++;
+  });
+}
+
+#pragma mark - Statistics
+
+- (NSUInteger)presentedFrameCountForView:(GPUImageView *)view {
+  __block NSUInteger presentedFrameCount;
+  runSynchronouslyOnVideoProcessingQueue(^{
+    presentedFrameCount = [self entryForView:view].presentedFrameCount;
+  });
+  return presentedFrameCount;
+}
+
+- (NSUInteger)skippedFrameCountForView:(GPUImageView *)view {
+  __block NSUInteger skippedFrameCount;
+  runSynchronouslyOnVideoProcessingQueue(^{
+    skippedFrameCount = [self entryForView:view].skippedFrameCount;
+  });
+  return skippedFrameCount;
+}
+
+- (CFTimeInterval)averageLatencyForView:(GPUImageView *)view {
+  __block CFTimeInterval averageLatency;
+  runSynchronouslyOnVideoProcessingQueue(^{
+    GPUImageDisplayCompositorEntry *entry = [self entryForView:view];
+    averageLatency = (entry.presentedFrameCount > 0) ? entry.totalLatency / entry.presentedFrameCount : 0.0;
+  });
+  return averageLatency;
+}
+
+- (CFTimeInterval)maximumLatencyForView:(GPUImageView *)view {
+  __block CFTimeInterval maximumLatency;
+  runSynchronouslyOnVideoProcessingQueue(^{
+    maximumLatency = [self entryForView:view].maximumLatency;
+  });
+  return maximumLatency;
+}
+
+- (void)resetStatistics {
+  runSynchronouslyOnVideoProcessingQueue(^{
+    for (GPUImageDisplayCompositorEntry *entry in self.entries) {
+      entry.presentedFrameCount = 0;
+      entry.skippedFrameCount = 0;
+      entry.totalLatency = 0.0;
+      entry.maximumLatency = 0.0;
+    }
+    _compositionCount = 0;
+  });
+}
+
+@end
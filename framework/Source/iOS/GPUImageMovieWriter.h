@@ -1,6 +1,7 @@
 #import <Foundation/Foundation.h>
 #import <AVFoundation/AVFoundation.h>
 #import "GPUImageContext.h"
+#import "GPUImageAudioLane.h"
 
 extern NSString *const kGPUImageColorSwizzlingFragmentShaderString;
 
@@ -46,8 +47,12 @@ extern NSString *const kGPUImageColorSwizzlingFragmentShaderString;
 @property(nonatomic, assign) CGAffineTransform transform;
 @property(nonatomic, copy) NSArray *metaData;
 @property(nonatomic, assign, getter = isPaused) BOOL paused;
+/// The context frames are written in and on whose queue the writer runs, the shared context by default. Set it before the first frame to write from a context sharing its resources
 @property(nonatomic, retain) GPUImageContext *movieWriterContext;
 
+/// Carries audio to the writer off the video processing queue, once an audio track was added. Add processors and read its statistics here
+@property(nonatomic, readonly) GPUImageAudioLane *audioLane;
+
 // Initialization and teardown
 - (id)initWithMovieURL:(NSURL *)newMovieURL size:(CGSize)newSize;
 - (id)initWithMovieURL:(NSURL *)newMovieURL size:(CGSize)newSize fileType:(NSString *)newFileType outputSettings:(NSDictionary *)outputSettings;
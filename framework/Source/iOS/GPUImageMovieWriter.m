@@ -59,6 +59,8 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
 @synthesize shouldInvalidateAudioSampleWhenDone = _shouldInvalidateAudioSampleWhenDone;
 @synthesize paused = _paused;
 @synthesize movieWriterContext = _movieWriterContext;
+@synthesize audioProcessingCallback = _audioProcessingCallback;
+@synthesize audioLane = _audioLane;
 
 @synthesize delegate = _delegate;
 
@@ -93,9 +95,8 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
     inputRotation = kGPUImageNoRotation;
     
     _movieWriterContext = [GPUImageContext sharedImageProcessingContext];
-    [_movieWriterContext useSharegroup:[[[GPUImageContext sharedImageProcessingContext] context] sharegroup]];
 
-    runSynchronouslyOnVideoProcessingQueue(^{
+    runSynchronouslyOnContextQueue(_movieWriterContext, ^{
         [_movieWriterContext useAsCurrentContext];
         
         if ([GPUImageContext supportsFastTextureUpload])
@@ -228,7 +229,8 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
 {
     alreadyFinishedRecording = NO;
     startTime = kCMTimeInvalid;
-    runSynchronouslyOnVideoProcessingQueue(^{
+    [_audioLane reset];
+    runSynchronouslyOnContextQueue(_movieWriterContext, ^{
         if (audioInputReadyCallback == NULL)
         {
             [assetWriter startWriting];
@@ -253,7 +255,7 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
     }
     
     isRecording = NO;
-    runSynchronouslyOnVideoProcessingQueue(^{
+    runSynchronouslyOnContextQueue(_movieWriterContext, ^{
         alreadyFinishedRecording = YES;
 
         if( assetWriter.status == AVAssetWriterStatusWriting && ! videoEncodingIsFinished )
@@ -261,6 +263,7 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
             videoEncodingIsFinished = YES;
             [assetWriterVideoInput markAsFinished];
         }
+        [_audioLane discardQueuedSampleBuffers];
         if( assetWriter.status == AVAssetWriterStatusWriting && ! audioEncodingIsFinished )
         {
             audioEncodingIsFinished = YES;
@@ -277,13 +280,13 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
 
 - (void)finishRecordingWithCompletionHandler:(void (^)(void))handler;
 {
-    runSynchronouslyOnVideoProcessingQueue(^{
+    runSynchronouslyOnContextQueue(_movieWriterContext, ^{
         isRecording = NO;
         
         if (assetWriter.status == AVAssetWriterStatusCompleted || assetWriter.status == AVAssetWriterStatusCancelled || assetWriter.status == AVAssetWriterStatusUnknown)
         {
             if (handler)
-                runAsynchronouslyOnVideoProcessingQueue(handler);
+                runAsynchronouslyOnContextQueue(_movieWriterContext, handler);
             return;
         }
         if( assetWriter.status == AVAssetWriterStatusWriting && ! videoEncodingIsFinished )
@@ -291,6 +294,8 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
             videoEncodingIsFinished = YES;
             [assetWriterVideoInput markAsFinished];
         }
+        // With video finished the writer takes the audio still queued without waiting to interleave it
+        [_audioLane flush];
         if( assetWriter.status == AVAssetWriterStatusWriting && ! audioEncodingIsFinished )
         {
             audioEncodingIsFinished = YES;
@@ -314,7 +319,7 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
             [assetWriter finishWriting];
 #pragma clang diagnostic pop
             if (handler)
-                runAsynchronouslyOnVideoProcessingQueue(handler);
+                runAsynchronouslyOnContextQueue(_movieWriterContext, handler);
         }
 //#endif
     });
@@ -330,13 +335,11 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
 //    if (_hasAudioTrack && CMTIME_IS_VALID(startTime))
     if (_hasAudioTrack)
     {
-        CFRetain(audioBuffer);
-
         CMTime currentSampleTime = CMSampleBufferGetOutputPresentationTimeStamp(audioBuffer);
         
         if (CMTIME_IS_INVALID(startTime))
         {
-            runSynchronouslyOnVideoProcessingQueue(^{
+            runSynchronouslyOnContextQueue(_movieWriterContext, ^{
                 if ((audioInputReadyCallback == NULL) && (assetWriter.status != AVAssetWriterStatusWriting))
                 {
                     [assetWriter startWriting];
@@ -346,78 +349,12 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
             });
         }
 
-        if (!assetWriterAudioInput.readyForMoreMediaData && _encodingLiveVideo)
-        {
-            NSLog(@"1: Had to drop an audio frame: %@", CFBridgingRelease(CMTimeCopyDescription(kCFAllocatorDefault, currentSampleTime)));
-            if (_shouldInvalidateAudioSampleWhenDone)
-            {
-                CMSampleBufferInvalidate(audioBuffer);
-            }
-            CFRelease(audioBuffer);
-            return;
-        }
-
         previousAudioTime = currentSampleTime;
-        
-        //if the consumer wants to do something with the audio samples before writing, let him.
-        if (self.audioProcessingCallback) {
-            //need to introspect into the opaque CMBlockBuffer structure to find its raw sample buffers.
-            CMBlockBufferRef buffer = CMSampleBufferGetDataBuffer(audioBuffer);
-            CMItemCount numSamplesInBuffer = CMSampleBufferGetNumSamples(audioBuffer);
-            AudioBufferList audioBufferList;
-            
-            CMSampleBufferGetAudioBufferListWithRetainedBlockBuffer(audioBuffer,
-                                                                    NULL,
-                                                                    &audioBufferList,
-                                                                    sizeof(audioBufferList),
-                                                                    NULL,
-                                                                    NULL,
-                                                                    kCMSampleBufferFlag_AudioBufferList_Assure16ByteAlignment,
-                                                                    &buffer
-                                                                    );
-            //passing a live pointer to the audio buffers, try to process them in-place or we might have syncing issues.
-            for (int bufferCount=0; bufferCount < audioBufferList.mNumberBuffers; bufferCount++) {
-                SInt16 *samples = (SInt16 *)audioBufferList.mBuffers[bufferCount].mData;
-                self.audioProcessingCallback(&samples, numSamplesInBuffer);
-            }
-        }
-        
-//        NSLog(@"Recorded audio sample time: %lld, %d, %lld", currentSampleTime.value, currentSampleTime.timescale, currentSampleTime.epoch);
-        void(^write)() = ^() {
-            while( ! assetWriterAudioInput.readyForMoreMediaData && ! _encodingLiveVideo && ! audioEncodingIsFinished ) {
-                NSDate *maxDate = [NSDate dateWithTimeIntervalSinceNow:0.5];
-                //NSLog(@"audio waiting...");
-                [[NSRunLoop currentRunLoop] runUntilDate:maxDate];
-            }
-            if (!assetWriterAudioInput.readyForMoreMediaData)
-            {
-                NSLog(@"2: Had to drop an audio frame %@", CFBridgingRelease(CMTimeCopyDescription(kCFAllocatorDefault, currentSampleTime)));
-            }
-            else if(assetWriter.status == AVAssetWriterStatusWriting)
-            {
-                if (![assetWriterAudioInput appendSampleBuffer:audioBuffer])
-                    NSLog(@"Problem appending audio buffer at time: %@", CFBridgingRelease(CMTimeCopyDescription(kCFAllocatorDefault, currentSampleTime)));
-            }
-            else
-            {
-                //NSLog(@"Wrote an audio frame %@", CFBridgingRelease(CMTimeCopyDescription(kCFAllocatorDefault, currentSampleTime)));
-            }
-
-            if (_shouldInvalidateAudioSampleWhenDone)
-            {
-                CMSampleBufferInvalidate(audioBuffer);
-            }
-            CFRelease(audioBuffer);
-        };
-//        runAsynchronouslyOnContextQueue(_movieWriterContext, write);
-        if( _encodingLiveVideo )
 
+        // Processing and appending happen on the lane's own queue, so audio never waits behind rendering
+        if (![_audioLane enqueueSampleBuffer:audioBuffer])
         {
-            runAsynchronouslyOnVideoProcessingQueue(write);
-        }
-        else
-        {
-            write();
+            NSLog(@"1: Had to drop an audio frame: %@", CFBridgingRelease(CMTimeCopyDescription(kCFAllocatorDefault, currentSampleTime)));
         }
     }
 }
@@ -444,7 +381,7 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
             {
                 if( videoInputReadyCallback && ! videoInputReadyCallback() && ! videoEncodingIsFinished )
                 {
-                    runAsynchronouslyOnVideoProcessingQueue(^{
+                    runAsynchronouslyOnContextQueue(_movieWriterContext, ^{
                         if( assetWriter.status == AVAssetWriterStatusWriting && ! videoEncodingIsFinished )
                         {
                             videoEncodingIsFinished = YES;
@@ -473,7 +410,8 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
             {
                 if( audioInputReadyCallback && ! audioInputReadyCallback() && ! audioEncodingIsFinished )
                 {
-                    runAsynchronouslyOnVideoProcessingQueue(^{
+                    [_audioLane flush];
+                    runAsynchronouslyOnContextQueue(_movieWriterContext, ^{
                         if( assetWriter.status == AVAssetWriterStatusWriting && ! audioEncodingIsFinished )
                         {
                             audioEncodingIsFinished = YES;
@@ -546,7 +484,7 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
 
 - (void)destroyDataFBO;
 {
-    runSynchronouslyOnVideoProcessingQueue(^{
+    runSynchronouslyOnContextQueue(_movieWriterContext, ^{
         [_movieWriterContext useAsCurrentContext];
 
         if (movieFramebuffer)
@@ -643,7 +581,7 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
 
     if (CMTIME_IS_INVALID(startTime))
     {
-        runSynchronouslyOnVideoProcessingQueue(^{
+        runSynchronouslyOnContextQueue(_movieWriterContext, ^{
             if ((videoInputReadyCallback == NULL) && (assetWriter.status != AVAssetWriterStatusWriting))
             {
                 [assetWriter startWriting];
@@ -657,7 +595,7 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
     GPUImageFramebuffer *inputFramebufferForBlock = firstInputFramebuffer;
     glFinish();
 
-    runAsynchronouslyOnVideoProcessingQueue(^{
+    runAsynchronouslyOnContextQueue(_movieWriterContext, ^{
         if (!assetWriterVideoInput.readyForMoreMediaData && _encodingLiveVideo)
         {
             [inputFramebufferForBlock unlock];
@@ -707,6 +645,8 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
             {
                 if (![assetWriterPixelBufferInput appendPixelBuffer:pixel_buffer withPresentationTime:frameTime])
                     NSLog(@"Problem appending pixel buffer at time: %@", CFBridgingRelease(CMTimeCopyDescription(kCFAllocatorDefault, frameTime)));
+                else
+                    [_audioLane noteVideoFrameAtTime:frameTime];
             }
             else
             {
@@ -774,6 +714,12 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
     return NO;
 }
 
+- (BOOL)wantsFrameAtTime:(CMTime)frameTime;
+{
+    // The same frames -newFrameReadyAtTime:atIndex: would drop, so branches feeding only the writer idle until recording starts
+    return isRecording && CMTIME_IS_NUMERIC(frameTime);
+}
+
 #pragma mark - Accessors
 
 - (void)setHasAudioTrack:(BOOL)newValue
@@ -838,6 +784,12 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
         assetWriterAudioInput = [AVAssetWriterInput assetWriterInputWithMediaType:AVMediaTypeAudio outputSettings:audioOutputSettings];
         [assetWriter addInput:assetWriterAudioInput];
         assetWriterAudioInput.expectsMediaDataInRealTime = _encodingLiveVideo;
+
+        // A second of 1024 frame blocks at 44.1 kHz, enough to ride out a stalled encoder
+        _audioLane = [[GPUImageAudioLane alloc] initWithAssetWriter:assetWriter input:assetWriterAudioInput capacity:64];
+        _audioLane.waitsForWriterInput = !_encodingLiveVideo;
+        _audioLane.invalidatesSampleBuffers = _shouldInvalidateAudioSampleWhenDone;
+        _audioLane.sampleCallback = _audioProcessingCallback;
     }
     else
     {
@@ -845,6 +797,24 @@ NSString *const kGPUImageColorSwizzlingFragmentShaderString = SHADER_STRING
     }
 }
 
+- (void)setEncodingLiveVideo:(BOOL)newValue
+{
+    _encodingLiveVideo = newValue;
+    _audioLane.waitsForWriterInput = !newValue;
+}
+
+- (void)setShouldInvalidateAudioSampleWhenDone:(BOOL)newValue
+{
+    _shouldInvalidateAudioSampleWhenDone = newValue;
+    _audioLane.invalidatesSampleBuffers = newValue;
+}
+
+- (void)setAudioProcessingCallback:(void (^)(SInt16 **, CMItemCount))newValue
+{
+    _audioProcessingCallback = [newValue copy];
+    _audioLane.sampleCallback = _audioProcessingCallback;
+}
+
 - (NSArray*)metaData {
     return assetWriter.metadata;
 }
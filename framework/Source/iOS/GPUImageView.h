@@ -1,6 +1,8 @@
 #import <UIKit/UIKit.h>
 #import "GPUImageContext.h"
 
+@class GPUImageDisplayCompositor;
+
 typedef enum {
     kGPUImageFillModeStretch,                       // Stretch to fill the full view, which may distort the image outside of its normal aspect ratio
     kGPUImageFillModePreserveAspectRatio,           // Maintains the aspect ratio of the source image, adding bars of the specified background color
@@ -31,4 +33,15 @@ typedef enum {
  */
 - (void)setBackgroundColorRed:(GLfloat)redComponent green:(GLfloat)greenComponent blue:(GLfloat)blueComponent alpha:(GLfloat)alphaComponent;
 
+/// @name Compositing
+
+/// The compositor presenting this view, set by -[GPUImageDisplayCompositor addView:]. Without one the view presents each frame as it arrives
+@property (nonatomic, weak) GPUImageDisplayCompositor *displayCompositor;
+
+/// Draw a frame into the view's display framebuffer without presenting it. Call on the video processing queue
+- (void)drawFramebufferForDisplay:(GPUImageFramebuffer *)framebuffer;
+
+/// Present what was drawn last. Call on the video processing queue
+- (void)presentFramebuffer;
+
 @end
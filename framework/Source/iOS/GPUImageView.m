@@ -3,6 +3,7 @@
 #import <QuartzCore/QuartzCore.h>
 #import "GPUImageContext.h"
 #import "GPUImageFilter.h"
+#import "GPUImageDisplayCompositor.h"
 #import <AVFoundation/AVFoundation.h>
 
 #pragma mark -
@@ -27,6 +28,10 @@
 
 @property (nonatomic, assign) CGSize inputImageSize;
 
+// Size of the image relative to the view, above 1.0 where it is cropped
+@property (nonatomic, assign) GLfloat imageWidthScaling;
+@property (nonatomic, assign) GLfloat imageHeightScaling;
+
 @property (nonatomic, assign) GLfloat backgroundColorRed;
 @property (nonatomic, assign) GLfloat backgroundColorGreen;
 @property (nonatomic, assign) GLfloat backgroundColorBlue;
@@ -34,6 +39,9 @@
 
 @property (nonatomic, assign) CGSize boundsSizeAtFrameBufferEpoch;
 
+// Kept on the main thread, read on the video processing queue
+@property (atomic, assign) BOOL visibleOnScreen;
+
 @end
 
 @implementation GPUImageView
@@ -79,10 +87,20 @@
 
   runSynchronouslyOnVideoProcessingQueue(^{
     [GPUImageContext useImageProcessingContext];
-    self.displayProgram = [[GLProgram alloc] initWithVertexShaderString:kGPUImageVertexShaderString fragmentShaderString:kGPUImagePassthroughFragmentShaderString];
-    if (!self.displayProgram.initialized) {
-      [self initializeAttributes];
-      [self.displayProgram link];
+    // Views of a class share one program, so that a compositor drawing several of them binds it once
+    static NSMutableDictionary *displayPrograms = nil;
+    if (displayPrograms == nil) {
+      displayPrograms = [NSMutableDictionary dictionary];
+    }
+    NSString *programKey = NSStringFromClass([self class]);
+    self.displayProgram = displayPrograms[programKey];
+    if (self.displayProgram == nil) {
+      self.displayProgram = [[GLProgram alloc] initWithVertexShaderString:kGPUImageVertexShaderString fragmentShaderString:kGPUImagePassthroughFragmentShaderString];
+      if (!self.displayProgram.initialized) {
+        [self initializeAttributes];
+        [self.displayProgram link];
+      }
+      displayPrograms[programKey] = self.displayProgram;
     }
 
     [self configGL];
@@ -134,6 +152,8 @@
                 break;
         }
         NSAssert(!isnan(widthScaling) && !isnan(heightScaling), @"Invalid scaling");
+        self.imageWidthScaling = widthScaling;
+        self.imageHeightScaling = heightScaling;
         [self clearVerticesAndTextureCoordinates];
         runSynchronouslyOnVideoProcessingQueue(^{
             GLuint verticesBuffer;
@@ -231,6 +251,7 @@
     [self createDisplayFramebuffer];
   }
   glBindFramebuffer(GL_FRAMEBUFFER, displayFramebuffer);
+  glViewport(0, 0, (GLint)_sizeInPixels.width, (GLint)_sizeInPixels.height);
 }
 
 - (void)presentFramebuffer {
@@ -252,25 +273,34 @@
 
 - (void)newFrameReadyAtTime:(CMTime)frameTime atIndex:(NSInteger)textureIndex {
     runSynchronouslyOnVideoProcessingQueue(^{
-        [GPUImageContext setActiveShaderProgram:self.displayProgram];
-        [self setDisplayFramebuffer];
+        GPUImageDisplayCompositor *compositor = self.displayCompositor;
+        if (compositor != nil) {
+            // The compositor takes over the lock and presents on the next display refresh
+            [compositor enqueueFramebuffer:self.inputFramebufferForDisplay forView:self];
+        } else {
+            [self drawFramebufferForDisplay:self.inputFramebufferForDisplay];
+            [self presentFramebuffer];
+            [self.inputFramebufferForDisplay unlock];
+        }
+        self.inputFramebufferForDisplay = nil;
+    });
+}
 
-        glClearColor(self.backgroundColorRed, self.backgroundColorGreen, self.backgroundColorBlue, self.backgroundColorAlpha);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+- (void)drawFramebufferForDisplay:(GPUImageFramebuffer *)framebuffer {
+    [GPUImageContext setActiveShaderProgram:self.displayProgram];
+    [self setDisplayFramebuffer];
 
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_2D, [self.inputFramebufferForDisplay texture]);
+    glClearColor(self.backgroundColorRed, self.backgroundColorGreen, self.backgroundColorBlue, self.backgroundColorAlpha);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        [self bindVerticesAndIndices];
+    glActiveTexture(GL_TEXTURE4);
+    glBindTexture(GL_TEXTURE_2D, [framebuffer texture]);
 
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    [self bindVerticesAndIndices];
 
-        [self unbindVerticesAndIndices];
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-        [self presentFramebuffer];
-        [self.inputFramebufferForDisplay unlock];
-        self.inputFramebufferForDisplay = nil;
-    });
+    [self unbindVerticesAndIndices];
 }
 
 #pragma mark - Vertices & Indices
@@ -313,6 +343,14 @@
     });
 }
 
+- (CGRect)regionOfInterestForInputAtIndex:(NSInteger)textureIndex {
+    // Only the center of the image is visible when filling the view
+    GLfloat visibleWidth = (self.imageWidthScaling > 1.0) ? 1.0 / self.imageWidthScaling : 1.0;
+    GLfloat visibleHeight = (self.imageHeightScaling > 1.0) ? 1.0 / self.imageHeightScaling : 1.0;
+    CGRect visibleRegion = CGRectMake(0.5 * (1.0 - visibleWidth), 0.5 * (1.0 - visibleHeight), visibleWidth, visibleHeight);
+    return rotatedRect(visibleRegion, self.inputRotation);
+}
+
 - (CGSize)maximumOutputSize {
     if ([self respondsToSelector:@selector(setContentScaleFactor:)]) {
         CGSize pointSize = self.bounds.size;
@@ -329,6 +367,27 @@
     return NO;
 }
 
+- (BOOL)wantsFrameAtTime:(CMTime)frameTime {
+    // Off screen or hidden, nothing upstream needs to render for the view
+    return self.visibleOnScreen;
+}
+
+#pragma mark - Visibility
+
+- (void)didMoveToWindow {
+    [super didMoveToWindow];
+    [self updateVisibleOnScreen];
+}
+
+- (void)setHidden:(BOOL)hidden {
+    [super setHidden:hidden];
+    [self updateVisibleOnScreen];
+}
+
+- (void)updateVisibleOnScreen {
+    self.visibleOnScreen = (self.window != nil && !self.hidden);
+}
+
 #pragma mark - Accessors
 
 - (CGSize)sizeInPixels {